@@ -9,6 +9,7 @@
 #include "SkAAClip.h"
 #include "SkCanvas.h"
 #include "SkPath.h"
+#include "SkPictureRecorder.h"
 #include "SkRandom.h"
 #include "SkRegion.h"
 #include "SkString.h"
@@ -242,6 +243,71 @@ private:
     typedef Benchmark INHERITED;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// This bench plays a picture that sets up an AA clip back onto several canvases in turn, as
+// when many threads (or many frames) play back the same clipped content. With shared set,
+// every canvas ends up with the same clip stack, so the clip should be served from
+// SkAAClipCache. Otherwise the picture is moved by a fraction of a pixel each loop, so the
+// clip has to be built from scratch.
+class AAClipReplayBench : public Benchmark {
+    SkString            fName;
+    sk_sp<SkPicture>    fPicture;
+    SkBitmap            fBitmaps[4];
+    bool                fShared;
+
+public:
+    AAClipReplayBench(bool shared) : fShared(shared) {
+        fName.printf("aaclip_replay_%s", shared ? "shared" : "unique");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    void onDelayedSetup() override {
+        // a many-sided star, so that scan converting it is not trivial
+        SkPath clipPath;
+        const int kPoints = 24;
+        for (int i = 0; i < kPoints * 2; ++i) {
+            SkScalar r = (i & 1) ? SkIntToScalar(120) : SkIntToScalar(200);
+            SkScalar angle = SK_ScalarPI * i / kPoints;
+            SkPoint pt = SkPoint::Make(320 + r * SkScalarCos(angle), 240 + r * SkScalarSin(angle));
+            if (0 == i) {
+                clipPath.moveTo(pt);
+            } else {
+                clipPath.lineTo(pt);
+            }
+        }
+        clipPath.close();
+
+        SkPictureRecorder recorder;
+        SkCanvas* canvas = recorder.beginRecording(640, 480);
+        canvas->save();
+        canvas->clipRect(SkRect::MakeLTRB(20, 20, 620, 460));
+        canvas->clipPath(clipPath, SkRegion::kIntersect_Op, true);
+        canvas->drawRect(SkRect::MakeWH(16, 16), SkPaint());
+        canvas->restore();
+        fPicture = recorder.finishRecordingAsPicture();
+
+        for (SkBitmap& bm : fBitmaps) {
+            bm.allocN32Pixels(640, 480);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkCanvas canvas(fBitmaps[i % SK_ARRAY_COUNT(fBitmaps)]);
+            if (!fShared) {
+                canvas.translate(SkIntToScalar(i % 1024) / 1024, 0);
+            }
+            canvas.drawPicture(fPicture);
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH(return new AAClipBuilderBench(false, false);)
@@ -255,3 +321,5 @@ DEF_BENCH(return new AAClipBench(true, false);)
 DEF_BENCH(return new AAClipBench(true, true);)
 DEF_BENCH(return new NestedAAClipBench(false);)
 DEF_BENCH(return new NestedAAClipBench(true);)
+DEF_BENCH(return new AAClipReplayBench(true);)
+DEF_BENCH(return new AAClipReplayBench(false);)
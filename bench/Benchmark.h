@@ -126,6 +126,9 @@ public:
 
     virtual void getGpuStats(SkCanvas*, SkTArray<SkString>* keys, SkTArray<double>* values) {}
 
+    // Extra metrics to log, like throughput. msPerLoop is the fastest time measured per loop.
+    virtual void getStats(double msPerLoop, SkTArray<SkString>* keys, SkTArray<double>* values) {}
+
 protected:
     virtual void setupPaint(SkPaint* paint);
 
@@ -7,8 +7,11 @@
 
 #include "BitmapRegionDecoderBench.h"
 #include "CodecBenchPriv.h"
+#include "Resources.h"
 #include "SkBitmap.h"
 #include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkTDArray.h"
 
 BitmapRegionDecoderBench::BitmapRegionDecoderBench(const char* baseName, SkData* encoded,
         SkColorType colorType, uint32_t sampleSize, const SkIRect& subset)
@@ -45,3 +48,144 @@ void BitmapRegionDecoderBench::onDraw(int n, SkCanvas* canvas) {
         SkAssertResult(fBRD->decodeRegion(&bm, nullptr, fSubset, fSampleSize, fColorType, false));
     }
 }
+
+static uint32_t read_be16(const uint8_t* data) {
+    return (data[0] << 8) | data[1];
+}
+
+static void write_be16(uint8_t* data, uint32_t value) {
+    data[0] = (uint8_t) (value >> 8);
+    data[1] = (uint8_t) value;
+}
+
+/*
+ *  Builds a large jpeg by tiling the MCU rows of a small one, tilesX times across and
+ *  tilesY times down.  The small jpeg must be baseline, with a restart marker after every
+ *  MCU row, so that rows can be copied without re-encoding them.
+ */
+static sk_sp<SkData> make_tiled_jpeg(const char* path, int tilesX, int tilesY) {
+    sk_sp<SkData> src = SkData::MakeFromFileName(GetResourcePath(path).c_str());
+    if (!src) {
+        return nullptr;
+    }
+    const uint8_t* data = src->bytes();
+    const size_t length = src->size();
+
+    // Find the frame header and the start of the scan.
+    size_t offset = 2;
+    size_t frameOffset = 0;
+    size_t scanOffset = 0;
+    uint32_t mcuHeight = 8;
+    while (0 == scanOffset) {
+        if (offset + 4 > length || 0xFF != data[offset]) {
+            return nullptr;
+        }
+        const uint8_t marker = data[offset + 1];
+        const size_t segmentLength = read_be16(data + offset + 2);
+        if (0xC0 == marker) {
+            frameOffset = offset + 4;
+            for (uint32_t i = 0; i < data[frameOffset + 5]; i++) {
+                mcuHeight = SkTMax<uint32_t>(mcuHeight, 8 * (data[frameOffset + 7 + 3 * i] & 0xF));
+            }
+        } else if (0xDA == marker) {
+            scanOffset = offset + 2 + segmentLength;
+        }
+        offset += 2 + segmentLength;
+    }
+    if (0 == frameOffset) {
+        return nullptr;
+    }
+
+    // Each MCU row ends with a restart marker, or with the end of the image.
+    SkTDArray<size_t> rowEnds;
+    for (size_t i = scanOffset; i + 1 < length; i++) {
+        if (0xFF == data[i] && ((data[i + 1] >= 0xD0 && data[i + 1] <= 0xD7) ||
+                                0xD9 == data[i + 1])) {
+            *rowEnds.append() = i;
+        }
+    }
+    const uint32_t height = read_be16(data + frameOffset + 1);
+    const uint32_t width = read_be16(data + frameOffset + 3);
+    const int rows = (height + mcuHeight - 1) / mcuHeight;
+    if (rows != rowEnds.count() || 0 != height % mcuHeight || width * tilesX > 0xFFFF ||
+            height * tilesY > 0xFFFF) {
+        return nullptr;
+    }
+
+    SkDynamicMemoryWStream stream;
+    SkAutoTMalloc<uint8_t> header(scanOffset);
+    memcpy(header.get(), data, scanOffset);
+    write_be16(header.get() + frameOffset + 1, height * tilesY);
+    write_be16(header.get() + frameOffset + 3, width * tilesX);
+    stream.write(header.get(), scanOffset);
+
+    int restarts = 0;
+    const int totalRows = rows * tilesY;
+    for (int y = 0; y < totalRows; y++) {
+        const int row = y % rows;
+        const size_t start = row ? rowEnds[row - 1] + 2 : scanOffset;
+        for (int x = 0; x < tilesX; x++) {
+            stream.write(data + start, rowEnds[row] - start);
+            const uint8_t marker[] = { 0xFF, (uint8_t) (0xD0 + (restarts++ % 8)) };
+            if (y < totalRows - 1 || x < tilesX - 1) {
+                stream.write(marker, sizeof(marker));
+            }
+        }
+    }
+    const uint8_t eoi[] = { 0xFF, 0xD9 };
+    stream.write(eoi, sizeof(eoi));
+    return sk_sp<SkData>(stream.copyToData());
+}
+
+/*
+ *  Decodes a tile from the top or the bottom of a 1024x49152 (50 megapixel) jpeg with restart
+ *  markers, as a viewer would when scrolling through a very tall image.
+ */
+class TallJpegRegionBench : public Benchmark {
+public:
+    TallJpegRegionBench(bool bottom)
+        : fBottom(bottom)
+    {
+        fName.printf("BRD_tall_jpeg_50mp_%s", bottom ? "bottom" : "top");
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    bool isSuitableFor(Backend backend) override {
+        return kNonRendering_Backend == backend;
+    }
+
+    void onDelayedSetup() override {
+        fData = make_tiled_jpeg("mandrill_512_q075_restart.jpg", 2, 96);
+        if (fData) {
+            fBRD.reset(SkBitmapRegionDecoder::Create(fData.get(),
+                                                     SkBitmapRegionDecoder::kAndroidCodec_Strategy));
+        }
+    }
+
+    void onDraw(int n, SkCanvas*) override {
+        if (!fBRD) {
+            return;
+        }
+        const int top = fBottom ? fBRD->height() - kTileSize : 0;
+        const SkIRect subset = SkIRect::MakeXYWH(kTileSize / 2, top, kTileSize, kTileSize);
+        for (int i = 0; i < n; i++) {
+            SkBitmap bm;
+            SkAssertResult(fBRD->decodeRegion(&bm, nullptr, subset, 1, kN32_SkColorType, false));
+        }
+    }
+
+private:
+    static const int kTileSize = 512;
+
+    SkString                             fName;
+    const bool                           fBottom;
+    sk_sp<SkData>                        fData;
+    SkAutoTDelete<SkBitmapRegionDecoder> fBRD;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new TallJpegRegionBench(false);)
+DEF_BENCH(return new TallJpegRegionBench(true);)
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkClipStack.h"
+#include "SkRRect.h"
+#include "SkRandom.h"
+#include "SkString.h"
+
+// Models the clip stacks produced by web content: a deep stack of saves, each intersecting a
+// (mostly) rect or rounded-rect clip, queried many times per draw.
+class ClipStackQuickContainsBench : public Benchmark {
+public:
+    ClipStackQuickContainsBench(int depth, bool rrects) : fDepth(depth), fRRects(rrects) {
+        fName.printf("clipstack_quickcontains_%s_%d", rrects ? "rrect" : "rect", depth);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkRect bounds = SkRect::MakeWH(1024, 4096);
+        for (int i = 0; i < fDepth; ++i) {
+            fStack.save();
+            bounds.inset(4, 4);
+            if (fRRects && (i & 1)) {
+                SkRRect rrect;
+                rrect.setRectXY(bounds, 8, 8);
+                fStack.clipDevRRect(rrect, SkRegion::kIntersect_Op, true);
+            } else {
+                fStack.clipDevRect(bounds, SkRegion::kIntersect_Op, false);
+            }
+        }
+
+        SkRandom rand;
+        for (int i = 0; i < kQueryCount; ++i) {
+            SkScalar x = rand.nextRangeScalar(0, 1024);
+            SkScalar y = rand.nextRangeScalar(0, 4096);
+            fQueries[i] = SkRect::MakeXYWH(x, y, 64, 16);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            // Each query is repeated, as it is when several layers check the same draw.
+            for (int j = 0; j < kQueryCount; ++j) {
+                fStack.quickContains(fQueries[j]);
+                fStack.quickContains(fQueries[j]);
+
+                SkRect bounds;
+                bool isIntersectionOfRects;
+                fStack.getConservativeBounds(0, 0, 1024, 4096, &bounds, &isIntersectionOfRects);
+            }
+        }
+    }
+
+private:
+    static const int kQueryCount = 256;
+
+    int         fDepth;
+    bool        fRRects;
+    SkString    fName;
+    SkClipStack fStack;
+    SkRect      fQueries[kQueryCount];
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new ClipStackQuickContainsBench(8, false);)
+DEF_BENCH(return new ClipStackQuickContainsBench(64, false);)
+DEF_BENCH(return new ClipStackQuickContainsBench(8, true);)
+DEF_BENCH(return new ClipStackQuickContainsBench(64, true);)
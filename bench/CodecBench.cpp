@@ -7,27 +7,35 @@
 
 #include "CodecBench.h"
 #include "CodecBenchPriv.h"
+#include "Resources.h"
 #include "SkBitmap.h"
 #include "SkCodec.h"
+#include "SkColorPriv.h"
 #include "SkCommandLineFlags.h"
+#include "SkImageEncoder.h"
 #include "SkOSFile.h"
+#include "SkRandom.h"
+#include "SkStream.h"
 
 // Actually zeroing the memory would throw off timing, so we just lie.
 DEFINE_bool(zero_init, false, "Pretend our destination is zero-intialized, simulating Android?");
 
 CodecBench::CodecBench(SkString baseName, SkData* encoded, SkColorType colorType,
-        SkAlphaType alphaType)
+        SkAlphaType alphaType, bool allFrames)
     : fColorType(colorType)
     , fAlphaType(alphaType)
-    , fData(SkRef(encoded))
+    , fAllFrames(allFrames)
+    , fData(SkSafeRef(encoded))
 {
     // Parse filename and the color type to give the benchmark a useful name
-    fName.printf("Codec_%s_%s%s", baseName.c_str(), color_type_to_str(colorType),
-            alpha_type_to_str(alphaType));
+    fName.printf("Codec_%s_%s%s%s", baseName.c_str(), color_type_to_str(colorType),
+            alpha_type_to_str(alphaType), allFrames ? "_frames" : "");
 #ifdef SK_DEBUG
     // Ensure that we can create an SkCodec from this data.
-    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(fData));
-    SkASSERT(codec);
+    if (fData) {
+        SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(fData));
+        SkASSERT(codec);
+    }
 #endif
 }
 
@@ -58,6 +66,10 @@ void CodecBench::onDraw(int n, SkCanvas* canvas) {
     for (int i = 0; i < n; i++) {
         colorCount = 256;
         codec.reset(SkCodec::NewFromData(fData));
+        if (fAllFrames) {
+            this->drawAllFrames(codec, &options);
+            continue;
+        }
 #ifdef SK_DEBUG
         const SkCodec::Result result =
 #endif
@@ -67,3 +79,140 @@ void CodecBench::onDraw(int n, SkCanvas* canvas) {
                  || result == SkCodec::kIncompleteInput);
     }
 }
+
+void CodecBench::drawAllFrames(SkCodec* codec, SkCodec::Options* options) {
+    // Like a simple player, we only keep the last frame around.
+    const int frameCount = codec->getFrameCount();
+    for (int frame = 0; frame < frameCount; frame++) {
+        SkCodec::FrameInfo frameInfo;
+        SkAssertResult(codec->getFrameInfo(frame, &frameInfo));
+        options->fFrameIndex = frame;
+        options->fHasPriorFrame = frame > 0 && frameInfo.fRequiredFrame == frame - 1;
+#ifdef SK_DEBUG
+        const SkCodec::Result result =
+#endif
+        codec->getPixels(fInfo, fPixelStorage.get(), fInfo.minRowBytes(), options,
+                         nullptr, nullptr);
+        SkASSERT(result == SkCodec::kSuccess
+                 || result == SkCodec::kIncompleteInput);
+    }
+}
+
+// PNGs that nanobench's --images usually doesn't include: an interlaced one, and an 8k one,
+// where decoding can overlap inflating with swizzling. They are only read or made in
+// onDelayedSetup(), since encoding the 8k PNG takes a while.
+class PngCodecBench : public CodecBench {
+public:
+    // Decodes the resource, or if it is null, a width x height PNG.
+    PngCodecBench(const char* baseName, const char* resource, int width, int height)
+        : INHERITED(SkString(baseName), nullptr, kN32_SkColorType, kPremul_SkAlphaType)
+        , fResource(resource)
+        , fWidth(width)
+        , fHeight(height)
+    {}
+
+protected:
+    void onDelayedSetup() override {
+        if (fResource) {
+            SkString path(GetResourcePath(fResource));
+            this->setData(SkData::MakeFromFileName(path.c_str()));
+        } else {
+            // Smooth gradients with some noise compress about as well as photos.
+            SkBitmap bm;
+            bm.allocN32Pixels(fWidth, fHeight, true);
+            SkRandom rand;
+            for (int y = 0; y < fHeight; y++) {
+                uint32_t* row = bm.getAddr32(0, y);
+                for (int x = 0; x < fWidth; x++) {
+                    const unsigned noise = rand.nextU() & 0x0F;
+                    row[x] = SkPackARGB32(0xFF, (x * 255 / fWidth) ^ noise,
+                                          (y * 255 / fHeight) ^ noise, ((x + y) & 0xFF) ^ noise);
+                }
+            }
+            this->setData(sk_sp<SkData>(SkImageEncoder::EncodeData(bm, SkImageEncoder::kPNG_Type,
+                                                                   100)));
+        }
+        INHERITED::onDelayedSetup();
+    }
+
+private:
+    const char* fResource;
+    const int   fWidth;
+    const int   fHeight;
+
+    typedef CodecBench INHERITED;
+};
+
+DEF_BENCH(return new PngCodecBench("interlaced.png", "mandrill_256_interlaced.png", 0, 0);)
+DEF_BENCH(return new PngCodecBench("8k.png", nullptr, 7680, 4320);)
+
+// Page sized scans, as bottom-up bmps and as a wbmp. Every row of these is the same size, so
+// they are decoded in bands on other threads. Made in onDelayedSetup(), like the 8k PNG.
+class ScanCodecBench : public CodecBench {
+public:
+    // A bitsPerPixel of 1 makes a wbmp. 16 bit bmps use bit masks, and 8 bit ones a gray
+    // color table.
+    ScanCodecBench(const char* baseName, int bitsPerPixel)
+        : INHERITED(SkString(baseName), nullptr, kN32_SkColorType, kPremul_SkAlphaType)
+        , fBitsPerPixel(bitsPerPixel)
+    {}
+
+protected:
+    void onDelayedSetup() override {
+        // A4 at 300 dpi.
+        const int width = 2480, height = 3508;
+        const bool masks = 16 == fBitsPerPixel;
+        const int colors = 8 == fBitsPerPixel ? 256 : 0;
+        const int rowBytes = 1 == fBitsPerPixel ? (width + 7) / 8
+                                                : SkAlign4(width * fBitsPerPixel / 8);
+
+        SkDynamicMemoryWStream stream;
+        if (1 == fBitsPerPixel) {
+            const uint8_t header[] = {
+                0, 0,
+                (uint8_t) (0x80 | (width >> 7)), (uint8_t) (width & 0x7F),
+                (uint8_t) (0x80 | (height >> 7)), (uint8_t) (height & 0x7F),
+            };
+            stream.write(header, sizeof(header));
+        } else {
+            const uint32_t headerBytes = 14 + 40 + (masks ? 12 : 0) + colors * 4;
+            const uint32_t header[] = {
+                headerBytes + rowBytes * height, 0, headerBytes,
+                40, (uint32_t) width, (uint32_t) height, (uint32_t) (1 | (fBitsPerPixel << 16)),
+                masks ? 3u : 0u, (uint32_t) (rowBytes * height), 2835, 2835, (uint32_t) colors, 0,
+            };
+            stream.write("BM", 2);
+            stream.write(header, sizeof(header));
+            if (masks) {
+                const uint32_t rgb565[] = { 0xF800, 0x07E0, 0x001F };
+                stream.write(rgb565, sizeof(rgb565));
+            }
+            for (int i = 0; i < colors; i++) {
+                stream.write32(SkColorSetRGB(i, i, i));
+            }
+        }
+
+        // Mostly white, with darker bands for lines of text.
+        SkRandom rand;
+        SkAutoTMalloc<uint8_t> row(rowBytes);
+        for (int y = 0; y < height; y++) {
+            const bool text = (y / 20) % 3 == 0;
+            for (int i = 0; i < rowBytes; i++) {
+                row[i] = text ? rand.nextU() & 0xFF : 0xFF;
+            }
+            stream.write(row.get(), rowBytes);
+        }
+        this->setData(sk_sp<SkData>(stream.copyToData()));
+        INHERITED::onDelayedSetup();
+    }
+
+private:
+    const int fBitsPerPixel;
+
+    typedef CodecBench INHERITED;
+};
+
+DEF_BENCH(return new ScanCodecBench("scan24.bmp", 24);)
+DEF_BENCH(return new ScanCodecBench("scan16.bmp", 16);)
+DEF_BENCH(return new ScanCodecBench("scan8.bmp", 8);)
+DEF_BENCH(return new ScanCodecBench("scan.wbmp", 1);)
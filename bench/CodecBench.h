@@ -9,6 +9,7 @@
 #define CodecBench_DEFINED
 
 #include "Benchmark.h"
+#include "SkCodec.h"
 #include "SkData.h"
 #include "SkImageInfo.h"
 #include "SkRefCnt.h"
@@ -19,19 +20,29 @@
  */
 class CodecBench : public Benchmark {
 public:
-    // Calls encoded->ref()
-    CodecBench(SkString basename, SkData* encoded, SkColorType colorType, SkAlphaType alphaType);
+    // Calls encoded->ref(), if encoded is not null.
+    // If allFrames is true, each draw plays back every frame of the image, decoding each
+    // frame on top of the previous one when possible.
+    CodecBench(SkString basename, SkData* encoded, SkColorType colorType, SkAlphaType alphaType,
+            bool allFrames = false);
 
 protected:
+    // Subclasses may pass a null encoded to the constructor, and call this in onDelayedSetup(),
+    // before calling CodecBench::onDelayedSetup().
+    void setData(sk_sp<SkData> encoded) { fData.reset(encoded.release()); }
+
     const char* onGetName() override;
     bool isSuitableFor(Backend backend) override;
     void onDraw(int n, SkCanvas* canvas) override;
     void onDelayedSetup() override;
 
 private:
+    void drawAllFrames(SkCodec*, SkCodec::Options*);
+
     SkString                fName;
     const SkColorType       fColorType;
     const SkAlphaType       fAlphaType;
+    const bool              fAllFrames;
     SkAutoTUnref<SkData>    fData;
     SkImageInfo             fInfo;          // Set in onDelayedSetup.
     SkAutoMalloc            fPixelStorage;
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "SkDistanceFieldGen.h"
+#include "SkFontMgr.h"
+#include "SkGlyphCache.h"
+#include "SkTArray.h"
+#include "SkTypeface.h"
+
+// Generates the distance fields of the glyphs of a font's Latin and common CJK characters, as
+// the GPU's distance field text would to fill its atlas, one at a time or in a batch.
+class DistanceFieldBench : public Benchmark {
+public:
+    explicit DistanceFieldBench(bool batch) : fBatch(batch) {}
+
+protected:
+    const char* onGetName() override {
+        return fBatch ? "distance_field_glyphs_batch" : "distance_field_glyphs";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        // Basic Latin and Latin-1 through Latin Extended-A.
+        SkTDArray<SkUnichar> latin;
+        for (SkUnichar c = 0x20; c < 0x7F; ++c) {
+            *latin.append() = c;
+        }
+        for (SkUnichar c = 0xA0; c < 0x180; ++c) {
+            *latin.append() = c;
+        }
+        this->addGlyphs(SkTypeface::MakeDefault(), latin);
+
+        sk_sp<SkFontMgr> fontMgr(SkFontMgr::RefDefault());
+        sk_sp<SkTypeface> cjk(fontMgr->matchFamilyStyleCharacter(nullptr, SkFontStyle(),
+                                                                 nullptr, 0, 0x4E2D));
+        if (cjk) {
+            SkTDArray<SkUnichar> ideographs;
+            for (SkUnichar c = 0x4E00; c < 0x4E00 + 2000; ++c) {
+                *ideographs.append() = c;
+            }
+            this->addGlyphs(std::move(cjk), ideographs);
+        }
+
+        // Skip the glyphs that fail, as the atlas would, so both ways time the same fields.
+        SkGenerateDistanceFields(fImages.begin(), fImages.count());
+        for (int i = fImages.count() - 1; i >= 0; --i) {
+            if (!fImages[i].fSuccess) {
+                fImages.removeShuffle(i);
+            }
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            if (fBatch) {
+                SkGenerateDistanceFields(fImages.begin(), fImages.count());
+                continue;
+            }
+            for (const SkDistanceFieldImage& image : fImages) {
+                SkGenerateDistanceFieldFromA8Image(image.fDistanceField, image.fImage,
+                                                   image.fWidth, image.fHeight, image.fRowBytes);
+            }
+        }
+    }
+
+private:
+    // Adds the A8 masks of the glyphs of typeface for chars, at the size distance field text
+    // generates its smallest fields from.
+    void addGlyphs(sk_sp<SkTypeface> typeface, const SkTDArray<SkUnichar>& chars) {
+        SkPaint paint;
+        paint.setTypeface(std::move(typeface));
+        paint.setTextSize(32);
+        paint.setAntiAlias(true);
+        SkAutoGlyphCache autoCache(paint, nullptr, nullptr);
+        SkGlyphCache* cache = autoCache.getCache();
+        for (SkUnichar c : chars) {
+            const SkGlyph& glyph = cache->getUnicharMetrics(c);
+            const void* image = cache->findImage(glyph);
+            if (!image || SkMask::kA8_Format != glyph.fMaskFormat) {
+                continue;
+            }
+            // The cache may purge its images, so the bench keeps its own.
+            size_t imageSize = glyph.computeImageSize();
+            SkAutoTMalloc<unsigned char>& copy = fStorage.push_back();
+            copy.reset(imageSize + SkComputeDistanceFieldSize(glyph.fWidth, glyph.fHeight));
+            memcpy(copy.get(), image, imageSize);
+            SkDistanceFieldImage* dfImage = fImages.append();
+            dfImage->fDistanceField = copy.get() + imageSize;
+            dfImage->fImage = copy.get();
+            dfImage->fWidth = glyph.fWidth;
+            dfImage->fHeight = glyph.fHeight;
+            dfImage->fRowBytes = glyph.rowBytes();
+            dfImage->fIsBW = false;
+        }
+    }
+
+    const bool                                   fBatch;
+    SkTArray<SkAutoTMalloc<unsigned char>, true> fStorage;
+    SkTDArray<SkDistanceFieldImage>              fImages;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new DistanceFieldBench(false);)
+DEF_BENCH(return new DistanceFieldBench(true);)
@@ -6,10 +6,14 @@
  */
 
 #include "Benchmark.h"
+#include "ProcStats.h"
 #include "Resources.h"
 #include "SkBitmap.h"
+#include "SkCanvas.h"
 #include "SkData.h"
+#include "SkGradientShader.h"
 #include "SkImageEncoder.h"
+#include "SkStream.h"
 
 class EncodeBench : public Benchmark {
 public:
@@ -79,3 +83,139 @@ DEF_BENCH(return new EncodeBench("color_wheel.jpg", SkImageEncoder::kPNG_Type, 9
 // TODO: What is the appropriate quality to use to benchmark WEBP encodes?
 DEF_BENCH(return new EncodeBench("mandrill_512.png", SkImageEncoder::kWEBP_Type, 90));
 DEF_BENCH(return new EncodeBench("color_wheel.jpg", SkImageEncoder::kWEBP_Type, 90));
+
+// Only counts the bytes, so that the encoded data doesn't add to the memory in use.
+class CountingWStream : public SkWStream {
+public:
+    CountingWStream() : fBytes(0) {}
+    bool write(const void*, size_t size) override { fBytes += size; return true; }
+    size_t bytesWritten() const override { return fBytes; }
+
+private:
+    size_t fBytes;
+};
+
+// Renders a large image and encodes it, either from one bitmap holding the whole render, or
+// band by band, as a tiled renderer would. Both sides feed the encoder through its row
+// streaming API, so they run the same encoder code and differ only in the pixels they hold.
+// Reports throughput, the peak heap memory the encode took, and the encoded size.
+class EncodeRowsBench : public Benchmark {
+public:
+    EncodeRowsBench(SkImageEncoder::Type type, bool streamRows)
+        : fType(type)
+        , fStreamRows(streamRows)
+        , fEncodedBytes(0)
+        , fPeakBytes(-1)
+    {
+        const char* typeName = SkImageEncoder::kPNG_Type == type ? "PNG" : "JPEG";
+        fName.printf("Encode_%s_%dx%d_%s", streamRows ? "rows" : "bitmap", kWidth, kHeight,
+                     typeName);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onPreDraw(SkCanvas*) override {
+        // Measured outside the timed loops, which don't pay for sampling the heap.
+        fEncodedBytes = this->encode(&fPeakBytes);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            this->encode(nullptr);
+        }
+    }
+
+    void getStats(double msPerLoop, SkTArray<SkString>* keys,
+                  SkTArray<double>* values) override {
+        if (fPeakBytes >= 0) {
+            keys->push_back(SkString("peak_mb"));
+            values->push_back(fPeakBytes / double(1 << 20));
+        }
+        keys->push_back(SkString("mb_per_s"));
+        values->push_back(kWidth * 4.0 * kHeight / (1 << 20) / (msPerLoop / 1000));
+        keys->push_back(SkString("encoded_kb"));
+        values->push_back(fEncodedBytes / 1024.0);
+    }
+
+private:
+    static const int kWidth = 2048;
+    static const int kHeight = 2048;
+    static const int kBandHeight = 128;
+
+    // Renders and encodes the image once, returning the encoded size. If peakBytes is not
+    // null, it is set to the most heap memory held at once above what was in use before, or
+    // to -1 if the heap can't be measured on this platform.
+    size_t encode(long long* peakBytes) {
+        const long long baseline = peakBytes ? sk_tools::getCurrHeapAllocatedBytes() : -1;
+        long long peak = 0;
+        auto sample = [&] {
+            if (baseline >= 0) {
+                peak = SkTMax(peak, sk_tools::getCurrHeapAllocatedBytes() - baseline);
+            }
+        };
+
+        SkAutoTDelete<SkImageEncoder> encoder(SkImageEncoder::Create(fType));
+        if (!encoder) {
+            return 0;
+        }
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(kWidth, kHeight);
+        CountingWStream stream;
+        SkBitmap bm;
+        SkAssertResult(encoder->begin(&stream, info, 90));
+        if (fStreamRows) {
+            bm.allocPixels(info.makeWH(kWidth, kBandHeight));
+            for (int y = 0; y < kHeight; y += kBandHeight) {
+                this->render(&bm, y);
+                sample();
+                const int rows = SkTMin(kHeight - y, int(kBandHeight));
+                SkAssertResult(encoder->encodeRows(bm.getPixels(), bm.rowBytes(), rows));
+                sample();
+            }
+        } else {
+            bm.allocPixels(info);
+            this->render(&bm, 0);
+            sample();
+            SkAssertResult(encoder->encodeRows(bm.getPixels(), bm.rowBytes(), kHeight));
+            sample();
+        }
+        SkAssertResult(encoder->finish());
+        sample();
+
+        if (peakBytes) {
+            *peakBytes = baseline >= 0 ? peak : -1;
+        }
+        return stream.bytesWritten();
+    }
+
+    // Draws the rows of the image starting at top into bm.
+    void render(SkBitmap* bm, int top) {
+        SkCanvas canvas(*bm);
+        canvas.translate(0, SkIntToScalar(-top));
+        const SkPoint pts[] = { { 0, 0 }, { SkIntToScalar(kWidth), SkIntToScalar(kHeight) } };
+        const SkColor colors[] = { SK_ColorBLUE, SK_ColorYELLOW, SK_ColorRED };
+        SkPaint paint;
+        paint.setShader(SkGradientShader::MakeLinear(pts, colors, nullptr, 3,
+                                                     SkShader::kClamp_TileMode));
+        canvas.drawPaint(paint);
+        paint.setShader(nullptr);
+        paint.setAntiAlias(true);
+        for (int i = 0; i < 64; i++) {
+            paint.setColor(SkColorSetARGB(0x80, i * 4, 0xFF - i * 4, i * 2));
+            canvas.drawCircle(SkIntToScalar((i * 397) % kWidth), SkIntToScalar((i * 211) % kHeight),
+                              SkIntToScalar(50 + i), paint);
+        }
+    }
+
+    const SkImageEncoder::Type fType;
+    const bool                 fStreamRows;
+    SkString                   fName;
+    size_t                     fEncodedBytes;
+    long long                  fPeakBytes;
+};
+
+DEF_BENCH(return new EncodeRowsBench(SkImageEncoder::kPNG_Type, false));
+DEF_BENCH(return new EncodeRowsBench(SkImageEncoder::kPNG_Type, true));
+DEF_BENCH(return new EncodeRowsBench(SkImageEncoder::kJPEG_Type, false));
+DEF_BENCH(return new EncodeRowsBench(SkImageEncoder::kJPEG_Type, true));
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID)
+
+#include "Resources.h"
+#include "SkData.h"
+#include "SkFontMgr.h"
+#include "SkFontMgr_custom.h"
+#include "SkOSFile.h"
+#include "SkOTUtils.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTArray.h"
+#include "SkTypeface.h"
+
+#include <stdlib.h>
+
+static const int kFontCount = 2000;
+
+static SkString family_name(int index) {
+    return SkStringPrintf("Bench Family %04d", index);
+}
+
+// Returns a synthetic directory of kFontCount fonts, each the same small font renamed to its own
+// family, writing it the first time.
+static SkString make_font_directory() {
+    const char* tmp = getenv("TMPDIR");
+    SkString dir(SkOSPath::Join(tmp ? tmp : "/tmp", "skia_fontmgr_bench"));
+    if (!sk_isdir(dir.c_str())) {
+        sk_mkdir(dir.c_str());
+    }
+
+    SkAutoTDelete<SkStreamAsset> font(GetResourceAsStream("fonts/Roboto2-Regular_NoEmbed.ttf"));
+    if (!font) {
+        return dir;
+    }
+    for (int i = 0; i < kFontCount; ++i) {
+        SkString path(SkOSPath::Join(dir.c_str(), SkStringPrintf("font%04d.ttf", i).c_str()));
+        if (sk_exists(path.c_str())) {
+            continue;
+        }
+        SkString name(family_name(i));
+        font->rewind();
+        sk_sp<SkData> renamed(SkOTUtils::RenameFont(font, name.c_str(), (int)name.size()));
+        SkFILEWStream file(path.c_str());
+        if (renamed && file.isValid()) {
+            file.write(renamed->data(), renamed->size());
+        }
+    }
+    return dir;
+}
+
+// Matches each family of a large font directory, as text layout looking up the fonts a page
+// names would.
+class FontMgrMatchFamilyBench : public Benchmark {
+protected:
+    const char* onGetName() override {
+        return "fontmgr_match_family_2000";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fFontMgr.reset(SkFontMgr_New_Custom_Directory(make_font_directory().c_str()));
+        for (int i = 0; i < kFontCount; ++i) {
+            fNames.push_back(family_name(i));
+        }
+        // And some families which are not there.
+        for (int i = 0; i < 20; ++i) {
+            fNames.push_back(SkStringPrintf("Missing Family %d", i));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            for (const SkString& name : fNames) {
+                SkAutoTUnref<SkTypeface> face(fFontMgr->matchFamilyStyle(name.c_str(),
+                                                                         SkFontStyle()));
+            }
+        }
+    }
+
+private:
+    SkAutoTUnref<SkFontMgr> fFontMgr;
+    SkTArray<SkString>      fNames;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new FontMgrMatchFamilyBench;)
+
+// Makes a manager of a large font directory, as an application starting up would, scanning every
+// font or reading the faces from an index written by an earlier manager.
+class FontMgrStartupBench : public Benchmark {
+public:
+    explicit FontMgrStartupBench(bool useIndex) : fUseIndex(useIndex) {}
+
+protected:
+    const char* onGetName() override {
+        return fUseIndex ? "fontmgr_startup_2000_index" : "fontmgr_startup_2000";
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void onDelayedSetup() override {
+        fDirectory = make_font_directory();
+        if (fUseIndex) {
+            fIndex = fDirectory;
+            fIndex.append(".index");
+            // Write the index, for the draws to read.
+            SkAutoTUnref<SkFontMgr>(SkFontMgr_New_Custom_Directory(fDirectory.c_str(),
+                                                                   fIndex.c_str()));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        while (loops-- > 0) {
+            SkAutoTUnref<SkFontMgr> fontMgr(SkFontMgr_New_Custom_Directory(
+                    fDirectory.c_str(), fUseIndex ? fIndex.c_str() : nullptr));
+        }
+    }
+
+private:
+    const bool fUseIndex;
+    SkString   fDirectory;
+    SkString   fIndex;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new FontMgrStartupBench(false);)
+DEF_BENCH(return new FontMgrStartupBench(true);)
+
+#endif
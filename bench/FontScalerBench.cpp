@@ -6,11 +6,13 @@
  */
 
 #include "Benchmark.h"
+#include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkRandom.h"
 #include "SkString.h"
+#include "SkTaskGroup.h"
 
 class FontScalerBench : public Benchmark {
     SkString fName;
@@ -46,7 +48,57 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Rasterizes glyphs from many threads at once on a cold cache. Each thread draws at its own
+// size, so no two threads share glyphs or a glyph cache, and only the font scaler itself can
+// make them wait on one another.
+class ThreadedFontScalerBench : public Benchmark {
+    static const int kThreads = 16;
+
+    SkString fName;
+    SkString fText;
+    bool     fDoLCD;
+    SkBitmap fBitmaps[kThreads];
+public:
+    ThreadedFontScalerBench(bool doLCD)  {
+        fName.printf("fontscaler_%s_threaded", doLCD ? "lcd" : "aa");
+        fText.set("abcdefghijklmnopqrstuvwxyz01234567890");
+        fDoLCD = doLCD;
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        for (int i = 0; i < kThreads; i++) {
+            fBitmaps[i].allocN32Pixels(640, 64);
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; i++) {
+            SkGraphics::PurgeFontCache();
+
+            SkTaskGroup().batch(kThreads, [&](int threadIndex) {
+                SkCanvas canvas(fBitmaps[threadIndex]);
+                SkPaint paint;
+                this->setupPaint(&paint);
+                paint.setLCDRenderText(fDoLCD);
+                paint.setTextSize(SkIntToScalar(9 + threadIndex));
+                canvas.drawText(fText.c_str(), fText.size(), 0, SkIntToScalar(40), paint);
+            });
+        }
+    }
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH(return new FontScalerBench(false);)
 DEF_BENCH(return new FontScalerBench(true);)
+DEF_BENCH(return new ThreadedFontScalerBench(false);)
+DEF_BENCH(return new ThreadedFontScalerBench(true);)
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "Resources.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkImage.h"
+#include "SkSurface.h"
+#include "SkTime.h"
+
+// Scrolls through a page of thumbnails, decoded from JPEGs as they come into view. Without
+// prefetching, each frame decodes the images entering the viewport itself. With prefetching,
+// images are prefetched a couple of rows before they come into view, so their decodes run
+// alongside the frames on other threads. Reports the slowest frame as well as the total.
+class ImagePrefetchBench : public Benchmark {
+public:
+    enum Mode {
+        kDecodeOnDraw_Mode,
+        kPrefetch_Mode,        // prefetch the full size image
+        kPrefetchScaled_Mode,  // prefetch a copy at thumbnail size
+    };
+
+    ImagePrefetchBench(Mode mode) : fMode(mode), fWorstFrameMs(0) {
+        static const char* gNames[] = { "decode_on_draw", "prefetch", "prefetch_scaled" };
+        fName.printf("image_scroll_%s", gNames[mode]);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkString path(GetResourcePath("mandrill_512_q075.jpg"));
+        fEncoded = SkData::MakeFromFileName(path.c_str());
+        fSurface = SkSurface::MakeRasterN32Premul(kColumns * kCellSize, kViewportHeight);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fEncoded || !fSurface) {
+            return;
+        }
+        SkCanvas* canvas = fSurface->getCanvas();
+        SkPaint paint;
+        paint.setFilterQuality(kMedium_SkFilterQuality);
+        fWorstFrameMs = 0;
+
+        for (int loop = 0; loop < loops; ++loop) {
+            // New images each time, so nothing is already cached.
+            sk_sp<SkImage> images[kColumns * kRows];
+            bool prefetched[kColumns * kRows] = { false };
+            for (int i = 0; i < kColumns * kRows; ++i) {
+                images[i] = SkImage::MakeFromEncoded(fEncoded);
+            }
+
+            for (int top = 0; top + kViewportHeight <= kRows * kCellSize; top += kScrollStep) {
+                const double start = SkTime::GetNSecs();
+                const int firstRow = top / kCellSize;
+                const int lastRow = SkTMin(kRows - 1, (top + kViewportHeight - 1) / kCellSize);
+
+                if (kDecodeOnDraw_Mode != fMode) {
+                    const int lastPrefetchRow = SkTMin(kRows - 1, lastRow + kPrefetchRows);
+                    for (int i = firstRow * kColumns; i < (lastPrefetchRow + 1) * kColumns; ++i) {
+                        if (!prefetched[i] && images[i]) {
+                            images[i]->prefetch(kPrefetch_Mode == fMode ? 1 : kThumbnailScale);
+                            prefetched[i] = true;
+                        }
+                    }
+                }
+
+                canvas->clear(SK_ColorWHITE);
+                for (int row = firstRow; row <= lastRow; ++row) {
+                    for (int col = 0; col < kColumns; ++col) {
+                        const SkImage* image = images[row * kColumns + col].get();
+                        if (image) {
+                            const SkRect dst = SkRect::MakeXYWH(
+                                    SkIntToScalar(col * kCellSize),
+                                    SkIntToScalar(row * kCellSize - top),
+                                    SkIntToScalar(kCellSize), SkIntToScalar(kCellSize));
+                            canvas->drawImageRect(image, dst, &paint);
+                        }
+                    }
+                }
+                const double frameMs = (SkTime::GetNSecs() - start) * 1e-6;
+                fWorstFrameMs = SkTMax(fWorstFrameMs, frameMs);
+            }
+        }
+    }
+
+    void getStats(double msPerLoop, SkTArray<SkString>* keys,
+                  SkTArray<double>* values) override {
+        keys->push_back(SkString("worst_frame_ms"));
+        values->push_back(fWorstFrameMs);
+    }
+
+private:
+    static const int kColumns = 4;
+    static const int kRows = 50;
+    static const int kCellSize = 128;
+    static const int kViewportHeight = 768;
+    static const int kScrollStep = 64;
+    static const int kPrefetchRows = 2;
+    static constexpr float kThumbnailScale = 0.25f;  // 512 pixel images in 128 pixel cells
+
+    Mode            fMode;
+    SkString        fName;
+    sk_sp<SkData>   fEncoded;
+    sk_sp<SkSurface> fSurface;
+    double          fWorstFrameMs;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new ImagePrefetchBench(ImagePrefetchBench::kDecodeOnDraw_Mode);)
+DEF_BENCH(return new ImagePrefetchBench(ImagePrefetchBench::kPrefetch_Mode);)
+DEF_BENCH(return new ImagePrefetchBench(ImagePrefetchBench::kPrefetchScaled_Mode);)
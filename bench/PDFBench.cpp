@@ -8,7 +8,9 @@
 #include "Benchmark.h"
 #include "Resources.h"
 #include "SkAutoPixmapStorage.h"
+#include "SkCanvas.h"
 #include "SkData.h"
+#include "SkFontMgr.h"
 #include "SkGradientShader.h"
 #include "SkImage.h"
 #include "SkPDFBitmap.h"
@@ -208,6 +210,65 @@ struct WStreamWriteTextBenchmark : public Benchmark {
     }
 };
 
+/** Writes a PDF of a few pages of CJK text, which uses a few hundred of the font's glyphs.
+    Reports the size of the document, which is mostly the embedded font. */
+struct PDFCJKTextBench : public Benchmark {
+    static const int kPages = 4;
+    static const int kLines = 40;
+    static const int kCharsPerLine = 30;
+
+    sk_sp<SkTypeface> fTypeface;
+    SkUnichar fText[kPages][kLines][kCharsPerLine];
+    size_t fBytes = 0;
+
+    const char* onGetName() override { return "PDFCJKText"; }
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+    void onDelayedSetup() override {
+        sk_sp<SkFontMgr> fontMgr(SkFontMgr::RefDefault());
+        fTypeface.reset(fontMgr->matchFamilyStyleCharacter(nullptr, SkFontStyle(),
+                                                           nullptr, 0, 0x4E2D));
+        // Common ideographs, as in running text.
+        SkRandom random;
+        for (int page = 0; page < kPages; ++page) {
+            for (int line = 0; line < kLines; ++line) {
+                for (int i = 0; i < kCharsPerLine; ++i) {
+                    fText[page][line][i] = random.nextRangeU(0x4E00, 0x4E00 + 1500);
+                }
+            }
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fTypeface) {
+            return;
+        }
+        SkPaint paint;
+        paint.setTypeface(fTypeface);
+        paint.setTextSize(14);
+        paint.setTextEncoding(SkPaint::kUTF32_TextEncoding);
+        while (loops-- > 0) {
+            NullWStream nullStream;
+            sk_sp<SkDocument> doc(SkDocument::MakePDF(&nullStream));
+            for (int page = 0; page < kPages; ++page) {
+                SkCanvas* canvas = doc->beginPage(612, 792);
+                for (int line = 0; line < kLines; ++line) {
+                    canvas->drawText(fText[page][line], sizeof(fText[page][line]),
+                                     36, SkIntToScalar(36 + 18 * line), paint);
+                }
+                doc->endPage();
+            }
+            doc->close();
+            fBytes = nullStream.bytesWritten();
+        }
+    }
+    void getStats(double msPerLoop, SkTArray<SkString>* keys,
+                  SkTArray<double>* values) override {
+        keys->push_back(SkString("pdf_bytes"));
+        values->push_back((double)fBytes);
+    }
+};
+
 }  // namespace
 DEF_BENCH(return new PDFImageBench;)
 DEF_BENCH(return new PDFJpegImageBench;)
@@ -215,3 +276,4 @@ DEF_BENCH(return new PDFCompressionBench;)
 DEF_BENCH(return new PDFScalarBench;)
 DEF_BENCH(return new PDFShaderBench;)
 DEF_BENCH(return new WStreamWriteTextBenchmark;)
+DEF_BENCH(return new PDFCJKTextBench;)
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "Resources.h"
+#include "SkBitmap.h"
+#include "SkCodec.h"
+#include "SkData.h"
+#include "SkStream.h"
+
+// A stream that has only received part of its data, like an image that is still downloading.
+class PartialStream : public SkStream {
+public:
+    PartialStream(sk_sp<SkData> data, size_t limit)
+        : fTotalSize(data->size())
+        , fLimit(limit)
+        , fStream(std::move(data))
+    {}
+
+    void addData(size_t bytes) { fLimit = SkTMin(fTotalSize, fLimit + bytes); }
+    bool hasAllData() const { return fLimit == fTotalSize; }
+
+    size_t read(void* buffer, size_t size) override {
+        size = SkTMin(size, fLimit - fStream.getPosition());
+        return fStream.read(buffer, size);
+    }
+
+    bool isAtEnd() const override { return fStream.isAtEnd(); }
+    bool rewind() override { return fStream.rewind(); }
+
+private:
+    const size_t    fTotalSize;
+    size_t          fLimit;
+    SkMemoryStream  fStream;
+};
+
+// Decodes an image each time another chunk of its data arrives, until it is complete.  An
+// incremental decode continues from where the last chunk ran out, so its total work is about
+// that of one full decode.  Without one, the decode starts over on all of the data so far.
+class PartialDecodeBench : public Benchmark {
+public:
+    PartialDecodeBench(const char* resource, bool incremental)
+        : fResource(resource)
+        , fIncremental(incremental)
+    {
+        fName.printf("partial_decode_%s_%s", resource, incremental ? "incremental" : "restart");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        fEncoded = SkData::MakeFromFileName(GetResourcePath(fResource).c_str());
+        if (!fEncoded) {
+            return;
+        }
+        SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(fEncoded.get()));
+        if (codec) {
+            fBitmap.allocN32Pixels(codec->getInfo().width(), codec->getInfo().height());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (fBitmap.drawsNothing()) {
+            return;
+        }
+        for (int loop = 0; loop < loops; ++loop) {
+            if (fIncremental) {
+                this->decodeIncrementally();
+            } else {
+                this->decodeFromStart();
+            }
+        }
+    }
+
+private:
+    static const size_t kChunkSize = 8192;
+
+    void decodeIncrementally() {
+        PartialStream* stream = new PartialStream(fEncoded, kChunkSize);
+        SkAutoTDelete<SkCodec> codec(SkCodec::NewFromStream(stream));
+        if (!codec || SkCodec::kSuccess != codec->startIncrementalDecode(fBitmap.info(),
+                fBitmap.getPixels(), fBitmap.rowBytes())) {
+            return;
+        }
+        while (SkCodec::kIncompleteInput == codec->incrementalDecode() && !stream->hasAllData()) {
+            stream->addData(kChunkSize);
+        }
+    }
+
+    void decodeFromStart() {
+        for (size_t size = kChunkSize; ; size += kChunkSize) {
+            size = SkTMin(size, fEncoded->size());
+            sk_sp<SkData> data(SkData::MakeSubset(fEncoded.get(), 0, size));
+            SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(data.get()));
+            if (codec && SkCodec::kSuccess == codec->getPixels(fBitmap.info(),
+                    fBitmap.getPixels(), fBitmap.rowBytes())) {
+                return;
+            }
+            if (size == fEncoded->size()) {
+                return;
+            }
+        }
+    }
+
+    const char*     fResource;
+    const bool      fIncremental;
+    SkString        fName;
+    sk_sp<SkData>   fEncoded;
+    SkBitmap        fBitmap;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new PartialDecodeBench("mandrill_512_q075.jpg", true);)
+DEF_BENCH(return new PartialDecodeBench("mandrill_512_q075.jpg", false);)
+DEF_BENCH(return new PartialDecodeBench("brickwork-texture.jpg", true);)
+DEF_BENCH(return new PartialDecodeBench("brickwork-texture.jpg", false);)
+DEF_BENCH(return new PartialDecodeBench("mandrill_256_interlaced.png", true);)
+DEF_BENCH(return new PartialDecodeBench("mandrill_256_interlaced.png", false);)
@@ -8,6 +8,8 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkColorPriv.h"
+#include "SkCompactPath.h"
+#include "SkGlyphCache.h"
 #include "SkPaint.h"
 #include "SkPath.h"
 #include "SkRandom.h"
@@ -89,7 +91,156 @@ private:
     typedef Benchmark INHERITED;
 };
 
+// Compares raw iteration of a glyph-like path (points on a 26.6 fixed point grid) stored as an
+// SkPath against the same path stored as an SkCompactPath, which decodes points as it goes.
+class CompactPathIterBench : public Benchmark {
+    SkString                        fName;
+    SkPath                          fPath;
+    SkAutoTDelete<SkCompactPath>    fCompact;
+    bool                            fUseCompact;
+
+public:
+    CompactPathIterBench(bool useCompact) : fUseCompact(useCompact) {
+        fName.printf("pathiter_glyph_%s", useCompact ? "compact" : "raw");
+
+        SkRandom rand;
+        for (int i = 0; i < 1000; ++i) {
+            SkPoint pts[4];
+            int n = rand_pts(rand, pts);
+            for (int j = 0; j < n; ++j) {
+                pts[j].set(SkScalarRoundToScalar(pts[j].fX * 64 * 64) / 64,
+                           SkScalarRoundToScalar(pts[j].fY * 64 * 64) / 64);
+            }
+            switch (n) {
+                case 1:
+                    fPath.moveTo(pts[0]);
+                    break;
+                case 2:
+                    fPath.lineTo(pts[1]);
+                    break;
+                case 3:
+                    fPath.quadTo(pts[1], pts[2]);
+                    break;
+                case 4:
+                    fPath.cubicTo(pts[1], pts[2], pts[3]);
+                    break;
+            }
+        }
+        fCompact.reset(SkCompactPath::Create(fPath));
+        SkASSERT(fCompact);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (fUseCompact) {
+            for (int i = 0; i < loops; ++i) {
+                SkCompactPath::Iter iter(*fCompact);
+                SkPoint pts[4];
+
+                while (iter.next(pts) != SkPath::kDone_Verb) { }
+            }
+        } else {
+            for (int i = 0; i < loops; ++i) {
+                SkPath::RawIter iter(fPath);
+                SkPoint pts[4];
+
+                while (iter.next(pts) != SkPath::kDone_Verb) { }
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+// Compares the glyph cache's two ways of keeping outlines: handing back a copy of each printable
+// ASCII glyph's SkPath, or decoding it from an SkCompactPath. Reports the bytes each form holds.
+class GlyphPathBytesBench : public Benchmark {
+    SkString                    fName;
+    SkTArray<SkPath>            fPaths;
+    SkTArray<SkCompactPath*>    fCompacts;
+    bool                        fUseCompact;
+    size_t                      fBytes;
+
+public:
+    GlyphPathBytesBench(bool useCompact) : fUseCompact(useCompact), fBytes(0) {
+        fName.printf("pathiter_glyph_bytes_%s", useCompact ? "compact" : "path");
+    }
+
+    ~GlyphPathBytesBench() override {
+        for (SkCompactPath* compact : fCompacts) {
+            delete compact;
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+    void getStats(double msPerLoop, SkTArray<SkString>* keys,
+                  SkTArray<double>* values) override {
+        keys->push_back(SkString("glyph_path_bytes"));
+        values->push_back((double)fBytes);
+    }
+
+protected:
+    const char* onGetName() override {
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        SkPaint paint;
+        paint.setTextSize(64);
+        SkAutoGlyphCache cache(paint, nullptr, nullptr);
+        for (SkUnichar c = 0x21; c < 0x7F; ++c) {
+            const SkGlyph& glyph = cache->getUnicharMetrics(c);
+            if (!glyph.fWidth) {
+                continue;
+            }
+            SkPath path;
+            cache->getScalerContext()->getPath(glyph, &path);
+            SkCompactPath* compact = SkCompactPath::Create(path);
+            if (!compact) {
+                continue;
+            }
+            fPaths.push_back(path);
+            fCompacts.push_back(compact);
+            fBytes += fUseCompact ? compact->approximateBytesUsed()
+                                  : sizeof(SkPath) + path.countPoints() * sizeof(SkPoint) +
+                                    path.countVerbs();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        SkPath path;
+        for (int i = 0; i < loops; ++i) {
+            for (int j = 0; j < fPaths.count(); ++j) {
+                if (fUseCompact) {
+                    fCompacts[j]->toPath(&path);
+                } else {
+                    path = fPaths[j];
+                }
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 DEF_BENCH( return new PathIterBench(false); )
 DEF_BENCH( return new PathIterBench(true); )
+DEF_BENCH( return new CompactPathIterBench(false); )
+DEF_BENCH( return new CompactPathIterBench(true); )
+DEF_BENCH( return new GlyphPathBytesBench(false); )
+DEF_BENCH( return new GlyphPathBytesBench(true); )
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "Sk1DPathEffect.h"
+#include "SkCanvas.h"
+#include "SkDiscretePathEffect.h"
+#include "SkPaint.h"
+#include "SkPath.h"
+#include "SkPathMeasure.h"
+#include "SkRandom.h"
+#include "SkString.h"
+#include "SkStrokeRec.h"
+
+// Models text-on-path and animations: every frame measures the same path again and samples it
+// at many increasing distances.
+class PathMeasureBench : public Benchmark {
+public:
+    PathMeasureBench(bool batch) : fBatch(batch) {
+        fName.printf("pathmeasure_postan_%s", batch ? "batch" : "single");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkRandom rand;
+        fPath.moveTo(0, 0);
+        for (int i = 0; i < 100; ++i) {
+            fPath.cubicTo(rand.nextRangeScalar(0, 1000), rand.nextRangeScalar(0, 1000),
+                          rand.nextRangeScalar(0, 1000), rand.nextRangeScalar(0, 1000),
+                          rand.nextRangeScalar(0, 1000), rand.nextRangeScalar(0, 1000));
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkPathMeasure meas(fPath, false);
+            SkScalar step = meas.getLength() / kSampleCount;
+            if (fBatch) {
+                for (int j = 0; j < kSampleCount; ++j) {
+                    fDistances[j] = j * step;
+                }
+                (void)meas.getPosTan(kSampleCount, fDistances, fPositions, fTangents);
+            } else {
+                for (int j = 0; j < kSampleCount; ++j) {
+                    (void)meas.getPosTan(j * step, &fPositions[j], &fTangents[j]);
+                }
+            }
+        }
+    }
+
+private:
+    static const int kSampleCount = 10000;
+
+    bool        fBatch;
+    SkString    fName;
+    SkPath      fPath;
+    SkScalar    fDistances[kSampleCount];
+    SkPoint     fPositions[kSampleCount];
+    SkVector    fTangents[kSampleCount];
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new PathMeasureBench(false);)
+DEF_BENCH(return new PathMeasureBench(true);)
+
+static void make_follow_path(SkPath* path) {
+    SkRandom rand;
+    path->moveTo(0, 0);
+    for (int i = 0; i < 20; ++i) {
+        path->cubicTo(rand.nextRangeScalar(0, 640), rand.nextRangeScalar(0, 480),
+                      rand.nextRangeScalar(0, 640), rand.nextRangeScalar(0, 480),
+                      rand.nextRangeScalar(0, 640), rand.nextRangeScalar(0, 480));
+    }
+}
+
+// The path effects that sample an SkPathMeasure at increasing distances along each contour.
+class PathEffectMeasureBench : public Benchmark {
+public:
+    PathEffectMeasureBench(const char* name, sk_sp<SkPathEffect> effect)
+        : fEffect(std::move(effect)) {
+        fName.printf("pathmeasure_effect_%s", name);
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        make_follow_path(&fPath);
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        for (int i = 0; i < loops; ++i) {
+            SkPath dst;
+            SkStrokeRec rec(SkStrokeRec::kHairline_InitStyle);
+            (void)fEffect->filterPath(&dst, fPath, &rec, nullptr);
+        }
+    }
+
+private:
+    SkString            fName;
+    SkPath              fPath;
+    sk_sp<SkPathEffect> fEffect;
+
+    typedef Benchmark INHERITED;
+};
+
+static sk_sp<SkPathEffect> make_1d_effect(SkPath1DPathEffect::Style style) {
+    SkPath stamp;
+    stamp.moveTo(-3, -2);
+    stamp.lineTo(3, 0);
+    stamp.lineTo(-3, 2);
+    stamp.close();
+    return SkPath1DPathEffect::Make(stamp, 8, 0, style);
+}
+
+DEF_BENCH(return new PathEffectMeasureBench("1d_translate",
+                                            make_1d_effect(SkPath1DPathEffect::kTranslate_Style));)
+DEF_BENCH(return new PathEffectMeasureBench("1d_rotate",
+                                            make_1d_effect(SkPath1DPathEffect::kRotate_Style));)
+DEF_BENCH(return new PathEffectMeasureBench("1d_morph",
+                                            make_1d_effect(SkPath1DPathEffect::kMorph_Style));)
+DEF_BENCH(return new PathEffectMeasureBench("discrete", SkDiscretePathEffect::Make(4, 2));)
+
+// Text on path morphs every point of every glyph outline onto the follow path.
+class TextOnPathMeasureBench : public Benchmark {
+protected:
+    const char* onGetName() override { return "pathmeasure_textonpath"; }
+
+    void onDelayedSetup() override {
+        make_follow_path(&fPath);
+        fPaint.setAntiAlias(true);
+        fPaint.setTextSize(24);
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        static const char kText[] = "The quick brown fox jumps over the lazy dog. "
+                                    "Sphinx of black quartz, judge my vow.";
+        for (int i = 0; i < loops; ++i) {
+            canvas->drawTextOnPath(kText, sizeof(kText) - 1, fPath, nullptr, fPaint);
+        }
+    }
+
+private:
+    SkPath  fPath;
+    SkPaint fPaint;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new TextOnPathMeasureBench;)
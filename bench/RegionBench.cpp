@@ -8,6 +8,7 @@
 #include "SkRandom.h"
 #include "SkRegion.h"
 #include "SkString.h"
+#include "SkTDArray.h"
 
 static bool union_proc(SkRegion& a, SkRegion& b) {
     SkRegion result;
@@ -129,3 +130,54 @@ DEF_BENCH(return new RegionBench(SMALL, containsrect_proc, "containsrect");)
 DEF_BENCH(return new RegionBench(SMALL, sectsrgn_proc, "intersectsrgn");)
 DEF_BENCH(return new RegionBench(SMALL, sectsrect_proc, "intersectsrect");)
 DEF_BENCH(return new RegionBench(SMALL, containsxy_proc, "containsxy");)
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Unions many small rects, as when accumulating damage, either one op at a time or with a
+// single setRects() call.
+class RegionUnionRectsBench : public Benchmark {
+public:
+    RegionUnionRectsBench(int count, bool batch) : fBatch(batch) {
+        fName.printf("region_unionrects_%s_%d", batch ? "batch" : "loop", count);
+
+        SkRandom rand;
+        for (int i = 0; i < count; i++) {
+            int x = rand.nextU() % 1024;
+            int y = rand.nextU() % 768;
+            *fRects.append() = SkIRect::MakeXYWH(x, y, 8 + rand.nextU() % 64,
+                                                 8 + rand.nextU() % 64);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; ++i) {
+            SkRegion rgn;
+            if (fBatch) {
+                rgn.setRects(fRects.begin(), fRects.count());
+            } else {
+                for (int j = 0; j < fRects.count(); ++j) {
+                    rgn.op(fRects[j], SkRegion::kUnion_Op);
+                }
+            }
+        }
+    }
+
+private:
+    SkTDArray<SkIRect> fRects;
+    bool               fBatch;
+    SkString           fName;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new RegionUnionRectsBench(SMALL, false);)
+DEF_BENCH(return new RegionUnionRectsBench(SMALL, true);)
+DEF_BENCH(return new RegionUnionRectsBench(256, false);)
+DEF_BENCH(return new RegionUnionRectsBench(256, true);)
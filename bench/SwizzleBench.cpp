@@ -7,6 +7,7 @@
 
 #include "Benchmark.h"
 #include "SkOpts.h"
+#include "SkSwizzler.h"
 
 class SwizzleBench : public Benchmark {
 public:
@@ -37,3 +38,143 @@ DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_RGBA", SkOpts::grayA_to_RGBA
 DEF_BENCH(return new SwizzleBench("SkOpts::grayA_to_rgbA", SkOpts::grayA_to_rgbA));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_RGB1", SkOpts::inverted_CMYK_to_RGB1));
 DEF_BENCH(return new SwizzleBench("SkOpts::inverted_CMYK_to_BGR1", SkOpts::inverted_CMYK_to_BGR1));
+
+class Swizzle565Bench : public Benchmark {
+public:
+    Swizzle565Bench(const char* name, SkOpts::Swizzle_565 fn) : fName(name), fFn(fn) {}
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName; }
+    void onDraw(int loops, SkCanvas*) override {
+        static const int K = 1023;
+        uint16_t dst[K];
+        uint32_t src[K];
+        while (loops --> 0) {
+            fFn(dst, src, K);
+        }
+    }
+private:
+    const char* fName;
+    SkOpts::Swizzle_565 fFn;
+};
+
+DEF_BENCH(return new Swizzle565Bench("SkOpts::RGBA_to_565", SkOpts::RGBA_to_565));
+DEF_BENCH(return new Swizzle565Bench("SkOpts::BGRA_to_565", SkOpts::BGRA_to_565));
+
+// Bit masks as a bmp would use them: 555, 8888 with alpha, and 888 in 24 bits.
+static const SkOpts::BitMasks k555Masks = {
+    { 0x7C00, 0x03E0, 0x001F, 0 }, { 10, 5, 0, 0 }, { 5, 5, 5, 0 },
+};
+static const SkOpts::BitMasks k8888Masks = {
+    { 0xFF0000, 0xFF00, 0xFF, 0xFF000000 }, { 16, 8, 0, 24 }, { 8, 8, 8, 8 },
+};
+
+class SwizzleMasksBench : public Benchmark {
+public:
+    SwizzleMasksBench(const char* name, SkOpts::Swizzle_masks fn, int bytesPerPixel,
+                      const SkOpts::BitMasks& masks)
+        : fFn(fn), fBytesPerPixel(bytesPerPixel), fMasks(masks) {
+        fName.printf("SkOpts::%s_%d", name, 8 * bytesPerPixel);
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+    void onDraw(int loops, SkCanvas*) override {
+        static const int K = 1023;
+        uint32_t dst[K], src[K];
+        while (loops --> 0) {
+            fFn(dst, (const uint8_t*) src, K, fBytesPerPixel, fBytesPerPixel, fMasks);
+        }
+    }
+private:
+    SkString fName;
+    SkOpts::Swizzle_masks fFn;
+    int fBytesPerPixel;
+    SkOpts::BitMasks fMasks;
+};
+
+DEF_BENCH(return new SwizzleMasksBench("masks_to_RGBA", SkOpts::masks_to_RGBA, 2, k555Masks));
+DEF_BENCH(return new SwizzleMasksBench("masks_to_RGBA", SkOpts::masks_to_RGBA, 3, k8888Masks));
+DEF_BENCH(return new SwizzleMasksBench("masks_to_RGBA", SkOpts::masks_to_RGBA, 4, k8888Masks));
+DEF_BENCH(return new SwizzleMasksBench("masks_to_rgbA", SkOpts::masks_to_rgbA, 4, k8888Masks));
+DEF_BENCH(return new SwizzleMasksBench("masks_to_BGRA", SkOpts::masks_to_BGRA, 4, k8888Masks));
+DEF_BENCH(return new SwizzleMasksBench("masks_to_bgrA", SkOpts::masks_to_bgrA, 4, k8888Masks));
+
+// A whole row through SkSwizzler, which picks its row proc in CreateSwizzler, optionally
+// sampling every sampleX'th pixel.
+class SwizzlerBench : public Benchmark {
+public:
+    SwizzlerBench(const char* name, SkEncodedInfo::Color color, SkEncodedInfo::Alpha alpha,
+                  SkColorType colorType, int sampleX)
+        : fEncodedInfo(SkEncodedInfo::Make(color, alpha, 8))
+        , fDstInfo(SkImageInfo::Make(kWidth, 1, colorType,
+                                     SkEncodedInfo::kOpaque_Alpha == alpha ? kOpaque_SkAlphaType
+                                                                           : kPremul_SkAlphaType))
+        , fSampleX(sampleX) {
+        fName.printf("SkSwizzler_%s_to_%s", name,
+                     kRGB_565_SkColorType == colorType ? "565" : "n32");
+        if (sampleX > 1) {
+            fName.appendf("_sample%d", sampleX);
+        }
+        for (int i = 0; i < 256; i++) {
+            fColorTable[i] = SkPackARGB32(0xFF, i, i, i);
+        }
+    }
+
+    bool isSuitableFor(Backend backend) override { return backend == kNonRendering_Backend; }
+    const char* onGetName() override { return fName.c_str(); }
+    void onDelayedSetup() override {
+        fSwizzler.reset(SkSwizzler::CreateSwizzler(fEncodedInfo, fColorTable, fDstInfo,
+                                                   SkCodec::Options()));
+        if (fSwizzler) {
+            fSwizzler->setSampleX(fSampleX);
+        }
+    }
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fSwizzler) {
+            return;
+        }
+        uint32_t dst[kWidth], src[kWidth];
+        sk_bzero(src, sizeof(src));
+        while (loops --> 0) {
+            fSwizzler->swizzle(dst, (const uint8_t*) src);
+        }
+    }
+private:
+    static const int kWidth = 1023;
+
+    SkString                  fName;
+    const SkEncodedInfo       fEncodedInfo;
+    const SkImageInfo         fDstInfo;
+    const int                 fSampleX;
+    SkPMColor                 fColorTable[256];
+    SkAutoTDelete<SkSwizzler> fSwizzler;
+};
+
+#define SWIZZLER_BENCH(name, color, alpha, colorType, sampleX)                              \
+    DEF_BENCH(return new SwizzlerBench(name, SkEncodedInfo::color, SkEncodedInfo::alpha,      \
+                                       colorType, sampleX));
+#define SWIZZLER_BENCHES(name, color, alpha)                                                  \
+    SWIZZLER_BENCH(name, color, alpha, kN32_SkColorType, 1)                                   \
+    SWIZZLER_BENCH(name, color, alpha, kN32_SkColorType, 2)                                   \
+    SWIZZLER_BENCH(name, color, alpha, kN32_SkColorType, 4)
+
+SWIZZLER_BENCHES("gray",    kGray_Color,         kOpaque_Alpha)
+SWIZZLER_BENCHES("grayA",   kGrayAlpha_Color,    kUnpremul_Alpha)
+SWIZZLER_BENCHES("index",   kPalette_Color,      kOpaque_Alpha)
+SWIZZLER_BENCHES("RGB",     kRGB_Color,          kOpaque_Alpha)
+SWIZZLER_BENCHES("RGBA",    kRGBA_Color,         kUnpremul_Alpha)
+SWIZZLER_BENCHES("BGR",     kBGR_Color,          kOpaque_Alpha)
+SWIZZLER_BENCHES("BGRX",    kBGRX_Color,         kOpaque_Alpha)
+SWIZZLER_BENCHES("BGRA",    kBGRA_Color,         kUnpremul_Alpha)
+SWIZZLER_BENCHES("invCMYK", kInvertedCMYK_Color, kOpaque_Alpha)
+
+SWIZZLER_BENCH("gray",    kGray_Color,         kOpaque_Alpha, kRGB_565_SkColorType, 1)
+SWIZZLER_BENCH("index",   kPalette_Color,      kOpaque_Alpha, kRGB_565_SkColorType, 1)
+SWIZZLER_BENCH("RGB",     kRGB_Color,          kOpaque_Alpha, kRGB_565_SkColorType, 1)
+SWIZZLER_BENCH("BGR",     kBGR_Color,          kOpaque_Alpha, kRGB_565_SkColorType, 1)
+SWIZZLER_BENCH("BGRX",    kBGRX_Color,         kOpaque_Alpha, kRGB_565_SkColorType, 1)
+SWIZZLER_BENCH("invCMYK", kInvertedCMYK_Color, kOpaque_Alpha, kRGB_565_SkColorType, 1)
+
+#undef SWIZZLER_BENCHES
+#undef SWIZZLER_BENCH
@@ -8,13 +8,21 @@
 #include "Benchmark.h"
 #include "Resources.h"
 #include "SkCanvas.h"
+#include "SkGlyphCache.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkRandom.h"
+#include "SkSharedGlyphStore.h"
 #include "SkStream.h"
 #include "SkString.h"
+#include "SkTArray.h"
 #include "SkTemplates.h"
 #include "SkTypeface.h"
 
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+    #include <unistd.h>
+#endif
+
 enum FontQuality {
     kBW,
     kAA,
@@ -175,3 +183,188 @@ DEF_BENCH( return new TextBench(STR, 16, 0x88FF0000, kBW, true); )
 
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kBW, true, true); )
 DEF_BENCH( return new TextBench(STR, 16, 0xFF000000, kAA, false, true); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+static const char* gParagraph[] = {
+    "The quick brown fox jumps over the lazy dog; PACK MY BOX WITH",
+    "five dozen liquor jugs! 0123456789 (Sphinx of black quartz),",
+    "judge my vow. How vexingly quick daft zebras jump & waltz?",
+    "Jackdaws love my big sphinx of quartz - \"Glib jocks quiz nymph",
+    "to vex dwarf.\" [Bright vixens jump; dozy fowl quack.] #42 @ 7%",
+};
+
+// Draws a paragraph with drawPosTextH, a line at a time, with its glyphs already in the cache, to
+// measure finding and placing many glyphs.
+class PosTextParagraphBench : public Benchmark {
+    SkPaint             fPaint;
+    SkString            fName;
+    SkTArray<SkScalar>  fXPos[SK_ARRAY_COUNT(gParagraph)];
+public:
+    PosTextParagraphBench(int ps, FontQuality fq, bool subpixel) {
+        fPaint.setAntiAlias(kBW != fq);
+        fPaint.setLCDRenderText(kLCD == fq);
+        fPaint.setSubpixelText(subpixel);
+        fPaint.setTextSize(SkIntToScalar(ps));
+    }
+
+protected:
+    const char* onGetName() override {
+        fName.printf("text_%g_pos_paragraph_%s%s", SkScalarToFloat(fPaint.getTextSize()),
+                     fontQualityName(fPaint), fPaint.isSubpixelText() ? "_subpixel" : "");
+        return fName.c_str();
+    }
+
+    void onDelayedSetup() override {
+        for (size_t i = 0; i < SK_ARRAY_COUNT(gParagraph); ++i) {
+            const char* line = gParagraph[i];
+            const size_t len = strlen(line);
+            SkAutoTArray<SkScalar> widths(SkToInt(len));
+            fPaint.getTextWidths(line, len, widths.get());
+            SkScalar x = 0;
+            for (size_t j = 0; j < len; ++j) {
+                fXPos[i].push_back(x);
+                x += widths[j];
+            }
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint(fPaint);
+        this->setupPaint(&paint);
+        paint.setAntiAlias(fPaint.isAntiAlias());
+        paint.setLCDRenderText(fPaint.isLCDRenderText());
+        paint.setSubpixelText(fPaint.isSubpixelText());
+
+        // Blink draws text with a translated matrix.
+        canvas->translate(SK_Scalar1 / 3, SK_Scalar1);
+        const SkScalar lineHeight = paint.getFontSpacing();
+        for (int i = 0; i < loops; i++) {
+            SkScalar y = lineHeight;
+            for (size_t j = 0; j < SK_ARRAY_COUNT(gParagraph); ++j) {
+                canvas->drawPosTextH(gParagraph[j], strlen(gParagraph[j]), fXPos[j].begin(), y,
+                                     paint);
+                y += lineHeight;
+            }
+        }
+    }
+
+private:
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new PosTextParagraphBench(12, kAA, false); )
+DEF_BENCH( return new PosTextParagraphBench(12, kAA, true); )
+DEF_BENCH( return new PosTextParagraphBench(12, kLCD, true); )
+DEF_BENCH( return new PosTextParagraphBench(16, kBW, false); )
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Draws a paragraph after purging the font cache, so every glyph image of every line is generated
+// during the draw, as when a page of new text first appears. With a glyph store, the images are
+// instead found in a store which a first draw filled: in shared memory, as another process would
+// have, or in a file which each loop opens again, as the first frame after a restart would.
+enum GlyphStore {
+    kNo_GlyphStore,
+    kSharedMemory_GlyphStore,
+    kFile_GlyphStore,
+};
+
+class ColdTextBench : public Benchmark {
+    SkPaint     fPaint;
+    SkString    fName;
+    FontQuality fFQ;
+    GlyphStore  fGlyphStore;
+    SkString    fStorePath;
+public:
+    ColdTextBench(int ps, FontQuality fq, GlyphStore glyphStore = kNo_GlyphStore)
+        : fFQ(fq), fGlyphStore(glyphStore) {
+        fPaint.setAntiAlias(kBW != fq);
+        fPaint.setLCDRenderText(kLCD == fq);
+        fPaint.setTextSize(SkIntToScalar(ps));
+    }
+
+protected:
+    const char* onGetName() override {
+        static const char* kStoreNames[] = { "", "shared_", "file_" };
+        fName.printf("text_%g_paragraph_cold_%s%s", SkScalarToFloat(fPaint.getTextSize()),
+                     kStoreNames[fGlyphStore], fontQualityName(fPaint));
+        return fName.c_str();
+    }
+
+    void onPerCanvasPreDraw(SkCanvas* canvas) override {
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+        if (kSharedMemory_GlyphStore == fGlyphStore) {
+            SkString name;
+            name.printf("/skia-%s-%d", this->getName(), (int)getpid());
+            sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(name.c_str(), kStoreSize));
+            SkSharedGlyphStore::Unlink(name.c_str());
+            SkGlyphCache::SetSharedGlyphStore(std::move(store));
+            this->drawParagraph(canvas);
+        } else if (kFile_GlyphStore == fGlyphStore) {
+            fStorePath.printf("/tmp/skia-%s-%d", this->getName(), (int)getpid());
+            remove(fStorePath.c_str());
+            SkGraphics::SetFontCacheFile(fStorePath.c_str(), kStoreSize);
+            this->drawParagraph(canvas);
+            SkGlyphCache::SetSharedGlyphStore(nullptr);
+        }
+#endif
+    }
+
+    void onPerCanvasPostDraw(SkCanvas*) override {
+        if (kNo_GlyphStore != fGlyphStore) {
+            SkGlyphCache::SetSharedGlyphStore(nullptr);
+        }
+        if (kFile_GlyphStore == fGlyphStore) {
+            remove(fStorePath.c_str());
+        }
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        for (int i = 0; i < loops; i++) {
+            if (kFile_GlyphStore == fGlyphStore) {
+                // Maps the file again, and purges the font cache.
+                SkGraphics::SetFontCacheFile(fStorePath.c_str(), kStoreSize);
+            } else {
+                SkGraphics::PurgeFontCache();
+            }
+            this->drawParagraph(canvas);
+        }
+    }
+
+private:
+    static const size_t kStoreSize = 4 << 20;
+
+    void drawParagraph(SkCanvas* canvas) {
+        SkPaint paint(fPaint);
+        this->setupPaint(&paint);
+        paint.setAntiAlias(kBW != fFQ);
+        paint.setLCDRenderText(kLCD == fFQ);
+
+        const SkScalar lineHeight = paint.getFontSpacing();
+        SkScalar y = lineHeight;
+        for (const char* line : gParagraph) {
+            canvas->drawText(line, strlen(line), 0, y, paint);
+            y += lineHeight;
+        }
+    }
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new ColdTextBench(12, kAA); )
+DEF_BENCH( return new ColdTextBench(12, kLCD); )
+DEF_BENCH( return new ColdTextBench(24, kAA); )
+DEF_BENCH( return new ColdTextBench(24, kBW); )
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+DEF_BENCH( return new ColdTextBench(12, kAA, kSharedMemory_GlyphStore); )
+DEF_BENCH( return new ColdTextBench(12, kLCD, kSharedMemory_GlyphStore); )
+DEF_BENCH( return new ColdTextBench(24, kAA, kSharedMemory_GlyphStore); )
+DEF_BENCH( return new ColdTextBench(24, kBW, kSharedMemory_GlyphStore); )
+
+DEF_BENCH( return new ColdTextBench(12, kAA, kFile_GlyphStore); )
+DEF_BENCH( return new ColdTextBench(12, kLCD, kFile_GlyphStore); )
+DEF_BENCH( return new ColdTextBench(24, kAA, kFile_GlyphStore); )
+DEF_BENCH( return new ColdTextBench(24, kBW, kFile_GlyphStore); )
+#endif
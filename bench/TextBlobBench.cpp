@@ -14,6 +14,7 @@
 #include "SkString.h"
 #include "SkTemplates.h"
 #include "SkTextBlob.h"
+#include "SkTextBlobRunIterator.h"
 #include "SkTypeface.h"
 
 #include "sk_tool_utils.h"
@@ -70,3 +71,105 @@ private:
 };
 
 DEF_BENCH( return new TextBlobBench(); )
+
+/*
+ * Benchmarks a textblob of a paragraph, with a positioned run per line, drawn again and again at
+ * the same place. With drawRuns, each run is drawn with drawPosText instead, so that the raster
+ * backend can not reuse where it placed the glyphs of the blob.
+ */
+class TextBlobParagraphBench : public Benchmark {
+public:
+    TextBlobParagraphBench(bool fullPositions, bool drawRuns)
+        : fFullPositions(fullPositions)
+        , fDrawRuns(drawRuns) {}
+
+protected:
+    void onDelayedSetup() override {
+        static const char* kLines[] = {
+            "The quick brown fox jumps over the lazy dog; PACK MY BOX WITH",
+            "five dozen liquor jugs! 0123456789 (Sphinx of black quartz),",
+            "judge my vow. How vexingly quick daft zebras jump & waltz?",
+            "Jackdaws love my big sphinx of quartz - \"Glib jocks quiz nymph",
+            "to vex dwarf.\" [Bright vixens jump; dozy fowl quack.] #42 @ 7%",
+        };
+        fTypeface = sk_tool_utils::create_portable_typeface("serif", SkTypeface::kNormal);
+        SkPaint paint;
+        paint.setTypeface(fTypeface);
+        paint.setTextSize(12);
+
+        SkTextBlobBuilder builder;
+        SkScalar y = paint.getFontSpacing();
+        for (const char* line : kLines) {
+            const size_t len = strlen(line);
+            SkTDArray<uint16_t> glyphs;
+            glyphs.setCount(paint.textToGlyphs(line, len, nullptr));
+            paint.textToGlyphs(line, len, glyphs.begin());
+            SkTDArray<SkScalar> widths;
+            widths.setCount(glyphs.count());
+            paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+            paint.getTextWidths(glyphs.begin(), glyphs.count() * sizeof(uint16_t),
+                                widths.begin());
+
+            const SkTextBlobBuilder::RunBuffer& run = fFullPositions
+                    ? builder.allocRunPos(paint, glyphs.count())
+                    : builder.allocRunPosH(paint, glyphs.count(), y);
+            memcpy(run.glyphs, glyphs.begin(), glyphs.count() * sizeof(uint16_t));
+            SkScalar x = 0;
+            for (int i = 0; i < glyphs.count(); ++i) {
+                if (fFullPositions) {
+                    run.pos[2 * i] = x;
+                    run.pos[2 * i + 1] = y;
+                } else {
+                    run.pos[i] = x;
+                }
+                x += widths[i];
+            }
+            paint.setTextEncoding(SkPaint::kUTF8_TextEncoding);
+            y += paint.getFontSpacing();
+        }
+        fBlob.reset(builder.build());
+    }
+
+    const char* onGetName() override {
+        fName.printf("TextBlobParagraphBench_%s%s", fFullPositions ? "pos" : "posH",
+                     fDrawRuns ? "_runs" : "");
+        return fName.c_str();
+    }
+
+    void onDraw(int loops, SkCanvas* canvas) override {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+
+        for (int i = 0; i < loops; i++) {
+            if (!fDrawRuns) {
+                canvas->drawTextBlob(fBlob, 0, 0, paint);
+                continue;
+            }
+            SkPaint runPaint(paint);
+            for (SkTextBlobRunIterator it(fBlob); !it.done(); it.next()) {
+                it.applyFontToPaint(&runPaint);
+                size_t length = it.glyphCount() * sizeof(uint16_t);
+                if (fFullPositions) {
+                    canvas->drawPosText(it.glyphs(), length, (const SkPoint*)it.pos(), runPaint);
+                } else {
+                    canvas->drawPosTextH(it.glyphs(), length, it.pos(), it.offset().y(),
+                                         runPaint);
+                }
+            }
+        }
+    }
+
+private:
+    const bool                      fFullPositions;
+    const bool                      fDrawRuns;
+    SkString                        fName;
+    SkAutoTUnref<const SkTextBlob>  fBlob;
+    sk_sp<SkTypeface>               fTypeface;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH( return new TextBlobParagraphBench(false, false); )
+DEF_BENCH( return new TextBlobParagraphBench(true, false); )
+DEF_BENCH( return new TextBlobParagraphBench(false, true); )
+DEF_BENCH( return new TextBlobParagraphBench(true, true); )
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Benchmark.h"
+#include "Resources.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkGraphics.h"
+#include "SkImage.h"
+#include "SkSurface.h"
+
+// Draws a grid of photo thumbnails from JPEGs, either decoded to RGBA, or kept as YUV planes and
+// converted as they are drawn (SkImage::MakeFromEncodedYUV()). Cold draws make new images each
+// time, so they include the decodes; warm draws reuse images whose pixels are already cached.
+// Reports how many bytes the decoded pixels (and anything derived from them, like mipmaps) use.
+class YUVImageBench : public Benchmark {
+public:
+    YUVImageBench(bool yuv, bool warm) : fYUV(yuv), fWarm(warm), fCacheBytes(0) {
+        fName.printf("photo_grid_%s_%s", yuv ? "yuv" : "rgba", warm ? "warm" : "cold");
+    }
+
+    bool isSuitableFor(Backend backend) override {
+        return backend == kNonRendering_Backend;
+    }
+
+protected:
+    const char* onGetName() override { return fName.c_str(); }
+
+    void onDelayedSetup() override {
+        SkString path(GetResourcePath("mandrill_512_q075.jpg"));
+        fEncoded = SkData::MakeFromFileName(path.c_str());
+        fSurface = SkSurface::MakeRasterN32Premul(kColumns * kCellSize, kRows * kCellSize);
+        if (fWarm && fEncoded && fSurface) {
+            SkGraphics::PurgeResourceCache();
+            this->makeImages();
+            this->drawGrid();
+            fCacheBytes = SkGraphics::GetResourceCacheTotalBytesUsed();
+        }
+    }
+
+    void onDraw(int loops, SkCanvas*) override {
+        if (!fEncoded || !fSurface) {
+            return;
+        }
+        for (int loop = 0; loop < loops; ++loop) {
+            if (!fWarm) {
+                SkGraphics::PurgeResourceCache();
+                this->makeImages();
+            }
+            this->drawGrid();
+            if (!fWarm) {
+                fCacheBytes = SkGraphics::GetResourceCacheTotalBytesUsed();
+            }
+        }
+    }
+
+    void getStats(double msPerLoop, SkTArray<SkString>* keys,
+                  SkTArray<double>* values) override {
+        keys->push_back(SkString("cache_bytes"));
+        values->push_back((double)fCacheBytes);
+    }
+
+private:
+    static const int kColumns = 4;
+    static const int kRows = 3;
+    static const int kCellSize = 128;
+
+    void makeImages() {
+        for (int i = 0; i < kColumns * kRows; ++i) {
+            fImages[i] = fYUV ? SkImage::MakeFromEncodedYUV(fEncoded)
+                              : SkImage::MakeFromEncoded(fEncoded);
+        }
+    }
+
+    void drawGrid() {
+        SkCanvas* canvas = fSurface->getCanvas();
+        SkPaint paint;
+        paint.setFilterQuality(kMedium_SkFilterQuality);
+        canvas->clear(SK_ColorWHITE);
+        for (int i = 0; i < kColumns * kRows; ++i) {
+            if (fImages[i]) {
+                const SkRect dst = SkRect::MakeXYWH(SkIntToScalar(i % kColumns * kCellSize),
+                                                    SkIntToScalar(i / kColumns * kCellSize),
+                                                    SkIntToScalar(kCellSize),
+                                                    SkIntToScalar(kCellSize));
+                canvas->drawImageRect(fImages[i], dst, &paint);
+            }
+        }
+    }
+
+    bool             fYUV;
+    bool             fWarm;
+    SkString         fName;
+    sk_sp<SkData>    fEncoded;
+    sk_sp<SkSurface> fSurface;
+    sk_sp<SkImage>   fImages[kColumns * kRows];
+    size_t           fCacheBytes;
+
+    typedef Benchmark INHERITED;
+};
+
+DEF_BENCH(return new YUVImageBench(false, false);)
+DEF_BENCH(return new YUVImageBench(true, false);)
+DEF_BENCH(return new YUVImageBench(false, true);)
+DEF_BENCH(return new YUVImageBench(true, true);)
@@ -556,6 +556,7 @@ public:
                       , fCurrentSKP(0)
                       , fCurrentUseMPD(0)
                       , fCurrentCodec(0)
+                      , fCurrentAnimCodec(0)
                       , fCurrentAndroidCodec(0)
                       , fCurrentBRDImage(0)
                       , fCurrentColorType(0)
@@ -802,8 +803,27 @@ public:
             fCurrentColorType = 0;
         }
 
+        // Play back every frame of animated images.
+        for (; fCurrentAnimCodec < fImages.count(); fCurrentAnimCodec++) {
+            fSourceType = "image";
+            fBenchType = "skcodec_frames";
+            const SkString& path = fImages[fCurrentAnimCodec];
+            if (SkCommandLineFlags::ShouldSkip(FLAGS_match, path.c_str())) {
+                continue;
+            }
+            SkAutoTUnref<SkData> encoded(SkData::NewFromFileName(path.c_str()));
+            SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(encoded));
+            if (!codec || codec->getFrameCount() < 2) {
+                continue;
+            }
+
+            fCurrentAnimCodec++;
+            return new CodecBench(SkOSPath::Basename(path.c_str()), encoded, kN32_SkColorType,
+                    kPremul_SkAlphaType, true);
+        }
+
         // Run AndroidCodecBenches
-        const int sampleSizes[] = { 2, 4, 8 };
+        const int sampleSizes[] = { 2, 3, 4, 8 };
         for (; fCurrentAndroidCodec < fImages.count(); fCurrentAndroidCodec++) {
             fSourceType = "image";
             fBenchType = "skandroidcodec";
@@ -973,6 +993,7 @@ private:
     int fCurrentSKP;
     int fCurrentUseMPD;
     int fCurrentCodec;
+    int fCurrentAnimCodec;
     int fCurrentAndroidCodec;
     int fCurrentBRDImage;
     int fCurrentColorType;
@@ -1185,6 +1206,13 @@ int nanobench_main() {
             benchStream.fillCurrentOptions(log.get());
             target->fillOptions(log.get());
             log->metric("min_ms",    stats.min);
+            SkTArray<SkString> statKeys;
+            SkTArray<double> statValues;
+            bench->getStats(stats.min, &statKeys, &statValues);
+            SkASSERT(statKeys.count() == statValues.count());
+            for (int j = 0; j < statKeys.count(); j++) {
+                log->metric(statKeys[j].c_str(), statValues[j]);
+            }
 #if SK_SUPPORT_GPU
             if (gpuStatsDump) {
                 // dump to json, only SKPBench currently returns valid keys / values
@@ -40,6 +40,7 @@
           'link_settings': {
             'libraries': [
               '-lpthread',
+              '-lrt',
             ],
           },
         }],
@@ -248,6 +248,8 @@ public:
         Options()
             : fZeroInitialized(kNo_ZeroInitialized)
             , fSubset(NULL)
+            , fFrameIndex(0)
+            , fHasPriorFrame(false)
         {}
 
         ZeroInitialized fZeroInitialized;
@@ -269,6 +271,26 @@ public:
          *  to getScanlines().
          */
         SkIRect*        fSubset;
+
+        /**
+         *  The frame to decode, for images with more than one (see getFrameCount()).
+         *
+         *  Frames other than the first are only supported by getPixels, without
+         *  a subset or scaling.
+         */
+        int             fFrameIndex;
+
+        /**
+         *  If true, the caller is asserting that the destination already holds
+         *  the frame's required frame (FrameInfo::fRequiredFrame), exactly as it
+         *  was left by decoding it. The codec will then only touch the pixels
+         *  that change: the required frame's rect, if it is disposed by clearing,
+         *  and this frame's rect. If false, the codec decodes the required
+         *  frame(s) into the destination first.
+         *
+         *  Ignored if the frame has no required frame.
+         */
+        bool            fHasPriorFrame;
     };
 
     /**
@@ -312,6 +334,70 @@ public:
      */
     Result getPixels(const SkImageInfo& info, void* pixels, size_t rowBytes);
 
+    /**
+     *  How a frame of an animation is disposed of before the next frame is drawn.
+     */
+    enum DisposalMethod {
+        /** The frame is left in place, and the next frame is drawn on top of it. */
+        kKeep_DisposalMethod,
+        /** The frame's rect is cleared to transparent. */
+        kRestoreBGColor_DisposalMethod,
+        /** The canvas is restored to what it was before the frame was drawn. */
+        kRestorePrevious_DisposalMethod,
+    };
+
+    /**
+     *  Index used to indicate there is no frame (e.g. no required frame).
+     */
+    static const int kNone = -1;
+
+    /**
+     *  Information about a single frame of an image.
+     */
+    struct FrameInfo {
+        /**
+         *  The frame that must be in the destination before this frame can be
+         *  drawn on top of it, or kNone if this frame can be decoded on its own.
+         */
+        int             fRequiredFrame;
+
+        /**
+         *  Number of milliseconds to show this frame.
+         */
+        int             fDuration;
+
+        /**
+         *  The part of the image that this frame draws.
+         */
+        SkIRect         fFrameRect;
+
+        DisposalMethod  fDisposalMethod;
+    };
+
+    /**
+     *  Return the number of frames in the image.
+     *
+     *  This is 1 for still images. For animated images, this may require
+     *  reading through the entire stream, in which case any scanline or
+     *  incremental decode in progress will need to be restarted.
+     */
+    int getFrameCount() {
+        return this->onGetFrameCount();
+    }
+
+    /**
+     *  Return information about the frame at the given index, or false if
+     *  the index is out of range.
+     *
+     *  Like getFrameCount(), this may need to read through the entire stream.
+     */
+    bool getFrameInfo(int index, FrameInfo* info) {
+        if (index < 0 || nullptr == info) {
+            return false;
+        }
+        return this->onGetFrameInfo(index, info);
+    }
+
     /**
      *  If decoding to YUV is supported, this returns true.  Otherwise, this
      *  returns false and does not modify any of the parameters.
@@ -615,6 +701,24 @@ protected:
         return false;
     }
 
+    virtual int onGetFrameCount() {
+        return 1;
+    }
+
+    /**
+     *  The default describes a still image: a single, independent frame.
+     */
+    virtual bool onGetFrameInfo(int index, FrameInfo* info) {
+        if (0 != index) {
+            return false;
+        }
+        info->fRequiredFrame = kNone;
+        info->fDuration = 0;
+        info->fFrameRect = SkIRect::MakeSize(this->getInfo().dimensions());
+        info->fDisposalMethod = kKeep_DisposalMethod;
+        return true;
+    }
+
     /**
      *  If the stream was previously read, attempt to rewind.
      *
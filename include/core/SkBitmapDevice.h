@@ -114,6 +114,12 @@ protected:
     virtual void drawPosText(const SkDraw&, const void* text, size_t len,
                              const SkScalar pos[], int scalarsPerPos,
                              const SkPoint& offset, const SkPaint& paint) override;
+    /**
+     *  Draws each run as drawPosText would, but keeps where the glyphs go, so that drawing the
+     *  same blob again with the same matrix only blits them.
+     */
+    void drawTextBlob(const SkDraw&, const SkTextBlob*, SkScalar x, SkScalar y,
+                      const SkPaint&, SkDrawFilter*) override;
     virtual void drawVertices(const SkDraw&, SkCanvas::VertexMode, int vertexCount,
                               const SkPoint verts[], const SkPoint texs[],
                               const SkColor colors[], SkXfermode* xmode,
@@ -314,7 +314,8 @@ public:
     /**
      * Returns true if the input rect in device space is entirely contained
      * by the clip. A return value of false does not guarantee that the rect
-     * is not contained by the clip.
+     * is not contained by the clip. This is O(1) when the rect lies outside
+     * the clip's bounds, or when the clip is an intersection of rects.
      */
     bool quickContains(const SkRect& devRect) const;
 
@@ -26,6 +26,8 @@ class SkRasterClip;
 struct SkDrawProcs;
 struct SkRect;
 class SkRRect;
+class SkTextBlob;
+class SkTextBlobRunIterator;
 
 class SkDraw {
 public:
@@ -69,6 +71,14 @@ public:
     void    drawPosText(const char text[], size_t byteLength,
                         const SkScalar pos[], int scalarsPerPosition,
                         const SkPoint& offset, const SkPaint& paint) const;
+    /**
+     *  Draws run runIndex of blob, whose font is already applied to paint, at origin, as
+     *  drawText or drawPosText would. The placed glyphs are kept in SkTextBlobRasterCache, so
+     *  that drawing the run again with the same matrix and strike only blits them.
+     */
+    void    drawTextBlobRun(const SkTextBlob& blob, int runIndex,
+                            const SkTextBlobRunIterator& it, SkPoint origin,
+                            const SkPaint& paint) const;
     void    drawVertices(SkCanvas::VertexMode mode, int count,
                          const SkPoint vertices[], const SkPoint textures[],
                          const SkColor colors[], SkXfermode* xmode,
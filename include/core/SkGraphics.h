@@ -72,6 +72,29 @@ public:
      */
     static int SetFontCacheCountLimit(int count);
 
+    /**
+     *  Shares the glyphs of the font cache with other processes through the POSIX shared memory
+     *  object name (e.g. "/myapp-glyphs"), which is created with room for bytes if no process
+     *  has created it yet. Glyphs which any of the processes has generated are then used by all
+     *  of them instead of being generated again. Glyphs are never removed from the shared memory;
+     *  once it is full, new glyphs are only kept in each process's own cache.
+     *
+     *  Returns false, and does not share glyphs, if shared memory can not be used.
+     */
+    static bool SetFontCacheSharedMemory(const char name[], size_t bytes);
+
+    /**
+     *  Keeps the glyphs of the font cache in the file at path, which is created with room for
+     *  bytes if it does not exist, so that later runs of the process find the glyphs generated by
+     *  earlier ones instead of generating them again. As with SetFontCacheSharedMemory, processes
+     *  using the same file at once share their glyphs, and glyphs are never removed from the file.
+     *  A file written by another milestone of Skia is replaced, and glyphs in it are only used if
+     *  the same version of the font engine generated them.
+     *
+     *  Returns false, and does not keep glyphs in a file, if the file can not be used.
+     */
+    static bool SetFontCacheFile(const char path[], size_t bytes);
+
     /**
      *  For debugging purposes, this will attempt to purge the font cache. It
      *  does not change the limit, but will cause subsequent font measures and
@@ -83,6 +83,14 @@ public:
      */
     static sk_sp<SkImage> MakeFromEncoded(sk_sp<SkData> encoded, const SkIRect* subset = NULL);
 
+    /**
+     *  Like MakeFromEncoded(), but if the encoded data can be decoded to YUV planes (e.g. a
+     *  JPEG), the image keeps those instead of RGBA pixels, and raster draws convert them to RGB
+     *  as they sample them. This needs about half the memory (less with chroma subsampling)
+     *  of an RGBA decode. Reading the pixels (e.g. readPixels()) still decodes to RGBA.
+     */
+    static sk_sp<SkImage> MakeFromEncodedYUV(sk_sp<SkData> encoded);
+
     /**
      *  Create a new image from the specified descriptor. Note - the caller is responsible for
      *  managing the lifetime of the underlying platform texture.
@@ -205,6 +213,23 @@ public:
      */
     void preroll(GrContext* = nullptr) const;
 
+    /**
+     *  Like preroll(), but for raster drawing, and without blocking: lazily generated images
+     *  (e.g. from encoded data) start decoding on another thread (see SkTaskGroup), into
+     *  discardable memory, and this returns right away. A draw that needs those pixels before
+     *  they are ready waits for that one decode; other draws don't wait.
+     *
+     *  A scale in (0, 1) decodes a copy that much smaller instead, for images that will only be
+     *  shown thumbnail-sized. Raster draws that scale the image down to that size draw the copy.
+     *
+     *  colorType is the color type the image will be drawn from, which is the image's own for a
+     *  full size prefetch and kN32 for a smaller copy; prefetch does nothing if it is anything
+     *  else. kUnknown_SkColorType accepts either.
+     *
+     *  Does nothing for images that are not lazily generated.
+     */
+    void prefetch(SkScalar scale = 1, SkColorType colorType = kUnknown_SkColorType) const;
+
     // DEPRECATED - currently used by Canvas2DLayerBridge in Chromium.
     GrTexture* getTexture() const;
 
@@ -33,6 +33,7 @@ public:
     };
     static SkImageEncoder* Create(Type);
 
+    SkImageEncoder() : fRowsRemaining(-1), fMinRowBytes(0) {}
     virtual ~SkImageEncoder();
 
     /*  Quality ranges from 0..100 */
@@ -77,6 +78,22 @@ public:
         encoded as SkImageEncoder::kPNG_Type images. */
     static SkPixelSerializer* CreatePixelSerializer();
 
+    /**
+     *  Encode an image that is passed in bands of rows, so that a large image, like a tiled
+     *  render, never needs to be held in memory at once.
+     *
+     *  Call begin() with the stream and the image's info (which must not be kIndex_8), then
+     *  encodeRows() with all of its rows in order, from top to bottom, and finally finish().
+     *  Each returns false on failure, which abandons the encode. The PNG and JPEG encoders
+     *  support this. Others, including WebP (libwebp only encodes whole pictures), return
+     *  false from begin().
+     *
+     *  The stream must remain valid until finish() returns.
+     */
+    bool begin(SkWStream* stream, const SkImageInfo& info, int quality);
+    bool encodeRows(const void* rows, size_t rowBytes, int count);
+    bool finish();
+
 protected:
     /**
      * Encode bitmap 'bm' in the desired format, writing results to
@@ -86,6 +103,21 @@ protected:
      * This must be overridden by each SkImageEncoder implementation.
      */
     virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) = 0;
+
+    /**
+     *  Overridden by encoders that support row streaming. begin(), encodeRows() and finish()
+     *  have already checked their parameters, including that the right number of rows are
+     *  passed. onBeginRows() must discard any encode that was left unfinished.
+     */
+    virtual bool onBeginRows(SkWStream*, const SkImageInfo&, int /*quality*/) { return false; }
+    virtual bool onEncodeRows(const void* /*rows*/, size_t /*rowBytes*/, int /*count*/) {
+        return false;
+    }
+    virtual bool onFinishRows() { return false; }
+
+private:
+    int     fRowsRemaining;     // -1 unless rows are being streamed.
+    size_t  fMinRowBytes;
 };
 
 // This macro declares a global (i.e., non-class owned) creation entry point
@@ -47,6 +47,16 @@ public:
     bool SK_WARN_UNUSED_RESULT getPosTan(SkScalar distance, SkPoint* position,
                                          SkVector* tangent);
 
+    /** Batch version of getPosTan(). Each distance is pinned and evaluated as above, writing
+        into positions[i] and tangents[i] (either array may be null). Distances in increasing
+        order, as when laying out glyphs or dashes along the contour, are located without a
+        full search of the contour.
+        Returns false if there is no path, or a zero-length path was specified, in which case
+        positions and tangents are unchanged.
+    */
+    bool SK_WARN_UNUSED_RESULT getPosTan(int count, const SkScalar distances[],
+                                         SkPoint positions[], SkVector tangents[]);
+
     enum MatrixFlags {
         kGetPosition_MatrixFlag     = 0x01,
         kGetTangent_MatrixFlag      = 0x02,
@@ -113,6 +123,7 @@ private:
     SkScalar compute_cubic_segs(const SkPoint pts[3], SkScalar distance,
                                 int mint, int maxt, int ptIndex);
     const Segment* distanceToSegment(SkScalar distance, SkScalar* t);
+    const Segment* indexToSegment(int index, SkScalar distance, SkScalar* t) const;
     bool quad_too_curvy(const SkPoint pts[3]);
     bool conic_too_curvy(const SkPoint& firstPt, const SkPoint& midTPt,const SkPoint& lastPt);
     bool cheap_dist_exceeds_limit(const SkPoint& pt, SkScalar x, SkScalar y);
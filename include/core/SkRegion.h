@@ -120,13 +120,23 @@ public:
     bool setRect(int32_t left, int32_t top, int32_t right, int32_t bottom);
 
     /**
-     *  Set this region to the union of an array of rects. This is generally
-     *  faster than calling region.op(rect, kUnion_Op) in a loop. If count is
-     *  0, then this region is set to the empty region.
+     *  Set this region to the union of an array of rects. The result is built
+     *  in a single pass, so this is much faster than calling
+     *  region.op(rect, kUnion_Op) in a loop. If count is 0 (or all of the
+     *  rects are empty), then this region is set to the empty region.
      *  @return true if the resulting region is non-empty
      */
     bool setRects(const SkIRect rects[], int count);
 
+    /**
+     *  Union this region with an array of rects: this = (this union rects).
+     *  The rects are combined in a single pass (see setRects) and then merged
+     *  with this region in a single op, so this is much faster than calling
+     *  op(rect, kUnion_Op) for each rect, e.g. when accumulating damage.
+     *  @return true if the resulting region is non-empty
+     */
+    bool unionRects(const SkIRect rects[], int count);
+
     /**
      *  Set this region to the specified region, and return true if it is
      *  non-empty.
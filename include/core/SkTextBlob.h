@@ -8,6 +8,7 @@
 #ifndef SkTextBlob_DEFINED
 #define SkTextBlob_DEFINED
 
+#include "../private/SkAtomics.h"
 #include "../private/SkTemplates.h"
 #include "SkPaint.h"
 #include "SkRefCnt.h"
@@ -69,12 +70,20 @@ private:
 
     static unsigned ScalarsPerGlyph(GlyphPositioning pos);
 
+    // Call when this blob is part of the key to a resourcecache entry, so that the entries are
+    // purged when it is deleted.
+    void notifyAddedToCache() const {
+        fAddedToCache.store(true);
+    }
+
     friend class SkTextBlobBuilder;
+    friend class SkTextBlobRasterCache;
     friend class SkTextBlobRunIterator;
 
     const int        fRunCount;
     const SkRect     fBounds;
     const uint32_t fUniqueID;
+    mutable SkAtomic<bool> fAddedToCache;
 
     SkDEBUGCODE(size_t fStorageSize;)
 
@@ -12,8 +12,12 @@
 
 class SkFontMgr;
 
-/** Create a custom font manager which scans a given directory for font files. */
-SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir);
+/** Create a custom font manager which scans a given directory for font files.
+ *  If indexPath is not null, the faces found are kept in the file at indexPath, so that later
+ *  managers only have to scan the font files which are new or have changed.
+ */
+SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir,
+                                                 const char* indexPath = nullptr);
 
 /** Create a custom font manager that contains no built-in fonts. */
 SK_API SkFontMgr* SkFontMgr_New_Custom_Empty();
@@ -8,6 +8,7 @@
 #define SkBmpCodec_DEFINED
 
 #include "SkCodec.h"
+#include "SkCodecPriv.h"
 #include "SkColorSpace.h"
 #include "SkColorTable.h"
 #include "SkImageInfo.h"
@@ -103,6 +104,30 @@ protected:
             const SkCodec::Options& options, SkPMColor inputColorPtr[],
             int* inputColorCount) = 0;
 
+    /*
+     * Rows of standard and mask bmps all have the same size, so full decodes of large images
+     * are split into bands that are swizzled on other threads.  Bottom-up bmps are swizzled
+     * straight into the right rows, as they are serially.
+     *
+     * Returns the number of rows decoded, or -1 if the rows should be decoded serially
+     * instead, in which case nothing has been read.
+     */
+    template <typename Swizzler>
+    int decodeRowsInBands(Swizzler* swizzler, const SkImageInfo& dstInfo, void* dst,
+                          size_t dstRowBytes) {
+        // Scanline decodes may skip rows, or stop early.
+        if (this->currScanline() >= 0 ||
+                sk_64_mul(dstInfo.width(), dstInfo.height()) < kMinPixelsForRowBands) {
+            return -1;
+        }
+        const int height = dstInfo.height();
+        return decode_rows_in_bands(this->stream(), fSrcRowBytes, height,
+                                    [=](int y, const uint8_t* src) {
+            swizzler->swizzle(SkTAddOffset<void>(dst, this->getDstRow(y, height) * dstRowBytes),
+                              src);
+        });
+    }
+
 private:
 
     /*
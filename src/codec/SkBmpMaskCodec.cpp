@@ -73,9 +73,17 @@ SkCodec::Result SkBmpMaskCodec::prepareToDecode(const SkImageInfo& dstInfo,
 int SkBmpMaskCodec::decodeRows(const SkImageInfo& dstInfo,
                                            void* dst, size_t dstRowBytes,
                                            const Options& opts) {
+    const int height = dstInfo.height();
+    const int bandRows = this->decodeRowsInBands(fMaskSwizzler.get(), dstInfo, dst, dstRowBytes);
+    if (bandRows >= 0) {
+        if (bandRows < height) {
+            SkCodecPrintf("Warning: incomplete input stream.\n");
+        }
+        return bandRows;
+    }
+
     // Iterate over rows of the image
     uint8_t* srcRow = fSrcBuffer.get();
-    const int height = dstInfo.height();
     for (int y = 0; y < height; y++) {
         // Read a row of the input
         if (this->stream()->read(srcRow, this->srcRowBytes()) != this->srcRowBytes()) {
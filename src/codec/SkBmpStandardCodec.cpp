@@ -194,20 +194,29 @@ SkCodec::Result SkBmpStandardCodec::prepareToDecode(const SkImageInfo& dstInfo,
  */
 int SkBmpStandardCodec::decodeRows(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
         const Options& opts) {
-    // Iterate over rows of the image
     const int height = dstInfo.height();
-    for (int y = 0; y < height; y++) {
-        // Read a row of the input
-        if (this->stream()->read(fSrcBuffer.get(), this->srcRowBytes()) != this->srcRowBytes()) {
+    const int bandRows = this->decodeRowsInBands(fSwizzler.get(), dstInfo, dst, dstRowBytes);
+    if (bandRows >= 0) {
+        if (bandRows < height) {
             SkCodecPrintf("Warning: incomplete input stream.\n");
-            return y;
+            return bandRows;
         }
+    } else {
+        // Iterate over rows of the image
+        for (int y = 0; y < height; y++) {
+            // Read a row of the input
+            if (this->stream()->read(fSrcBuffer.get(), this->srcRowBytes()) !=
+                    this->srcRowBytes()) {
+                SkCodecPrintf("Warning: incomplete input stream.\n");
+                return y;
+            }
 
-        // Decode the row in destination format
-        uint32_t row = this->getDstRow(y, dstInfo.height());
+            // Decode the row in destination format
+            uint32_t row = this->getDstRow(y, dstInfo.height());
 
-        void* dstRow = SkTAddOffset<void>(dst, row * dstRowBytes);
-        fSwizzler->swizzle(dstRow, fSrcBuffer.get());
+            void* dstRow = SkTAddOffset<void>(dst, row * dstRowBytes);
+            fSwizzler->swizzle(dstRow, fSrcBuffer.get());
+        }
     }
 
     if (fInIco && fIsOpaque) {
@@ -182,6 +182,17 @@ SkCodec::Result SkCodec::getPixels(const SkImageInfo& info, void* pixels, size_t
 
     CHECK_COLOR_TABLE;
 
+    // Counting frames may read through the stream, so do it before rewinding.
+    if (options && 0 != options->fFrameIndex) {
+        if (options->fFrameIndex < 0 || options->fFrameIndex >= this->getFrameCount()) {
+            return kInvalidParameters;
+        }
+        // Frames are composited onto the whole image.
+        if (options->fSubset || info.dimensions() != this->getInfo().dimensions()) {
+            return kUnimplemented;
+        }
+    }
+
     if (!this->rewindIfNeeded()) {
         return kCouldNotRewind;
     }
@@ -246,6 +257,11 @@ SkCodec::Result SkCodec::startIncrementalDecode(const SkImageInfo& info, void* p
     // Ensure that valid color ptrs are passed in for kIndex8 color type
     CHECK_COLOR_TABLE;
 
+    // Only getPixels() supports decoding frames other than the first.
+    if (options && 0 != options->fFrameIndex) {
+        return kUnimplemented;
+    }
+
     // FIXME: If the rows come after the rows of a previous incremental decode,
     // we might be able to skip the rewind, but only the implementation knows
     // that. (e.g. PNG will always need to rewind, since we called longjmp, but
@@ -304,6 +320,11 @@ SkCodec::Result SkCodec::startScanlineDecode(const SkImageInfo& info,
     // Ensure that valid color ptrs are passed in for kIndex8 color type
     CHECK_COLOR_TABLE;
 
+    // Only getPixels() supports decoding frames other than the first.
+    if (options && 0 != options->fFrameIndex) {
+        return kUnimplemented;
+    }
+
     if (!this->rewindIfNeeded()) {
         return kCouldNotRewind;
     }
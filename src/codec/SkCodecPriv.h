@@ -8,9 +8,13 @@
 #ifndef SkCodecPriv_DEFINED
 #define SkCodecPriv_DEFINED
 
+#include "SkCodec.h"
 #include "SkColorPriv.h"
 #include "SkColorTable.h"
 #include "SkImageInfo.h"
+#include "SkStream.h"
+#include "SkTaskGroup.h"
+#include "SkTemplates.h"
 #include "SkTypes.h"
 
 #ifdef SK_PRINT_CODEC_MESSAGES
@@ -316,4 +320,128 @@ inline PackColorProc choose_pack_color_proc(bool isPremul, SkColorType colorType
     }
 }
 
+/*
+ * Computes the required frame (see SkCodec::FrameInfo) of frames[index], given that
+ * frames[0..index-1] are already filled in.
+ *
+ * @param replacesCanvas True if the frame covers the whole canvas and overwrites every
+ *                       pixel, so nothing drawn before it shows through.
+ */
+inline int compute_required_frame(const SkCodec::FrameInfo frames[], int index,
+                                  bool replacesCanvas, const SkISize& canvasSize) {
+    if (0 == index || replacesCanvas) {
+        return SkCodec::kNone;
+    }
+
+    // A frame that restores the previous canvas leaves behind the canvas it was drawn on, which
+    // is what the frame before it left. That holds even if the restored frame is independent.
+    int prev = index - 1;
+    while (SkCodec::kRestorePrevious_DisposalMethod == frames[prev].fDisposalMethod) {
+        if (0 == prev) {
+            return SkCodec::kNone;
+        }
+        prev--;
+    }
+
+    if (SkCodec::kRestoreBGColor_DisposalMethod == frames[prev].fDisposalMethod &&
+            frames[prev].fFrameRect.contains(SkIRect::MakeSize(canvasSize))) {
+        // Disposing of the previous frame clears the whole canvas.
+        return SkCodec::kNone;
+    }
+    return prev;
+}
+
+/*
+ * Clears the rect of a frame that is disposed with kRestoreBGColor_DisposalMethod.
+ * Assumes a 4-byte destination color type.
+ */
+inline void clear_frame_rect(void* dst, size_t rowBytes, const SkIRect& frameRect) {
+    for (int y = frameRect.top(); y < frameRect.bottom(); y++) {
+        uint32_t* row = SkTAddOffset<uint32_t>(dst, y * rowBytes);
+        sk_bzero(row + frameRect.left(), frameRect.width() * sizeof(uint32_t));
+    }
+}
+
+// Full decodes of formats with fixed-size rows are split into bands on other threads once the
+// image has at least this many pixels.
+static constexpr int64_t kMinPixelsForRowBands = 512 * 512;
+
+/*
+ * Decodes count rows of srcRowBytes each, starting at the stream's position, in bands on other
+ * threads. decodeRow(y, src) is called for every row y that is entirely present in the stream,
+ * and the stream is left just past the last of them.
+ *
+ * Each band reads its rows straight from the stream's memory, if it has any, or otherwise
+ * through its own duplicate of the stream, seeked to the band's first row. duplicate() need
+ * not be thread safe, so the duplicates are all made up front on the calling thread.
+ *
+ * Returns the number of rows decoded, or -1 without reading anything if the stream can't be
+ * read from more than one place at once.
+ */
+template <typename DecodeRowProc>
+int decode_rows_in_bands(SkStream* stream, size_t srcRowBytes, int count,
+                         DecodeRowProc decodeRow) {
+    if (!stream->hasPosition() || !stream->hasLength() || 0 == srcRowBytes) {
+        return -1;
+    }
+    const size_t start = stream->getPosition();
+    const size_t length = stream->getLength();
+    if (start > length) {
+        return -1;
+    }
+    const uint8_t* base = static_cast<const uint8_t*>(stream->getMemoryBase());
+
+    const int rows = (int) SkTMin<size_t>(count, (length - start) / srcRowBytes);
+    constexpr int kRowsPerBand = 32;
+    const int bandCount = (rows + kRowsPerBand - 1) / kRowsPerBand;
+    SkAutoTArray<SkAutoTDelete<SkStream>> bandStreams(base ? 0 : bandCount);
+    if (!base) {
+        for (int band = 0; band < bandCount; band++) {
+            bandStreams[band].reset(stream->duplicate());
+            if (!bandStreams[band]) {
+                return -1;
+            }
+        }
+    }
+    SkAutoTDelete<SkStream>* bandStreamsPtr = bandStreams.get();
+    // Should a duplicate stream come up short, rows past that point are left undecoded.
+    SkAutoTMalloc<int> bandRows(bandCount);
+    int* bandRowsPtr = bandRows.get();
+    SkTaskGroup().batch(bandCount, [=](int band) {
+        const int firstRow = band * kRowsPerBand;
+        const int endRow = SkTMin(firstRow + kRowsPerBand, rows);
+        if (base) {
+            for (int y = firstRow; y < endRow; y++) {
+                decodeRow(y, base + start + y * srcRowBytes);
+            }
+            bandRowsPtr[band] = endRow - firstRow;
+            return;
+        }
+
+        bandRowsPtr[band] = 0;
+        SkStream* bandStream = bandStreamsPtr[band].get();
+        if (!bandStream->seek(start + firstRow * srcRowBytes)) {
+            return;
+        }
+        SkAutoTMalloc<uint8_t> src(srcRowBytes);
+        for (int y = firstRow; y < endRow; y++) {
+            if (bandStream->read(src.get(), srcRowBytes) != srcRowBytes) {
+                return;
+            }
+            decodeRow(y, src.get());
+            bandRowsPtr[band]++;
+        }
+    });
+
+    int decoded = 0;
+    for (int band = 0; band < bandCount; band++) {
+        decoded += bandRows[band];
+        if (bandRows[band] < SkTMin(kRowsPerBand, rows - band * kRowsPerBand)) {
+            break;
+        }
+    }
+    stream->seek(start + decoded * srcRowBytes);
+    return decoded;
+}
+
 #endif // SkCodecPriv_DEFINED
@@ -59,40 +59,77 @@ static GifFileType* open_gif(SkStream* stream) {
 }
 
 /*
- * Check if a there is an index of the color table for a transparent pixel
+ * Find the graphics control extension of an image frame, if it has one
  */
-static uint32_t find_trans_index(const SavedImage& image) {
-    // If there is a transparent index specified, it will be contained in an
-    // extension block.  We will loop through extension blocks in reverse order
+static const ExtensionBlock* find_graphics_control(const SavedImage& image) {
+    // The graphics control extension contains transparency and animation
+    // information.  We will loop through extension blocks in reverse order
     // to check the most recent extension blocks first.
     for (int32_t i = image.ExtensionBlockCount - 1; i >= 0; i--) {
         // Get an extension block
         const ExtensionBlock& extBlock = image.ExtensionBlocks[i];
 
-        // Specifically, we need to check for a graphics control extension,
-        // which may contain transparency information.  Also, note that a valid
-        // graphics control extension is always four bytes.  The fourth byte
-        // is the transparent index (if it exists), so we need at least four
-        // bytes.
+        // Note that a valid graphics control extension is always four bytes.
+        // The fourth byte is the transparent index (if it exists), so we need
+        // at least four bytes.
         if (GRAPHICS_EXT_FUNC_CODE == extBlock.Function && extBlock.ByteCount >= 4) {
-            // Check the transparent color flag which indicates whether a
-            // transparent index exists.  It is the least significant bit of
-            // the first byte of the extension block.
-            if (1 == (extBlock.Bytes[0] & 1)) {
-                // Use uint32_t to prevent sign extending
-                return extBlock.Bytes[3];
-            }
-
             // There should only be one graphics control extension for the image frame
-            break;
+            return &extBlock;
         }
     }
+    return nullptr;
+}
+
+/*
+ * Check if a there is an index of the color table for a transparent pixel
+ */
+static uint32_t find_trans_index(const SavedImage& image) {
+    const ExtensionBlock* extBlock = find_graphics_control(image);
+
+    // Check the transparent color flag which indicates whether a
+    // transparent index exists.  It is the least significant bit of
+    // the first byte of the extension block.
+    if (extBlock && 1 == (extBlock->Bytes[0] & 1)) {
+        // Use uint32_t to prevent sign extending
+        return extBlock->Bytes[3];
+    }
 
     // Use maximum unsigned int (surely an invalid index) to indicate that a valid
     // index was not found.
     return SK_MaxU32;
 }
 
+/*
+ * Get the delay and disposal method of an animation frame
+ */
+static void find_frame_timing(const SavedImage& image, int* duration,
+                              SkCodec::DisposalMethod* disposal) {
+    *duration = 0;
+    *disposal = SkCodec::kKeep_DisposalMethod;
+
+    const ExtensionBlock* extBlock = find_graphics_control(image);
+    if (!extBlock) {
+        return;
+    }
+
+    // The delay is stored little endian, in hundredths of a second.
+    const uint8_t* bytes = (const uint8_t*) extBlock->Bytes;
+    *duration = (bytes[1] | (bytes[2] << 8)) * 10;
+
+    // The disposal method is stored in bits 2-4 of the first byte.  Values
+    // other than 2 and 3 (including 0, "unspecified") leave the frame in place.
+    switch ((bytes[0] >> 2) & 7) {
+        case 2:
+            *disposal = SkCodec::kRestoreBGColor_DisposalMethod;
+            break;
+        case 3:
+            *disposal = SkCodec::kRestorePrevious_DisposalMethod;
+            break;
+        default:
+            break;
+    }
+}
+
 inline uint32_t ceil_div(uint32_t a, uint32_t b) {
     return (a + b - 1) / b;
 }
@@ -177,7 +214,7 @@ bool SkGifCodec::ReadHeader(SkStream* stream, SkCodec** codecOut, GifFileType**
     // Read through gif extensions to get to the image data.  Set the
     // transparent index based on the extension data.
     uint32_t transIndex;
-    SkCodec::Result result = ReadUpToFirstImage(gif, &transIndex);
+    SkCodec::Result result = ReadUpToNextImage(gif, &transIndex);
     if (kSuccess != result){
         return false;
     }
@@ -253,6 +290,7 @@ SkGifCodec::SkGifCodec(int width, int height, const SkEncodedInfo& info, SkStrea
     , fFrameIsSubset(frameIsSubset)
     , fSwizzler(NULL)
     , fColorTable(NULL)
+    , fScannedFrames(false)
 {}
 
 bool SkGifCodec::onRewind() {
@@ -266,7 +304,8 @@ bool SkGifCodec::onRewind() {
     return true;
 }
 
-SkCodec::Result SkGifCodec::ReadUpToFirstImage(GifFileType* gif, uint32_t* transIndex) {
+SkCodec::Result SkGifCodec::ReadUpToNextImage(GifFileType* gif, uint32_t* transIndex,
+        int* duration, DisposalMethod* disposal) {
     // Use this as a container to hold information about any gif extension
     // blocks.  This generally stores transparency and animation instructions.
     SavedImage saveExt;
@@ -276,9 +315,7 @@ SkCodec::Result SkGifCodec::ReadUpToFirstImage(GifFileType* gif, uint32_t* trans
     GifByteType* extData;
     int32_t extFunction;
 
-    // We will loop over components of gif images until we find an image.  Once
-    // we find an image, we will decode and return it.  While many gif files
-    // contain more than one image, we will simply decode the first image.
+    // We will loop over components of gif images until we find an image.
     GifRecordType recordType;
     do {
         // Get the current record type
@@ -288,28 +325,19 @@ SkCodec::Result SkGifCodec::ReadUpToFirstImage(GifFileType* gif, uint32_t* trans
         switch (recordType) {
             case IMAGE_DESC_RECORD_TYPE: {
                 *transIndex = find_trans_index(saveExt);
+                if (duration && disposal) {
+                    find_frame_timing(saveExt, duration, disposal);
+                }
 
-                // FIXME: Gif files may have multiple images stored in a single
-                //        file.  This is most commonly used to enable
-                //        animations.  Since we are leaving animated gifs as a
-                //        TODO, we will return kSuccess after decoding the
-                //        first image in the file.  This is the same behavior
-                //        as SkImageDecoder_libgif.
-                //
-                //        Most times this works pretty well, but sometimes it
-                //        doesn't.  For example, I have an animated test image
-                //        where the first image in the file is 1x1, but the
-                //        subsequent images are meaningful.  This currently
-                //        displays the 1x1 image, which is not ideal.  Right
-                //        now I am leaving this as an issue that will be
-                //        addressed when we implement animated gifs.
+                // Gif files may have multiple images stored in a single file.
+                // This is most commonly used to enable animations, where each
+                // image is a frame (see scanFrames()).
                 //
-                //        It is also possible (not explicitly disallowed in the
+                // FIXME: It is also possible (not explicitly disallowed in the
                 //        specification) that gif files provide multiple
                 //        images in a single file that are all meant to be
-                //        displayed in the same frame together.  I will
-                //        currently leave this unimplemented until I find a
-                //        test case that expects this behavior.
+                //        displayed in the same frame together.  We treat
+                //        every image as a separate frame.
                 return kSuccess;
             }
             // Extensions are used to specify special properties of the image
@@ -357,6 +385,84 @@ SkCodec::Result SkGifCodec::ReadUpToFirstImage(GifFileType* gif, uint32_t* trans
     return gif_error("Could not find any images to decode in gif file.\n", kInvalidInput);
 }
 
+bool SkGifCodec::SkipImageData(GifFileType* gif) {
+    int codeSize;
+    GifByteType* codeBlock;
+    if (GIF_ERROR == DGifGetCode(gif, &codeSize, &codeBlock)) {
+        return false;
+    }
+    while (nullptr != codeBlock) {
+        if (GIF_ERROR == DGifGetCodeNext(gif, &codeBlock)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SkGifCodec::scanFrames() {
+    if (fScannedFrames) {
+        return;
+    }
+    fScannedFrames = true;
+
+    // Scanning moves the stream out from under fGif, so the next decode must rewind.
+    if (this->rewindIfNeeded() && this->stream()->rewind()) {
+        SkAutoTCallVProc<GifFileType, CloseGif> gif(open_gif(this->stream()));
+        const SkIRect canvas = SkIRect::MakeSize(this->getInfo().dimensions());
+        while (gif) {
+            FrameInfo frame;
+            uint32_t transIndex;
+            if (kSuccess != ReadUpToNextImage(gif, &transIndex, &frame.fDuration,
+                                              &frame.fDisposalMethod) ||
+                    GIF_ERROR == DGifGetImageDesc(gif)) {
+                break;
+            }
+
+            const GifImageDesc& desc = gif->Image;
+            frame.fFrameRect.setXYWH(desc.Left, desc.Top, desc.Width, desc.Height);
+            if (!canvas.contains(frame.fFrameRect)) {
+                // The first frame determined the size of the canvas.  Later frames must fit.
+                break;
+            }
+
+            // We do not know if the transparent index is valid yet, so treat it as if it were.
+            const bool replacesCanvas = frame.fFrameRect == canvas && transIndex >= 256;
+            frame.fRequiredFrame = compute_required_frame(fFrames.begin(), fFrames.count(),
+                    replacesCanvas, canvas.size());
+            fFrames.push_back(frame);
+            *fFrameTransIndices.append() = transIndex;
+
+            if (!SkipImageData(gif)) {
+                break;
+            }
+        }
+    }
+
+    if (fFrames.empty()) {
+        // Fall back to describing the image as we found it in the header.
+        FrameInfo& frame = fFrames.push_back();
+        frame.fRequiredFrame = kNone;
+        frame.fDuration = 0;
+        frame.fFrameRect = fFrameRect;
+        frame.fDisposalMethod = kKeep_DisposalMethod;
+        *fFrameTransIndices.append() = fTransIndex;
+    }
+}
+
+int SkGifCodec::onGetFrameCount() {
+    this->scanFrames();
+    return fFrames.count();
+}
+
+bool SkGifCodec::onGetFrameInfo(int index, FrameInfo* info) {
+    this->scanFrames();
+    if (index >= fFrames.count()) {
+        return false;
+    }
+    *info = fFrames[index];
+    return true;
+}
+
 bool SkGifCodec::GetDimensions(GifFileType* gif, SkISize* size, SkIRect* frameRect) {
     // Get the encoded dimension values
     SavedImage* image = &gif->SavedImages[gif->ImageCount - 1];
@@ -386,7 +492,7 @@ bool SkGifCodec::GetDimensions(GifFileType* gif, SkISize* size, SkIRect* frameRe
 }
 
 void SkGifCodec::initializeColorTable(const SkImageInfo& dstInfo, SkPMColor* inputColorPtr,
-        int* inputColorCount) {
+        int* inputColorCount, uint32_t transIndex) {
     // Set up our own color table
     const uint32_t maxColors = 256;
     SkPMColor colorPtr[256];
@@ -429,9 +535,9 @@ void SkGifCodec::initializeColorTable(const SkImageInfo& dstInfo, SkPMColor* inp
         // constructor).  This behavior is not specified but matches
         // SkImageDecoder_libgif.
         uint32_t backgroundIndex = fGif->SBackGroundColor;
-        if (fTransIndex < colorCount) {
-            colorPtr[fTransIndex] = SK_ColorTRANSPARENT;
-            fFillIndex = fTransIndex;
+        if (transIndex < colorCount) {
+            colorPtr[transIndex] = SK_ColorTRANSPARENT;
+            fFillIndex = transIndex;
         } else if (backgroundIndex < colorCount) {
             fFillIndex = backgroundIndex;
         }
@@ -456,7 +562,7 @@ SkCodec::Result SkGifCodec::prepareToDecode(const SkImageInfo& dstInfo, SkPMColo
     }
 
     // Initialize color table and copy to the client if necessary
-    this->initializeColorTable(dstInfo, inputColorPtr, inputColorCount);
+    this->initializeColorTable(dstInfo, inputColorPtr, inputColorCount, fTransIndex);
 
     this->initializeSwizzler(dstInfo, opts);
     return kSuccess;
@@ -483,6 +589,10 @@ SkCodec::Result SkGifCodec::onGetPixels(const SkImageInfo& dstInfo,
                                         SkPMColor* inputColorPtr,
                                         int* inputColorCount,
                                         int* rowsDecoded) {
+    if (opts.fFrameIndex > 0) {
+        return this->decodeFrame(dstInfo, dst, dstRowBytes, opts, rowsDecoded);
+    }
+
     Result result = this->prepareToDecode(dstInfo, inputColorPtr, inputColorCount, opts);
     if (kSuccess != result) {
         return result;
@@ -511,6 +621,114 @@ SkCodec::Result SkGifCodec::onGetPixels(const SkImageInfo& dstInfo,
     return kSuccess;
 }
 
+/*
+ * Decodes a frame after the first.  SkCodec has already checked that the index
+ * is valid and that there is no subset or scaling.
+ */
+SkCodec::Result SkGifCodec::decodeFrame(const SkImageInfo& dstInfo, void* dst,
+        size_t dstRowBytes, const Options& opts, int* rowsDecoded) {
+    // Frames are composited, so we need a color type that can hold any color and alpha.
+    if (kN32_SkColorType != dstInfo.colorType() ||
+            !conversion_possible(dstInfo, this->getInfo())) {
+        return gif_error("Frames after the first must be decoded to kN32.\n",
+                kInvalidConversion);
+    }
+
+    const int index = opts.fFrameIndex;
+    SkASSERT(index > 0 && index < fFrames.count());
+
+    // The frames to draw, from index back to the nearest frame that does not depend on
+    // another one, unless we were given the frame index depends on.
+    SkTDArray<int> frames;
+    *frames.append() = index;
+    if (!opts.fHasPriorFrame) {
+        while (kNone != fFrames[frames.top()].fRequiredFrame) {
+            *frames.append() = fFrames[frames.top()].fRequiredFrame;
+        }
+    }
+
+    // From here on, failures leave the composited frame as is, rather than letting
+    // SkCodec fill over it.
+    *rowsDecoded = dstInfo.height();
+
+    // fGif has read the descriptor of the first image.  Read forward through the stream
+    // once, drawing the frames we need in order and skipping the others.
+    int next = frames.count() - 1;
+    for (int i = 0; i <= index; i++) {
+        if (i > 0) {
+            uint32_t transIndex;
+            if (kSuccess != ReadUpToNextImage(fGif, &transIndex) ||
+                    GIF_ERROR == DGifGetImageDesc(fGif)) {
+                return gif_error("Could not find frame.\n", kIncompleteInput);
+            }
+        }
+        if (i != frames[next]) {
+            if (!SkipImageData(fGif)) {
+                return gif_error("Could not skip image data.\n", kIncompleteInput);
+            }
+            continue;
+        }
+
+        const Result result = this->drawFrame(i, dstInfo, dst, dstRowBytes, opts);
+        if (kSuccess != result) {
+            return result;
+        }
+        next--;
+    }
+    return kSuccess;
+}
+
+SkCodec::Result SkGifCodec::drawFrame(int index, const SkImageInfo& dstInfo, void* dst,
+        size_t dstRowBytes, const Options& opts) {
+    const FrameInfo& info = fFrames[index];
+    const SkIRect& frameRect = info.fFrameRect;
+    const uint32_t transIndex = fFrameTransIndices[index];
+    this->initializeColorTable(dstInfo, nullptr, nullptr, transIndex);
+
+    const int required = info.fRequiredFrame;
+    if (kNone == required) {
+        // The first frame starts on the fill color, as it does when decoded on its own.
+        const uint32_t fillValue = 0 == index ? this->getFillValue(dstInfo.colorType())
+                                              : SK_ColorTRANSPARENT;
+        SkSampler::Fill(dstInfo, dst, dstRowBytes, fillValue, opts.fZeroInitialized);
+    } else if (kRestoreBGColor_DisposalMethod == fFrames[required].fDisposalMethod) {
+        clear_frame_rect(dst, dstRowBytes, fFrames[required].fFrameRect);
+    }
+
+    const SkPMColor* colorPtr = get_color_ptr(fColorTable.get());
+    fSwizzler.reset(SkSwizzler::CreateSwizzler(this->getEncodedInfo(), colorPtr, dstInfo, opts,
+            &frameRect));
+    SkASSERT(fSwizzler);
+
+    // Transparent pixels must let the required frame show through, so they cannot be
+    // swizzled directly into the destination.
+    const bool blend = kNone != required && transIndex < 256;
+    SkAutoTMalloc<uint32_t> blendRow(blend ? dstInfo.width() : 0);
+
+    const bool interlaced = fGif->Image.Interlace;
+    for (int y = 0; y < frameRect.height(); y++) {
+        if (GIF_ERROR == DGifGetLine(fGif, fSrcBuffer.get(), frameRect.width())) {
+            return gif_error("Could not decode line.\n", kIncompleteInput);
+        }
+        const int dstY = frameRect.top() +
+                (interlaced ? get_output_row_interlaced(y, frameRect.height()) : y);
+        uint32_t* dstRow = SkTAddOffset<uint32_t>(dst, dstRowBytes * dstY);
+        if (!blend) {
+            fSwizzler->swizzle(dstRow, fSrcBuffer.get());
+            continue;
+        }
+
+        fSwizzler->swizzle(blendRow.get(), fSrcBuffer.get());
+        for (int x = frameRect.left(); x < frameRect.right(); x++) {
+            // Gif pixels are either opaque or fully transparent.
+            if (SkGetPackedA32(blendRow[x])) {
+                dstRow[x] = blendRow[x];
+            }
+        }
+    }
+    return kSuccess;
+}
+
 // FIXME: This is similar to the implementation for bmp and png.  Can we share more code or
 //        possibly make this non-virtual?
 uint32_t SkGifCodec::onGetFillValue(SkColorType colorType) const {
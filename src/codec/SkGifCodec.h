@@ -10,6 +10,8 @@
 #include "SkColorTable.h"
 #include "SkImageInfo.h"
 #include "SkSwizzler.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
 
 struct GifFileType;
 struct SavedImage;
@@ -70,19 +72,53 @@ protected:
 
     int onOutputScanline(int inputScanline) const override;
 
+    int onGetFrameCount() override;
+
+    bool onGetFrameInfo(int index, FrameInfo*) override;
+
 private:
 
     /*
-     * A gif can contain multiple image frames.  We will only decode the first
-     * frame.  This function reads up to the first image frame, processing
-     * transparency and/or animation information that comes before the image
-     * data.
+     * A gif can contain multiple image frames.  This function reads up to the
+     * next image frame, processing transparency and/or animation information
+     * that comes before the image data.
      *
      * @param gif        Pointer to the library type that manages the gif decode
      * @param transIndex This call will set the transparent index based on the
      *                   extension data.
+     * @param duration   If not nullptr, set to the frame's duration in milliseconds.
+     * @param disposal   If not nullptr, set to the frame's disposal method.
      */
-     static Result ReadUpToFirstImage(GifFileType* gif, uint32_t* transIndex);
+     static Result ReadUpToNextImage(GifFileType* gif, uint32_t* transIndex,
+             int* duration = nullptr, DisposalMethod* disposal = nullptr);
+
+     /*
+      * Skips the compressed data of the image frame whose descriptor was just read.
+      *
+      * @return true on success, false otherwise
+      */
+     static bool SkipImageData(GifFileType* gif);
+
+     /*
+      * Reads through the entire stream, recording the rect, timing, disposal and
+      * transparency of every frame in fFrames.  Only done once, and only when a
+      * client asks about frames.  Afterwards, the next decode will rewind.
+      */
+     void scanFrames();
+
+     /*
+      * Decodes a frame after the first, compositing it onto the frame it depends on.
+      */
+     Result decodeFrame(const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+             const Options& opts, int* rowsDecoded);
+
+     /*
+      * Draws the frame at index, whose descriptor fGif has just read, onto the frame it
+      * depends on, which must already be in dst.  Frames which do not depend on another
+      * are drawn on a cleared canvas.
+      */
+     Result drawFrame(int index, const SkImageInfo& dstInfo, void* dst, size_t dstRowBytes,
+             const Options& opts);
 
      /*
       * A gif may contain many image frames, all of different sizes.
@@ -110,9 +146,10 @@ private:
      *                        contain 8-bit indices, we need a 256 entry color
      *                        table to ensure that indexing is always in
      *                        bounds.
+     * @param transIndex      The transparent index of the frame being decoded.
      */
     void initializeColorTable(const SkImageInfo& dstInfo, SkPMColor* colorPtr,
-            int* inputColorCount);
+            int* inputColorCount, uint32_t transIndex);
 
    /*
     * Checks for invalid inputs and calls setFrameDimensions(), and
@@ -201,5 +238,10 @@ private:
     SkAutoTDelete<SkSwizzler>               fSwizzler;
     SkAutoTUnref<SkColorTable>              fColorTable;
 
+    // Filled in by scanFrames(), one entry per frame.
+    SkTArray<FrameInfo, true>               fFrames;
+    SkTDArray<uint32_t>                     fFrameTransIndices;
+    bool                                    fScannedFrames;
+
     typedef SkCodec INHERITED;
 };
@@ -7,6 +7,7 @@
 
 #include "SkCodec.h"
 #include "SkMSAN.h"
+#include "SkOpts.h"
 #include "SkJpegCodec.h"
 #include "SkJpegDecoderMgr.h"
 #include "SkCodecPriv.h"
@@ -256,6 +257,25 @@ SkJpegCodec::SkJpegCodec(int width, int height, const SkEncodedInfo& info, SkStr
     , fDecoderMgr(decoderMgr)
     , fReadyState(decoderMgr->dinfo()->global_state)
     , fSwizzlerSubset(SkIRect::MakeEmpty())
+    , fCropped(false)
+    , fCropX(0)
+    , fCropWidth(0)
+    , fResize(false)
+    , fResizeWidth(0)
+    , fResizeHeight(0)
+    , fResizeBytesPerPixel(0)
+    , fRestartIndexState(kUnknown_RestartIndexState)
+    , fScanOffset(0)
+    , fSOFHeightOffset(0)
+    , fMCUsPerRow(0)
+    , fRestartInterval(0)
+    , fRowOffset(0)
+    , fIncrementalState(kStartDecompress_IncrementalState)
+    , fIncrementalDst(nullptr)
+    , fIncrementalRowBytes(0)
+    , fIncrementalRow(0)
+    , fIncrementalRowsInitialized(0)
+    , fIncrementalScan(0)
 {}
 
 /*
@@ -285,6 +305,15 @@ void calc_output_dimensions(jpeg_decompress_struct* dinfo, unsigned int num, uns
     jpeg_calc_output_dimensions(dinfo);
 }
 
+/*
+ * Returns the first row or column of the natively scaled image that is covered by
+ * a row or column of the output.  The output is no larger than the scaled image,
+ * so every output row or column covers at least one.
+ */
+static uint32_t box_start(uint32_t dst, uint32_t srcSize, uint32_t dstSize) {
+    return (uint32_t) (((uint64_t) dst * srcSize) / dstSize);
+}
+
 /*
  * Return a valid set of output dimensions for this decoder, given an input scale
  */
@@ -330,6 +359,8 @@ bool SkJpegCodec::onRewind() {
     }
     SkASSERT(nullptr != decoderMgr);
     fDecoderMgr.reset(decoderMgr);
+    fRegionStream.reset(nullptr);
+    fRowOffset = 0;
     return true;
 }
 
@@ -403,8 +434,9 @@ bool SkJpegCodec::setOutputColorSpace(const SkImageInfo& dst) {
 }
 
 /*
- * Checks if we can natively scale to the requested dimensions and natively scales the
- * dimensions if possible
+ * Checks if we can scale to the requested dimensions and natively scales the
+ * dimensions if possible.  Sizes that libjpeg-turbo cannot produce are decoded
+ * at the next larger native scale and resampled.
  */
 bool SkJpegCodec::onDimensionsSupported(const SkISize& size) {
     if (setjmp(fDecoderMgr->getJmpBuf())) {
@@ -413,6 +445,10 @@ bool SkJpegCodec::onDimensionsSupported(const SkISize& size) {
 
     const unsigned int dstWidth = size.width();
     const unsigned int dstHeight = size.height();
+    if (0 == dstWidth || 0 == dstHeight || dstWidth > (unsigned int) this->getInfo().width() ||
+            dstHeight > (unsigned int) this->getInfo().height()) {
+        return false;
+    }
 
     // Set up a fake decompress struct in order to use libjpeg to calculate output dimensions
     // FIXME: Why is this necessary?
@@ -428,9 +464,15 @@ bool SkJpegCodec::onDimensionsSupported(const SkISize& size) {
     calc_output_dimensions(&dinfo, num, denom);
     while (dinfo.output_width != dstWidth || dinfo.output_height != dstHeight) {
 
-        // Return a failure if we have tried all of the possible scales
-        if (1 == num || dstWidth > dinfo.output_width || dstHeight > dinfo.output_height) {
-            return false;
+        // If there is no exact match, use the smallest scale that is at least as large
+        // as the request.  initializeResize() will take care of the rest.
+        if (dstWidth > dinfo.output_width || dstHeight > dinfo.output_height) {
+            SkASSERT(num < 8);
+            num += 1;
+            break;
+        }
+        if (1 == num) {
+            break;
         }
 
         // Try the next scale
@@ -477,6 +519,19 @@ SkCodec::Result SkJpegCodec::onGetPixels(const SkImageInfo& dstInfo,
     // If it's not, we want to know because it means our strategy is not optimal.
     SkASSERT(1 == dinfo->rec_outbuf_height);
 
+    this->initializeResize(dstInfo, options);
+    if (fResize) {
+        for (int y = 0; y < dstInfo.height(); y++) {
+            if (!this->readResizedRow(dst, y)) {
+                *rowsDecoded = y;
+
+                return fDecoderMgr->returnFailure("Incomplete image data", kIncompleteInput);
+            }
+            dst = SkTAddOffset<void>(dst, dstRowBytes);
+        }
+        return kSuccess;
+    }
+
     J_COLOR_SPACE colorSpace = dinfo->out_color_space;
     if (JCS_CMYK == colorSpace || JCS_RGB == colorSpace) {
         this->initializeSwizzler(dstInfo, options);
@@ -553,6 +608,11 @@ void SkJpegCodec::initializeSwizzler(const SkImageInfo& dstInfo, const Options&
 }
 
 SkSampler* SkJpegCodec::getSampler(bool createIfNecessary) {
+    if (fResize) {
+        // The swizzler, if any, works on rows of the natively scaled image.
+        return nullptr;
+    }
+
     if (!createIfNecessary || fSwizzler) {
         SkASSERT(!fSwizzler || (fSrcRow && fStorage.get() == fSrcRow));
         return fSwizzler;
@@ -586,6 +646,13 @@ SkCodec::Result SkJpegCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
         return kInvalidInput;
     }
 
+    fCropped = false;
+    this->initializeResize(dstInfo, options);
+    if (fResize) {
+        // Resampling picks out the columns of the subset.
+        return kSuccess;
+    }
+
     if (options.fSubset) {
         fSwizzlerSubset = *options.fSubset;
     }
@@ -601,6 +668,9 @@ SkCodec::Result SkJpegCodec::onStartScanlineDecode(const SkImageInfo& dstInfo,
         // of width so that the right edge of the requested subset remains
         // the same.
         jpeg_crop_scanline(fDecoderMgr->dinfo(), &startX, &width);
+        fCropped = true;
+        fCropX = startX;
+        fCropWidth = width;
 
         SkASSERT(startX <= (uint32_t) options.fSubset->x());
         SkASSERT(width >= (uint32_t) options.fSubset->width());
@@ -649,6 +719,18 @@ int SkJpegCodec::onGetScanlines(void* dst, int count, size_t dstRowBytes) {
     if (setjmp(fDecoderMgr->getJmpBuf())) {
         return fDecoderMgr->returnFailure("setjmp", kInvalidInput);
     }
+
+    if (fResize) {
+        for (int y = 0; y < count; y++) {
+            if (!this->readResizedRow(dst, this->currScanline() + y)) {
+                fDecoderMgr->dinfo()->output_scanline = fDecoderMgr->dinfo()->output_height;
+                return y;
+            }
+            dst = SkTAddOffset<void>(dst, dstRowBytes);
+        }
+        return count;
+    }
+
     // Read rows one at a time
     JSAMPLE* dstRow;
     size_t srcRowBytes = get_row_bytes(fDecoderMgr->dinfo());
@@ -666,7 +748,7 @@ int SkJpegCodec::onGetScanlines(void* dst, int count, size_t dstRowBytes) {
         uint32_t rowsDecoded = jpeg_read_scanlines(fDecoderMgr->dinfo(), &dstRow, 1);
         sk_msan_mark_initialized(dstRow, dstRow + srcRowBytes, "skbug.com/4550");
         if (rowsDecoded != 1) {
-            fDecoderMgr->dinfo()->output_scanline = this->dstInfo().height();
+            fDecoderMgr->dinfo()->output_scanline = fDecoderMgr->dinfo()->output_height;
             return y;
         }
 
@@ -687,15 +769,38 @@ bool SkJpegCodec::onSkipScanlines(int count) {
         return fDecoderMgr->returnFalse("setjmp");
     }
 
+    // Find the row of the scaled image that should be read next.
+    uint32_t nextRow;
+    if (fResize) {
+        const int dstY = this->currScanline() + count;
+        if (dstY >= fResizeHeight) {
+            // There is nothing left to read.
+            return true;
+        }
+        nextRow = box_start(dstY, fRowOffset + fDecoderMgr->dinfo()->output_height,
+                            fResizeHeight);
+    } else {
+        nextRow = this->nextSrcRow() + count;
+    }
+
+    if (this->jumpToRow(nextRow)) {
+        // Errors must now be caught on the new decompress struct.
+        if (setjmp(fDecoderMgr->getJmpBuf())) {
+            return fDecoderMgr->returnFalse("setjmp");
+        }
+    }
+
+    SkASSERT(nextRow >= this->nextSrcRow());
+    const uint32_t rowsToSkip = nextRow - this->nextSrcRow();
 #ifdef TURBO_HAS_SKIP
-    return (uint32_t) count == jpeg_skip_scanlines(fDecoderMgr->dinfo(), count);
+    return rowsToSkip == jpeg_skip_scanlines(fDecoderMgr->dinfo(), rowsToSkip);
 #else
     if (!fSrcRow) {
         fStorage.reset(get_row_bytes(fDecoderMgr->dinfo()));
         fSrcRow = fStorage.get();
     }
 
-    for (int y = 0; y < count; y++) {
+    for (uint32_t y = 0; y < rowsToSkip; y++) {
         if (1 != jpeg_read_scanlines(fDecoderMgr->dinfo(), &fSrcRow, 1)) {
             return false;
         }
@@ -704,6 +809,526 @@ bool SkJpegCodec::onSkipScanlines(int count) {
 #endif
 }
 
+SkCodec::Result SkJpegCodec::onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst,
+        size_t rowBytes, const Options& options, SkPMColor*, int*) {
+    if (options.fSubset && *options.fSubset != SkIRect::MakeSize(dstInfo.dimensions())) {
+        // Subsets are not supported.
+        return kUnimplemented;
+    }
+
+    // Set the jump location for libjpeg errors
+    if (setjmp(fDecoderMgr->getJmpBuf())) {
+        return fDecoderMgr->returnFailure("setjmp", kInvalidInput);
+    }
+
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (dinfo->arith_code) {
+        // libjpeg cannot suspend while it decodes arithmetic coded data.
+        return kUnimplemented;
+    }
+
+    // Check if we can decode to the requested destination and set the output color space
+    if (!this->setOutputColorSpace(dstInfo)) {
+        return kInvalidConversion;
+    }
+
+    // Remove objects used for sampling.
+    fSwizzler.reset(nullptr);
+    fSrcRow = nullptr;
+    fStorage.reset();
+
+    // Otherwise, jpeg_start_decompress() would not return until every scan has arrived.
+    dinfo->buffered_image = jpeg_has_multiple_scans(dinfo);
+    fDecoderMgr->srcMgr()->fSuspendable = true;
+
+    fIncrementalState = kStartDecompress_IncrementalState;
+    fIncrementalDst = dst;
+    fIncrementalRowBytes = rowBytes;
+    fIncrementalRow = 0;
+    fIncrementalRowsInitialized = 0;
+    fIncrementalScan = 0;
+    return kSuccess;
+}
+
+SkCodec::Result SkJpegCodec::onIncrementalDecode(int* rowsDecoded) {
+    // Set the jump location for libjpeg errors
+    if (setjmp(fDecoderMgr->getJmpBuf())) {
+        return fDecoderMgr->returnFailure("setjmp", kInvalidInput);
+    }
+
+    // libjpeg also suspends when the source manager has to move data that it will read again,
+    // in which case it can continue right away.
+    skjpeg_source_mgr* src = fDecoderMgr->srcMgr();
+    Result result;
+    do {
+        src->fHasMoreData = false;
+        result = this->continueIncrementalDecode();
+    } while (kIncompleteInput == result && src->fHasMoreData);
+
+    if (kIncompleteInput == result && rowsDecoded) {
+        *rowsDecoded = fIncrementalRowsInitialized;
+    }
+    return result;
+}
+
+SkCodec::Result SkJpegCodec::continueIncrementalDecode() {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    skjpeg_source_mgr* src = fDecoderMgr->srcMgr();
+    for (;;) {
+        switch (fIncrementalState) {
+            case kStartDecompress_IncrementalState: {
+                if (!jpeg_start_decompress(dinfo)) {
+                    return kIncompleteInput;
+                }
+
+                Options options = this->options();
+                options.fSubset = nullptr;
+                this->initializeResize(this->dstInfo(), options);
+                J_COLOR_SPACE colorSpace = dinfo->out_color_space;
+                if (!fResize && (JCS_CMYK == colorSpace || JCS_RGB == colorSpace)) {
+                    this->initializeSwizzler(this->dstInfo(), options);
+                }
+                fIncrementalState = dinfo->buffered_image ? kStartOutput_IncrementalState
+                                                          : kReadRows_IncrementalState;
+                break;
+            }
+            case kStartOutput_IncrementalState: {
+                // Entropy decode everything that has arrived.  This is the only work that
+                // grows with the new data until a scan is complete.
+                int status;
+                do {
+                    src->fHasMoreData = false;
+                    status = jpeg_consume_input(dinfo);
+                } while (JPEG_REACHED_EOI != status &&
+                         (JPEG_SUSPENDED != status || src->fHasMoreData));
+
+                // Output the latest complete scan, if it has not been output already.
+                // The first scan is output as it arrives, so that something is shown early.
+                const bool complete = jpeg_input_complete(dinfo);
+                int scan = dinfo->input_scan_number;
+                if (!complete && fIncrementalScan > 0) {
+                    scan--;
+                }
+                if (scan <= fIncrementalScan) {
+                    return kIncompleteInput;
+                }
+                if (!jpeg_start_output(dinfo, scan)) {
+                    return kIncompleteInput;
+                }
+                fIncrementalScan = scan;
+                fIncrementalRow = 0;
+                fIncrementalState = kReadRows_IncrementalState;
+                break;
+            }
+            case kReadRows_IncrementalState:
+                if (!this->readIncrementalRows()) {
+                    return kIncompleteInput;
+                }
+                if (!dinfo->buffered_image) {
+                    return kSuccess;
+                }
+                fIncrementalState = kFinishOutput_IncrementalState;
+                break;
+            case kFinishOutput_IncrementalState:
+                if (!jpeg_finish_output(dinfo)) {
+                    return kIncompleteInput;
+                }
+                if (jpeg_input_complete(dinfo) && fIncrementalScan == dinfo->input_scan_number) {
+                    return kSuccess;
+                }
+                fIncrementalState = kStartOutput_IncrementalState;
+                break;
+        }
+    }
+}
+
+bool SkJpegCodec::readIncrementalRows() {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const int height = this->dstInfo().height();
+    while (fIncrementalRow < height) {
+        void* dst = SkTAddOffset<void>(fIncrementalDst, fIncrementalRow * fIncrementalRowBytes);
+        if (fResize) {
+            if (!this->readResizedRow(dst, fIncrementalRow)) {
+                return false;
+            }
+        } else {
+            JSAMPLE* dstRow = fSwizzler ? fSrcRow : (JSAMPLE*) dst;
+            if (1 != jpeg_read_scanlines(dinfo, &dstRow, 1)) {
+                return false;
+            }
+            sk_msan_mark_initialized(dstRow, dstRow + get_row_bytes(dinfo), "skbug.com/4550");
+            if (fSwizzler) {
+                fSwizzler->swizzle(dst, dstRow);
+            }
+        }
+        fIncrementalRow++;
+        fIncrementalRowsInitialized = SkTMax(fIncrementalRowsInitialized, fIncrementalRow);
+    }
+    return true;
+}
+
+void SkJpegCodec::initializeResize(const SkImageInfo& dstInfo, const Options& options) {
+    fResize = false;
+    fSwizzler.reset(nullptr);
+    fSrcRow = nullptr;
+
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (dinfo->output_width == (uint32_t) dstInfo.width() &&
+            dinfo->output_height == (uint32_t) dstInfo.height()) {
+        return;
+    }
+    SkASSERT(dinfo->output_width >= (uint32_t) dstInfo.width() &&
+             dinfo->output_height >= (uint32_t) dstInfo.height());
+
+    int left = 0;
+    fResizeWidth = dstInfo.width();
+    if (options.fSubset) {
+        left = options.fSubset->x();
+        fResizeWidth = options.fSubset->width();
+    }
+    fResize = true;
+    fResizeHeight = dstInfo.height();
+    fResizeBytesPerPixel = SkColorTypeBytesPerPixel(dstInfo.colorType());
+    fResizeX.reset(fResizeWidth + 1);
+    for (int x = 0; x <= fResizeWidth; x++) {
+        fResizeX[x] = box_start(left + x, dinfo->output_width, dstInfo.width());
+    }
+    fResizeRow.reset(dinfo->output_width * fResizeBytesPerPixel);
+
+    // 565 is filtered as 8888, so it needs a wider copy of the source row and of the output.
+    const int channels = 1 == fResizeBytesPerPixel ? 1 : 4;
+    fResizeSums.reset(dinfo->output_width * channels);
+    if (2 == fResizeBytesPerPixel) {
+        fResize32.reset(dinfo->output_width + fResizeWidth);
+    }
+
+    // Convert whole rows of the natively scaled image, if libjpeg-turbo cannot.
+    J_COLOR_SPACE colorSpace = dinfo->out_color_space;
+    if (JCS_CMYK == colorSpace || JCS_RGB == colorSpace) {
+        Options swizzlerOptions = options;
+        swizzlerOptions.fSubset = nullptr;
+        this->initializeSwizzler(dstInfo.makeWH(dinfo->output_width, dinfo->output_height),
+                                 swizzlerOptions);
+    }
+}
+
+uint32_t SkJpegCodec::nextSrcRow() {
+    return fRowOffset + fDecoderMgr->dinfo()->output_scanline;
+}
+
+bool SkJpegCodec::readResizedRow(void* dst, int dstY) {
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const uint32_t srcHeight = fRowOffset + dinfo->output_height;
+    const uint32_t top = box_start(dstY, srcHeight, fResizeHeight);
+    const uint32_t bottom = box_start(dstY + 1, srcHeight, fResizeHeight);
+    if (this->nextSrcRow() > top) {
+        // Only happens if a previous read failed.
+        return false;
+    }
+
+    // Drop any rows above the box, then add up the rows inside it.
+    const int srcWidth = dinfo->output_width;
+    const int channels = 1 == fResizeBytesPerPixel ? 1 : 4;
+    sk_bzero(fResizeSums.get(), srcWidth * channels * sizeof(float));
+    JSAMPLE* srcRow = fSwizzler ? fSrcRow : fResizeRow.get();
+    while (this->nextSrcRow() < bottom) {
+        const bool inBox = this->nextSrcRow() >= top;
+        if (1 != jpeg_read_scanlines(dinfo, &srcRow, 1)) {
+            return false;
+        }
+        sk_msan_mark_initialized(srcRow, srcRow + get_row_bytes(dinfo), "skbug.com/4550");
+        if (!inBox) {
+            continue;
+        }
+
+        if (fSwizzler) {
+            fSwizzler->swizzle(fResizeRow.get(), fSrcRow);
+        }
+        const uint8_t* row = fResizeRow.get();
+        if (2 == fResizeBytesPerPixel) {
+            const uint16_t* row16 = (const uint16_t*) fResizeRow.get();
+            for (int x = 0; x < srcWidth; x++) {
+                fResize32[x] = SkPixel16ToPixel32(row16[x]);
+            }
+            row = (const uint8_t*) fResize32.get();
+        }
+        SkOpts::box_accumulate_row(fResizeSums.get(), row, srcWidth * channels);
+    }
+
+    const int rows = bottom - top;
+    switch (fResizeBytesPerPixel) {
+        case 1:
+        case 4:
+            SkOpts::box_resolve_row((uint8_t*) dst, fResizeSums.get(), fResizeX.get(),
+                                    fResizeWidth, rows, fResizeBytesPerPixel);
+            break;
+        case 2: {
+            uint32_t* dst32 = fResize32.get() + srcWidth;
+            SkOpts::box_resolve_row((uint8_t*) dst32, fResizeSums.get(), fResizeX.get(),
+                                    fResizeWidth, rows, 4);
+            uint16_t* dstRow = (uint16_t*) dst;
+            for (int x = 0; x < fResizeWidth; x++) {
+                dstRow[x] = SkPixel32ToPixel16(dst32[x]);
+            }
+            break;
+        }
+        default:
+            SkASSERT(false);
+            return false;
+    }
+    return true;
+}
+
+bool SkJpegCodec::buildRestartIndex() {
+    if (kUnknown_RestartIndexState != fRestartIndexState) {
+        return kUsable_RestartIndexState == fRestartIndexState;
+    }
+    fRestartIndexState = kUnusable_RestartIndexState;
+
+    // We need a single, interleaved, Huffman coded scan with restart markers.  For simplicity,
+    // a single component must not be subsampled, so that each iMCU row is one MCU row.
+    const jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    if (0 == dinfo->restart_interval || dinfo->progressive_mode || dinfo->arith_code ||
+            dinfo->comps_in_scan != dinfo->num_components) {
+        return false;
+    }
+    if (1 == dinfo->num_components && (1 != dinfo->comp_info[0].h_samp_factor ||
+                                       1 != dinfo->comp_info[0].v_samp_factor)) {
+        return false;
+    }
+
+    // And random access to the encoded data.
+    SkStream* stream = this->stream();
+    const uint8_t* data = (const uint8_t*) stream->getMemoryBase();
+    if (!data || !stream->hasLength()) {
+        return false;
+    }
+    const size_t length = stream->getLength();
+
+    // Find the height in the frame header, and the start of the scan.
+    size_t offset = 2;
+    fSOFHeightOffset = 0;
+    fScanOffset = 0;
+    while (0 == fScanOffset) {
+        if (offset + 4 > length || 0xFF != data[offset]) {
+            return false;
+        }
+        const uint8_t marker = data[offset + 1];
+        if (0xFF == marker) {
+            // Fill byte
+            offset++;
+            continue;
+        }
+        const size_t segmentLength = (data[offset + 2] << 8) | data[offset + 3];
+        switch (marker) {
+            case 0xC0:  // Baseline
+            case 0xC1:  // Extended sequential
+                fSOFHeightOffset = SkToU32(offset + 5);
+                break;
+            case 0xDA:  // Start of scan
+                fScanOffset = SkToU32(offset + 2 + segmentLength);
+                break;
+            default:
+                break;
+        }
+        offset += 2 + segmentLength;
+    }
+    if (0 == fSOFHeightOffset || fScanOffset >= length || dinfo->image_height !=
+            (uint32_t) ((data[fSOFHeightOffset] << 8) | data[fSOFHeightOffset + 1])) {
+        return false;
+    }
+
+    // Find the restart markers.  Any other marker before the end of the image means that
+    // there is more than one scan.
+    SkTDArray<uint32_t> restartOffsets;
+    const uint8_t* ptr = data + fScanOffset;
+    const uint8_t* end = data + length;
+    for (;;) {
+        ptr = (const uint8_t*) memchr(ptr, 0xFF, end - ptr);
+        if (!ptr || ptr + 1 >= end) {
+            return false;
+        }
+        const uint8_t marker = ptr[1];
+        if (0x00 == marker) {
+            // Stuffed zero
+            ptr += 2;
+        } else if (0xFF == marker) {
+            // Fill byte
+            ptr += 1;
+        } else if (marker >= 0xD0 && marker <= 0xD7) {
+            if (marker - 0xD0 != restartOffsets.count() % 8) {
+                return false;
+            }
+            ptr += 2;
+            *restartOffsets.append() = SkToU32(ptr - data);
+        } else if (0xD9 == marker) {
+            break;
+        } else {
+            return false;
+        }
+    }
+
+    // Every interval but the last must end with a marker.
+    const uint32_t mcuWidth = dinfo->max_h_samp_factor * DCTSIZE;
+    const uint32_t mcuHeight = dinfo->max_v_samp_factor * DCTSIZE;
+    const uint32_t interval = dinfo->restart_interval;
+    fMCUsPerRow = (dinfo->image_width + mcuWidth - 1) / mcuWidth;
+    const uint64_t totalMCUs = (uint64_t) fMCUsPerRow *
+            ((dinfo->image_height + mcuHeight - 1) / mcuHeight);
+    if ((uint64_t) restartOffsets.count() != (totalMCUs + interval - 1) / interval - 1) {
+        return false;
+    }
+
+    fRestartOffsets.swap(restartOffsets);
+    fRestartInterval = interval;
+    fRestartIndexState = kUsable_RestartIndexState;
+    return true;
+}
+
+/*
+ * Presents an in-memory jpeg that begins at one of its restart intervals: the
+ * original headers with the height reduced, followed by the entropy coded data
+ * from that interval on.  Restart markers are renumbered so that the first one
+ * the decoder sees is RST0.
+ */
+class JpegRegionStream : public SkStream {
+public:
+    JpegRegionStream(const uint8_t* data, size_t length, uint32_t scanOffset,
+                     uint32_t heightOffset, uint32_t height, const SkTDArray<uint32_t>& markers,
+                     int firstInterval)
+        : fData(data)
+        , fHeader(scanOffset)
+        , fHeaderLength(scanOffset)
+        , fTailOffset(markers[firstInterval - 1])
+        , fLength(scanOffset + length - fTailOffset)
+        , fPosition(0)
+        , fMarkers(markers.begin())
+        , fMarkerCount(markers.count())
+        , fFirstMarker(firstInterval)
+        , fNextMarker(firstInterval)
+    {
+        SkASSERT(firstInterval > 0 && height <= 0xFFFF);
+        memcpy(fHeader.get(), data, scanOffset);
+        fHeader[heightOffset] = (uint8_t) (height >> 8);
+        fHeader[heightOffset + 1] = (uint8_t) height;
+    }
+
+    size_t read(void* buffer, size_t size) override {
+        size = SkTMin(size, fLength - fPosition);
+        if (buffer) {
+            uint8_t* dst = (uint8_t*) buffer;
+            size_t remaining = size;
+            size_t position = fPosition;
+            if (position < fHeaderLength) {
+                const size_t bytes = SkTMin(remaining, fHeaderLength - position);
+                memcpy(dst, fHeader.get() + position, bytes);
+                dst += bytes;
+                position += bytes;
+                remaining -= bytes;
+            }
+            if (remaining > 0) {
+                const size_t start = position - fHeaderLength + fTailOffset;
+                memcpy(dst, fData + start, remaining);
+
+                // The marker number is the byte before each restart offset.
+                while (fNextMarker < fMarkerCount && fMarkers[fNextMarker] - 1 < start) {
+                    fNextMarker++;
+                }
+                for (int i = fNextMarker; i < fMarkerCount &&
+                        fMarkers[i] - 1 < start + remaining; i++) {
+                    dst[fMarkers[i] - 1 - start] = 0xD0 + ((i - fFirstMarker) & 7);
+                }
+            }
+        }
+        fPosition += size;
+        return size;
+    }
+
+    bool isAtEnd() const override { return fPosition == fLength; }
+
+private:
+    const uint8_t*          fData;
+    SkAutoTMalloc<uint8_t>  fHeader;
+    const size_t            fHeaderLength;
+    const size_t            fTailOffset;
+    const size_t            fLength;
+    size_t                  fPosition;
+    const uint32_t*         fMarkers;
+    const int               fMarkerCount;
+    const int               fFirstMarker;
+    int                     fNextMarker;
+};
+
+bool SkJpegCodec::jumpToRow(uint32_t row) {
+    if (!this->buildRestartIndex()) {
+        return false;
+    }
+
+    jpeg_decompress_struct* dinfo = fDecoderMgr->dinfo();
+    const uint32_t rowsPerIMCU =
+            dinfo->max_v_samp_factor * DCTSIZE * dinfo->scale_num / dinfo->scale_denom;
+
+    // Start an iMCU row early, so that the upsampler sees the same context for row.
+    uint32_t iMCURow = row / rowsPerIMCU;
+    if (iMCURow < 2) {
+        return false;
+    }
+    iMCURow--;
+    while (iMCURow > 0 && 0 != (iMCURow * fMCUsPerRow) % fRestartInterval) {
+        iMCURow--;
+    }
+    if (0 == iMCURow || iMCURow * rowsPerIMCU <= this->nextSrcRow()) {
+        // Skipping from here is no more work.
+        return false;
+    }
+
+    const uint32_t totalHeight = fRowOffset + dinfo->output_height;
+    const int firstInterval = iMCURow * fMCUsPerRow / fRestartInterval;
+    SkASSERT(firstInterval > 0 && firstInterval <= fRestartOffsets.count());
+    // dinfo may already be decoding a region, so use the height of the original image.
+    const uint32_t height = this->getInfo().height() -
+            iMCURow * dinfo->max_v_samp_factor * DCTSIZE;
+
+    SkStream* stream = this->stream();
+    SkAutoTDelete<SkStream> regionStream(new JpegRegionStream(
+            (const uint8_t*) stream->getMemoryBase(), stream->getLength(), fScanOffset,
+            fSOFHeightOffset, height, fRestartOffsets, firstInterval));
+    JpegDecoderMgr* decoderMgr = nullptr;
+    if (!ReadHeader(regionStream.get(), nullptr, &decoderMgr)) {
+        return false;
+    }
+    SkAutoTDelete<JpegDecoderMgr> decoderMgrDeleter(decoderMgr);
+
+    if (setjmp(decoderMgr->getJmpBuf())) {
+        return decoderMgr->returnFalse("jumpToRow/setjmp");
+    }
+
+    // Decode exactly as before.
+    jpeg_decompress_struct* regionInfo = decoderMgr->dinfo();
+    regionInfo->out_color_space = dinfo->out_color_space;
+    regionInfo->dither_mode = dinfo->dither_mode;
+    regionInfo->scale_num = dinfo->scale_num;
+    regionInfo->scale_denom = dinfo->scale_denom;
+    if (!jpeg_start_decompress(regionInfo)) {
+        return decoderMgr->returnFalse("jumpToRow/startDecompress");
+    }
+#ifdef TURBO_HAS_CROP
+    if (fCropped) {
+        uint32_t startX = fCropX;
+        uint32_t width = fCropWidth;
+        jpeg_crop_scanline(regionInfo, &startX, &width);
+        SkASSERT(startX == fCropX && width == fCropWidth);
+    }
+#endif
+    SkASSERT(regionInfo->output_width == dinfo->output_width);
+    SkASSERT(iMCURow * rowsPerIMCU + regionInfo->output_height == totalHeight);
+
+    fRowOffset = iMCURow * rowsPerIMCU;
+    fDecoderMgr.reset(decoderMgrDeleter.release());
+    fRegionStream.reset(regionStream.release());
+    return true;
+}
+
 static bool is_yuv_supported(jpeg_decompress_struct* dinfo) {
     // Scaling is not supported in raw data mode.
     SkASSERT(dinfo->scale_num == dinfo->scale_denom);
@@ -13,6 +13,7 @@
 #include "SkImageInfo.h"
 #include "SkSwizzler.h"
 #include "SkStream.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
 
 class JpegDecoderMgr;
@@ -58,6 +59,15 @@ protected:
 
     bool onDimensionsSupported(const SkISize&) override;
 
+    /*
+     * Incremental decodes keep libjpeg's state as the stream receives more data.  Progressive
+     * images are decoded in buffered image mode, so that each call shows the latest complete
+     * scan, and the first scan is shown as soon as it starts to arrive.
+     */
+    Result onStartIncrementalDecode(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+            const Options&, SkPMColor*, int*) override;
+    Result onIncrementalDecode(int* rowsDecoded) override;
+
 private:
 
     /*
@@ -109,6 +119,61 @@ private:
     int onGetScanlines(void* dst, int count, size_t rowBytes) override;
     bool onSkipScanlines(int count) override;
 
+    /*
+     * libjpeg-turbo only scales by multiples of 1/8.  For other sizes, we decode
+     * at the nearest larger scale and box filter the rows down as they are decoded.
+     * Sets fResize if this is necessary.  Must be called after jpeg_start_decompress().
+     *
+     * @param dstInfo The requested output, at its full (not subsetted) size.
+     * @param options fSubset, if set, selects the columns that will be written.
+     */
+    void initializeResize(const SkImageInfo& dstInfo, const Options& options);
+
+    /*
+     * Decodes the rows of the scaled image that are covered by dst row dstY,
+     * and averages them into dst.  Only used if fResize is set.
+     */
+    bool readResizedRow(void* dst, int dstY);
+
+    /*
+     * Returns the row of the scaled image that libjpeg-turbo will output next.
+     */
+    uint32_t nextSrcRow();
+
+    /*
+     * If the image has restart markers at the start of MCU rows, and its data is
+     * in memory, records the offset of each restart interval in fRestartOffsets.
+     * Only done once.
+     *
+     * @return true if the index can be used by jumpToRow().
+     */
+    bool buildRestartIndex();
+
+    /*
+     * Skipping rows normally requires entropy decoding all of them.  Instead,
+     * this starts a new decode at the closest restart interval above row,
+     * replacing fDecoderMgr.
+     *
+     * @param row Row of the scaled image that will be read next.
+     * @return true if fDecoderMgr was replaced, in which case the caller must
+     *         set a new jump location for errors.
+     */
+    bool jumpToRow(uint32_t row);
+
+    /*
+     * Continues an incremental decode with the data that the stream has now.
+     * Returns kIncompleteInput if libjpeg suspends before the decode is done.
+     */
+    Result continueIncrementalDecode();
+
+    /*
+     * Reads the rest of the rows of the current output pass into fIncrementalDst.
+     * Returns false if libjpeg suspends first.
+     */
+    bool readIncrementalRows();
+
+    // Declared before fDecoderMgr, which may read from it.
+    SkAutoTDelete<SkStream>       fRegionStream;
     SkAutoTDelete<JpegDecoderMgr> fDecoderMgr;
     // We will save the state of the decompress struct after reading the header.
     // This allows us to safely call onGetScaledDimensions() at any time.
@@ -122,7 +187,53 @@ private:
     // to further subset the output from libjpeg-turbo.
     SkIRect                    fSwizzlerSubset;
     SkAutoTDelete<SkSwizzler>  fSwizzler;
-    
+
+    // Horizontal crop passed to libjpeg-turbo, so that it can be repeated by jumpToRow().
+    bool                       fCropped;
+    uint32_t                   fCropX;
+    uint32_t                   fCropWidth;
+
+    // Resampling to sizes that libjpeg-turbo cannot scale to directly
+    bool                       fResize;
+    int                        fResizeWidth;   // Width of the rows that are written
+    int                        fResizeHeight;  // Height of the full output
+    int                        fResizeBytesPerPixel;
+    SkAutoTMalloc<uint32_t>    fResizeX;    // Source column where each output column starts
+    SkAutoTMalloc<uint8_t>     fResizeRow;  // A row of the scaled image, in the output format
+    SkAutoTMalloc<float>       fResizeSums; // Per channel sums of the rows in the current box
+    SkAutoTMalloc<uint32_t>    fResize32;   // 565 rows expanded to 8888 for filtering
+
+    // Restart marker index for region decodes
+    enum RestartIndexState {
+        kUnknown_RestartIndexState,
+        kUnusable_RestartIndexState,
+        kUsable_RestartIndexState,
+    };
+    RestartIndexState          fRestartIndexState;
+    SkTDArray<uint32_t>        fRestartOffsets;    // Offset of the data after each marker
+    uint32_t                   fScanOffset;        // Offset of the entropy coded data
+    uint32_t                   fSOFHeightOffset;   // Offset of the height in the frame header
+    uint32_t                   fMCUsPerRow;
+    uint32_t                   fRestartInterval;   // In MCUs
+
+    // Set by jumpToRow().  fDecoderMgr is decoding fRegionStream, which begins at
+    // row fRowOffset of the scaled image.
+    uint32_t                   fRowOffset;
+
+    // Incremental decoding
+    enum IncrementalState {
+        kStartDecompress_IncrementalState,
+        kStartOutput_IncrementalState,      // Only in buffered image mode
+        kReadRows_IncrementalState,
+        kFinishOutput_IncrementalState,     // Only in buffered image mode
+    };
+    IncrementalState           fIncrementalState;
+    void*                      fIncrementalDst;
+    size_t                     fIncrementalRowBytes;
+    int                        fIncrementalRow;    // Next row of the current output pass
+    int                        fIncrementalRowsInitialized;
+    int                        fIncrementalScan;   // Scan of the last output pass, or 0
+
     typedef SkCodec INHERITED;
 };
 
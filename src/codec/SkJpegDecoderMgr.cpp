@@ -86,3 +86,7 @@ jmp_buf& JpegDecoderMgr::getJmpBuf() {
 jpeg_decompress_struct* JpegDecoderMgr::dinfo() {
     return &fDInfo;
 }
+
+skjpeg_source_mgr* JpegDecoderMgr::srcMgr() {
+    return &fSrcMgr;
+}
@@ -63,6 +63,11 @@ public:
      */
     jpeg_decompress_struct* dinfo();
 
+    /*
+     * Get function for the source manager
+     */
+    skjpeg_source_mgr* srcMgr();
+
 private:
 
     jpeg_decompress_struct fDInfo;
@@ -14,8 +14,53 @@
  */
 static void sk_init_source(j_decompress_ptr dinfo) {
     skjpeg_source_mgr* src = (skjpeg_source_mgr*) dinfo->src;
-    src->next_input_byte = (const JOCTET*) src->fBuffer;
+    src->next_input_byte = (const JOCTET*) src->fBuffer.get();
     src->bytes_in_buffer = 0;
+    src->fHasMoreData = false;
+    src->fBytesToSkip = 0;
+}
+
+/*
+ * Fill the input buffer from the stream, for a decoder that may suspend.
+ *
+ * When this is called, the bytes that libjpeg has not finished with are still in the buffer.
+ * If there are none, new data can simply replace them.  Otherwise libjpeg has read them into
+ * its own state, but will go back to them if it suspends before it finishes, so they must
+ * stay in front of any new data.  There is no way to tell libjpeg that the buffer moved, so we
+ * suspend instead, and the caller calls libjpeg again to resume from the start of the buffer.
+ */
+static boolean sk_fill_suspendable_input_buffer(skjpeg_source_mgr* src) {
+    if (src->fBytesToSkip > 0) {
+        src->fBytesToSkip -= src->fStream->skip(src->fBytesToSkip);
+        if (src->fBytesToSkip > 0) {
+            return false;
+        }
+    }
+
+    const size_t kept = src->bytes_in_buffer;
+    if (0 == kept) {
+        const size_t bytes = src->fStream->read(src->fBuffer.get(), src->fBufferCapacity);
+        if (0 == bytes) {
+            return false;
+        }
+        src->next_input_byte = (const JOCTET*) src->fBuffer.get();
+        src->bytes_in_buffer = bytes;
+        return true;
+    }
+
+    const size_t offset = src->next_input_byte - src->fBuffer.get();
+    if (kept + skjpeg_source_mgr::kBufferSize > src->fBufferCapacity) {
+        src->fBufferCapacity = SkTMax(2 * src->fBufferCapacity,
+                                      kept + skjpeg_source_mgr::kBufferSize);
+        src->fBuffer.realloc(src->fBufferCapacity);
+    }
+    memmove(src->fBuffer.get(), src->fBuffer.get() + offset, kept);
+    const size_t bytes = src->fStream->read(src->fBuffer.get() + kept,
+                                            src->fBufferCapacity - kept);
+    src->next_input_byte = (const JOCTET*) src->fBuffer.get();
+    src->bytes_in_buffer = kept + bytes;
+    src->fHasMoreData = bytes > 0;
+    return false;
 }
 
 /*
@@ -23,14 +68,18 @@ static void sk_init_source(j_decompress_ptr dinfo) {
  */
 static boolean sk_fill_input_buffer(j_decompress_ptr dinfo) {
     skjpeg_source_mgr* src = (skjpeg_source_mgr*) dinfo->src;
-    size_t bytes = src->fStream->read(src->fBuffer, skjpeg_source_mgr::kBufferSize);
+    if (src->fSuspendable) {
+        return sk_fill_suspendable_input_buffer(src);
+    }
+
+    size_t bytes = src->fStream->read(src->fBuffer.get(), skjpeg_source_mgr::kBufferSize);
 
     // libjpeg is still happy with a less than full read, as long as the result is non-zero
     if (bytes == 0) {
         return false;
     }
 
-    src->next_input_byte = (const JOCTET*) src->fBuffer;
+    src->next_input_byte = (const JOCTET*) src->fBuffer.get();
     src->bytes_in_buffer = bytes;
     return true;
 }
@@ -44,13 +93,19 @@ static void sk_skip_input_data(j_decompress_ptr dinfo, long numBytes) {
 
     if (bytes > src->bytes_in_buffer) {
         size_t bytesToSkip = bytes - src->bytes_in_buffer;
-        if (bytesToSkip != src->fStream->skip(bytesToSkip)) {
-            SkCodecPrintf("Failure to skip.\n");
-            dinfo->err->error_exit((j_common_ptr) dinfo);
-            return;
+        const size_t bytesSkipped = src->fStream->skip(bytesToSkip);
+        if (bytesToSkip != bytesSkipped) {
+            if (src->fSuspendable) {
+                // Skip the rest once the stream has it.
+                src->fBytesToSkip = bytesToSkip - bytesSkipped;
+            } else {
+                SkCodecPrintf("Failure to skip.\n");
+                dinfo->err->error_exit((j_common_ptr) dinfo);
+                return;
+            }
         }
 
-        src->next_input_byte = (const JOCTET*) src->fBuffer;
+        src->next_input_byte = (const JOCTET*) src->fBuffer.get();
         src->bytes_in_buffer = 0;
     } else {
         src->next_input_byte += numBytes;
@@ -75,6 +130,11 @@ static void sk_term_source(j_decompress_ptr dinfo)
  */
 skjpeg_source_mgr::skjpeg_source_mgr(SkStream* stream)
     : fStream(stream)
+    , fBuffer(kBufferSize)
+    , fBufferCapacity(kBufferSize)
+    , fSuspendable(false)
+    , fHasMoreData(false)
+    , fBytesToSkip(0)
 {
     init_source = sk_init_source;
     fill_input_buffer = sk_fill_input_buffer;
@@ -10,6 +10,7 @@
 #define SkJpegUtility_codec_DEFINED
 
 #include "SkStream.h"
+#include "SkTemplates.h"
 
 #include <setjmp.h>
 // stdio is needed for jpeglib
@@ -44,7 +45,20 @@ struct skjpeg_source_mgr : jpeg_source_mgr {
         // This size was chosen because it matches SkImageDecoder.
         kBufferSize = 1024
     };
-    uint8_t fBuffer[kBufferSize];
+    SkAutoTMalloc<uint8_t> fBuffer;
+    size_t fBufferCapacity;
+
+    // Set for incremental decodes, which call libjpeg again each time the stream receives more
+    // data.  When the stream runs dry, libjpeg suspends, and later resumes from the last point
+    // that it completed, so any bytes after that point are kept until they are read again.
+    bool fSuspendable;
+
+    // Set when libjpeg suspended even though the stream had more data for it.  Calling libjpeg
+    // again will make progress.
+    bool fHasMoreData;
+
+    // Bytes that libjpeg skipped before the stream received them.
+    size_t fBytesToSkip;
 };
 
 #endif
@@ -8,376 +8,7 @@
 #include "SkCodecPriv.h"
 #include "SkColorPriv.h"
 #include "SkMaskSwizzler.h"
-
-static void swizzle_mask16_to_rgba_opaque(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPackARGB_as_RGBA(0xFF, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask16_to_bgra_opaque(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPackARGB_as_BGRA(0xFF, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask16_to_rgba_unpremul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = SkPackARGB_as_RGBA(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask16_to_bgra_unpremul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = SkPackARGB_as_BGRA(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask16_to_rgba_premul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = premultiply_argb_as_rgba(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask16_to_bgra_premul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = premultiply_argb_as_bgra(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-// TODO (msarett): We have promoted a two byte per pixel image to 8888, only to
-// convert it back to 565. Instead, we should swizzle to 565 directly.
-static void swizzle_mask16_to_565(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint16_t* srcPtr = ((uint16_t*) srcRow) + startX;
-    uint16_t* dstPtr = (uint16_t*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint16_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPack888ToRGB16(red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask24_to_rgba_opaque(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPackARGB_as_RGBA(0xFF, red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask24_to_bgra_opaque(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPackARGB_as_BGRA(0xFF, red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask24_to_rgba_unpremul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = SkPackARGB_as_RGBA(alpha, red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask24_to_bgra_unpremul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = SkPackARGB_as_BGRA(alpha, red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask24_to_rgba_premul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = premultiply_argb_as_rgba(alpha, red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask24_to_bgra_premul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = premultiply_argb_as_bgra(alpha, red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask24_to_565(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    srcRow += 3 * startX;
-    uint16_t* dstPtr = (uint16_t*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcRow[0] | (srcRow[1] << 8) | srcRow[2] << 16;
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPack888ToRGB16(red, green, blue);
-        srcRow += 3 * sampleX;
-    }
-}
-
-static void swizzle_mask32_to_rgba_opaque(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPackARGB_as_RGBA(0xFF, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask32_to_bgra_opaque(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPackARGB_as_BGRA(0xFF, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask32_to_rgba_unpremul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = SkPackARGB_as_RGBA(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask32_to_bgra_unpremul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = SkPackARGB_as_BGRA(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask32_to_rgba_premul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = premultiply_argb_as_rgba(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask32_to_bgra_premul(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    SkPMColor* dstPtr = (SkPMColor*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        uint8_t alpha = masks->getAlpha(p);
-        dstPtr[i] = premultiply_argb_as_bgra(alpha, red, green, blue);
-        srcPtr += sampleX;
-    }
-}
-
-static void swizzle_mask32_to_565(
-        void* dstRow, const uint8_t* srcRow, int width, SkMasks* masks,
-        uint32_t startX, uint32_t sampleX) {
-    // Use the masks to decode to the destination
-    uint32_t* srcPtr = ((uint32_t*) srcRow) + startX;
-    uint16_t* dstPtr = (uint16_t*) dstRow;
-    for (int i = 0; i < width; i++) {
-        uint32_t p = srcPtr[0];
-        uint8_t red = masks->getRed(p);
-        uint8_t green = masks->getGreen(p);
-        uint8_t blue = masks->getBlue(p);
-        dstPtr[i] = SkPack888ToRGB16(red, green, blue);
-        srcPtr += sampleX;
-    }
-}
+#include "SkOpts.h"
 
 /*
  *
@@ -389,135 +20,39 @@ SkMaskSwizzler* SkMaskSwizzler::CreateMaskSwizzler(const SkImageInfo& dstInfo,
         const SkCodec::Options& options) {
 
     // Choose the appropriate row procedure
-    RowProc proc = nullptr;
-    switch (bitsPerPixel) {
-        case 16:
-            switch (dstInfo.colorType()) {
-                case kRGBA_8888_SkColorType:
-                    if (kOpaque_SkAlphaType == srcInfo.alphaType()) {
-                        proc = &swizzle_mask16_to_rgba_opaque;
-                    } else {
-                        switch (dstInfo.alphaType()) {
-                            case kUnpremul_SkAlphaType:
-                                proc = &swizzle_mask16_to_rgba_unpremul;
-                                break;
-                            case kPremul_SkAlphaType:
-                                proc = &swizzle_mask16_to_rgba_premul;
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
-                case kBGRA_8888_SkColorType:
-                    if (kOpaque_SkAlphaType == srcInfo.alphaType()) {
-                        proc = &swizzle_mask16_to_bgra_opaque;
-                    } else {
-                        switch (dstInfo.alphaType()) {
-                            case kUnpremul_SkAlphaType:
-                                proc = &swizzle_mask16_to_bgra_unpremul;
-                                break;
-                            case kPremul_SkAlphaType:
-                                proc = &swizzle_mask16_to_bgra_premul;
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
-                case kRGB_565_SkColorType:
-                    proc = &swizzle_mask16_to_565;
-                    break;
-                default:
-                    break;
-            }
+    SkOpts::Swizzle_masks proc = nullptr;
+    const bool opaque = kOpaque_SkAlphaType == srcInfo.alphaType();
+    const bool premul = !opaque && kPremul_SkAlphaType == dstInfo.alphaType();
+    switch (dstInfo.colorType()) {
+        case kRGBA_8888_SkColorType:
+            proc = premul ? SkOpts::masks_to_rgbA : SkOpts::masks_to_RGBA;
             break;
-        case 24:
-            switch (dstInfo.colorType()) {
-                case kRGBA_8888_SkColorType:
-                    if (kOpaque_SkAlphaType == srcInfo.alphaType()) {
-                        proc = &swizzle_mask24_to_rgba_opaque;
-                    } else {
-                        switch (dstInfo.alphaType()) {
-                            case kUnpremul_SkAlphaType:
-                                proc = &swizzle_mask24_to_rgba_unpremul;
-                                break;
-                            case kPremul_SkAlphaType:
-                                proc = &swizzle_mask24_to_rgba_premul;
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
-                case kBGRA_8888_SkColorType:
-                    if (kOpaque_SkAlphaType == srcInfo.alphaType()) {
-                        proc = &swizzle_mask24_to_bgra_opaque;
-                    } else {
-                        switch (dstInfo.alphaType()) {
-                            case kUnpremul_SkAlphaType:
-                                proc = &swizzle_mask24_to_bgra_unpremul;
-                                break;
-                            case kPremul_SkAlphaType:
-                                proc = &swizzle_mask24_to_bgra_premul;
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
-                case kRGB_565_SkColorType:
-                    proc = &swizzle_mask24_to_565;
-                    break;
-                default:
-                    break;
-            }
+        case kBGRA_8888_SkColorType:
+            proc = premul ? SkOpts::masks_to_bgrA : SkOpts::masks_to_BGRA;
             break;
-        case 32:
-            switch (dstInfo.colorType()) {
-                case kRGBA_8888_SkColorType:
-                    if (kOpaque_SkAlphaType == srcInfo.alphaType()) {
-                        proc = &swizzle_mask32_to_rgba_opaque;
-                    } else {
-                        switch (dstInfo.alphaType()) {
-                            case kUnpremul_SkAlphaType:
-                                proc = &swizzle_mask32_to_rgba_unpremul;
-                                break;
-                            case kPremul_SkAlphaType:
-                                proc = &swizzle_mask32_to_rgba_premul;
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
-                case kBGRA_8888_SkColorType:
-                    if (kOpaque_SkAlphaType == srcInfo.alphaType()) {
-                        proc = &swizzle_mask32_to_bgra_opaque;
-                    } else {
-                        switch (dstInfo.alphaType()) {
-                            case kUnpremul_SkAlphaType:
-                                proc = &swizzle_mask32_to_bgra_unpremul;
-                                break;
-                            case kPremul_SkAlphaType:
-                                proc = &swizzle_mask32_to_bgra_premul;
-                                break;
-                            default:
-                                break;
-                        }
-                    }
-                    break;
-                case kRGB_565_SkColorType:
-                    proc = &swizzle_mask32_to_565;
-                    break;
-                default:
-                    break;
-            }
+        case kRGB_565_SkColorType:
+            // swizzle() packs these into 565.
+            proc = SkOpts::masks_to_RGBA;
             break;
         default:
-            SkASSERT(false);
             return nullptr;
     }
+    if (16 != bitsPerPixel && 24 != bitsPerPixel && 32 != bitsPerPixel) {
+        SkASSERT(false);
+        return nullptr;
+    }
+
+    // An opaque source ignores its alpha mask.
+    SkOpts::BitMasks bitMasks;
+    const SkMasks::MaskInfo infos[4] = {
+        masks->getRedInfo(), masks->getGreenInfo(), masks->getBlueInfo(),
+        opaque ? SkMasks::MaskInfo{ 0, 0, 0 } : masks->getAlphaInfo(),
+    };
+    for (int c = 0; c < 4; c++) {
+        bitMasks.mask[c] = infos[c].mask;
+        bitMasks.shift[c] = infos[c].shift;
+        bitMasks.size[c] = infos[c].size;
+    }
 
     int srcOffset = 0;
     int srcWidth = dstInfo.width();
@@ -526,7 +61,8 @@ SkMaskSwizzler* SkMaskSwizzler::CreateMaskSwizzler(const SkImageInfo& dstInfo,
         srcWidth = options.fSubset->width();
     }
 
-    return new SkMaskSwizzler(masks, proc, srcOffset, srcWidth);
+    return new SkMaskSwizzler(bitMasks, bitsPerPixel / 8, proc,
+                              kRGB_565_SkColorType == dstInfo.colorType(), srcOffset, srcWidth);
 }
 
 /*
@@ -534,9 +70,13 @@ SkMaskSwizzler* SkMaskSwizzler::CreateMaskSwizzler(const SkImageInfo& dstInfo,
  * Constructor for mask swizzler
  *
  */
-SkMaskSwizzler::SkMaskSwizzler(SkMasks* masks, RowProc proc, int srcOffset, int subsetWidth)
+SkMaskSwizzler::SkMaskSwizzler(const SkOpts::BitMasks& masks, int bytesPerPixel,
+                               SkOpts::Swizzle_masks proc, bool to565, int srcOffset,
+                               int subsetWidth)
     : fMasks(masks)
+    , fBytesPerPixel(bytesPerPixel)
     , fRowProc(proc)
+    , fTo565(to565)
     , fSubsetWidth(subsetWidth)
     , fDstWidth(subsetWidth)
     , fSampleX(1)
@@ -564,5 +104,20 @@ int SkMaskSwizzler::onSetSampleX(int sampleX) {
  */
 void SkMaskSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
-    fRowProc(dst, src, fDstWidth, fMasks, fX0, fSampleX);
+    src += fX0 * fBytesPerPixel;
+    const int srcStep = fSampleX * fBytesPerPixel;
+    if (!fTo565) {
+        fRowProc((uint32_t*) dst, src, fDstWidth, fBytesPerPixel, srcStep, fMasks);
+        return;
+    }
+
+    // There is no alpha in 565, so go through 8888 in chunks that stay in cache.
+    uint16_t* dst16 = (uint16_t*) dst;
+    uint32_t rgba[64];
+    for (int x = 0; x < fDstWidth; x += SK_ARRAY_COUNT(rgba)) {
+        const int count = SkTMin(fDstWidth - x, (int) SK_ARRAY_COUNT(rgba));
+        fRowProc(rgba, src, count, fBytesPerPixel, srcStep, fMasks);
+        SkOpts::RGBA_to_565(dst16 + x, rgba, count);
+        src += count * srcStep;
+    }
 }
@@ -8,6 +8,7 @@
 #define SkMaskSwizzler_DEFINED
 
 #include "SkMasks.h"
+#include "SkOpts.h"
 #include "SkSampler.h"
 #include "SkSwizzler.h"
 #include "SkTypes.h"
@@ -47,18 +48,15 @@ public:
 
 private:
 
-    /*
-     * Row procedure used for swizzle
-     */
-    typedef void (*RowProc)(void* dstRow, const uint8_t* srcRow, int width,
-            SkMasks* masks, uint32_t startX, uint32_t sampleX);
-
-    SkMaskSwizzler(SkMasks* masks, RowProc proc, int subsetWidth, int srcOffset);
+    SkMaskSwizzler(const SkOpts::BitMasks& masks, int bytesPerPixel, SkOpts::Swizzle_masks proc,
+                   bool to565, int srcOffset, int subsetWidth);
 
     int onSetSampleX(int) override;
 
-    SkMasks*        fMasks;           // unowned
-    const RowProc   fRowProc;
+    const SkOpts::BitMasks      fMasks;
+    const int                   fBytesPerPixel;
+    const SkOpts::Swizzle_masks fRowProc;
+    const bool                  fTo565;       // fRowProc makes RGBA, for swizzle() to pack.
 
     // FIXME: Can this class share more with SkSwizzler? These variables are all the same.
     const int       fSubsetWidth;     // Width of the subset of source before any sampling.
@@ -67,6 +67,16 @@ public:
         return fAlpha.mask;
      }
 
+    /*
+     *
+     * Getters for the information about each mask, used by the optimized swizzlers
+     *
+     */
+    const MaskInfo& getRedInfo() const { return fRed; }
+    const MaskInfo& getGreenInfo() const { return fGreen; }
+    const MaskInfo& getBlueInfo() const { return fBlue; }
+    const MaskInfo& getAlphaInfo() const { return fAlpha; }
+
 private:
 
     /*
@@ -16,6 +16,7 @@
 #include "SkSize.h"
 #include "SkStream.h"
 #include "SkSwizzler.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 
@@ -383,6 +384,9 @@ public:
         , fRowBytes(0)
         , fFirstRow(0)
         , fLastRow(0)
+        , fBatchRowBytes(0)
+        , fBatchIndex(0)
+        , fBatchRows(0)
     {}
 
     static void AllRowsCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum, int /*pass*/) {
@@ -401,21 +405,55 @@ private:
     int                         fFirstRow;  // FIXME: Move to baseclass?
     int                         fLastRow;
 
+    // Variables for threaded decodes of all rows. libpng inflates and unfilters rows on this
+    // thread, and copies them into batches that are swizzled into fDst on other threads.
+    static constexpr int64_t    kMinPixelsForThreads = 512 * 512;
+    static constexpr int        kRowsPerBatch = 16;
+    static constexpr int        kBatchCount = 4;
+    size_t                      fBatchRowBytes;
+    SkAutoTMalloc<png_byte>     fBatchStorage;
+    int                         fBatchIndex;
+    int                         fBatchRows;
+    SkTaskGroup                 fBatchTasks[kBatchCount];
+
     typedef SkPngCodec INHERITED;
 
     static SkPngNormalDecoder* GetDecoder(png_structp png_ptr) {
         return static_cast<SkPngNormalDecoder*>(png_get_progressive_ptr(png_ptr));
     }
 
+    static void BatchedRowsCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum,
+                                    int /*pass*/) {
+        GetDecoder(png_ptr)->batchedRowsCallback(row, rowNum);
+    }
+
     Result decodeAllRows(void* dst, size_t rowBytes, int* rowsDecoded) override {
         const int height = this->getInfo().height();
-        png_set_progressive_read_fn(this->png_ptr(), this, nullptr, AllRowsCallback, nullptr);
         fDst = dst;
         fRowBytes = rowBytes;
 
         fLinesDecoded = 0;
 
-        this->processData();
+        // Handing rows to other threads only pays off when there are plenty of them.
+        if (sk_64_mul(this->getInfo().width(), height) >= kMinPixelsForThreads) {
+            png_set_progressive_read_fn(this->png_ptr(), this, nullptr, BatchedRowsCallback,
+                                        nullptr);
+            fBatchRowBytes = png_get_rowbytes(this->png_ptr(), this->info_ptr());
+            fBatchStorage.reset(fBatchRowBytes * kRowsPerBatch * kBatchCount);
+            fBatchIndex = 0;
+            fBatchRows = 0;
+
+            this->processData();
+
+            // Swizzle whatever was decoded, even if the input was incomplete.
+            this->flushBatch();
+            for (SkTaskGroup& tasks : fBatchTasks) {
+                tasks.wait();
+            }
+        } else {
+            png_set_progressive_read_fn(this->png_ptr(), this, nullptr, AllRowsCallback, nullptr);
+            this->processData();
+        }
 
         if (fLinesDecoded == height) {
             return SkCodec::kSuccess;
@@ -435,6 +473,47 @@ private:
         fDst = SkTAddOffset<void>(fDst, fRowBytes);
     }
 
+    void batchedRowsCallback(png_bytep row, int rowNum) {
+        SkASSERT(rowNum == fLinesDecoded);
+        if (0 == fBatchRows) {
+            // The batch may still be in use from the last time around.
+            fBatchTasks[fBatchIndex].wait();
+        }
+        png_bytep batchRow = fBatchStorage.get()
+                + (fBatchIndex * kRowsPerBatch + fBatchRows) * fBatchRowBytes;
+        memcpy(batchRow, row, fBatchRowBytes);
+        fLinesDecoded++;
+        if (kRowsPerBatch == ++fBatchRows) {
+            this->flushBatch();
+        }
+    }
+
+    void flushBatch() {
+        if (0 == fBatchRows) {
+            return;
+        }
+
+        SkSwizzler* swizzler = this->swizzler();
+        const png_byte* src = fBatchStorage.get() + fBatchIndex * kRowsPerBatch * fBatchRowBytes;
+        const size_t srcRowBytes = fBatchRowBytes;
+        void* dst = fDst;
+        const size_t dstRowBytes = fRowBytes;
+        const int count = fBatchRows;
+        fBatchTasks[fBatchIndex].add([=] {
+            void* dstRow = dst;
+            const png_byte* srcRow = src;
+            for (int i = 0; i < count; i++) {
+                swizzler->swizzle(dstRow, srcRow);
+                dstRow = SkTAddOffset<void>(dstRow, dstRowBytes);
+                srcRow += srcRowBytes;
+            }
+        });
+
+        fDst = SkTAddOffset<void>(fDst, count * fRowBytes);
+        fBatchRows = 0;
+        fBatchIndex = (fBatchIndex + 1) % kBatchCount;
+    }
+
     void setRange(int firstRow, int lastRow, void* dst, size_t rowBytes) override {
         png_set_progressive_read_fn(this->png_ptr(), this, nullptr, RowCallback, nullptr);
         fFirstRow = firstRow;
@@ -491,8 +570,12 @@ public:
         , fFirstRow(0)
         , fLastRow(0)
         , fLinesDecoded(0)
+        , fFirstDirtyRow(0)
+        , fLastDirtyRow(-1)
         , fInterlacedComplete(false)
         , fPng_rowbytes(0)
+        , fCombinedRows(nullptr)
+        , fCombinedRowBytes(0)
     {}
 
     static void InterlacedRowCallback(png_structp png_ptr, png_bytep row, png_uint_32 rowNum, int pass) {
@@ -507,12 +590,22 @@ private:
     void*                   fDst;
     size_t                  fRowBytes;
     int                     fLinesDecoded;
+    // Rows of the interlace buffer that libpng has written to since the last call to decode().
+    int                     fFirstDirtyRow;
+    int                     fLastDirtyRow;
     bool                    fInterlacedComplete;
     size_t                  fPng_rowbytes;
     SkAutoTMalloc<png_byte> fInterlaceBuffer;
 
+    // Where passes are combined: either fInterlaceBuffer, or the destination itself when
+    // libpng produces pixels in the destination's format.
+    png_bytep               fCombinedRows;
+    size_t                  fCombinedRowBytes;
+
     typedef SkPngCodec INHERITED;
 
+    bool allowsDirectDecode() const override { return true; }
+
     // FIXME: Currently sharing interlaced callback for all rows and subset. It's not
     // as expensive as the subset version of non-interlaced, but it still does extra
     // work.
@@ -522,8 +615,10 @@ private:
             return;
         }
 
-        png_bytep oldRow = fInterlaceBuffer.get() + (rowNum - fFirstRow) * fPng_rowbytes;
+        png_bytep oldRow = fCombinedRows + (rowNum - fFirstRow) * fCombinedRowBytes;
         png_progressive_combine_row(this->png_ptr(), oldRow, row);
+        fFirstDirtyRow = SkTMin(fFirstDirtyRow, rowNum - fFirstRow);
+        fLastDirtyRow = SkTMax(fLastDirtyRow, rowNum - fFirstRow);
 
         if (0 == pass) {
             // The first pass initializes all rows.
@@ -545,7 +640,16 @@ private:
 
     SkCodec::Result decodeAllRows(void* dst, size_t rowBytes, int* rowsDecoded) override {
         const int height = this->getInfo().height();
-        this->setUpInterlaceBuffer(height);
+        if (this->swizzler()) {
+            this->setUpInterlaceBuffer(height);
+        } else {
+            // Each pass is combined straight into dst. Since libpng repeats the rows of the
+            // first pass to fill the rows below them, dst holds a blocky preview of the whole
+            // image as soon as the first pass is done.
+            fInterlacedComplete = false;
+            fCombinedRows = static_cast<png_bytep>(dst);
+            fCombinedRowBytes = rowBytes;
+        }
         png_set_progressive_read_fn(this->png_ptr(), this, nullptr, InterlacedRowCallback, nullptr);
 
         fFirstRow = 0;
@@ -554,12 +658,8 @@ private:
 
         this->processData();
 
-        png_bytep srcRow = fInterlaceBuffer.get();
-        // FIXME: When resuming, this may rewrite rows that did not change.
-        for (int rowNum = 0; rowNum < fLinesDecoded; rowNum++) {
-            this->swizzler()->swizzle(dst, srcRow);
-            dst = SkTAddOffset<void>(dst, rowBytes);
-            srcRow = SkTAddOffset<png_byte>(srcRow, fPng_rowbytes);
+        if (this->swizzler()) {
+            this->swizzleRows(dst, rowBytes, fInterlaceBuffer.get(), fPng_rowbytes, fLinesDecoded);
         }
         if (fInterlacedComplete) {
             return SkCodec::kSuccess;
@@ -584,24 +684,25 @@ private:
     }
 
     SkCodec::Result decode(int* rowsDecoded) override {
+        fFirstDirtyRow = fLastRow - fFirstRow + 1;
+        fLastDirtyRow = -1;
         this->processData();
 
         // Now call the callback on all the rows that were decoded.
         if (!fLinesDecoded) {
             return SkCodec::kIncompleteInput;
         }
-        const int lastRow = fLinesDecoded + fFirstRow - 1;
-        SkASSERT(lastRow <= fLastRow);
+        SkASSERT(fLinesDecoded + fFirstRow - 1 <= fLastRow);
 
-        // FIXME: For resuming interlace, we may swizzle a row that hasn't changed. But it
-        // may be too tricky/expensive to handle that correctly.
-        png_bytep srcRow = fInterlaceBuffer.get();
+        // When resuming, only swizzle the rows that libpng changed, so that the work done
+        // by each call depends on the new data, rather than on all the data so far.
         const int sampleY = this->swizzler()->sampleY();
-        void* dst = fDst;
-        for (int rowNum = fFirstRow; rowNum <= lastRow; rowNum += sampleY) {
-            this->swizzler()->swizzle(dst, srcRow);
-            dst = SkTAddOffset<void>(dst, fRowBytes);
-            srcRow = SkTAddOffset<png_byte>(srcRow, fPng_rowbytes * sampleY);
+        const int firstDstRow = (fFirstDirtyRow + sampleY - 1) / sampleY;
+        const int lastDstRow = fLastDirtyRow / sampleY;
+        if (firstDstRow <= lastDstRow) {
+            this->swizzleRows(SkTAddOffset<void>(fDst, firstDstRow * fRowBytes), fRowBytes,
+                              fInterlaceBuffer.get() + firstDstRow * sampleY * fPng_rowbytes,
+                              fPng_rowbytes * sampleY, lastDstRow - firstDstRow + 1);
         }
 
         if (fInterlacedComplete) {
@@ -618,6 +719,24 @@ private:
         fPng_rowbytes = png_get_rowbytes(this->png_ptr(), this->info_ptr());
         fInterlaceBuffer.reset(fPng_rowbytes * height);
         fInterlacedComplete = false;
+        fCombinedRows = fInterlaceBuffer.get();
+        fCombinedRowBytes = fPng_rowbytes;
+    }
+
+    // Swizzles count rows, srcRowBytes apart, from src in fInterlaceBuffer into dst.
+    // The rows are independent, so bands of them are swizzled on separate threads.
+    void swizzleRows(void* dst, size_t dstRowBytes, const png_byte* src, size_t srcRowBytes,
+                     int count) {
+        constexpr int kRowsPerBand = 32;
+        SkSwizzler* swizzler = this->swizzler();
+        SkTaskGroup().batch((count + kRowsPerBand - 1) / kRowsPerBand, [=](int band) {
+            const int firstRow = band * kRowsPerBand;
+            const int endRow = SkTMin(firstRow + kRowsPerBand, count);
+            for (int row = firstRow; row < endRow; row++) {
+                swizzler->swizzle(SkTAddOffset<void>(dst, row * dstRowBytes),
+                                  src + row * srcRowBytes);
+            }
+        });
     }
 };
 
@@ -825,13 +944,52 @@ void SkPngCodec::destroyReadStruct() {
 // Getting the pixels
 ///////////////////////////////////////////////////////////////////////////////
 
+// If libpng can produce rows in dstInfo's format by itself, sets the transforms that it needs
+// (which must happen before png_read_update_info) and returns true.
+static bool set_direct_transforms(png_structp png_ptr, const SkEncodedInfo& encodedInfo,
+                                  const SkImageInfo& dstInfo) {
+    switch (dstInfo.colorType()) {
+        case kGray_8_SkColorType:
+            return SkEncodedInfo::kGray_Color == encodedInfo.color();
+        case kRGBA_8888_SkColorType:
+        case kBGRA_8888_SkColorType:
+            break;
+        default:
+            return false;
+    }
+
+    switch (encodedInfo.color()) {
+        case SkEncodedInfo::kRGB_Color:
+            png_set_filler(png_ptr, 0xFF, PNG_FILLER_AFTER);
+            break;
+        case SkEncodedInfo::kRGBA_Color:
+            // Premultiplying is left to the swizzler.
+            if (kUnpremul_SkAlphaType != dstInfo.alphaType()) {
+                return false;
+            }
+            break;
+        default:
+            return false;
+    }
+    if (kBGRA_8888_SkColorType == dstInfo.colorType()) {
+        png_set_bgr(png_ptr);
+    }
+    return true;
+}
+
 bool SkPngCodec::initializeSwizzler(const SkImageInfo& requestedInfo,
                                     const Options& options,
                                     SkPMColor ctable[],
-                                    int* ctableCount) {
+                                    int* ctableCount,
+                                    bool allowDirect) {
     if (setjmp(png_jmpbuf(fPng_ptr))) {
         return false;
     }
+    if (allowDirect && set_direct_transforms(fPng_ptr, this->getEncodedInfo(), requestedInfo)) {
+        png_read_update_info(fPng_ptr, fInfo_ptr);
+        fSwizzler.reset(nullptr);
+        return true;
+    }
     png_read_update_info(fPng_ptr, fInfo_ptr);
 
     if (SkEncodedInfo::kPalette_Color == this->getEncodedInfo().color()) {
@@ -886,7 +1044,8 @@ SkCodec::Result SkPngCodec::onGetPixels(const SkImageInfo& requestedInfo, void*
     }
 
     // Note that ctable and ctableCount may be modified if there is a color table
-    if (!this->initializeSwizzler(requestedInfo, options, ctable, ctableCount)) {
+    if (!this->initializeSwizzler(requestedInfo, options, ctable, ctableCount,
+                                  this->allowsDirectDecode())) {
         return kInvalidInput;   // or parameters?
     }
 
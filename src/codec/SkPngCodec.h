@@ -38,10 +38,13 @@ protected:
     uint32_t onGetFillValue(SkColorType) const override;
 
     // Helper to set up swizzler and color table. Also calls png_read_update_info.
+    // If allowDirect is true and libpng can output requestedInfo's format itself, it is told
+    // to, and no swizzler is created.
     bool initializeSwizzler(const SkImageInfo& requestedInfo, const Options&,
-                            SkPMColor*, int* ctableCount);
+                            SkPMColor*, int* ctableCount, bool allowDirect = false);
     SkSampler* getSampler(bool createIfNecessary) override {
-        SkASSERT(fSwizzler);
+        // There is no swizzler after a direct decode, but then nothing needs to be sampled.
+        SkASSERT(fSwizzler || !createIfNecessary);
         return fSwizzler;
     }
 
@@ -75,6 +78,9 @@ private:
     bool createColorTable(SkColorType dstColorType, bool premultiply, int* ctableCount);
     void destroyReadStruct();
 
+    // Whether decodeAllRows can handle a null swizzler, i.e. rows that libpng has already
+    // converted to the destination's format.
+    virtual bool allowsDirectDecode() const { return false; }
     virtual Result decodeAllRows(void* dst, size_t rowBytes, int* rowsDecoded) = 0;
     virtual void setRange(int firstRow, int lastRow, void* dst, size_t rowBytes) = 0;
     virtual Result decode(int* rowsDecoded) = 0;
@@ -39,25 +39,21 @@ SkISize SkSampledCodec::accountForNativeScaling(int* sampleSizePtr, int* nativeS
                 break;
         }
 
-        // Check if sampleSize is a multiple of something libjpeg can support.
-        int remainder;
-        const int sampleSizes[] = { 8, 4, 2 };
-        for (int supportedSampleSize : sampleSizes) {
-            int actualSampleSize;
-            SkTDivMod(sampleSize, supportedSampleSize, &actualSampleSize, &remainder);
-            if (0 == remainder) {
-                float scale = get_scale_from_sample_size(supportedSampleSize);
-
-                // this->codec() will scale to this size.
-                preSampledSize = this->codec()->getScaledDimensions(scale);
-
-                // And then this class will sample it.
-                *sampleSizePtr = actualSampleSize;
-                if (nativeSampleSize) {
-                    *nativeSampleSize = supportedSampleSize;
-                }
-                break;
+        // Otherwise libjpeg decodes at the nearest scale of M/8 that is at least 1/sampleSize,
+        // and this->codec() box filters that down the rest of the way.
+        const int num = (8 + sampleSize - 1) / sampleSize;
+        const SkISize nativeSize = this->codec()->getScaledDimensions(num / 8.0f);
+        const SkISize sampledSize = SkISize::Make(
+                get_scaled_dimension(preSampledSize.width(), sampleSize),
+                get_scaled_dimension(preSampledSize.height(), sampleSize));
+        if (nativeSize.width() >= sampledSize.width() &&
+                nativeSize.height() >= sampledSize.height()) {
+            // This class does not need to do any sampling.
+            *sampleSizePtr = 1;
+            if (nativeSampleSize) {
+                *nativeSampleSize = sampleSize;
             }
+            return sampledSize;
         }
     }
 
@@ -50,6 +50,38 @@ static void sample4(void* dst, const uint8_t* src, int width, int bpp, int delta
     }
 }
 
+// Formats that SkOpts can't take straight to 565 are swizzled to 8888 in chunks small enough to
+// stay in cache, and then packed.
+static constexpr int kChunkPixels = 64;
+
+template <SkOpts::Swizzle_8888* kTo8888, SkOpts::Swizzle_565* kTo565>
+static void fast_swizzle_via_8888_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    src += offset;
+    uint16_t* dst16 = (uint16_t*) dst;
+    uint32_t rgba[kChunkPixels];
+    while (width > 0) {
+        const int count = SkTMin(width, kChunkPixels);
+        (*kTo8888)(rgba, src, count);
+        (*kTo565)(dst16, rgba, count);
+        src += count * bpp;
+        dst16 += count;
+        width -= count;
+    }
+}
+
+#if SK_PMCOLOR_BYTE_ORDER(B,G,R,A)
+    static SkOpts::Swizzle_565* const kPMColorTo565 = &SkOpts::BGRA_to_565;
+#else
+    static SkOpts::Swizzle_565* const kPMColorTo565 = &SkOpts::RGBA_to_565;
+#endif
+
 // kBit
 // These routines exclusively choose between white and black
 
@@ -256,6 +288,30 @@ static void swizzle_index_to_565(
     }
 }
 
+static void fast_swizzle_index_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    // There is no gather before AVX2, so the lookups stay scalar, but the packing need not.
+    src += offset;
+    uint16_t* dst16 = (uint16_t*) dst;
+    SkPMColor colors[kChunkPixels];
+    while (width > 0) {
+        const int count = SkTMin(width, kChunkPixels);
+        for (int x = 0; x < count; x++) {
+            colors[x] = ctable[src[x]];
+        }
+        (*kPMColorTo565)(dst16, colors, count);
+        src += count;
+        dst16 += count;
+        width -= count;
+    }
+}
+
 // kGray
 
 static void swizzle_gray_to_n32(
@@ -362,6 +418,48 @@ static void swizzle_bgr_to_565(
     }
 }
 
+// kBGRX
+
+// The fourth byte is ignored, so these are bit masks with no alpha.
+static const SkOpts::BitMasks kBGRXMasks = {
+    { 0xFF0000, 0xFF00, 0xFF, 0 },
+    { 16, 8, 0, 0 },
+    { 8, 8, 8, 0 },
+};
+
+static void fast_swizzle_bgrx_to_rgba(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::masks_to_RGBA((uint32_t*) dst, src + offset, width, 4, 4, kBGRXMasks);
+}
+
+static void fast_swizzle_bgrx_to_bgra(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::masks_to_BGRA((uint32_t*) dst, src + offset, width, 4, 4, kBGRXMasks);
+}
+
+static void fast_swizzle_bgrx_to_565(
+        void* dst, const uint8_t* src, int width, int bpp, int deltaSrc, int offset,
+        const SkPMColor ctable[]) {
+
+    // This function must not be called if we are sampling.  If we are not
+    // sampling, deltaSrc should equal bpp.
+    SkASSERT(deltaSrc == bpp);
+
+    SkOpts::BGRA_to_565((uint16_t*) dst, (const uint32_t*) (src + offset), width);
+}
+
 // kRGB
 
 static void swizzle_rgb_to_rgba(
@@ -717,6 +815,8 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_gray_to_565;
+                                fastProc = &fast_swizzle_via_8888_to_565<&SkOpts::gray_to_RGB1,
+                                                                         &SkOpts::RGBA_to_565>;
                                 break;
                             default:
                                 return nullptr;
@@ -790,6 +890,7 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                                 break;
                             case kRGB_565_SkColorType:
                                 proc = &swizzle_index_to_565;
+                                fastProc = &fast_swizzle_index_to_565;
                                 break;
                             case kIndex_8_SkColorType:
                                 proc = &sample1;
@@ -815,6 +916,8 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_rgb_to_565;
+                        fastProc = &fast_swizzle_via_8888_to_565<&SkOpts::RGB_to_RGB1,
+                                                                 &SkOpts::RGBA_to_565>;
                         break;
                     default:
                         return nullptr;
@@ -879,6 +982,8 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_bgr_to_565;
+                        fastProc = &fast_swizzle_via_8888_to_565<&SkOpts::RGB_to_RGB1,
+                                                                 &SkOpts::BGRA_to_565>;
                         break;
                     default:
                         return nullptr;
@@ -888,12 +993,15 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                 switch (dstInfo.colorType()) {
                     case kBGRA_8888_SkColorType:
                         proc = &swizzle_rgb_to_rgba;
+                        fastProc = &fast_swizzle_bgrx_to_bgra;
                         break;
                     case kRGBA_8888_SkColorType:
                         proc = &swizzle_rgb_to_bgra;
+                        fastProc = &fast_swizzle_bgrx_to_rgba;
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_bgr_to_565;
+                        fastProc = &fast_swizzle_bgrx_to_565;
                         break;
                     default:
                         return nullptr;
@@ -958,6 +1066,8 @@ SkSwizzler* SkSwizzler::CreateSwizzler(const SkEncodedInfo& encodedInfo,
                         break;
                     case kRGB_565_SkColorType:
                         proc = &swizzle_cmyk_to_565;
+                        fastProc = &fast_swizzle_via_8888_to_565<&SkOpts::inverted_CMYK_to_RGB1,
+                                                                 &SkOpts::RGBA_to_565>;
                         break;
                     default:
                         return nullptr;
@@ -1015,6 +1125,7 @@ SkSwizzler::SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable,
     , fSampleX(1)
     , fSrcBPP(srcBPP)
     , fDstBPP(dstBPP)
+    , fGatherSamples(false)
 {}
 
 int SkSwizzler::onSetSampleX(int sampleX) {
@@ -1027,12 +1138,17 @@ int SkSwizzler::onSetSampleX(int sampleX) {
     fAllocatedWidth = get_scaled_dimension(fDstWidth, sampleX);
 
     // The optimized swizzler functions do not support sampling.  Sampled swizzles
-    // are already fast because they skip pixels.  We haven't seen a situation
-    // where speeding up sampling has a significant impact on total decode time.
+    // are already fast because they skip pixels.  But four byte pixels (rgba, cmyk,
+    // bgrx) take enough work to convert that swizzle() gathers the sampled pixels into
+    // chunks for the optimized functions.  Narrower pixels cost about as much to gather
+    // as to convert, and a plain copy gains nothing, so those use the sampling functions.
+    fGatherSamples = false;
     if (1 == fSampleX && fFastProc) {
         fActualProc = fFastProc;
     } else {
         fActualProc = fSlowProc;
+        fGatherSamples = fFastProc && 4 == fSrcBPP && &copy != fFastProc &&
+                         &SkipLeading8888ZerosThen<copy> != fFastProc;
     }
 
     return fAllocatedWidth;
@@ -1040,6 +1156,22 @@ int SkSwizzler::onSetSampleX(int sampleX) {
 
 void SkSwizzler::swizzle(void* dst, const uint8_t* SK_RESTRICT src) {
     SkASSERT(nullptr != dst && nullptr != src);
+    if (fGatherSamples) {
+        uint8_t* dstPixels = SkTAddOffset<uint8_t>(dst, fDstOffsetBytes);
+        src += fSrcOffsetUnits;
+        const int deltaSrc = fSampleX * fSrcBPP;
+        uint32_t gathered[kChunkPixels];
+        for (int x = 0; x < fSwizzleWidth; x += kChunkPixels) {
+            const int count = SkTMin(fSwizzleWidth - x, kChunkPixels);
+            for (int i = 0; i < count; i++) {
+                memcpy(&gathered[i], src, 4);
+                src += deltaSrc;
+            }
+            fFastProc(dstPixels, (const uint8_t*) gathered, count, 4, 4, 0, fColorTable);
+            dstPixels += count * fDstBPP;
+        }
+        return;
+    }
     fActualProc(SkTAddOffset<void>(dst, fDstOffsetBytes), src, fSwizzleWidth, fSrcBPP,
             fSampleX * fSrcBPP, fSrcOffsetUnits, fColorTable);
 }
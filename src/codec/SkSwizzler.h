@@ -194,6 +194,8 @@ private:
                                           // else
                                           //     fBPP is bitsPerPixel
     const int           fDstBPP;          // Bytes per pixel for the destination color type
+    bool                fGatherSamples;   // Whether swizzle() gathers sampled pixels for
+                                          // fFastProc
 
     SkSwizzler(RowProc fastProc, RowProc proc, const SkPMColor* ctable, int srcOffset,
             int srcWidth, int dstOffset, int dstWidth, int srcBPP, int dstBPP);
@@ -141,6 +141,22 @@ SkCodec::Result SkWbmpCodec::onGetPixels(const SkImageInfo& info,
 
     // Perform the decode
     SkISize size = info.dimensions();
+    if (sk_64_mul(size.width(), size.height()) >= kMinPixelsForRowBands) {
+        // Every row is the same size, so large images are swizzled in bands on other threads.
+        SkSwizzler* bandSwizzler = swizzler.get();
+        const int rows = decode_rows_in_bands(this->stream(), fSrcRowBytes, size.height(),
+                                              [=](int y, const uint8_t* src) {
+            bandSwizzler->swizzle(SkTAddOffset<void>(dst, y * rowBytes), src);
+        });
+        if (rows >= 0) {
+            if (rows < size.height()) {
+                *rowsDecoded = rows;
+                return kIncompleteInput;
+            }
+            return kSuccess;
+        }
+    }
+
     SkAutoTMalloc<uint8_t> src(fSrcRowBytes);
     void* dstRow = dst;
     for (int y = 0; y < size.height(); ++y) {
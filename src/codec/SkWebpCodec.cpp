@@ -6,6 +6,8 @@
  */
 
 #include "SkCodecPriv.h"
+#include "SkSampler.h"
+#include "SkStreamPriv.h"
 #include "SkWebpCodec.h"
 #include "SkTemplates.h"
 
@@ -18,6 +20,7 @@
 // If moving libwebp out of skia source tree, path for webp headers must be
 // updated accordingly. Here, we enforce using local copy in webp sub-directory.
 #include "webp/decode.h"
+#include "webp/demux.h"
 #include "webp/encode.h"
 
 bool SkWebpCodec::IsWebp(const void* buf, size_t bytesRead) {
@@ -101,7 +104,8 @@ SkCodec* SkWebpCodec::NewFromStream(SkStream* stream) {
     }
 
     SkEncodedInfo info = SkEncodedInfo::Make(color, alpha, 8);
-    return new SkWebpCodec(features.width, features.height, info, streamDeleter.release());
+    return new SkWebpCodec(features.width, features.height, info, streamDeleter.release(),
+            SkToBool(features.has_animation));
 }
 
 // This version is slightly different from SkCodecPriv's version of conversion_possible. It
@@ -187,6 +191,11 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
         return kInvalidConversion;
     }
 
+    if (fIsAnimated) {
+        // Even the first frame of an animation is only available through the demuxer.
+        return this->decodeFrame(dstInfo, dst, rowBytes, options, rowsDecoded);
+    }
+
     WebPDecoderConfig config;
     if (0 == WebPInitDecoderConfig(&config)) {
         // ABI mismatch.
@@ -274,7 +283,206 @@ SkCodec::Result SkWebpCodec::onGetPixels(const SkImageInfo& dstInfo, void* dst,
     }
 }
 
-SkWebpCodec::SkWebpCodec(int width, int height, const SkEncodedInfo& info, SkStream* stream)
+void SkWebpCodec::scanFrames() {
+    if (fScannedFrames) {
+        return;
+    }
+    fScannedFrames = true;
+
+    // Our copy of the data replaces the stream, so there is no need to rewind again.
+    if (!this->rewindIfNeeded() || !this->stream()->rewind()) {
+        return;
+    }
+    fData = SkCopyStreamToData(this->stream());
+
+    WebPData webpData = { fData->bytes(), fData->size() };
+    SkAutoTCallVProc<WebPDemuxer, WebPDemuxDelete> demux(WebPDemux(&webpData));
+    if (!demux) {
+        return;
+    }
+
+    const SkIRect canvas = SkIRect::MakeSize(this->getInfo().dimensions());
+    const int frameCount = WebPDemuxGetI(demux, WEBP_FF_FRAME_COUNT);
+    for (int i = 0; i < frameCount; i++) {
+        WebPIterator iter;
+        SkAutoTCallVProc<WebPIterator, WebPDemuxReleaseIterator> autoIter(&iter);
+        // libwebp numbers frames from 1.
+        if (!WebPDemuxGetFrame(demux, i + 1, &iter)) {
+            break;
+        }
+
+        FrameInfo frame;
+        frame.fFrameRect.setXYWH(iter.x_offset, iter.y_offset, iter.width, iter.height);
+        if (!canvas.contains(frame.fFrameRect)) {
+            break;
+        }
+        frame.fDuration = iter.duration;
+        frame.fDisposalMethod = WEBP_MUX_DISPOSE_BACKGROUND == iter.dispose_method ?
+                kRestoreBGColor_DisposalMethod : kKeep_DisposalMethod;
+
+        const bool blend = iter.has_alpha && WEBP_MUX_BLEND == iter.blend_method;
+        const bool replacesCanvas = frame.fFrameRect == canvas && !blend;
+        frame.fRequiredFrame = compute_required_frame(fFrames.begin(), fFrames.count(),
+                replacesCanvas, canvas.size());
+        fFrames.push_back(frame);
+        *fFrameBlends.append() = blend;
+    }
+}
+
+int SkWebpCodec::onGetFrameCount() {
+    if (!fIsAnimated) {
+        return 1;
+    }
+    this->scanFrames();
+    return fFrames.count();
+}
+
+bool SkWebpCodec::onGetFrameInfo(int index, FrameInfo* info) {
+    if (!fIsAnimated) {
+        return INHERITED::onGetFrameInfo(index, info);
+    }
+    this->scanFrames();
+    if (index >= fFrames.count()) {
+        return false;
+    }
+    *info = fFrames[index];
+    return true;
+}
+
+/*
+ * Draws src over dst.  Both are kN32 and have the same alpha type.
+ */
+static void blend_row(uint32_t* dst, const uint32_t* src, int width, bool premul) {
+    for (int x = 0; x < width; x++) {
+        const U8CPU srcA = SkGetPackedA32(src[x]);
+        if (0xFF == srcA) {
+            dst[x] = src[x];
+            continue;
+        }
+        if (0 == srcA) {
+            continue;
+        }
+        if (premul) {
+            dst[x] = SkPMSrcOver(src[x], dst[x]);
+            continue;
+        }
+
+        // Blend the unpremultiplied colors, weighting each by its contribution.
+        const U8CPU dstA = SkMulDiv255Round(SkGetPackedA32(dst[x]), 255 - srcA);
+        const U8CPU a = srcA + dstA;
+        const auto blend = [=](U8CPU s, U8CPU d) { return (s * srcA + d * dstA + a / 2) / a; };
+        dst[x] = SkPackARGB32NoCheck(a,
+                blend(SkGetPackedR32(src[x]), SkGetPackedR32(dst[x])),
+                blend(SkGetPackedG32(src[x]), SkGetPackedG32(dst[x])),
+                blend(SkGetPackedB32(src[x]), SkGetPackedB32(dst[x])));
+    }
+}
+
+SkCodec::Result SkWebpCodec::decodeFrame(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                         const Options& options, int* rowsDecoded) {
+    // Frames are composited onto the whole canvas.
+    if (options.fSubset || dstInfo.dimensions() != this->getInfo().dimensions()) {
+        return kUnimplemented;
+    }
+    if (kN32_SkColorType != dstInfo.colorType()) {
+        return kInvalidConversion;
+    }
+
+    this->scanFrames();
+    const int index = options.fFrameIndex;
+    if (!fData || index >= fFrames.count()) {
+        return kInvalidInput;
+    }
+    // The frames to draw, from index back to the nearest frame that does not depend on
+    // another one, unless we were given the frame index depends on.
+    SkTDArray<int> frames;
+    *frames.append() = index;
+    if (!options.fHasPriorFrame) {
+        while (kNone != fFrames[frames.top()].fRequiredFrame) {
+            *frames.append() = fFrames[frames.top()].fRequiredFrame;
+        }
+    }
+
+    // From here on, failures leave the composited frame as is, rather than letting
+    // SkCodec fill over it.
+    *rowsDecoded = dstInfo.height();
+
+    WebPData webpData = { fData->bytes(), fData->size() };
+    SkAutoTCallVProc<WebPDemuxer, WebPDemuxDelete> demux(WebPDemux(&webpData));
+    if (!demux) {
+        return kInvalidInput;
+    }
+    Result result = kSuccess;
+    for (int i = frames.count() - 1; i >= 0; i--) {
+        WebPIterator iter;
+        SkAutoTCallVProc<WebPIterator, WebPDemuxReleaseIterator> autoIter(&iter);
+        if (!WebPDemuxGetFrame(demux, frames[i] + 1, &iter)) {
+            return kInvalidInput;
+        }
+        result = this->drawFrame(frames[i], iter.fragment.bytes, iter.fragment.size, dstInfo,
+                dst, rowBytes, options);
+        // A frame that is only partly decoded is still drawn on.
+        if (kSuccess != result && kIncompleteInput != result) {
+            return result;
+        }
+    }
+    return result;
+}
+
+SkCodec::Result SkWebpCodec::drawFrame(int index, const uint8_t* fragment, size_t fragmentSize,
+                                       const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+                                       const Options& options) {
+    const FrameInfo& info = fFrames[index];
+    const SkIRect& frameRect = info.fFrameRect;
+    const bool premul = kPremul_SkAlphaType == dstInfo.alphaType();
+
+    const int required = info.fRequiredFrame;
+    if (kNone == required) {
+        SkSampler::Fill(dstInfo, dst, rowBytes, SK_ColorTRANSPARENT, options.fZeroInitialized);
+    } else if (kRestoreBGColor_DisposalMethod == fFrames[required].fDisposalMethod) {
+        clear_frame_rect(dst, rowBytes, fFrames[required].fFrameRect);
+    }
+
+    WebPDecoderConfig config;
+    if (0 == WebPInitDecoderConfig(&config)) {
+        return kInvalidInput;
+    }
+    SkAutoTCallVProc<WebPDecBuffer, WebPFreeDecBuffer> autoFree(&(config.output));
+
+    // Decode directly into the destination, unless the frame has to be blended.
+    const bool blend = kNone != required && fFrameBlends[index];
+    SkAutoTMalloc<uint32_t> blendPixels(blend ? frameRect.width() * frameRect.height() : 0);
+    uint8_t* frameDst = SkTAddOffset<uint8_t>(dst, frameRect.top() * rowBytes +
+            frameRect.left() * sizeof(uint32_t));
+    const size_t frameRowBytes = blend ? frameRect.width() * sizeof(uint32_t) : rowBytes;
+    if (blend) {
+        frameDst = (uint8_t*) blendPixels.get();
+    }
+
+    config.output.colorspace = webp_decode_mode(dstInfo.colorType(), premul);
+    config.output.u.RGBA.rgba = frameDst;
+    config.output.u.RGBA.stride = (int) frameRowBytes;
+    config.output.u.RGBA.size = frameRowBytes * (frameRect.height() - 1) +
+            frameRect.width() * sizeof(uint32_t);
+    config.output.is_external_memory = 1;
+
+    const Result result = VP8_STATUS_OK == WebPDecode(fragment, fragmentSize, &config)
+            ? kSuccess : kIncompleteInput;
+
+    if (blend && kSuccess == result) {
+        for (int y = 0; y < frameRect.height(); y++) {
+            uint32_t* dstRow = SkTAddOffset<uint32_t>(dst, (frameRect.top() + y) * rowBytes);
+            blend_row(dstRow + frameRect.left(), blendPixels.get() + y * frameRect.width(),
+                    frameRect.width(), premul);
+        }
+    }
+    return result;
+}
+
+SkWebpCodec::SkWebpCodec(int width, int height, const SkEncodedInfo& info, SkStream* stream,
+                         bool isAnimated)
     // The spec says an unmarked image is sRGB, so we return that space here.
     // TODO: Add support for parsing ICC profiles from webps.
-    : INHERITED(width, height, info, stream, SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named)) {}
+    : INHERITED(width, height, info, stream, SkColorSpace::NewNamed(SkColorSpace::kSRGB_Named))
+    , fIsAnimated(isAnimated)
+    , fScannedFrames(false) {}
@@ -10,8 +10,11 @@
 
 #include "SkCodec.h"
 #include "SkColorSpace.h"
+#include "SkData.h"
 #include "SkEncodedFormat.h"
 #include "SkImageInfo.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
 #include "SkTypes.h"
 
 class SkStream;
@@ -33,8 +36,41 @@ protected:
     bool onDimensionsSupported(const SkISize&) override;
 
     bool onGetValidSubset(SkIRect* /* desiredSubset */) const override;
+
+    int onGetFrameCount() override;
+
+    bool onGetFrameInfo(int index, FrameInfo*) override;
 private:
-    SkWebpCodec(int width, int height, const SkEncodedInfo&, SkStream*);
+    SkWebpCodec(int width, int height, const SkEncodedInfo&, SkStream*, bool isAnimated);
+
+    /*
+     * Reads the entire stream into fData and records every frame of an animated
+     * webp in fFrames.  Only done once.
+     */
+    void scanFrames();
+
+    /*
+     * Decodes a frame of an animated webp, compositing it onto the frame it depends on.
+     */
+    Result decodeFrame(const SkImageInfo& dstInfo, void* dst, size_t rowBytes,
+            const Options& options, int* rowsDecoded);
+
+    /*
+     * Draws the frame at index, whose data is fragment, onto the frame it depends on, which
+     * must already be in dst.  Frames which do not depend on another are drawn on a cleared
+     * canvas.
+     */
+    Result drawFrame(int index, const uint8_t* fragment, size_t fragmentSize,
+            const SkImageInfo& dstInfo, void* dst, size_t rowBytes, const Options& options);
+
+    // libwebp only decodes animations through the demuxer, which needs all of the data.
+    const bool                  fIsAnimated;
+    sk_sp<SkData>               fData;
+
+    // Filled in by scanFrames(), one entry per frame.
+    SkTArray<FrameInfo, true>   fFrames;
+    SkTDArray<bool>             fFrameBlends;    // true if the frame is drawn with src-over
+    bool                        fScannedFrames;
 
     typedef SkCodec INHERITED;
 };
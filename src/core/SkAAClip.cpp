@@ -443,6 +443,7 @@ bool SkAAClip::trimLeftRight() {
 
     const int width = fBounds.width();
     RunHead* head = fRunHead;
+    SkASSERT(1 == head->fRefCnt);   // once shared (e.g. via SkAAClipCache), runs are immutable
     YOffset* yoff = head->yoffsets();
     YOffset* stop = yoff + head->fRowCount;
     uint8_t* base = head->data();
@@ -519,6 +520,7 @@ bool SkAAClip::trimTopBottom() {
 
     const int width = fBounds.width();
     RunHead* head = fRunHead;
+    SkASSERT(1 == head->fRefCnt);   // once shared (e.g. via SkAAClipCache), runs are immutable
     YOffset* yoff = head->yoffsets();
     YOffset* stop = yoff + head->fRowCount;
     const uint8_t* base = head->data();
@@ -1834,6 +1836,13 @@ static void expand_row_to_mask(uint8_t* SK_RESTRICT mask,
     SkASSERT(0 == width);
 }
 
+size_t SkAAClip::approximateBytesUsed() const {
+    if (this->isEmpty()) {
+        return 0;
+    }
+    return sizeof(RunHead) + fRunHead->fRowCount * sizeof(YOffset) + fRunHead->fDataSize;
+}
+
 void SkAAClip::copyToMask(SkMask* mask) const {
     mask->fFormat = SkMask::kA8_Format;
     if (this->isEmpty()) {
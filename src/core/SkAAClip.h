@@ -57,6 +57,12 @@ public:
      */
     void copyToMask(SkMask*) const;
 
+    /**
+     *  Returns the number of bytes used by this clip's runs. Copies of a clip share its runs,
+     *  so this is the cost of the first copy only.
+     */
+    size_t approximateBytesUsed() const;
+
     // called internally
 
     bool quickContains(int left, int top, int right, int bottom) const;
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkAAClip.h"
+#include "SkAAClipCache.h"
+#include "SkAtomics.h"
+#include "SkChecksum.h"
+#include "SkClipStack.h"
+#include "SkPathPriv.h"
+#include "SkResourceCache.h"
+
+#define CHECK_LOCAL(localCache, localName, globalName, ...) \
+    ((localCache) ? localCache->localName(__VA_ARGS__) : SkResourceCache::globalName(__VA_ARGS__))
+
+namespace {
+static unsigned gAAClipKeyNamespaceLabel;
+
+// Hashes the shapes, ops and AA flags of the stack's elements, but not their genIDs or save
+// counts, which do not change the clip.
+static uint32_t hash_elements(const SkClipStack& stack) {
+    uint32_t hash = 0;
+    SkClipStack::B2TIter iter(stack);
+    while (const SkClipStack::Element* element = iter.next()) {
+        const uint32_t header[] = {
+            (uint32_t) element->getType(), (uint32_t) element->getOp(), element->isAA()
+        };
+        hash = SkChecksum::Murmur3(header, sizeof(header), hash);
+        switch (element->getType()) {
+            case SkClipStack::Element::kPath_Type:
+                hash = SkChecksum::Murmur3(&hash, sizeof(hash),
+                                           SkPathPriv::ComputeContentHash(element->getPath()));
+                break;
+            case SkClipStack::Element::kRect_Type:
+            case SkClipStack::Element::kRRect_Type: {
+                const SkRRect& rrect = element->asRRect();
+                hash = SkChecksum::Murmur3(&rrect.rect(), sizeof(SkRect), hash);
+                for (int i = 0; i < 4; ++i) {
+                    const SkVector radii = rrect.radii((SkRRect::Corner) i);
+                    hash = SkChecksum::Murmur3(&radii, sizeof(radii), hash);
+                }
+                break;
+            }
+            case SkClipStack::Element::kEmpty_Type:
+                break;
+        }
+    }
+    return hash;
+}
+
+static bool same_elements(const SkClipStack& a, const SkClipStack& b) {
+    SkClipStack::B2TIter aIter(a), bIter(b);
+    const SkClipStack::Element* aElement = aIter.next();
+    const SkClipStack::Element* bElement = bIter.next();
+    for (; aElement && bElement; aElement = aIter.next(), bElement = bIter.next()) {
+        if (aElement->getType() != bElement->getType() ||
+                aElement->getOp() != bElement->getOp() ||
+                aElement->isAA() != bElement->isAA()) {
+            return false;
+        }
+        switch (aElement->getType()) {
+            case SkClipStack::Element::kPath_Type:
+                if (aElement->getPath() != bElement->getPath()) {
+                    return false;
+                }
+                break;
+            case SkClipStack::Element::kRect_Type:
+            case SkClipStack::Element::kRRect_Type:
+                if (aElement->asRRect() != bElement->asRRect()) {
+                    return false;
+                }
+                break;
+            case SkClipStack::Element::kEmpty_Type:
+                break;
+        }
+    }
+    return !aElement && !bElement;
+}
+
+struct AAClipKey : public SkResourceCache::Key {
+public:
+    AAClipKey(const SkAAClipCache::Key& key)
+        : fElementsHash(key.fElementsHash)
+        , fDeviceBounds(key.fDeviceBounds)
+        , fLayerBounds(key.fLayerBounds)
+        , fSimplified(key.fSimplified)
+    {
+        this->init(&gAAClipKeyNamespaceLabel, 0,
+                   sizeof(fElementsHash) + sizeof(fDeviceBounds) + sizeof(fLayerBounds) +
+                   sizeof(fSimplified));
+    }
+
+    uint32_t    fElementsHash;
+    SkIRect     fDeviceBounds;
+    SkIRect     fLayerBounds;
+    int32_t     fSimplified;
+};
+
+struct AAClipRec : public SkResourceCache::Rec {
+    AAClipRec(const AAClipKey& key, const SkClipStack& stack, const SkAAClip& aaclip)
+        : fKey(key)
+        , fStack(stack)
+        , fAAClip(aaclip)
+    {}
+
+    AAClipKey   fKey;
+    SkClipStack fStack;     // to resolve hash collisions
+    SkAAClip    fAAClip;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override { return sizeof(*this) + fAAClip.approximateBytesUsed(); }
+    const char* getCategory() const override { return "aaclip"; }
+
+    struct Context {
+        const SkClipStack*  fStack;
+        SkAAClip*           fResult;
+    };
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const AAClipRec& rec = static_cast<const AAClipRec&>(baseRec);
+        Context* ctx = static_cast<Context*>(contextData);
+
+        // Different clips with the same hash. Returning false purges this rec, which is fine:
+        // collisions are rare, and the caller will add its own result.
+        if (!same_elements(rec.fStack, *ctx->fStack)) {
+            return false;
+        }
+        *ctx->fResult = rec.fAAClip;
+        return true;
+    }
+};
+
+// The hashes of recently missed keys, so that we only lock and search the cache for keys
+// which have been seen before, and only add clips which have been asked for more than once.
+// Racing updates may lose a hash, which just delays caching that key.
+static const int kMissCount = 64;
+static uint32_t gMisses[kMissCount];
+
+static uint32_t* miss_slot(const AAClipKey& key) {
+    return &gMisses[key.hash() & (kMissCount - 1)];
+}
+
+static bool missed_before(const AAClipKey& key) {
+    return key.hash() == sk_atomic_load(miss_slot(key), sk_memory_order_relaxed);
+}
+} // namespace
+
+SkAAClipCache::Key::Key(const SkClipStack& stack, const SkIRect& deviceBounds,
+                        const SkIRect& layerBounds, bool simplified)
+    : fStack(stack)
+    , fElementsHash(hash_elements(stack))
+    , fDeviceBounds(deviceBounds)
+    , fLayerBounds(layerBounds)
+    , fSimplified(simplified)
+{}
+
+bool SkAAClipCache::Find(const Key& key, SkAAClip* result, SkResourceCache* localCache) {
+    AAClipKey cacheKey(key);
+    if (!missed_before(cacheKey)) {
+        return false;
+    }
+    AAClipRec::Context ctx = { &key.fStack, result };
+    return CHECK_LOCAL(localCache, find, Find, cacheKey, AAClipRec::Visitor, &ctx);
+}
+
+void SkAAClipCache::Add(const Key& key, const SkAAClip& aaclip, SkResourceCache* localCache) {
+    AAClipKey cacheKey(key);
+    if (!missed_before(cacheKey)) {
+        sk_atomic_store(miss_slot(cacheKey), cacheKey.hash(), sk_memory_order_relaxed);
+        return;
+    }
+    return CHECK_LOCAL(localCache, add, Add, new AAClipRec(cacheKey, key.fStack, aaclip));
+}
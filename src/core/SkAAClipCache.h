@@ -0,0 +1,54 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkAAClipCache_DEFINED
+#define SkAAClipCache_DEFINED
+
+#include "SkRect.h"
+
+class SkAAClip;
+class SkClipStack;
+class SkResourceCache;
+
+/**
+ *  Caches the antialiased raster clip that a canvas builds from its clip stack, so that
+ *  canvases which set up the same clips (e.g. many threads or frames playing back the same
+ *  picture) share a single copy of the clip's runs rather than each scan converting them.
+ *
+ *  Entries are keyed by the contents of the clip stack's elements (their shapes, ops and AA
+ *  flags, not their genIDs, which differ between canvases), the canvas's device and top layer
+ *  bounds, and whether the canvas simplifies its clips. A clip is only added once its key has
+ *  missed before, so clips that are set up just once never take the cache's lock or use its
+ *  memory.
+ */
+class SkAAClipCache {
+public:
+    struct Key {
+        // Hashes the stack's elements, so build each key once and pass it to Find() and Add().
+        Key(const SkClipStack& stack, const SkIRect& deviceBounds, const SkIRect& layerBounds,
+            bool simplified);
+
+        const SkClipStack&  fStack;
+        uint32_t            fElementsHash;
+        SkIRect             fDeviceBounds;
+        SkIRect             fLayerBounds;
+        bool                fSimplified;
+    };
+
+    /**
+     *  On success, set result to share the cached clip's runs and return true.
+     *  On failure, return false and leave result unchanged.
+     */
+    static bool Find(const Key& key, SkAAClip* result, SkResourceCache* localCache = nullptr);
+
+    /**
+     *  Add the clip built for key to the cache, if key has missed before.
+     */
+    static void Add(const Key& key, const SkAAClip& aaclip, SkResourceCache* localCache = nullptr);
+};
+
+#endif
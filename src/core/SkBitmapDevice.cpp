@@ -17,6 +17,7 @@
 #include "SkPixmap.h"
 #include "SkShader.h"
 #include "SkSurface.h"
+#include "SkTextBlobRunIterator.h"
 #include "SkXfermode.h"
 
 class SkColorTable;
@@ -349,6 +350,25 @@ void SkBitmapDevice::drawPosText(const SkDraw& draw, const void* text, size_t le
     draw.drawPosText((const char*)text, len, xpos, scalarsPerPos, offset, paint);
 }
 
+void SkBitmapDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob, SkScalar x,
+                                  SkScalar y, const SkPaint& paint, SkDrawFilter* drawFilter) {
+    // A filter may change the runs' paints from one draw to the next, so draw them as usual.
+    if (drawFilter) {
+        this->INHERITED::drawTextBlob(draw, blob, x, y, paint, drawFilter);
+        return;
+    }
+
+    SkPaint runPaint = paint;
+    int runIndex = 0;
+    for (SkTextBlobRunIterator it(blob); !it.done(); it.next(), ++runIndex) {
+        // applyFontToPaint() always overwrites the exact same attributes,
+        // so it is safe to not re-seed the paint for this reason.
+        it.applyFontToPaint(&runPaint);
+        runPaint.setFlags(this->filterTextFlags(runPaint));
+        draw.drawTextBlobRun(*blob, runIndex, it, SkPoint::Make(x, y), runPaint);
+    }
+}
+
 void SkBitmapDevice::drawVertices(const SkDraw& draw, SkCanvas::VertexMode vmode,
                                   int vertexCount,
                                   const SkPoint verts[], const SkPoint textures[],
@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkAAClipCache.h"
 #include "SkBitmapDevice.h"
 #include "SkCanvas.h"
 #include "SkCanvasPriv.h"
@@ -291,6 +292,9 @@ public:
     SkRasterClip    fRasterClip;
     SkMatrix        fMatrix;
     int             fDeferredSaveCount;
+    // True once a region has been clipped to. The clip stack only records the region's bounds,
+    // so fRasterClip can no longer be rebuilt from the clip stack alone.
+    bool            fClippedToRegion;
 
     MCRec(bool conservativeRasterClip) : fRasterClip(conservativeRasterClip) {
         fFilter     = nullptr;
@@ -298,6 +302,7 @@ public:
         fTopLayer   = nullptr;
         fMatrix.reset();
         fDeferredSaveCount = 0;
+        fClippedToRegion = false;
 
         // don't bother initializing fNext
         inc_rec();
@@ -307,6 +312,7 @@ public:
         fLayer = nullptr;
         fTopLayer = prev.fTopLayer;
         fDeferredSaveCount = 0;
+        fClippedToRegion = prev.fClippedToRegion;
 
         // don't bother initializing fNext
         inc_rec();
@@ -323,6 +329,7 @@ public:
 
         fMatrix.reset();
         fRasterClip.setRect(bounds);
+        fClippedToRegion = false;
         fLayer->reset(bounds);
     }
 };
@@ -1693,6 +1700,21 @@ void SkCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edg
     // if we called path.swap() we could avoid a deep copy of this path
     fClipStack->clipDevPath(devPath, op, kSoft_ClipEdgeStyle == edgeStyle);
 
+    // Canvases that set up the same clips (e.g. by playing back the same picture) build the same
+    // AA clip, so they share it through SkAAClipCache.
+    const bool cacheable = !fConservativeRasterClip && !fMCRec->fClippedToRegion;
+    SkTLazy<SkAAClipCache::Key> cacheKey;
+    if (cacheable) {
+        SkBaseDevice* device = this->getDevice();
+        cacheKey.init(*fClipStack, device ? device->getGlobalBounds() : SkIRect::MakeEmpty(),
+                      this->getTopLayerBounds(), fAllowSimplifyClip);
+        SkAAClip cached;
+        if (SkAAClipCache::Find(*cacheKey.get(), &cached)) {
+            fMCRec->fRasterClip.setAAClip(cached);
+            return;
+        }
+    }
+
     if (fAllowSimplifyClip) {
         bool clipIsAA = getClipStack()->asPath(&devPath);
         if (clipIsAA) {
@@ -1703,6 +1725,10 @@ void SkCanvas::onClipPath(const SkPath& path, SkRegion::Op op, ClipEdgeStyle edg
     }
 
     fMCRec->fRasterClip.op(devPath, this->getTopLayerBounds(), op, edgeStyle);
+
+    if (cacheable && fMCRec->fRasterClip.isAA()) {
+        SkAAClipCache::Add(*cacheKey.get(), fMCRec->fRasterClip.aaRgn());
+    }
 }
 
 void SkCanvas::clipRegion(const SkRegion& rgn, SkRegion::Op op) {
@@ -1721,6 +1747,7 @@ void SkCanvas::onClipRegion(const SkRegion& rgn, SkRegion::Op op) {
     fClipStack->clipDevRect(rgn.getBounds(), op);
 
     fMCRec->fRasterClip.op(rgn, op);
+    fMCRec->fClippedToRegion = true;
 }
 
 #ifdef SK_DEBUG
@@ -622,6 +622,22 @@ void SkClipStack::getBounds(SkRect* canvFiniteBound,
 }
 
 bool SkClipStack::quickContains(const SkRect& rect) const {
+    const Element* top = (const Element*)fDeque.back();
+    if (nullptr == top) {
+        return true;
+    }
+
+    // The topmost element caches the bounds of the entire stack. If those are normal bounds,
+    // anything outside them is not contained, and if the clip is just an intersection of rects
+    // then the bounds are the clip.
+    if (kNormal_BoundsType == top->fFiniteBoundType) {
+        if (!top->fFiniteBound.contains(rect)) {
+            return false;
+        }
+        if (top->fIsIntersectionOfRects) {
+            return true;
+        }
+    }
 
     Iter iter(*this, Iter::kTop_IterStart);
     const Element* element = iter.prev();
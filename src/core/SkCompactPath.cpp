@@ -0,0 +1,305 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCompactPath.h"
+#include "SkBuffer.h"
+#include "SkFloatBits.h"
+#include "SkTDArray.h"
+#include "SkTemplates.h"
+
+// Finer grids than 1/256 are rare in practice and would rarely fit in 16 bits anyway.
+static const int kMaxShift = 8;
+
+bool SkCompactPath::QuantizeCoord(SkScalar value, SkScalar origin, SkScalar scale,
+                                  SkScalar invScale, bool negativeZero, uint16_t* coord) {
+    SkScalar offset = (value - origin) * scale;
+    if (!(offset >= 0 && offset <= 0xFFFF) || offset != sk_float_floor(offset)) {
+        return false;
+    }
+    *coord = SkToU16((int)offset);
+    // The subtraction above may have rounded, so make sure the decoder gets back the same bits.
+    return SkFloat2Bits(DecodeCoord(origin, *coord, invScale, negativeZero)) ==
+           SkFloat2Bits(value);
+}
+
+SkCompactPath* SkCompactPath::Create(const SkPath& path) {
+    if (!path.isFinite()) {
+        return nullptr;
+    }
+
+    SkTDArray<SkPoint>  pts;
+    SkTDArray<uint8_t>  verbs;
+    SkTDArray<SkScalar> weights;
+    {
+        SkPath::RawIter iter(path);
+        SkPoint segment[4];
+        SkPath::Verb verb;
+        while ((verb = iter.next(segment)) != SkPath::kDone_Verb) {
+            *verbs.append() = SkToU8(verb);
+            switch (verb) {
+                case SkPath::kMove_Verb:
+                    *pts.append() = segment[0];
+                    break;
+                case SkPath::kLine_Verb:
+                    *pts.append() = segment[1];
+                    break;
+                case SkPath::kConic_Verb:
+                    *weights.append() = iter.conicWeight();
+                    // fall-through
+                case SkPath::kQuad_Verb:
+                    pts.append(2, &segment[1]);
+                    break;
+                case SkPath::kCubic_Verb:
+                    pts.append(3, &segment[1]);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    SkASSERT(pts.count() == path.countPoints());
+
+    // The sign of the first zero of each axis is kept, and a zero of the other sign later makes
+    // the path fail to quantize.
+    uint8_t negativeZeros = 0, seenZeros = 0;
+    for (const SkPoint& pt : pts) {
+        if (0 == pt.fX && !(seenZeros & kX_Axis)) {
+            seenZeros |= kX_Axis;
+            negativeZeros |= SkFloat2Bits(pt.fX) < 0 ? kX_Axis : 0;
+        }
+        if (0 == pt.fY && !(seenZeros & kY_Axis)) {
+            seenZeros |= kY_Axis;
+            negativeZeros |= SkFloat2Bits(pt.fY) < 0 ? kY_Axis : 0;
+        }
+    }
+
+    const SkRect& bounds = path.getBounds();
+    SkAutoTMalloc<uint16_t> coords(2 * pts.count());
+    int shift = 0;
+    for (; shift <= kMaxShift; ++shift) {
+        const SkScalar scale = SkIntToScalar(1 << shift);
+        const SkScalar invScale = 1 / scale;
+        int i = 0;
+        for (; i < pts.count(); ++i) {
+            if (!QuantizeCoord(pts[i].fX, bounds.fLeft, scale, invScale,
+                               negativeZeros & kX_Axis, &coords[2 * i]) ||
+                !QuantizeCoord(pts[i].fY, bounds.fTop, scale, invScale,
+                               negativeZeros & kY_Axis, &coords[2 * i + 1])) {
+                break;
+            }
+        }
+        if (i == pts.count()) {
+            break;
+        }
+    }
+    if (shift > kMaxShift) {
+        return nullptr;
+    }
+
+    SkCompactPath* compact = new SkCompactPath;
+    compact->fBounds = bounds;
+    compact->fInvScale = 1 / SkIntToScalar(1 << shift);
+    compact->fPointCount = pts.count();
+    compact->fVerbCount = verbs.count();
+    compact->fConicCount = weights.count();
+    compact->fFillType = SkToU8(path.getFillType());
+    compact->fNegativeZeros = negativeZeros;
+    compact->allocStorage();
+
+    memcpy(compact->fConicWeights, weights.begin(), weights.count() * sizeof(SkScalar));
+    memcpy(compact->fCoords, coords.get(), 2 * pts.count() * sizeof(uint16_t));
+    memset(compact->fVerbs, 0, (verbs.count() + 1) >> 1);
+    for (int i = 0; i < verbs.count(); ++i) {
+        SkASSERT(verbs[i] <= 0xF);
+        compact->fVerbs[i >> 1] |= verbs[i] << ((i & 1) << 2);
+    }
+    return compact;
+}
+
+void SkCompactPath::allocStorage() {
+    const size_t weightBytes = fConicCount * sizeof(SkScalar);
+    const size_t coordBytes = 2 * fPointCount * sizeof(uint16_t);
+    const size_t verbBytes = (fVerbCount + 1) >> 1;
+    fStorageSize = weightBytes + coordBytes + verbBytes;
+    fStorage = sk_malloc_throw(fStorageSize);
+    fConicWeights = (SkScalar*)fStorage;
+    fCoords = (uint16_t*)((char*)fStorage + weightBytes);
+    fVerbs = (uint8_t*)fCoords + coordBytes;
+}
+
+SkCompactPath::~SkCompactPath() {
+    sk_free(fStorage);
+}
+
+// The path is written as its bounds, inverse scale, point, verb and conic counts, fill type and
+// signs of zeros, followed by its storage, padded to a multiple of 4 bytes.
+static const size_t kHeaderSize = 5 * sizeof(SkScalar) + 5 * sizeof(int32_t);
+
+size_t SkCompactPath::writeToMemory(void* buffer) const {
+    const size_t size = SkAlign4(kHeaderSize + fStorageSize);
+    if (buffer) {
+        SkWBuffer write(buffer, size);
+        write.write(&fBounds, sizeof(fBounds));
+        write.writeScalar(fInvScale);
+        write.write32(fPointCount);
+        write.write32(fVerbCount);
+        write.write32(fConicCount);
+        write.write32(fFillType);
+        write.write32(fNegativeZeros);
+        write.write(fStorage, fStorageSize);
+        write.padToAlign4();
+        SkASSERT(write.pos() == size);
+    }
+    return size;
+}
+
+SkCompactPath* SkCompactPath::CreateFromMemory(const void* buffer, size_t length) {
+    SkRBufferWithSizeCheck read(buffer, length);
+    SkRect bounds;
+    SkScalar invScale;
+    int32_t pointCount, verbCount, conicCount;
+    uint32_t fillType, negativeZeros;
+    if (!read.read(&bounds, sizeof(bounds)) || !read.readScalar(&invScale) ||
+        !read.readS32(&pointCount) || !read.readS32(&verbCount) || !read.readS32(&conicCount) ||
+        !read.readU32(&fillType) || !read.readU32(&negativeZeros) || !read.isValid()) {
+        return nullptr;
+    }
+    // Check everything the iterator trusts, as the buffer may have come from another process.
+    bool validScale = false;
+    for (int shift = 0; shift <= kMaxShift; ++shift) {
+        validScale |= invScale == 1 / SkIntToScalar(1 << shift);
+    }
+    if (!bounds.isFinite() || !validScale || pointCount < 0 || verbCount < 0 || conicCount < 0 ||
+        fillType > SkPath::kInverseEvenOdd_FillType ||
+        (negativeZeros & ~(kX_Axis | kY_Axis)) || pointCount > (1 << 28) ||
+        verbCount > (1 << 28) || conicCount > (1 << 28)) {
+        return nullptr;
+    }
+    const size_t storageSize = conicCount * sizeof(SkScalar) + 2 * pointCount * sizeof(uint16_t) +
+                               ((verbCount + 1) >> 1);
+    if (SkAlign4(kHeaderSize + storageSize) != length) {
+        return nullptr;
+    }
+
+    SkAutoTDelete<SkCompactPath> compact(new SkCompactPath);
+    compact->fBounds = bounds;
+    compact->fInvScale = invScale;
+    compact->fPointCount = pointCount;
+    compact->fVerbCount = verbCount;
+    compact->fConicCount = conicCount;
+    compact->fFillType = SkToU8(fillType);
+    compact->fNegativeZeros = SkToU8(negativeZeros);
+    compact->allocStorage();
+    SkAssertResult(read.read(compact->fStorage, storageSize));
+
+    int points = 0, conics = 0;
+    for (int i = 0; i < verbCount; ++i) {
+        switch (compact->verbAt(i)) {
+            case SkPath::kMove_Verb:
+            case SkPath::kLine_Verb:  points += 1; break;
+            case SkPath::kConic_Verb: conics += 1; // fall-through
+            case SkPath::kQuad_Verb:  points += 2; break;
+            case SkPath::kCubic_Verb: points += 3; break;
+            case SkPath::kClose_Verb: break;
+            default: return nullptr;
+        }
+    }
+    if (points != pointCount || conics != conicCount) {
+        return nullptr;
+    }
+    for (int i = 0; i < conicCount; ++i) {
+        if (!SkScalarIsFinite(compact->fConicWeights[i])) {
+            return nullptr;
+        }
+    }
+    return compact.release();
+}
+
+size_t SkCompactPath::approximateBytesUsed() const {
+    return sizeof(SkCompactPath) + fStorageSize;
+}
+
+void SkCompactPath::toPath(SkPath* path) const {
+    // Keeps the path's storage, so decoding into the same path again doesn't reallocate.
+    path->rewind();
+    path->incReserve(fPointCount);
+    path->setFillType(this->getFillType());
+
+    Iter iter(*this);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                path->moveTo(pts[0]);
+                break;
+            case SkPath::kLine_Verb:
+                path->lineTo(pts[1]);
+                break;
+            case SkPath::kQuad_Verb:
+                path->quadTo(pts[1], pts[2]);
+                break;
+            case SkPath::kConic_Verb:
+                path->conicTo(pts[1], pts[2], iter.conicWeight());
+                break;
+            case SkPath::kCubic_Verb:
+                path->cubicTo(pts[1], pts[2], pts[3]);
+                break;
+            case SkPath::kClose_Verb:
+                path->close();
+                break;
+            default:
+                SkDEBUGFAIL("unexpected verb");
+                break;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+SkCompactPath::Iter::Iter(const SkCompactPath& path)
+    : fPath(&path)
+    , fCoords(path.fCoords)
+    , fConicWeights(path.fConicWeights - 1) // begin one behind
+    , fVerbIndex(0) {
+    fLastPt.set(0, 0);
+}
+
+SkPath::Verb SkCompactPath::Iter::next(SkPoint pts[4]) {
+    SkASSERT(pts);
+    if (fVerbIndex == fPath->fVerbCount) {
+        return SkPath::kDone_Verb;
+    }
+
+    unsigned verb = fPath->verbAt(fVerbIndex++);
+    switch (verb) {
+        case SkPath::kMove_Verb:
+            pts[0] = fLastPt = this->decode();
+            break;
+        case SkPath::kLine_Verb:
+            pts[0] = fLastPt;
+            pts[1] = fLastPt = this->decode();
+            break;
+        case SkPath::kConic_Verb:
+            fConicWeights += 1;
+            // fall-through
+        case SkPath::kQuad_Verb:
+            pts[0] = fLastPt;
+            pts[1] = this->decode();
+            pts[2] = fLastPt = this->decode();
+            break;
+        case SkPath::kCubic_Verb:
+            pts[0] = fLastPt;
+            pts[1] = this->decode();
+            pts[2] = this->decode();
+            pts[3] = fLastPt = this->decode();
+            break;
+        default:
+            break;
+    }
+    return (SkPath::Verb)verb;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkCompactPath_DEFINED
+#define SkCompactPath_DEFINED
+
+#include "SkPath.h"
+
+/**
+ *  An immutable, compressed copy of an SkPath's geometry, intended for long-lived paths such as
+ *  glyph outlines and icons. Points are stored as unsigned 16-bit offsets from the top-left of
+ *  the path's bounds, scaled by a per-path power of two, and verbs are packed two to a byte.
+ *
+ *  The encoding is lossless: a path only qualifies if every point can be reproduced bit-for-bit
+ *  from its 16-bit offset (e.g. integer coordinates or 26.6 fixed point font outlines). Zeros keep
+ *  their sign as long as all the zeros of each axis have the same one, as in the outlines from
+ *  FreeType, whose y coordinates are negated. Iterating
+ *  an SkCompactPath returns exactly what SkPath::RawIter returns for the original path.
+ */
+class SkCompactPath : SkNoncopyable {
+public:
+    /**
+     *  Returns a compact copy of the path, or nullptr if the path's points cannot be represented
+     *  exactly. The caller owns the result.
+     */
+    static SkCompactPath* Create(const SkPath&);
+
+    /**
+     *  Returns a compact path read from the length bytes at buffer, as written by writeToMemory, or
+     *  nullptr if they are not a valid compact path. The caller owns the result.
+     */
+    static SkCompactPath* CreateFromMemory(const void* buffer, size_t length);
+
+    ~SkCompactPath();
+
+    int countPoints() const { return fPointCount; }
+    int countVerbs() const { return fVerbCount; }
+    SkPath::FillType getFillType() const { return (SkPath::FillType)fFillType; }
+    const SkRect& getBounds() const { return fBounds; }
+
+    /** Rebuilds the original path. */
+    void toPath(SkPath*) const;
+
+    /**
+     *  Writes the path to buffer, if it is not null, and returns the number of bytes it takes,
+     *  which is a multiple of 4.
+     */
+    size_t writeToMemory(void* buffer) const;
+
+    /** Returns the number of bytes used by this object, including its storage. */
+    size_t approximateBytesUsed() const;
+
+    /** Iterates the path, decoding points on the fly, just like SkPath::RawIter. */
+    class Iter {
+    public:
+        Iter(const SkCompactPath&);
+
+        SkPath::Verb next(SkPoint pts[4]);
+
+        SkScalar conicWeight() const { return *fConicWeights; }
+
+    private:
+        SkPoint decode() {
+            SkPoint pt = fPath->decode(fCoords);
+            fCoords += 2;
+            return pt;
+        }
+
+        const SkCompactPath*    fPath;
+        const uint16_t*         fCoords;
+        const SkScalar*         fConicWeights;
+        int                     fVerbIndex;
+        SkPoint                 fLastPt;
+    };
+
+private:
+    SkCompactPath() {}
+
+    static bool QuantizeCoord(SkScalar value, SkScalar origin, SkScalar scale, SkScalar invScale,
+                              bool negativeZero, uint16_t* coord);
+
+    // Allocates the storage for the counts, and points the arrays into it.
+    void allocStorage();
+
+    // Multiplying a 16-bit integer by a power of two is exact, so this is the only rounding step
+    // and the encoder can check that it reproduces the original coordinate.
+    static SkScalar DecodeCoord(SkScalar origin, unsigned coord, SkScalar invScale,
+                                bool negativeZero) {
+        SkScalar value = origin + SkIntToScalar(coord) * invScale;
+        return negativeZero && 0 == value ? -value : value;
+    }
+
+    SkPoint decode(const uint16_t coords[2]) const {
+        return SkPoint::Make(
+                DecodeCoord(fBounds.fLeft, coords[0], fInvScale, fNegativeZeros & kX_Axis),
+                DecodeCoord(fBounds.fTop, coords[1], fInvScale, fNegativeZeros & kY_Axis));
+    }
+
+    // The bits of fNegativeZeros, set if the zeros of that axis are negative.
+    enum {
+        kX_Axis = 1 << 0,
+        kY_Axis = 1 << 1,
+    };
+
+    unsigned verbAt(int index) const {
+        return (fVerbs[index >> 1] >> ((index & 1) << 2)) & 0xF;
+    }
+
+    SkRect      fBounds;
+    SkScalar    fInvScale;
+    int         fPointCount;
+    int         fVerbCount;
+    int         fConicCount;
+    uint8_t     fFillType;
+    uint8_t     fNegativeZeros;
+
+    // The three arrays below all live in this single allocation.
+    void*       fStorage;
+    size_t      fStorageSize;
+    SkScalar*   fConicWeights;
+    uint16_t*   fCoords;
+    uint8_t*    fVerbs;
+};
+
+#endif
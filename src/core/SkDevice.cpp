@@ -10,6 +10,7 @@
 #include "SkDraw.h"
 #include "SkDrawFilter.h"
 #include "SkImage_Base.h"
+#include "SkImageCacherator.h"
 #include "SkImageFilter.h"
 #include "SkImageFilterCache.h"
 #include "SkMetaData.h"
@@ -20,6 +21,7 @@
 #include "SkRSXform.h"
 #include "SkShader.h"
 #include "SkSpecialImage.h"
+#include "SkTArray.h"
 #include "SkTextBlobRunIterator.h"
 #include "SkTextToPathIter.h"
 
@@ -146,10 +148,67 @@ void SkBaseDevice::drawTextBlob(const SkDraw& draw, const SkTextBlob* blob, SkSc
     }
 }
 
+// If the image was prefetched at the size it is drawn (see SkImage::prefetch()), returns that
+// smaller copy, waiting for it if it is still being decoded, and src mapped into it.
+static bool lock_prefetched(const SkImage* image, const SkRect& src, const SkRect& dst,
+                            const SkMatrix& ctm, SkBitmap* bm, SkRect* scaledSrc) {
+    SkImageCacherator* cacher = as_IB(image)->peekCacherator();
+    if (!cacher || src.isEmpty()) {
+        return false;
+    }
+    SkMatrix matrix;
+    matrix.setRectToRect(src, dst, SkMatrix::kFill_ScaleToFit);
+    matrix.postConcat(ctm);
+    SkSize scale;
+    if (matrix.hasPerspective() || !matrix.decomposeScale(&scale, nullptr) ||
+            scale.width() >= 1 || scale.height() >= 1) {
+        return false;
+    }
+    const int width = SkScalarRoundToInt(image->width() * scale.width());
+    const int height = SkScalarRoundToInt(image->height() * scale.height());
+    if (width <= 0 || height <= 0 || !cacher->lockPrefetched(SkISize::Make(width, height), bm)) {
+        return false;
+    }
+    SkMatrix::MakeScale(SkIntToScalar(width) / image->width(),
+                        SkIntToScalar(height) / image->height()).mapRect(scaledSrc, src);
+    return true;
+}
+
+// Raster devices draw images that keep YUV planes (see SkImage::MakeFromEncodedYUV()) by filling
+// dst with a shader that samples the planes, so no RGBA copy is made. The shader clamps to the
+// image's edges, so this is only done when src is the whole image.
+static bool make_yuv_image_paint(SkBaseDevice* device, const SkImage* image, const SkRect& src,
+                                 const SkRect& dst, const SkPaint& paint, SkPaint* yuvPaint) {
+    SkPixmap unused;
+    if (!as_IB(image)->keepsYUVPlanes() || !device->peekPixels(&unused) ||
+            src != SkRect::MakeIWH(image->width(), image->height())) {
+        return false;
+    }
+    SkMatrix matrix;
+    matrix.setRectToRect(src, dst, SkMatrix::kFill_ScaleToFit);
+    *yuvPaint = paint;
+    yuvPaint->setStyle(SkPaint::kFill_Style);
+    yuvPaint->setShader(image->makeShader(SkShader::kClamp_TileMode, SkShader::kClamp_TileMode,
+                                          &matrix));
+    return true;
+}
+
 void SkBaseDevice::drawImage(const SkDraw& draw, const SkImage* image, SkScalar x, SkScalar y,
                              const SkPaint& paint) {
     // Default impl : turns everything into raster bitmap
     SkBitmap bm;
+    const SkRect bounds = SkRect::MakeIWH(image->width(), image->height());
+    SkRect scaledSrc;
+    if (lock_prefetched(image, bounds, bounds.makeOffset(x, y), *draw.fMatrix, &bm, &scaledSrc)) {
+        this->drawBitmapRect(draw, bm, &scaledSrc, bounds.makeOffset(x, y), paint,
+                             SkCanvas::kFast_SrcRectConstraint);
+        return;
+    }
+    SkPaint yuvPaint;
+    if (make_yuv_image_paint(this, image, bounds, bounds.makeOffset(x, y), paint, &yuvPaint)) {
+        this->drawRect(draw, bounds.makeOffset(x, y), yuvPaint);
+        return;
+    }
     if (as_IB(image)->getROPixels(&bm)) {
         this->drawBitmap(draw, bm, SkMatrix::MakeTrans(x, y), paint);
     }
@@ -160,6 +219,19 @@ void SkBaseDevice::drawImageRect(const SkDraw& draw, const SkImage* image, const
                                  SkCanvas::SrcRectConstraint constraint) {
     // Default impl : turns everything into raster bitmap
     SkBitmap bm;
+    SkRect scaledSrc;
+    if (lock_prefetched(image, src ? *src : SkRect::MakeIWH(image->width(), image->height()),
+                        dst, *draw.fMatrix, &bm, &scaledSrc)) {
+        this->drawBitmapRect(draw, bm, &scaledSrc, dst, paint, constraint);
+        return;
+    }
+    SkPaint yuvPaint;
+    if (make_yuv_image_paint(this, image,
+                             src ? *src : SkRect::MakeIWH(image->width(), image->height()),
+                             dst, paint, &yuvPaint)) {
+        this->drawRect(draw, dst, yuvPaint);
+        return;
+    }
     if (as_IB(image)->getROPixels(&bm)) {
         this->drawBitmapRect(draw, bm, src, dst, paint, constraint);
     }
@@ -282,38 +354,6 @@ bool SkBaseDevice::peekPixels(SkPixmap* pmap) {
 
 //////////////////////////////////////////////////////////////////////////////////////////
 
-static void morphpoints(SkPoint dst[], const SkPoint src[], int count,
-                        SkPathMeasure& meas, const SkMatrix& matrix) {
-    SkMatrix::MapXYProc proc = matrix.getMapXYProc();
-
-    for (int i = 0; i < count; i++) {
-        SkPoint pos;
-        SkVector tangent;
-
-        proc(matrix, src[i].fX, src[i].fY, &pos);
-        SkScalar sx = pos.fX;
-        SkScalar sy = pos.fY;
-
-        if (!meas.getPosTan(sx, &pos, &tangent)) {
-            // set to 0 if the measure failed, so that we just set dst == pos
-            tangent.set(0, 0);
-        }
-
-        /*  This is the old way (that explains our approach but is way too slow
-         SkMatrix    matrix;
-         SkPoint     pt;
-
-         pt.set(sx, sy);
-         matrix.setSinCos(tangent.fY, tangent.fX);
-         matrix.preTranslate(-sx, 0);
-         matrix.postTranslate(pos.fX, pos.fY);
-         matrix.mapPoints(&dst[i], &pt, 1);
-         */
-        dst[i].set(pos.fX - SkScalarMul(tangent.fY, sy),
-                   pos.fY + SkScalarMul(tangent.fX, sy));
-    }
-}
-
 /*  TODO
 
  Need differentially more subdivisions when the follow-path is curvy. Not sure how to
@@ -323,29 +363,81 @@ static void morphpoints(SkPoint dst[], const SkPoint src[], int count,
 static void morphpath(SkPath* dst, const SkPath& src, SkPathMeasure& meas,
                       const SkMatrix& matrix) {
     SkPath::Iter    iter(src, false);
-    SkPoint         srcP[4], dstP[3];
+    SkPoint         srcP[4];
     SkPath::Verb    verb;
 
+    // Gather every point we will morph first, so that meas can find them all in one batch.
+    SkSTArray<64, SkPoint, true> pts;
     while ((verb = iter.next(srcP)) != SkPath::kDone_Verb) {
         switch (verb) {
             case SkPath::kMove_Verb:
-                morphpoints(dstP, srcP, 1, meas, matrix);
-                dst->moveTo(dstP[0]);
+                pts.push_back_n(1, srcP);
                 break;
             case SkPath::kLine_Verb:
                 // turn lines into quads to look bendy
                 srcP[0].fX = SkScalarAve(srcP[0].fX, srcP[1].fX);
                 srcP[0].fY = SkScalarAve(srcP[0].fY, srcP[1].fY);
-                morphpoints(dstP, srcP, 2, meas, matrix);
-                dst->quadTo(dstP[0], dstP[1]);
+                pts.push_back_n(2, srcP);
+                break;
+            case SkPath::kQuad_Verb:
+                pts.push_back_n(2, &srcP[1]);
+                break;
+            case SkPath::kCubic_Verb:
+                pts.push_back_n(3, &srcP[1]);
+                break;
+            default:
                 break;
+        }
+    }
+
+    const int count = pts.count();
+    SkMatrix::MapXYProc proc = matrix.getMapXYProc();
+    SkSTArray<64, SkScalar, true> distances(count);
+    SkSTArray<64, SkVector, true> tangents(count);
+    for (int i = 0; i < count; i++) {
+        proc(matrix, pts[i].fX, pts[i].fY, &pts[i]);
+        distances.push_back(pts[i].fX);
+    }
+    tangents.push_back_n(count);
+
+    SkSTArray<64, SkPoint, true> positions(pts);
+    if (!meas.getPosTan(count, distances.begin(), positions.begin(), tangents.begin())) {
+        // set to 0 if the measure failed, so that we just set dst == pos
+        sk_bzero(tangents.begin(), count * sizeof(SkVector));
+    }
+
+    /*  This is the old way (that explains our approach but is way too slow
+     SkMatrix    matrix;
+     SkPoint     pt;
+
+     pt.set(sx, sy);
+     matrix.setSinCos(tangent.fY, tangent.fX);
+     matrix.preTranslate(-sx, 0);
+     matrix.postTranslate(pos.fX, pos.fY);
+     matrix.mapPoints(&dst[i], &pt, 1);
+     */
+    for (int i = 0; i < count; i++) {
+        SkScalar sy = pts[i].fY;
+        pts[i].set(positions[i].fX - SkScalarMul(tangents[i].fY, sy),
+                   positions[i].fY + SkScalarMul(tangents[i].fX, sy));
+    }
+
+    const SkPoint* dstP = pts.begin();
+    iter.setPath(src, false);
+    while ((verb = iter.next(srcP)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                dst->moveTo(dstP[0]);
+                dstP += 1;
+                break;
+            case SkPath::kLine_Verb:
             case SkPath::kQuad_Verb:
-                morphpoints(dstP, &srcP[1], 2, meas, matrix);
                 dst->quadTo(dstP[0], dstP[1]);
+                dstP += 2;
                 break;
             case SkPath::kCubic_Verb:
-                morphpoints(dstP, &srcP[1], 3, meas, matrix);
                 dst->cubicTo(dstP[0], dstP[1], dstP[2]);
+                dstP += 3;
                 break;
             case SkPath::kClose_Verb:
                 dst->close();
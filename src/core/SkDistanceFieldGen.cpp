@@ -6,12 +6,18 @@
  */
 
 #include "SkDistanceFieldGen.h"
+#include "SkNx.h"
 #include "SkPoint.h"
+#include "SkTaskGroup.h"
 
+// The working data of each texel, with a plane per field so that the passes of the distance
+// transform can work on several texels of a row at once.
 struct DFData {
-    float   fAlpha;      // alpha value of source texel
-    float   fDistSq;     // distance squared to nearest (so far) edge texel
-    SkPoint fDistVector; // distance vector to nearest (so far) edge texel
+    float*         fAlpha;     // alpha value of source texel
+    float*         fDistSq;    // distance squared to nearest (so far) edge texel
+    float*         fDistX;     // distance vector to nearest (so far) edge texel
+    float*         fDistY;
+    unsigned char* fEdges;     // non-zero for edge texels
 };
 
 enum NeighborFlags {
@@ -63,20 +69,18 @@ static bool found_edge(const unsigned char* imagePtr, int width, int neighborFla
     return false;
 }
 
-static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned char* image,
+static void init_glyph_data(const DFData& data, const unsigned char* image,
                             int dataWidth, int dataHeight,
                             int imageWidth, int imageHeight,
                             int pad) {
-    data += pad*dataWidth;
-    data += pad;
-    edges += (pad*dataWidth + pad);
+    int curr = pad*dataWidth + pad;
 
     for (int j = 0; j < imageHeight; ++j) {
         for (int i = 0; i < imageWidth; ++i) {
             if (255 == *image) {
-                data->fAlpha = 1.0f;
+                data.fAlpha[curr] = 1.0f;
             } else {
-                data->fAlpha = (*image)*0.00392156862f;  // 1/255
+                data.fAlpha[curr] = (*image)*0.00392156862f;  // 1/255
             }
             int checkMask = kAll_NeighborFlags;
             if (i == 0) {
@@ -92,14 +96,12 @@ static void init_glyph_data(DFData* data, unsigned char* edges, const unsigned c
                 checkMask &= ~(kBottomLeft_NeighborFlag|kBottom_NeighborFlag|kBottomRight_NeighborFlag);
             }
             if (found_edge(image, imageWidth, checkMask)) {
-                *edges = 255;  // using 255 makes for convenient debug rendering
+                data.fEdges[curr] = 255;  // using 255 makes for convenient debug rendering
             }
-            ++data;
+            ++curr;
             ++image;
-            ++edges;
         }
-        data += 2*pad;
-        edges += 2*pad;
+        curr += 2*pad;
     }
 }
 
@@ -145,171 +147,225 @@ static float edge_distance(const SkPoint& direction, float alpha) {
     return distance;
 }
 
-static void init_distances(DFData* data, unsigned char* edges, int width, int height) {
-    // skip one pixel border
-    DFData* currData = data;
-    DFData* prevData = data - width;
-    DFData* nextData = data + width;
-
-    for (int j = 0; j < height; ++j) {
-        for (int i = 0; i < width; ++i) {
-            if (*edges) {
-                // we should not be in the one-pixel outside band
-                SkASSERT(i > 0 && i < width-1 && j > 0 && j < height-1);
-                // gradient will point from low to high
-                // +y is down in this case
-                // i.e., if you're outside, gradient points towards edge
-                // if you're inside, gradient points away from edge
-                SkPoint currGrad;
-                currGrad.fX = (prevData+1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*(currData+1)->fAlpha
-                             - SK_ScalarSqrt2*(currData-1)->fAlpha
-                             + (nextData+1)->fAlpha - (nextData-1)->fAlpha;
-                currGrad.fY = (nextData-1)->fAlpha - (prevData-1)->fAlpha
-                             + SK_ScalarSqrt2*nextData->fAlpha
-                             - SK_ScalarSqrt2*prevData->fAlpha
-                             + (nextData+1)->fAlpha - (prevData+1)->fAlpha;
-                currGrad.setLengthFast(1.0f);
-
-                // init squared distance to edge and distance vector
-                float dist = edge_distance(currGrad, currData->fAlpha);
-                currGrad.scale(dist, &currData->fDistVector);
-                currData->fDistSq = dist*dist;
-            } else {
-                // init distance to "far away"
-                currData->fDistSq = 2000000.f;
-                currData->fDistVector.fX = 1000.f;
-                currData->fDistVector.fY = 1000.f;
-            }
-            ++currData;
-            ++prevData;
-            ++nextData;
-            ++edges;
+static void init_distances(const DFData& data, int width, int height) {
+    // init distance to "far away", then compute the distances of the edge texels
+    for (int curr = 0; curr < width*height; ++curr) {
+        data.fDistSq[curr] = 2000000.f;
+        data.fDistX[curr] = 1000.f;
+        data.fDistY[curr] = 1000.f;
+    }
+
+    const float* alpha = data.fAlpha;
+    for (int curr = 0; curr < width*height; ++curr) {
+        if (data.fEdges[curr]) {
+            // we should not be in the one-pixel outside band
+            SkASSERT(curr % width > 0 && curr % width < width-1 &&
+                     curr / width > 0 && curr / width < height-1);
+            int prev = curr - width;
+            int next = curr + width;
+            // gradient will point from low to high
+            // +y is down in this case
+            // i.e., if you're outside, gradient points towards edge
+            // if you're inside, gradient points away from edge
+            SkPoint currGrad;
+            currGrad.fX = alpha[prev+1] - alpha[prev-1]
+                         + SK_ScalarSqrt2*alpha[curr+1]
+                         - SK_ScalarSqrt2*alpha[curr-1]
+                         + alpha[next+1] - alpha[next-1];
+            currGrad.fY = alpha[next-1] - alpha[prev-1]
+                         + SK_ScalarSqrt2*alpha[next]
+                         - SK_ScalarSqrt2*alpha[prev]
+                         + alpha[next+1] - alpha[prev+1];
+            currGrad.setLengthFast(1.0f);
+
+            // init squared distance to edge and distance vector
+            float dist = edge_distance(currGrad, alpha[curr]);
+            data.fDistX[curr] = currGrad.fX * dist;
+            data.fDistY[curr] = currGrad.fY * dist;
+            data.fDistSq[curr] = dist*dist;
         }
     }
 }
 
 // Danielsson's 8SSEDT
+//
+// Each pass takes the nearest edge of a texel's neighbors, when that is nearer than its own, in
+// a fixed order. The neighbors in the row above or below are in a row which the pass has
+// finished, so they are checked for N texels of a row at once; those in the same row are checked
+// one texel at a time.
+
+// The distance from a texel to the nearest edge of a neighbor.
+template <int N>
+struct DFDist {
+    typedef SkNx<N, float> Nf;
+
+    DFDist(const DFData& data, int texel)
+        : fDistSq(Nf::Load(data.fDistSq + texel))
+        , fDistX(Nf::Load(data.fDistX + texel))
+        , fDistY(Nf::Load(data.fDistY + texel)) {}
+    DFDist(const Nf& distSq, const Nf& distX, const Nf& distY)
+        : fDistSq(distSq), fDistX(distX), fDistY(distY) {}
+
+    // Takes other where it is nearer.
+    void takeNearer(const DFDist& other) {
+        Nf nearer = other.fDistSq < fDistSq;
+        fDistSq = nearer.thenElse(other.fDistSq, fDistSq);
+        fDistX  = nearer.thenElse(other.fDistX,  fDistX);
+        fDistY  = nearer.thenElse(other.fDistY,  fDistY);
+    }
 
-// first stage forward pass
-// (forward in Y, forward in X)
-static void F1(DFData* curr, int width) {
-    // upper left
-    DFData* check = curr - width-1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*(distVec.fX + distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    // Stores this for the texels which are not edges.
+    void store(const DFData& data, int texel) const {
+        Nf isEdge = SkNx_cast<float>(SkNx<N, uint8_t>::Load(data.fEdges + texel)) != 0.0f;
+        DFDist old(data, texel);
+        isEdge.thenElse(old.fDistSq, fDistSq).store(data.fDistSq + texel);
+        isEdge.thenElse(old.fDistX,  fDistX ).store(data.fDistX  + texel);
+        isEdge.thenElse(old.fDistY,  fDistY ).store(data.fDistY  + texel);
     }
 
+    Nf fDistSq;
+    Nf fDistX;
+    Nf fDistY;
+};
+
+// The upper left, upper and upper right neighbors, as the first stage forward pass checks them.
+template <int N>
+static DFDist<N> upper_neighbors(const DFData& data, int curr, int width, DFDist<N> dist) {
+    // upper left
+    DFDist<N> check(data, curr - width-1);
+    dist.takeNearer(DFDist<N>(check.fDistSq - 2.0f*(check.fDistX + check.fDistY - 1.0f),
+                              check.fDistX - 1.0f, check.fDistY - 1.0f));
+
     // up
-    check = curr - width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+    check = DFDist<N>(data, curr - width);
+    dist.takeNearer(DFDist<N>(check.fDistSq - 2.0f*check.fDistY + 1.0f,
+                              check.fDistX, check.fDistY - 1.0f));
 
     // upper right
-    check = curr - width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX - distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+    check = DFDist<N>(data, curr - width+1);
+    dist.takeNearer(DFDist<N>(check.fDistSq + 2.0f*(check.fDistX - check.fDistY + 1.0f),
+                              check.fDistX + 1.0f, check.fDistY - 1.0f));
+    return dist;
+}
 
-    // left
-    check = curr - 1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
-    }
+// The lower left, lower and lower right neighbors, as the second stage backward pass checks them.
+template <int N>
+static DFDist<N> lower_neighbors(const DFData& data, int curr, int width, DFDist<N> dist) {
+    // bottom left
+    DFDist<N> check(data, curr + width-1);
+    dist.takeNearer(DFDist<N>(check.fDistSq - 2.0f*(check.fDistX - check.fDistY - 1.0f),
+                              check.fDistX - 1.0f, check.fDistY + 1.0f));
+
+    // bottom
+    check = DFDist<N>(data, curr + width);
+    dist.takeNearer(DFDist<N>(check.fDistSq + 2.0f*check.fDistY + 1.0f,
+                              check.fDistX, check.fDistY + 1.0f));
+
+    // bottom right
+    check = DFDist<N>(data, curr + width+1);
+    dist.takeNearer(DFDist<N>(check.fDistSq + 2.0f*(check.fDistX + check.fDistY + 1.0f),
+                              check.fDistX + 1.0f, check.fDistY + 1.0f));
+    return dist;
 }
 
-// second stage forward pass
-// (forward in Y, backward in X)
-static void F2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    float distSq = check->fDistSq;
-    SkPoint distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Checks the left neighbor of each texel from first to last, skipping edge texels. The nearest
+// distance is carried from one texel to the next, and taken without branching, as which of them
+// is nearer is hard to predict.
+static void left_neighbors(const DFData& data, int first, int last) {
+    float prevSq = data.fDistSq[first-1];
+    float prevX = data.fDistX[first-1];
+    float prevY = data.fDistY[first-1];
+    for (int curr = first; curr <= last; ++curr) {
+        float currSq = data.fDistSq[curr];
+        float currX = data.fDistX[curr];
+        float currY = data.fDistY[curr];
+        if (!data.fEdges[curr]) {
+            float distSq = prevSq - 2.0f*prevX + 1.0f;
+            bool nearer = distSq < currSq;
+            currSq = nearer ? distSq : currSq;
+            currX = nearer ? prevX - 1.0f : currX;
+            currY = nearer ? prevY : currY;
+            data.fDistSq[curr] = currSq;
+            data.fDistX[curr] = currX;
+            data.fDistY[curr] = currY;
+        }
+        prevSq = currSq;
+        prevX = currX;
+        prevY = currY;
     }
 }
 
-// first stage backward pass
-// (backward in Y, forward in X)
-static void B1(DFData* curr, int width) {
-    // left
-    DFData* check = curr - 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq - 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// Checks the right neighbor of each texel from last to first, skipping edge texels, and then
+// the distance in lower, if not null, as the second stage backward pass does.
+static void right_neighbors(const DFData& data, int first, int last, const DFData* lower) {
+    float nextSq = data.fDistSq[last+1];
+    float nextX = data.fDistX[last+1];
+    float nextY = data.fDistY[last+1];
+    for (int curr = last; curr >= first; --curr) {
+        float currSq = data.fDistSq[curr];
+        float currX = data.fDistX[curr];
+        float currY = data.fDistY[curr];
+        if (!data.fEdges[curr]) {
+            float distSq = nextSq + 2.0f*nextX + 1.0f;
+            bool nearer = distSq < currSq;
+            currSq = nearer ? distSq : currSq;
+            currX = nearer ? nextX + 1.0f : currX;
+            currY = nearer ? nextY : currY;
+            if (lower) {
+                int texel = curr - first;
+                nearer = lower->fDistSq[texel] < currSq;
+                currSq = nearer ? lower->fDistSq[texel] : currSq;
+                currX = nearer ? lower->fDistX[texel] : currX;
+                currY = nearer ? lower->fDistY[texel] : currY;
+            }
+            data.fDistSq[curr] = currSq;
+            data.fDistX[curr] = currX;
+            data.fDistY[curr] = currY;
+        }
+        nextSq = currSq;
+        nextX = currX;
+        nextY = currY;
     }
 }
 
-// second stage backward pass
-// (backward in Y, backwards in X)
-static void B2(DFData* curr, int width) {
-    // right
-    DFData* check = curr + 1;
-    SkPoint distVec = check->fDistVector;
-    float distSq = check->fDistSq + 2.0f*distVec.fX + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// first stage forward pass, then second stage forward pass, of the texels from first to last
+// (forward in Y, forward then backward in X)
+static void forward_pass(const DFData& data, int first, int last, int width) {
+    // The upper neighbors come first, so each texel can take them before its left neighbor.
+    int curr = first;
+    for (; curr + 4 <= last + 1; curr += 4) {
+        upper_neighbors<4>(data, curr, width, DFDist<4>(data, curr)).store(data, curr);
     }
-
-    // bottom left
-    check = curr + width-1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq - 2.0f*(distVec.fX - distVec.fY - 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX -= 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    for (; curr <= last; ++curr) {
+        upper_neighbors<1>(data, curr, width, DFDist<1>(data, curr)).store(data, curr);
     }
+    left_neighbors(data, first, last);
+    right_neighbors(data, first, last, nullptr);
+}
 
-    // bottom
-    check = curr + width;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*distVec.fY + 1.0f;
-    if (distSq < curr->fDistSq) {
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+// first stage backward pass, then second stage backward pass, of the texels from first to last
+// (backward in Y, forward then backward in X)
+static void backward_pass(const DFData& data, int first, int last, int width,
+                          const DFData& lower) {
+    left_neighbors(data, first, last);
+
+    // The lower neighbors come after the right one, so find the nearest of them for each texel
+    // first, and let right_neighbors take it after the right neighbor.
+    const float kFar = SK_FloatInfinity;
+    int curr = first;
+    for (; curr + 4 <= last + 1; curr += 4) {
+        DFDist<4> dist = lower_neighbors<4>(data, curr, width, DFDist<4>(kFar, kFar, kFar));
+        dist.fDistSq.store(lower.fDistSq + curr - first);
+        dist.fDistX.store(lower.fDistX + curr - first);
+        dist.fDistY.store(lower.fDistY + curr - first);
     }
-
-    // bottom right
-    check = curr + width+1;
-    distVec = check->fDistVector;
-    distSq = check->fDistSq + 2.0f*(distVec.fX + distVec.fY + 1.0f);
-    if (distSq < curr->fDistSq) {
-        distVec.fX += 1.0f;
-        distVec.fY += 1.0f;
-        curr->fDistSq = distSq;
-        curr->fDistVector = distVec;
+    for (; curr <= last; ++curr) {
+        DFDist<1> dist = lower_neighbors<1>(data, curr, width, DFDist<1>(kFar, kFar, kFar));
+        dist.fDistSq.store(lower.fDistSq + curr - first);
+        dist.fDistX.store(lower.fDistX + curr - first);
+        dist.fDistY.store(lower.fDistY + curr - first);
     }
+    right_neighbors(data, first, last, &lower);
 }
 
 // enable this to output edge data rather than the distance field
@@ -331,6 +387,17 @@ static unsigned char pack_distance_field_val(float dist) {
     // (which represents zero).
     return (unsigned char)SkScalarRoundToInt(dist / (2 * distanceMagnitude) * 256.0f);
 }
+
+// Packs the distances of four texels as pack_distance_field_val does, given their squares and
+// alpha values.
+template <int distanceMagnitude>
+static Sk4b pack_distance_field_vals(const Sk4f& distSq, const Sk4f& alpha) {
+    Sk4f dist = distSq.sqrt();
+    dist = (alpha > 0.5f).thenElse(dist, 0.0f - dist);
+    dist = Sk4f::Max(Sk4f::Min(dist, distanceMagnitude * 127.0f / 128.0f), -distanceMagnitude);
+    dist = dist + distanceMagnitude;
+    return SkNx_cast<uint8_t>((dist / (2 * distanceMagnitude) * 256.0f + 0.5f).floor());
+}
 #endif
 
 // assumes a padded 8-bit image and distance field
@@ -349,91 +416,58 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
     int dataWidth = width + 2*pad;
     int dataHeight = height + 2*pad;
 
-    // create zeroed temp DFData+edge storage
-    SkAutoFree storage(sk_calloc_throw(dataWidth*dataHeight*(sizeof(DFData) + 1)));
-    DFData*        dataPtr = (DFData*)storage.get();
-    unsigned char* edgePtr = (unsigned char*)storage.get() + dataWidth*dataHeight*sizeof(DFData);
+    // create zeroed temp DFData+edge storage, with room for a row of lower neighbors
+    int dataCount = dataWidth*dataHeight;
+    SkAutoFree storage(sk_calloc_throw((4*dataCount + 3*dataWidth)*sizeof(float) + dataCount));
+    float* planes = (float*)storage.get();
+    DFData data = { planes, planes + dataCount, planes + 2*dataCount, planes + 3*dataCount,
+                    (unsigned char*)(planes + 4*dataCount + 3*dataWidth) };
+    float* lowerPlanes = planes + 4*dataCount;
+    DFData lower = { nullptr, lowerPlanes, lowerPlanes + dataWidth, lowerPlanes + 2*dataWidth,
+                     nullptr };
 
     // copy glyph into distance field storage
-    init_glyph_data(dataPtr, edgePtr, copyPtr,
+    init_glyph_data(data, copyPtr,
                     dataWidth, dataHeight,
                     width+2, height+2, SK_DistanceFieldPad);
 
     // create initial distance data, particularly at edges
-    init_distances(dataPtr, edgePtr, dataWidth, dataHeight);
+    init_distances(data, dataWidth, dataHeight);
 
     // now perform Euclidean distance transform to propagate distances
 
-    // forwards in y
-    DFData* currData = dataPtr+dataWidth+1; // skip outer buffer
-    unsigned char* currEdge = edgePtr+dataWidth+1;
+    // forwards in y, skipping the outer buffer
     for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                F2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData += dataWidth+1;
-        currEdge += dataWidth+1;
+        int first = j*dataWidth + 1;
+        forward_pass(data, first, first + dataWidth-3, dataWidth);
     }
 
     // backwards in y
-    currData = dataPtr+dataWidth*(dataHeight-2) - 1; // skip outer buffer
-    currEdge = edgePtr+dataWidth*(dataHeight-2) - 1;
-    for (int j = 1; j < dataHeight-1; ++j) {
-        // forwards in x
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B1(currData, dataWidth);
-            }
-            ++currData;
-            ++currEdge;
-        }
-
-        // backwards in x
-        --currData; // reset to end
-        --currEdge;
-        for (int i = 1; i < dataWidth-1; ++i) {
-            // don't need to calculate distance for edge pixels
-            if (!*currEdge) {
-                B2(currData, dataWidth);
-            }
-            --currData;
-            --currEdge;
-        }
-
-        currData -= dataWidth-1;
-        currEdge -= dataWidth-1;
+    // Each row's texels start with the last one of the row above, and end with the fourth
+    // from the end of the row.
+    for (int j = dataHeight-2; j >= 1; --j) {
+        int first = j*dataWidth - 1;
+        backward_pass(data, first, first + dataWidth-3, dataWidth, lower);
     }
 
     // copy results to final distance field data
-    currData = dataPtr + dataWidth+1;
-    currEdge = edgePtr + dataWidth+1;
     unsigned char *dfPtr = distanceField;
     for (int j = 1; j < dataHeight-1; ++j) {
-        for (int i = 1; i < dataWidth-1; ++i) {
+        int curr = j*dataWidth + 1;
+        int i = 1;
+#if !DUMP_EDGE
+        for (; i + 4 <= dataWidth-1; i += 4) {
+            pack_distance_field_vals<SK_DistanceFieldMagnitude>(
+                    Sk4f::Load(data.fDistSq + curr), Sk4f::Load(data.fAlpha + curr)).store(dfPtr);
+            dfPtr += 4;
+            curr += 4;
+        }
+#endif
+        for (; i < dataWidth-1; ++i) {
 #if DUMP_EDGE
-            float alpha = currData->fAlpha;
+            float alpha = data.fAlpha[curr];
             float edge = 0.0f;
-            if (*currEdge) {
+            if (data.fEdges[curr]) {
                 edge = 0.25f;
             }
             // blend with original image
@@ -442,18 +476,15 @@ static bool generate_distance_field_from_image(unsigned char* distanceField,
             *dfPtr++ = val;
 #else
             float dist;
-            if (currData->fAlpha > 0.5f) {
-                dist = -SkScalarSqrt(currData->fDistSq);
+            if (data.fAlpha[curr] > 0.5f) {
+                dist = -SkScalarSqrt(data.fDistSq[curr]);
             } else {
-                dist = SkScalarSqrt(currData->fDistSq);
+                dist = SkScalarSqrt(data.fDistSq[curr]);
             }
             *dfPtr++ = pack_distance_field_val<SK_DistanceFieldMagnitude>(dist);
 #endif
-            ++currData;
-            ++currEdge;
+            ++curr;
         }
-        currData += 2;
-        currEdge += 2;
     }
 
     return true;
@@ -520,3 +551,46 @@ bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
 
     return generate_distance_field_from_image(distanceField, copyPtr, width, height);
 }
+
+// Batches with at least this many images are split into tasks of kImagesPerTask, which are
+// large enough to pay for running them on another thread.
+static constexpr int kMinImagesForTasks = 32;
+static constexpr int kImagesPerTask = 16;
+
+static bool generate_distance_fields(SkDistanceFieldImage images[], int count) {
+    bool success = true;
+    for (int i = 0; i < count; ++i) {
+        SkDistanceFieldImage& image = images[i];
+        if (!image.fDistanceField || !image.fImage || image.fWidth <= 0 || image.fHeight <= 0) {
+            image.fSuccess = false;
+        } else if (image.fIsBW) {
+            image.fSuccess = SkGenerateDistanceFieldFromBWImage(image.fDistanceField,
+                                                                image.fImage, image.fWidth,
+                                                                image.fHeight, image.fRowBytes);
+        } else {
+            image.fSuccess = SkGenerateDistanceFieldFromA8Image(image.fDistanceField,
+                                                                image.fImage, image.fWidth,
+                                                                image.fHeight, image.fRowBytes);
+        }
+        success &= image.fSuccess;
+    }
+    return success;
+}
+
+bool SkGenerateDistanceFields(SkDistanceFieldImage images[], int count) {
+    if (count < kMinImagesForTasks) {
+        return generate_distance_fields(images, count);
+    }
+
+    int taskCount = (count + kImagesPerTask - 1) / kImagesPerTask;
+    SkTaskGroup().batch(taskCount, [&](int task) {
+        generate_distance_fields(images + task * kImagesPerTask,
+                                 SkTMin(kImagesPerTask, count - task * kImagesPerTask));
+    });
+    for (int i = 0; i < count; ++i) {
+        if (!images[i].fSuccess) {
+            return false;
+        }
+    }
+    return true;
+}
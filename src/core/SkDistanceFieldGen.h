@@ -51,6 +51,29 @@ bool SkGenerateDistanceFieldFromBWImage(unsigned char* distanceField,
                                         const unsigned char* image,
                                         int w, int h, size_t rowBytes);
 
+/** A mask and the distance field to generate from it, for SkGenerateDistanceFields. */
+struct SkDistanceFieldImage {
+    unsigned char*       fDistanceField;  // allocated by the client with the padding above
+    const unsigned char* fImage;
+    int                  fWidth;
+    int                  fHeight;
+    size_t               fRowBytes;
+    bool                 fIsBW;           // fImage is a 1-bit mask rather than an 8-bit one
+    bool                 fSuccess;        // set by SkGenerateDistanceFields
+};
+
+/** Generates the distance field of each image, as SkGenerateDistanceFieldFromA8Image or
+ *  SkGenerateDistanceFieldFromBWImage do. Large batches are split across the threads of
+ *  SkTaskGroup. Needs no GPU context, so fields can be made ahead of time, e.g. for a whole font.
+ *  Each image's fSuccess is set to whether its field was generated; an empty image fails, and
+ *  its field is left untouched, so the caller should skip it as it would a failed single glyph.
+ *
+ *  @param images            The images to generate the distance fields of.
+ *  @param count             The number of images.
+ *  @return                  true if every image succeeded.
+ */
+bool SkGenerateDistanceFields(SkDistanceFieldImage images[], int count);
+
 /** Given width and height of original image, return size (in bytes) of distance field
  *  @param w                 Width of the original image.
  *  @param h                 Height of the original image.
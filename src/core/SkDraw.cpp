@@ -28,6 +28,8 @@
 #include "SkStroke.h"
 #include "SkStrokeRec.h"
 #include "SkTemplates.h"
+#include "SkTextBlobRasterCache.h"
+#include "SkTextBlobRunIterator.h"
 #include "SkTextMapStateProc.h"
 #include "SkTLazy.h"
 #include "SkUtils.h"
@@ -1447,16 +1449,27 @@ void SkDraw::drawText_asPaths(const char text[], size_t byteLength,
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// Collects the visible glyphs of a run and draws them in batches, so that the glyph cache can
+// generate the images of all of a batch's new glyphs together. If placed is not null, every glyph
+// of the run, visible or not, is also appended to it, with its bounds relative to placedOrigin.
+// Call flush() after the run.
 class DrawOneGlyph {
 public:
-    DrawOneGlyph(const SkDraw& draw, const SkPaint& paint, SkGlyphCache* cache, SkBlitter* blitter)
+    typedef SkTextBlobRasterCache::Glyph PlacedGlyph;
+
+    DrawOneGlyph(const SkDraw& draw, const SkPaint& paint, SkGlyphCache* cache, SkBlitter* blitter,
+                 SkTDArray<PlacedGlyph>* placed = nullptr,
+                 SkIPoint placedOrigin = SkIPoint::Make(0, 0))
         : fUseRegionToDraw(UsingRegionToDraw(draw.fRC))
         , fGlyphCache(cache)
         , fBlitter(blitter)
         , fClip(fUseRegionToDraw ? &draw.fRC->bwRgn() : nullptr)
         , fDraw(draw)
         , fPaint(paint)
-        , fClipBounds(PickClipBounds(draw)) { }
+        , fClipBounds(PickClipBounds(draw))
+        , fPlaced(placed)
+        , fPlacedOrigin(placedOrigin)
+        , fCount(0) { }
 
     void operator()(const SkGlyph& glyph, SkPoint position, SkPoint rounding) {
         position += rounding;
@@ -1478,8 +1491,53 @@ public:
         int right   = left + glyph.fWidth;
         int bottom  = top  + glyph.fHeight;
 
+        // The glyph itself may move as the cache adds glyphs, so keep its ID and find it again.
+        PlacedGlyph placed;
+        placed.fGlyphID = glyph.getGlyphID();
+        placed.fSubX    = glyph.getSubXFixed();
+        placed.fSubY    = glyph.getSubYFixed();
+        placed.fBounds  = SkIRect::MakeLTRB(left, top, right, bottom);
+        if (fPlaced) {
+            PlacedGlyph* relative = fPlaced->append();
+            *relative = placed;
+            relative->fBounds.offset(-fPlacedOrigin.fX, -fPlacedOrigin.fY);
+        }
+        this->drawPlaced(placed);
+    }
+
+    // Draws a glyph placed by operator() in an earlier draw with the same matrix and strike.
+    void drawPlaced(const PlacedGlyph& placed) {
+        if (fUseRegionToDraw ? !fClip->intersects(placed.fBounds)
+                             : !SkIRect::IntersectsNoEmptyCheck(placed.fBounds, fClipBounds)) {
+            return;
+        }
+
+        if (kMaxBatchCount == fCount) {
+            this->flush();
+        }
+        fBatch[fCount++] = placed;
+    }
+
+    void flush() {
+        const SkGlyph* glyphs[kMaxBatchCount];
+        for (int i = 0; i < fCount; ++i) {
+            const PlacedGlyph& batched = fBatch[i];
+            glyphs[i] = &fGlyphCache->getGlyphIDMetrics(batched.fGlyphID,
+                                                        batched.fSubX, batched.fSubY);
+        }
+        fGlyphCache->findImages(glyphs, fCount);
+        for (int i = 0; i < fCount; ++i) {
+            this->drawGlyph(*glyphs[i], fBatch[i].fBounds);
+        }
+        fCount = 0;
+    }
+
+private:
+    static const int kMaxBatchCount = 256;
+
+    void drawGlyph(const SkGlyph& glyph, const SkIRect& bounds) {
         SkMask mask;
-        mask.fBounds.set(left, top, right, bottom);
+        mask.fBounds = bounds;
 
         if (fUseRegionToDraw) {
             SkRegion::Cliperator clipper(*fClip, mask.fBounds);
@@ -1493,23 +1551,22 @@ public:
             }
         } else {
             SkIRect  storage;
-            SkIRect* bounds = &mask.fBounds;
+            const SkIRect* clipBounds = &mask.fBounds;
 
             // this extra test is worth it, assuming that most of the time it succeeds
             // since we can avoid writing to storage
             if (!fClipBounds.containsNoEmptyCheck(mask.fBounds)) {
                 if (!storage.intersectNoEmptyCheck(mask.fBounds, fClipBounds))
                     return;
-                bounds = &storage;
+                clipBounds = &storage;
             }
 
             if (this->getImageData(glyph, &mask)) {
-                this->blitMask(mask, *bounds);
+                this->blitMask(mask, *clipBounds);
             }
         }
     }
 
-private:
     static bool UsingRegionToDraw(const SkRasterClip* rClip) {
         return rClip->isBW() && !rClip->isRect();
     }
@@ -1525,7 +1582,7 @@ private:
     }
 
     bool getImageData(const SkGlyph& glyph, SkMask* mask) {
-        uint8_t* bits = (uint8_t*)(fGlyphCache->findImage(glyph));
+        uint8_t* bits = (uint8_t*)(glyph.fImage);
         if (nullptr == bits) {
             return false;  // can't rasterize glyph
         }
@@ -1555,6 +1612,10 @@ private:
     const SkDraw&         fDraw;
     const SkPaint&        fPaint;
     const SkIRect         fClipBounds;
+    SkTDArray<PlacedGlyph>* const fPlaced;
+    const SkIPoint        fPlacedOrigin;
+    PlacedGlyph           fBatch[kMaxBatchCount];
+    int                   fCount;
 };
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1595,6 +1656,7 @@ void SkDraw::drawText(const char text[], size_t byteLength,
     SkFindAndPlaceGlyph::ProcessText(
         paint.getTextEncoding(), text, byteLength,
         {x, y}, *fMatrix, paint.getTextAlign(), cache.get(), drawOneGlyph);
+    drawOneGlyph.flush();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -1624,11 +1686,11 @@ void SkDraw::drawPosText_asPaths(const char text[], size_t byteLength,
     paint.setStyle(origPaint.getStyle());
     paint.setPathEffect(sk_ref_sp(origPaint.getPathEffect()));
 
+    SkPath path;
     while (text < stop) {
         const SkGlyph& glyph = glyphCacheProc(cache.get(), &text);
         if (glyph.fWidth) {
-            const SkPath* path = cache->findPath(glyph);
-            if (path) {
+            if (cache->findPath(glyph, &path)) {
                 SkPoint tmsLoc;
                 tmsProc(pos, &tmsLoc);
                 SkPoint loc;
@@ -1637,9 +1699,9 @@ void SkDraw::drawPosText_asPaths(const char text[], size_t byteLength,
                 matrix[SkMatrix::kMTransX] = loc.fX;
                 matrix[SkMatrix::kMTransY] = loc.fY;
                 if (fDevice) {
-                    fDevice->drawPath(*this, *path, paint, &matrix, false);
+                    fDevice->drawPath(*this, path, paint, &matrix, false);
                 } else {
-                    this->drawPath(*path, paint, &matrix, false);
+                    this->drawPath(path, paint, &matrix, false);
                 }
             }
         }
@@ -1676,6 +1738,99 @@ void SkDraw::drawPosText(const char text[], size_t byteLength,
     SkFindAndPlaceGlyph::ProcessPosText(
         paint.getTextEncoding(), text, byteLength,
         offset, *fMatrix, pos, scalarsPerPosition, textAlignment, cache.get(), drawOneGlyph);
+    drawOneGlyph.flush();
+}
+
+void SkDraw::drawTextBlobRun(const SkTextBlob& blob, int runIndex, const SkTextBlobRunIterator& it,
+                             SkPoint origin, const SkPaint& paint) const {
+    SkASSERT(SkPaint::kGlyphID_TextEncoding == paint.getTextEncoding());
+
+    SkDEBUGCODE(this->validate();)
+
+    const char* text = (const char*)it.glyphs();
+    size_t byteLength = it.glyphCount() * sizeof(uint16_t);
+    const SkPoint& runOffset = it.offset();
+
+    // nothing to draw
+    if (0 == byteLength || fRC->isEmpty()) {
+        return;
+    }
+
+    if (ShouldDrawTextAsPaths(paint, *fMatrix) || fMatrix->hasPerspective()) {
+        switch (it.positioning()) {
+            case SkTextBlob::kDefault_Positioning:
+                this->drawText(text, byteLength, origin.x() + runOffset.x(),
+                               origin.y() + runOffset.y(), paint);
+                break;
+            case SkTextBlob::kHorizontal_Positioning:
+                this->drawPosText(text, byteLength, it.pos(), 1,
+                                  SkPoint::Make(origin.x(), origin.y() + runOffset.y()), paint);
+                break;
+            case SkTextBlob::kFull_Positioning:
+                this->drawPosText(text, byteLength, it.pos(), 2, origin, paint);
+                break;
+        }
+        return;
+    }
+
+    SkAutoGlyphCache cache(paint, &fDevice->surfaceProps(), this->scalerContextFlags(), fMatrix);
+    const SkDescriptor& desc = cache->getDescriptor();
+
+    // The Blitter Choose needs to be live while using the blitter below.
+    SkAutoBlitterChoose    blitterChooser(fDst, *fMatrix, paint);
+    SkAAClipBlitterWrapper wrapper(*fRC, blitterChooser.get());
+
+    // When the run has been drawn with this matrix and strike before, at the same fraction of a
+    // pixel, only blit its glyphs.
+    SkIPoint wholeOrigin;
+    SkVector fractionOrigin;
+    const bool cacheable = SkTextBlobRasterCache::MapOrigin(origin, *fMatrix, &wholeOrigin,
+                                                            &fractionOrigin);
+    sk_sp<SkData> placed;
+    if (cacheable) {
+        placed = SkTextBlobRasterCache::FindRun(blob, runIndex, fractionOrigin, *fMatrix, desc);
+    }
+    if (placed) {
+        DrawOneGlyph drawOneGlyph(*this, paint, cache.get(), wrapper.getBlitter());
+        const DrawOneGlyph::PlacedGlyph* glyphs =
+                static_cast<const DrawOneGlyph::PlacedGlyph*>(placed->data());
+        size_t count = placed->size() / sizeof(DrawOneGlyph::PlacedGlyph);
+        for (size_t i = 0; i < count; ++i) {
+            DrawOneGlyph::PlacedGlyph glyph = glyphs[i];
+            glyph.fBounds.offset(wholeOrigin.fX, wholeOrigin.fY);
+            drawOneGlyph.drawPlaced(glyph);
+        }
+        drawOneGlyph.flush();
+        return;
+    }
+
+    SkTDArray<DrawOneGlyph::PlacedGlyph> glyphs;
+    DrawOneGlyph drawOneGlyph(*this, paint, cache.get(), wrapper.getBlitter(),
+                              cacheable ? &glyphs : nullptr, wholeOrigin);
+    switch (it.positioning()) {
+        case SkTextBlob::kDefault_Positioning:
+            SkFindAndPlaceGlyph::ProcessText(
+                paint.getTextEncoding(), text, byteLength,
+                {origin.x() + runOffset.x(), origin.y() + runOffset.y()}, *fMatrix,
+                paint.getTextAlign(), cache.get(), drawOneGlyph);
+            break;
+        case SkTextBlob::kHorizontal_Positioning:
+            SkFindAndPlaceGlyph::ProcessPosText(
+                paint.getTextEncoding(), text, byteLength,
+                SkPoint::Make(origin.x(), origin.y() + runOffset.y()), *fMatrix, it.pos(), 1,
+                paint.getTextAlign(), cache.get(), drawOneGlyph);
+            break;
+        case SkTextBlob::kFull_Positioning:
+            SkFindAndPlaceGlyph::ProcessPosText(
+                paint.getTextEncoding(), text, byteLength,
+                origin, *fMatrix, it.pos(), 2, paint.getTextAlign(), cache.get(), drawOneGlyph);
+            break;
+    }
+    drawOneGlyph.flush();
+    if (cacheable) {
+        SkTextBlobRasterCache::AddRun(blob, runIndex, fractionOrigin, *fMatrix, desc,
+                                      SkData::MakeWithCopy(glyphs.begin(), glyphs.bytes()));
+    }
 }
 
 #if defined _WIN32
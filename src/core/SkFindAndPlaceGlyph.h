@@ -11,6 +11,7 @@
 #include "SkAutoKern.h"
 #include "SkGlyph.h"
 #include "SkGlyphCache.h"
+#include "SkNx.h"
 #include "SkPaint.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
@@ -64,6 +65,8 @@ public:
     //   to a whole coordinate instead of using sub-pixel positioning.
     // The number of variations is 108 for sub-pixel and 36 for full-pixel.
     // This routine handles all of them using inline polymorphic variable (no heap allocation).
+    // Left aligned text with a scale and translate matrix, the common case, is handled in batches
+    // by ProcessPosTextBatched instead.
     template<typename ProcessOneGlyph>
     static void ProcessPosText(
         SkPaint::TextEncoding, const char text[], size_t byteLength,
@@ -563,6 +566,48 @@ private:
         }
     }
 
+    // The most glyphs ProcessPosTextBatched finds and places at once.
+    static const int kMaxGlyphsPerBatch = 64;
+
+    // TextToGlyphIDs converts up to maxCount characters of text, before stop, to glyph IDs,
+    // advancing text past them. Returns the number of glyph IDs.
+    static int TextToGlyphIDs(SkPaint::TextEncoding textEncoding, const char** text,
+                              const char* stop, SkGlyphCache* cache,
+                              uint16_t glyphIDs[], int maxCount) {
+        int count = 0;
+        switch (textEncoding) {
+            case SkPaint::kUTF8_TextEncoding:
+                for (; count < maxCount && *text < stop; ++count) {
+                    glyphIDs[count] = cache->unicharToGlyph(SkUTF8_NextUnichar(text));
+                }
+                break;
+            case SkPaint::kUTF16_TextEncoding:
+                for (; count < maxCount && *text < stop; ++count) {
+                    glyphIDs[count] = cache->unicharToGlyph(
+                        SkUTF16_NextUnichar((const uint16_t**)text));
+                }
+                break;
+            case SkPaint::kUTF32_TextEncoding:
+                for (; count < maxCount && *text < stop; ++count) {
+                    glyphIDs[count] = cache->unicharToGlyph(*(const int32_t*)*text);
+                    *text += sizeof(int32_t);
+                }
+                break;
+            case SkPaint::kGlyphID_TextEncoding:
+                count = SkTMin(maxCount, SkToInt((stop - *text) / sizeof(uint16_t)));
+                memcpy(glyphIDs, *text, count * sizeof(uint16_t));
+                *text += count * sizeof(uint16_t);
+                break;
+        }
+        return count;
+    }
+
+    template<typename ProcessOneGlyph>
+    static void ProcessPosTextBatched(
+        SkPaint::TextEncoding, const char text[], size_t byteLength,
+        SkPoint offset, const SkMatrix& matrix, const SkScalar pos[], int scalarsPerPosition,
+        SkAxisAlignment axisAlignment, SkGlyphCache* cache, ProcessOneGlyph&& processOneGlyph);
+
     static SkPoint MeasureText(LookupGlyph& glyphFinder, const char text[], size_t byteLength) {
         SkScalar    x = 0, y = 0;
         const char* stop = text + byteLength;
@@ -591,31 +636,17 @@ inline void SkFindAndPlaceGlyph::ProcessPosText(
 
     SkAxisAlignment axisAlignment = cache->getScalerContext()->computeAxisAlignmentForHText();
     uint32_t mtype = matrix.getType();
-    LookupGlyph glyphFinder(textEncoding, cache);
 
-    // Specialized code for handling the most common case for blink. The while loop is totally
-    // de-virtualized.
-    if (scalarsPerPosition == 1
-        && textAlignment == SkPaint::kLeft_Align
-        && axisAlignment == kX_SkAxisAlignment
-        && cache->isSubpixel()
-        && mtype <= SkMatrix::kTranslate_Mask) {
-        typedef GlyphFindAndPlaceSubpixel<
-            ProcessOneGlyph, SkPaint::kLeft_Align, kX_SkAxisAlignment> Positioner;
-        HorizontalPositions positions{pos};
-        TranslationMapper mapper{matrix, offset};
-        Positioner positioner(glyphFinder);
-        const char* cursor = text;
-        const char* stop = text + byteLength;
-        while (cursor < stop) {
-            SkPoint mappedPoint = mapper.TranslationMapper::map(
-                positions.HorizontalPositions::nextPoint());
-            positioner.Positioner::findAndPositionGlyph(
-                &cursor, mappedPoint, std::forward<ProcessOneGlyph>(processOneGlyph));
-        }
+    if (textAlignment == SkPaint::kLeft_Align
+        && !(mtype & (SkMatrix::kAffine_Mask | SkMatrix::kPerspective_Mask))) {
+        ProcessPosTextBatched(
+            textEncoding, text, byteLength, offset, matrix, pos, scalarsPerPosition,
+            axisAlignment, cache, std::forward<ProcessOneGlyph>(processOneGlyph));
         return;
     }
 
+    LookupGlyph glyphFinder(textEncoding, cache);
+
     PositionReader positionReader{
         [&](PositionReader::Variants* to_init) {
             if (2 == scalarsPerPosition) {
@@ -687,6 +718,73 @@ inline void SkFindAndPlaceGlyph::ProcessPosText(
     }
 }
 
+// ProcessPosTextBatched finds and places up to kMaxGlyphsPerBatch glyphs at a time. It converts
+// their text to glyph IDs, maps their positions to device space and computes their sub-pixel
+// positions two points at a time, and then looks each glyph up in the cache. The matrix may only
+// scale and translate, and the text must be left aligned.
+template<typename ProcessOneGlyph>
+inline void SkFindAndPlaceGlyph::ProcessPosTextBatched(
+    SkPaint::TextEncoding textEncoding, const char text[], size_t byteLength,
+    SkPoint offset, const SkMatrix& matrix, const SkScalar pos[], int scalarsPerPosition,
+    SkAxisAlignment axisAlignment, SkGlyphCache* cache, ProcessOneGlyph&& processOneGlyph) {
+    SkASSERT(!(matrix.getType() & (SkMatrix::kAffine_Mask | SkMatrix::kPerspective_Mask)));
+
+    // Positions are mapped as in GeneralMapper, and sub-pixel positions are found as in
+    // SubpixelAlignment, which leaves out the sub-pixel position along the aligned axis.
+    const bool isSubpixel = cache->isSubpixel();
+    const SkPoint rounding = isSubpixel ? SubpixelPositionRounding(axisAlignment)
+                                        : SkPoint{SK_ScalarHalf, SK_ScalarHalf};
+    const float subX = isSubpixel && axisAlignment != kY_SkAxisAlignment ? SK_Fixed1 : 0;
+    const float subY = isSubpixel && axisAlignment != kX_SkAxisAlignment ? SK_Fixed1 : 0;
+    const SkPoint origin = matrix.mapXY(offset.fX, offset.fY);
+    const Sk4f scale(matrix.getScaleX(), matrix.getScaleY(),
+                     matrix.getScaleX(), matrix.getScaleY());
+    const Sk4f translate(origin.fX, origin.fY, origin.fX, origin.fY);
+    const Sk4f subpixelRounding(SkFixedToScalar(SkGlyph::kSubpixelRound));
+    const Sk4f subpixelScale(subX, subY, subX, subY);
+
+    // The arrays hold an even number of points, so the last pair may be written whole.
+    uint16_t glyphIDs[kMaxGlyphsPerBatch];
+    SkPoint  positions[kMaxGlyphsPerBatch];
+    SkIPoint subpixels[kMaxGlyphsPerBatch];
+    static_assert(0 == kMaxGlyphsPerBatch % 2, "Points are mapped in pairs.");
+
+    // A trailing odd byte of glyph ID text is not a glyph, and would never be consumed.
+    const char* stop = text + byteLength;
+    if (SkPaint::kGlyphID_TextEncoding == textEncoding) {
+        stop -= byteLength & 1;
+    }
+    while (text < stop) {
+        const int count =
+            TextToGlyphIDs(textEncoding, &text, stop, cache, glyphIDs, kMaxGlyphsPerBatch);
+
+        for (int i = 0; i < count; i += 2) {
+            const bool isPair = i + 1 < count;
+            Sk4f points;
+            if (1 == scalarsPerPosition) {
+                points = Sk4f(pos[i], 0, isPair ? pos[i + 1] : 0, 0);
+            } else if (isPair) {
+                points = Sk4f::Load(pos + 2 * i);
+            } else {
+                points = Sk4f(pos[2 * i], pos[2 * i + 1], 0, 0);
+            }
+            points = points * scale + translate;
+            points.store(&positions[i]);
+            SkNx_cast<int>((points - points.floor() + subpixelRounding) * subpixelScale)
+                .store(&subpixels[i]);
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const SkGlyph& glyph =
+                cache->getGlyphIDMetrics(glyphIDs[i], subpixels[i].fX, subpixels[i].fY);
+            if (glyph.fWidth > 0) {
+                processOneGlyph(glyph, positions[i], rounding);
+            }
+        }
+        pos += count * scalarsPerPosition;
+    }
+}
+
 template<typename ProcessOneGlyph>
 inline void SkFindAndPlaceGlyph::ProcessText(
     SkPaint::TextEncoding textEncoding, const char text[], size_t byteLength,
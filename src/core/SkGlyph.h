@@ -13,6 +13,7 @@
 #include "SkFixed.h"
 #include "SkMask.h"
 
+class SkCompactPath;
 class SkPath;
 class SkGlyphCache;
 
@@ -45,9 +46,12 @@ class SkGlyph {
         SkScalar   fInterval[2];  // the outside intersections of the axis and the glyph
     };
 
+    // The outline is kept as an SkCompactPath when that holds it exactly, and as an SkPath
+    // otherwise; the other is null.
     struct PathData {
-        Intercept* fIntercept;
-        SkPath*    fPath;
+        Intercept*      fIntercept;
+        SkPath*         fPath;
+        SkCompactPath*  fCompactPath;
     };
 
 public:
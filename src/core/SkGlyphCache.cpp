@@ -6,10 +6,13 @@
  */
 
 #include "SkGlyphCache.h"
+#include "SkCompactPath.h"
 #include "SkGlyphCache_Globals.h"
 #include "SkGraphics.h"
 #include "SkOnce.h"
 #include "SkPath.h"
+#include "SkTArray.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkTraceMemoryDump.h"
 #include "SkTypeface.h"
@@ -38,7 +41,8 @@ static SkGlyphCache_Globals& get_globals() {
 #define kMinGlyphImageSize  (16*2)
 #define kMinAllocAmount     ((sizeof(SkGlyph) + kMinGlyphImageSize) * kMinGlyphCount)
 
-SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkScalerContext* ctx)
+SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkScalerContext* ctx,
+                           sk_sp<SkSharedGlyphStore> sharedStore)
     : fDesc(desc->copy())
     , fScalerContext(ctx)
     , fGlyphAlloc(kMinAllocAmount) {
@@ -53,12 +57,25 @@ SkGlyphCache::SkGlyphCache(SkTypeface* typeface, const SkDescriptor* desc, SkSca
     fMemoryUsed = sizeof(*this);
 
     fAuxProcList = nullptr;
+
+    fSharedStrike = 0;
+    fSharedStore = std::move(sharedStore);
+    if (fSharedStore) {
+        sk_sp<SkData> key(SkSharedGlyphStore::MakeStrikeKey(fScalerContext, *desc));
+        if (key) {
+            fSharedStrike = fSharedStore->findOrAddStrike(*key);
+        }
+        if (!fSharedStrike) {
+            fSharedStore = nullptr;
+        }
+    }
 }
 
 SkGlyphCache::~SkGlyphCache() {
     fGlyphMap.foreach ([](SkGlyph* g) {
         if (g->fPathData) {
             delete g->fPathData->fPath;
+            delete g->fPathData->fCompactPath;
         } } );
     SkDescriptor::Free(fDesc);
     delete fScalerContext;
@@ -91,13 +108,14 @@ SkGlyphCache::CharGlyphRec* SkGlyphCache::getCharGlyphRec(PackedUnicharID packed
 uint16_t SkGlyphCache::unicharToGlyph(SkUnichar charCode) {
     VALIDATE();
     PackedUnicharID packedUnicharID = SkGlyph::MakeID(charCode);
-    const CharGlyphRec& rec = *this->getCharGlyphRec(packedUnicharID);
+    CharGlyphRec* rec = this->getCharGlyphRec(packedUnicharID);
 
-    if (rec.fPackedUnicharID == packedUnicharID) {
-        return SkGlyph::ID2Code(rec.fPackedGlyphID);
-    } else {
-        return fScalerContext->charToGlyphID(charCode);
+    if (rec->fPackedUnicharID != packedUnicharID) {
+        // Remember the glyph, as lookupByChar does, since text is converted a character at a time.
+        rec->fPackedUnicharID = packedUnicharID;
+        rec->fPackedGlyphID = SkGlyph::MakeID(fScalerContext->charToGlyphID(charCode));
     }
+    return SkGlyph::ID2Code(rec->fPackedGlyphID);
 }
 
 SkUnichar SkGlyphCache::glyphToUnichar(uint16_t glyphID) {
@@ -164,14 +182,22 @@ SkGlyph* SkGlyphCache::lookupByChar(SkUnichar charCode, MetricsType type, SkFixe
     }
 }
 
+static bool can_have_image(const SkGlyph& glyph) {
+    return glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth;
+}
+
 SkGlyph* SkGlyphCache::lookupByPackedGlyphID(PackedGlyphID packedGlyphID, MetricsType type) {
     SkGlyph* glyph = fGlyphMap.find(packedGlyphID);
 
     if (nullptr == glyph) {
         glyph = this->allocateNewGlyph(packedGlyphID, type);
     } else {
-        if (type == kFull_MetricsType && glyph->isJustAdvance()) {
+        if (type == kFull_MetricsType && glyph->isJustAdvance() &&
+            !this->findSharedGlyph(glyph)) {
            fScalerContext->getMetrics(glyph);
+           if (!can_have_image(*glyph)) {
+               this->shareGlyphs(&glyph, 1);
+           }
         }
     }
     return glyph;
@@ -187,20 +213,55 @@ SkGlyph* SkGlyphCache::allocateNewGlyph(PackedGlyphID packedGlyphID, MetricsType
         glyphPtr = fGlyphMap.set(glyph);
     }
 
-    if (kJustAdvance_MetricsType == mtype) {
+    if (this->findSharedGlyph(glyphPtr)) {
+        // The shared store has full metrics, which are fine for either type.
+    } else if (kJustAdvance_MetricsType == mtype) {
         fScalerContext->getAdvance(glyphPtr);
     } else {
         SkASSERT(kFull_MetricsType == mtype);
         fScalerContext->getMetrics(glyphPtr);
+        // Glyphs with images are shared once they have them.
+        if (!can_have_image(*glyphPtr)) {
+            this->shareGlyphs(&glyphPtr, 1);
+        }
     }
 
     SkASSERT(glyphPtr->fID != SkGlyph::kImpossibleID);
     return glyphPtr;
 }
 
+bool SkGlyphCache::findSharedGlyph(SkGlyph* glyph) const {
+    return fSharedStore && fSharedStore->findGlyph(fSharedStrike, glyph->fID, glyph);
+}
+
+bool SkGlyphCache::findSharedImage(const SkGlyph& glyph) const {
+    SkGlyph shared;
+    if (!fSharedStore || !fSharedStore->findGlyph(fSharedStrike, glyph.fID, &shared) ||
+        !shared.fImage) {
+        return false;
+    }
+    SkASSERT(shared.fWidth == glyph.fWidth && shared.fHeight == glyph.fHeight);
+    // The scaler may have changed the mask format when it made the image.
+    const_cast<SkGlyph&>(glyph).fMaskFormat = shared.fMaskFormat;
+    const_cast<SkGlyph&>(glyph).fImage = shared.fImage;
+    return true;
+}
+
+void SkGlyphCache::shareGlyphs(const SkGlyph* const glyphs[], int count) {
+    if (!fSharedStore) {
+        return;
+    }
+    SkAutoSTMalloc<64, uint32_t> packedIDs(count);
+    for (int i = 0; i < count; ++i) {
+        SkASSERT(glyphs[i]->isFullMetrics());
+        packedIDs[i] = glyphs[i]->fID;
+    }
+    fSharedStore->addGlyphs(fSharedStrike, packedIDs.get(), glyphs, count);
+}
+
 const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
-    if (glyph.fWidth > 0 && glyph.fWidth < kMaxGlyphWidth) {
-        if (nullptr == glyph.fImage) {
+    if (can_have_image(glyph)) {
+        if (nullptr == glyph.fImage && !this->findSharedImage(glyph)) {
             size_t  size = glyph.computeImageSize();
             const_cast<SkGlyph&>(glyph).fImage = fGlyphAlloc.alloc(size,
                                         SkChunkAlloc::kReturnNil_AllocFailType);
@@ -212,25 +273,98 @@ const void* SkGlyphCache::findImage(const SkGlyph& glyph) {
                 // overallocated the buffer. Check if the new computedImageSize
                 // is smaller, and if so, strink the alloc size in fImageAlloc.
                 fMemoryUsed += size;
+                const SkGlyph* glyphPtr = &glyph;
+                this->shareGlyphs(&glyphPtr, 1);
             }
         }
     }
     return glyph.fImage;
 }
 
-const SkPath* SkGlyphCache::findPath(const SkGlyph& glyph) {
-    if (glyph.fWidth) {
-        if (glyph.fPathData == nullptr) {
-            SkGlyph::PathData* pathData =
-                    (SkGlyph::PathData* ) fGlyphAlloc.allocThrow(sizeof(SkGlyph::PathData));
-            const_cast<SkGlyph&>(glyph).fPathData = pathData;
-            pathData->fIntercept = nullptr;
-            SkPath* path = pathData->fPath = new SkPath;
-            fScalerContext->getPath(glyph, path);
-            fMemoryUsed += sizeof(SkPath) + path->countPoints() * sizeof(SkPoint);
+// Batches with at least this many glyphs to generate are split into tasks of kGlyphsPerTask.
+// Each task after the first makes its own scaler context, so they must be large enough to pay
+// for that.
+static constexpr int kMinGlyphsForTasks = 128;
+static constexpr int kGlyphsPerTask = 64;
+
+void SkGlyphCache::findImages(const SkGlyph* const glyphs[], int count) {
+    SkSTArray<64, const SkGlyph*, true> missing;
+    for (int i = 0; i < count; ++i) {
+        const SkGlyph& glyph = *glyphs[i];
+        if (can_have_image(glyph) && nullptr == glyph.fImage && !this->findSharedImage(glyph)) {
+            size_t  size = glyph.computeImageSize();
+            const_cast<SkGlyph&>(glyph).fImage = fGlyphAlloc.alloc(size,
+                                        SkChunkAlloc::kReturnNil_AllocFailType);
+            // check that alloc() actually succeeded
+            if (glyph.fImage) {
+                missing.push_back(&glyph);
+                fMemoryUsed += size;
+            }
         }
     }
-    return glyph.fPathData ? glyph.fPathData->fPath : nullptr;
+
+    if (missing.count() < kMinGlyphsForTasks) {
+        fScalerContext->getImages(missing.begin(), missing.count());
+        this->shareGlyphs(missing.begin(), missing.count());
+        return;
+    }
+
+    // The other tasks' contexts are made from our descriptor, so they make the same images.
+    int taskCount = (missing.count() + kGlyphsPerTask - 1) / kGlyphsPerTask;
+    SkTaskGroup().batch(taskCount, [&](int task) {
+        const SkGlyph* const* taskGlyphs = missing.begin() + task * kGlyphsPerTask;
+        int taskGlyphCount = SkTMin(kGlyphsPerTask, missing.count() - task * kGlyphsPerTask);
+        if (0 == task) {
+            fScalerContext->getImages(taskGlyphs, taskGlyphCount);
+            return;
+        }
+        SkAutoTDelete<SkScalerContext> context(fScalerContext->getTypeface()->createScalerContext(
+                fScalerContext->getEffects(), fDesc));
+        context->getImages(taskGlyphs, taskGlyphCount);
+    });
+    this->shareGlyphs(missing.begin(), missing.count());
+}
+
+bool SkGlyphCache::findPath(const SkGlyph& glyph, SkPath* path) {
+    if (!glyph.fWidth) {
+        return false;
+    }
+    if (glyph.fPathData == nullptr) {
+        SkGlyph::PathData* pathData =
+                (SkGlyph::PathData* ) fGlyphAlloc.allocThrow(sizeof(SkGlyph::PathData));
+        const_cast<SkGlyph&>(glyph).fPathData = pathData;
+        pathData->fIntercept = nullptr;
+        pathData->fPath = nullptr;
+        SkPath outline;
+        if (!fSharedStore || !fSharedStore->findPath(fSharedStrike, glyph.fID, &outline)) {
+            fScalerContext->getPath(glyph, &outline);
+            if (fSharedStore) {
+                // The path is added to the glyph's entry, which glyphs drawn only as paths
+                // do not have yet.
+                const SkGlyph* glyphPtr = &glyph;
+                this->shareGlyphs(&glyphPtr, 1);
+                fSharedStore->addPath(fSharedStrike, glyph.fID, outline);
+            }
+        }
+        // Font outlines are usually on a 26.6 or integer grid, which SkCompactPath holds exactly
+        // in about three quarters of the memory.
+        pathData->fCompactPath = SkCompactPath::Create(outline);
+        if (pathData->fCompactPath) {
+            fMemoryUsed += pathData->fCompactPath->approximateBytesUsed();
+        } else {
+            pathData->fPath = new SkPath(outline);
+            fMemoryUsed += sizeof(SkPath) + outline.countPoints() * sizeof(SkPoint);
+        }
+    }
+    if (path) {
+        const SkGlyph::PathData* pathData = glyph.fPathData;
+        if (pathData->fCompactPath) {
+            pathData->fCompactPath->toPath(path);
+        } else {
+            *path = *pathData->fPath;
+        }
+    }
+    return true;
 }
 
 #include "../pathops/SkPathOpsCubic.h"
@@ -350,7 +484,12 @@ void SkGlyphCache::findIntercepts(const SkScalar bounds[2], SkScalar scale, SkSc
     intercept->fInterval[0] = SK_ScalarMax;
     intercept->fInterval[1] = SK_ScalarMin;
     glyph->fPathData->fIntercept = intercept;
+    SkPath decoded;
     const SkPath* path = glyph->fPathData->fPath;
+    if (!path) {
+        glyph->fPathData->fCompactPath->toPath(&decoded);
+        path = &decoded;
+    }
     const SkRect& pathBounds = path->getBounds();
     if (*(&pathBounds.fBottom - yAxis) < bounds[0] || bounds[1] < *(&pathBounds.fTop - yAxis)) {
         return;
@@ -504,6 +643,17 @@ void SkGlyphCache_Globals::purgeAll() {
     this->internalPurge(fTotalMemoryUsed);
 }
 
+sk_sp<SkSharedGlyphStore> SkGlyphCache_Globals::getSharedGlyphStore() {
+    Exclusive ac(fLock);
+    return fSharedGlyphStore;
+}
+
+void SkGlyphCache_Globals::setSharedGlyphStore(sk_sp<SkSharedGlyphStore> store) {
+    Exclusive ac(fLock);
+    fSharedGlyphStore = std::move(store);
+    this->internalPurge(fTotalMemoryUsed);
+}
+
 /*  This guy calls the visitor from within the mutext lock, so the visitor
     cannot:
     - take too much time
@@ -562,7 +712,7 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
             ctx = typeface->createScalerContext(effects, desc, false);
             SkASSERT(ctx);
         }
-        cache = new SkGlyphCache(typeface, desc, ctx);
+        cache = new SkGlyphCache(typeface, desc, ctx, globals.getSharedGlyphStore());
     }
 
     AutoValidate av(cache);
@@ -574,6 +724,10 @@ SkGlyphCache* SkGlyphCache::VisitCache(SkTypeface* typeface,
     return cache;
 }
 
+void SkGlyphCache::SetSharedGlyphStore(sk_sp<SkSharedGlyphStore> store) {
+    get_globals().setSharedGlyphStore(std::move(store));
+}
+
 void SkGlyphCache::AttachCache(SkGlyphCache* cache) {
     SkASSERT(cache);
     SkASSERT(cache->fNext == nullptr);
@@ -826,6 +980,24 @@ int SkGraphics::GetFontCacheCountUsed() {
     return get_globals().getCacheCountUsed();
 }
 
+bool SkGraphics::SetFontCacheSharedMemory(const char name[], size_t bytes) {
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(name, bytes));
+    if (!store) {
+        return false;
+    }
+    SkGlyphCache::SetSharedGlyphStore(std::move(store));
+    return true;
+}
+
+bool SkGraphics::SetFontCacheFile(const char path[], size_t bytes) {
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::MakeFromFile(path, bytes));
+    if (!store) {
+        return false;
+    }
+    SkGlyphCache::SetSharedGlyphStore(std::move(store));
+    return true;
+}
+
 void SkGraphics::PurgeFontCache() {
     get_globals().purgeAll();
     SkTypefaceCache::PurgeAll();
@@ -14,6 +14,7 @@
 #include "SkPaint.h"
 #include "SkTHash.h"
 #include "SkScalerContext.h"
+#include "SkSharedGlyphStore.h"
 #include "SkTemplates.h"
 #include "SkTDArray.h"
 
@@ -57,7 +58,8 @@ public:
     const SkGlyph& getGlyphIDMetrics(uint16_t, SkFixed x, SkFixed y);
 
     /** Return the glyphID for the specified Unichar. If the char has already been seen, use the
-        existing cache entry. If not, ask the scalercontext to compute it for us.
+        existing cache entry. If not, ask the scalercontext to compute it for us, and add it to
+        the cache.
     */
     uint16_t unicharToGlyph(SkUnichar);
 
@@ -77,16 +79,24 @@ public:
     */
     const void* findImage(const SkGlyph&);
 
+    /** Generates the images of any of the glyphs that do not have one yet, as findImage would,
+        but all at once. Large batches are split between several scaler contexts on an
+        SkTaskGroup. Afterwards each glyph's fImage is its image, or null if it has none.
+        No glyphs may be added to the strike while the caller holds the glyph pointers.
+    */
+    void findImages(const SkGlyph* const glyphs[], int count);
+
     /** If the advance axis intersects the glyph's path, append the positions scaled and offset
         to the array (if non-null), and set the count to the updated array length.
     */
     void findIntercepts(const SkScalar bounds[2], SkScalar scale, SkScalar xPos,
                         bool yAxis, SkGlyph* , SkScalar* array, int* count);
 
-    /** Return the Path associated with the glyph. If it has not been generated this will trigger
-        that.
+    /** Sets path, if it is not null, to the outline of the glyph, and returns true, or returns
+        false if the glyph has no outline. If it has not been generated this will trigger that.
+        Outlines are cached compactly where possible, so each call decodes a copy.
     */
-    const SkPath* findPath(const SkGlyph&);
+    bool findPath(const SkGlyph&, SkPath* path);
 
     /** Return the vertical metrics for this strike.
     */
@@ -151,6 +161,12 @@ public:
         return VisitCache(typeface, effects, desc, DetachProc, nullptr);
     }
 
+    /** Makes the strikes created from now on look up glyphs in store before generating them, and
+        add the glyphs they generate to it. Purges the cache, so that strikes made with a previous
+        store are not reused. Pass nullptr to stop sharing glyphs.
+    */
+    static void SetSharedGlyphStore(sk_sp<SkSharedGlyphStore> store);
+
     static void Dump();
 
     /** Dump memory usage statistics of all the attaches caches in the process using the
@@ -188,6 +204,7 @@ public:
 
 private:
     friend class SkGlyphCache_Globals;
+    friend class SkGlyphCacheTestingAccess; // for testing
 
     enum MetricsType {
         kJustAdvance_MetricsType,
@@ -214,8 +231,10 @@ private:
         void* fData;
     };
 
-    // SkGlyphCache takes ownership of the scalercontext.
-    SkGlyphCache(SkTypeface*, const SkDescriptor*, SkScalerContext*);
+    // SkGlyphCache takes ownership of the scalercontext. Glyphs are shared through sharedStore,
+    // if it is not null.
+    SkGlyphCache(SkTypeface*, const SkDescriptor*, SkScalerContext*,
+                 sk_sp<SkSharedGlyphStore> sharedStore);
     ~SkGlyphCache();
 
     // Return the SkGlyph* associated with MakeID. The id parameter is the
@@ -238,6 +257,13 @@ private:
 
     void invokeAndRemoveAuxProcs();
 
+    // Sets glyph's metrics, and its image if it has one, from the shared store, if it has it.
+    bool findSharedGlyph(SkGlyph* glyph) const;
+    // Sets glyph's image from the shared store, if it has one.
+    bool findSharedImage(const SkGlyph& glyph) const;
+    // Adds glyphs, which have full metrics, to the shared store.
+    void shareGlyphs(const SkGlyph* const glyphs[], int count);
+
     inline static SkGlyphCache* FindTail(SkGlyphCache* head);
 
     static void OffsetResults(const SkGlyph::Intercept* intercept, SkScalar scale,
@@ -271,6 +297,10 @@ private:
     size_t                 fMemoryUsed;
 
     AuxProcRec*            fAuxProcList;
+
+    // The store of glyphs shared with other processes, and this strike in it, if any.
+    sk_sp<SkSharedGlyphStore>   fSharedStore;
+    SkSharedGlyphStore::StrikeID fSharedStrike;
 };
 
 class SkAutoGlyphCache : public std::unique_ptr<SkGlyphCache, SkGlyphCache::AttachCacheFunctor> {
@@ -71,6 +71,9 @@ public:
 
     void purgeAll(); // does not change budget
 
+    sk_sp<SkSharedGlyphStore> getSharedGlyphStore();
+    void setSharedGlyphStore(sk_sp<SkSharedGlyphStore>);
+
     // call when a glyphcache is available for caching (i.e. not in use)
     void attachCacheToHead(SkGlyphCache*);
 
@@ -84,6 +87,7 @@ private:
     size_t  fCacheSizeLimit;
     int32_t fCacheCountLimit;
     int32_t fCacheCount;
+    sk_sp<SkSharedGlyphStore> fSharedGlyphStore;
 
     // Checkout budgets, modulated by the specified min-bytes-needed-to-purge,
     // and attempt to purge caches to match.
@@ -7,10 +7,12 @@
 
 #include "SkBitmap.h"
 #include "SkBitmapCache.h"
+#include "SkBitmapScaler.h"
 #include "SkImage_Base.h"
 #include "SkImageCacherator.h"
 #include "SkMallocPixelRef.h"
 #include "SkNextID.h"
+#include "SkOpts.h"
 #include "SkPixelRef.h"
 #include "SkResourceCache.h"
 
@@ -76,6 +78,14 @@ SkImageCacherator::SkImageCacherator(SkImageGenerator* gen, const SkImageInfo& i
     , fUniqueID(uniqueID)
 {}
 
+SkImageCacherator::~SkImageCacherator() {
+    // The prefetch tasks use this, so they must all finish first.
+    for (Prefetch* prefetch : fPrefetches) {
+        prefetch->fTasks.wait();
+        delete prefetch;
+    }
+}
+
 SkData* SkImageCacherator::refEncoded(GrContext* ctx) {
     ScopedGenerator generator(this);
     return generator->refEncodedData(ctx);
@@ -91,9 +101,7 @@ static bool check_output_bitmap(const SkBitmap& bitmap, uint32_t expectedID) {
 // Note, this returns a new, mutable, bitmap, with a new genID.
 // If you want the immutable bitmap with the same ID as our cacherator, call tryLockAsBitmap()
 //
-bool SkImageCacherator::generateBitmap(SkBitmap* bitmap) {
-    SkBitmap::Allocator* allocator = SkResourceCache::GetAllocator();
-
+bool SkImageCacherator::generateBitmap(SkBitmap* bitmap, SkBitmap::Allocator* allocator) {
     ScopedGenerator generator(this);
     const SkImageInfo& genInfo = generator->getInfo();
     if (fInfo.dimensions() == genInfo.dimensions()) {
@@ -138,7 +146,12 @@ bool SkImageCacherator::tryLockAsBitmap(SkBitmap* bitmap, const SkImage* client,
     if (this->lockAsBitmapOnlyIfAlreadyCached(bitmap)) {
         return true;
     }
-    if (!this->generateBitmap(bitmap)) {
+    // If a prefetch is generating the pixels, let it finish rather than generate them twice.
+    this->waitForPrefetch(fInfo.dimensions());
+    if (this->lockAsBitmapOnlyIfAlreadyCached(bitmap)) {
+        return true;
+    }
+    if (!this->generateBitmap(bitmap, SkResourceCache::GetAllocator())) {
         return false;
     }
 
@@ -152,6 +165,261 @@ bool SkImageCacherator::tryLockAsBitmap(SkBitmap* bitmap, const SkImage* client,
     return true;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Generates a copy of the pixels scaled to size. Generators that can scale themselves (e.g.
+// pictures) produce it directly; otherwise we generate the whole thing and resize it.
+bool SkImageCacherator::generateScaledBitmap(SkBitmap* bitmap, const SkISize& size,
+                                             SkBitmap::Allocator* allocator) {
+    const SkImageInfo info = SkImageInfo::MakeN32(size.width(), size.height(),
+                                                  fInfo.isOpaque() ? kOpaque_SkAlphaType
+                                                                   : kPremul_SkAlphaType);
+    {
+        ScopedGenerator generator(this);
+        if (fInfo.dimensions() == generator->getInfo().dimensions()) {
+            SkPixmap pixmap;
+            bitmap->setInfo(info);
+            if (bitmap->tryAllocPixels(allocator, nullptr) && bitmap->peekPixels(&pixmap) &&
+                    generator->generateScaledPixels(pixmap)) {
+                return true;
+            }
+        }
+    }
+    SkBitmap full, fullN32;
+    if (!this->generateBitmap(&full, nullptr)) {
+        return false;
+    }
+    if (kN32_SkColorType != full.colorType()) {
+        if (!full.copyTo(&fullN32, kN32_SkColorType)) {
+            return false;
+        }
+        full.swap(fullN32);
+    }
+    SkAutoPixmapUnlock src;
+    return full.requestLock(&src) &&
+           SkBitmapScaler::Resize(bitmap, src.pixmap(), SkBitmapScaler::RESIZE_MITCHELL,
+                                  size.width(), size.height(), allocator);
+}
+
+SkBitmapCacheDesc SkImageCacherator::scaledCacheDesc(const SkISize& size) const {
+    // Matches SkBitmapCacheDesc::Make(image, width, height) for the image that owns us.
+    SkBitmapCacheDesc desc;
+    desc.fImageID = fUniqueID;
+    desc.fWidth = size.width();
+    desc.fHeight = size.height();
+    desc.fBounds = SkIRect::MakeWH(fInfo.width(), fInfo.height());
+    return desc;
+}
+
+void SkImageCacherator::prefetch(const SkISize& size, const SkImage* client) {
+    if (size.isEmpty() || size.width() > fInfo.width() || size.height() > fInfo.height()) {
+        return;
+    }
+    const bool fullSize = fInfo.dimensions() == size;
+
+    Prefetch* prefetch = nullptr;
+    {
+        SkAutoMutexAcquire lock(fPrefetchMutex);
+        for (Prefetch* p : fPrefetches) {
+            if (p->fSize == size) {
+                prefetch = p;
+                break;
+            }
+        }
+        if (prefetch && prefetch->fRunning) {
+            return;
+        }
+        if (!prefetch) {
+            prefetch = new Prefetch;
+            prefetch->fSize = size;
+            *fPrefetches.append() = prefetch;
+        }
+        prefetch->fRunning = true;
+    }
+
+    prefetch->fTasks.add([this, prefetch, fullSize, client] {
+        SkBitmap bitmap;
+        bool cached = fullSize ? this->lockAsBitmapOnlyIfAlreadyCached(&bitmap)
+                               : SkBitmapCache::FindWH(this->scaledCacheDesc(prefetch->fSize),
+                                                       &bitmap);
+        if (!cached) {
+            SkBitmap::Allocator* allocator = SkResourceCache::GetDiscardableAllocator();
+            if (fullSize && this->generateBitmap(&bitmap, allocator)) {
+                bitmap.pixelRef()->setImmutableWithID(fUniqueID);
+                SkBitmapCache::Add(fUniqueID, bitmap);
+                cached = true;
+            } else if (!fullSize && this->generateScaledBitmap(&bitmap, prefetch->fSize,
+                                                               allocator)) {
+                bitmap.setImmutable();
+                cached = SkBitmapCache::AddWH(this->scaledCacheDesc(prefetch->fSize), bitmap);
+            }
+            if (cached && client) {
+                as_IB(client)->notifyAddedToCache();
+            }
+        }
+
+        SkAutoMutexAcquire lock(fPrefetchMutex);
+        prefetch->fRunning = false;
+    });
+}
+
+bool SkImageCacherator::waitForPrefetch(const SkISize& size) {
+    Prefetch* prefetch = nullptr;
+    {
+        SkAutoMutexAcquire lock(fPrefetchMutex);
+        for (Prefetch* p : fPrefetches) {
+            if (p->fSize == size) {
+                prefetch = p;
+                break;
+            }
+        }
+    }
+    if (!prefetch) {
+        return false;
+    }
+    prefetch->fTasks.wait();
+    return true;
+}
+
+bool SkImageCacherator::lockPrefetched(const SkISize& size, SkBitmap* bitmap) {
+    return this->waitForPrefetch(size) &&
+           SkBitmapCache::FindWH(this->scaledCacheDesc(size), bitmap);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void set_yuv_plane_addrs(const SkYUVPlanesCache::Info& info, const void* data,
+                                const void* planes[3]) {
+    const SkYUVSizeInfo& sizes = info.fSizeInfo;
+    planes[0] = data;
+    planes[1] = (const uint8_t*)planes[0] + sizes.fWidthBytes[SkYUVSizeInfo::kY] *
+                                            sizes.fSizes[SkYUVSizeInfo::kY].fHeight;
+    planes[2] = (const uint8_t*)planes[1] + sizes.fWidthBytes[SkYUVSizeInfo::kU] *
+                                            sizes.fSizes[SkYUVSizeInfo::kU].fHeight;
+}
+
+// Returns new data holding planes downscaled so Y is 2^level times smaller, each texel the
+// average of the box of texels it covers, and sets info to describe them. Subsampled U and V
+// planes are only downscaled as far as they are larger than the new Y plane.
+static SkCachedData* downscale_yuv_planes(const SkYUVPlanesCache::Info& srcInfo,
+                                          const void* srcPlanes[3], int level,
+                                          SkYUVPlanesCache::Info* info) {
+    info->fColorSpace = srcInfo.fColorSpace;
+    const SkISize& ySize = srcInfo.fSizeInfo.fSizes[SkYUVSizeInfo::kY];
+    const int levelWidth = SkTMax(1, ySize.width() >> level),
+              levelHeight = SkTMax(1, ySize.height() >> level);
+    size_t totalSize = 0;
+    int maxWidth = 0;
+    for (int i = 0; i < 3; i++) {
+        const SkISize& size = srcInfo.fSizeInfo.fSizes[i];
+        info->fSizeInfo.fSizes[i].set(SkTMin(size.width(), levelWidth),
+                                      SkTMin(size.height(), levelHeight));
+        info->fSizeInfo.fWidthBytes[i] = info->fSizeInfo.fSizes[i].width();
+        totalSize += info->fSizeInfo.fWidthBytes[i] * info->fSizeInfo.fSizes[i].height();
+        maxWidth = SkTMax(maxWidth, size.width());
+    }
+    SkCachedData* data = SkResourceCache::NewCachedData(totalSize);
+    if (!data) {
+        return nullptr;
+    }
+
+    void* planes[3];
+    set_yuv_plane_addrs(*info, data->writable_data(), (const void**)planes);
+    SkAutoTMalloc<float> sums(maxWidth);
+    SkAutoTMalloc<uint32_t> bounds(maxWidth + 1);
+    for (int i = 0; i < 3; i++) {
+        const int srcWidth = srcInfo.fSizeInfo.fSizes[i].width(),
+                  srcHeight = srcInfo.fSizeInfo.fSizes[i].height(),
+                  width = info->fSizeInfo.fSizes[i].width(),
+                  height = info->fSizeInfo.fSizes[i].height();
+        const size_t srcRowBytes = srcInfo.fSizeInfo.fWidthBytes[i];
+        for (int x = 0; x <= width; x++) {
+            bounds[x] = x * srcWidth / width;
+        }
+        for (int y = 0; y < height; y++) {
+            const int top = y * srcHeight / height,
+                      bottom = (y + 1) * srcHeight / height;
+            sk_bzero(sums.get(), srcWidth * sizeof(float));
+            for (int sy = top; sy < bottom; sy++) {
+                SkOpts::box_accumulate_row(sums.get(),
+                                           (const uint8_t*)srcPlanes[i] + sy * srcRowBytes,
+                                           srcWidth);
+            }
+            SkOpts::box_resolve_row((uint8_t*)planes[i] + y * width, sums.get(), bounds.get(),
+                                    width, bottom - top, 1);
+        }
+    }
+    return data;
+}
+
+// The planes are keyed by the generator's ID, as the GPU's YUV upload (GrYUVProvider) keys
+// them, so both share one decode.
+SkCachedData* SkImageCacherator::lockAsYUVPlanes(SkYUVPlanesCache::Info* info,
+                                                 const void* planes[3], const SkImage* client,
+                                                 int level) {
+    if (fOrigin.x() || fOrigin.y()) {
+        return nullptr;
+    }
+    if (level > 0) {
+        // Downscaled levels are made from the full planes once, and cached beside them.
+        SkCachedData* data = SkYUVPlanesCache::FindAndRefLevel(fUniqueID, level, info);
+        if (!data) {
+            SkYUVPlanesCache::Info srcInfo;
+            const void* srcPlanes[3];
+            SkAutoTUnref<SkCachedData> src(this->lockAsYUVPlanes(&srcInfo, srcPlanes, client, 0));
+            if (!src) {
+                return nullptr;
+            }
+            data = downscale_yuv_planes(srcInfo, srcPlanes, level, info);
+            if (!data) {
+                return nullptr;
+            }
+            SkYUVPlanesCache::AddLevel(fUniqueID, level, data, info);
+            if (client) {
+                as_IB(client)->notifyAddedToCache();
+            }
+        }
+        set_yuv_plane_addrs(*info, data->data(), planes);
+        return data;
+    }
+    SkCachedData* data = SkYUVPlanesCache::FindAndRef(fUniqueID, info);
+    if (!data) {
+        ScopedGenerator generator(this);
+        if (fInfo.dimensions() != generator->getInfo().dimensions()) {
+            return nullptr;
+        }
+        // Another thread may have generated them while we waited for the generator.
+        data = SkYUVPlanesCache::FindAndRef(fUniqueID, info);
+        if (!data) {
+            if (!generator->queryYUV8(&info->fSizeInfo, &info->fColorSpace)) {
+                return nullptr;
+            }
+            size_t totalSize = 0;
+            for (int i = 0; i < 3; i++) {
+                totalSize += info->fSizeInfo.fWidthBytes[i] * info->fSizeInfo.fSizes[i].fHeight;
+            }
+            data = SkResourceCache::NewCachedData(totalSize);
+            if (!data) {
+                return nullptr;
+            }
+            void* writablePlanes[3];
+            set_yuv_plane_addrs(*info, data->writable_data(), (const void**)writablePlanes);
+            if (!generator->getYUV8Planes(info->fSizeInfo, writablePlanes)) {
+                data->unref();
+                return nullptr;
+            }
+            SkYUVPlanesCache::Add(fUniqueID, data, info);
+            if (client) {
+                as_IB(client)->notifyAddedToCache();
+            }
+        }
+    }
+    set_yuv_plane_addrs(*info, data->data(), planes);
+    return data;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
 bool SkImageCacherator::lockAsBitmap(SkBitmap* bitmap, const SkImage* client,
                                      SkImage::CachingHint chint) {
     if (this->tryLockAsBitmap(bitmap, client, chint)) {
@@ -8,9 +8,13 @@
 #ifndef SkImageCacherator_DEFINED
 #define SkImageCacherator_DEFINED
 
+#include "SkBitmapCache.h"
 #include "SkImageGenerator.h"
 #include "SkMutex.h"
+#include "SkTDArray.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
+#include "SkYUVPlanesCache.h"
 
 class GrContext;
 class GrTextureParams;
@@ -26,6 +30,9 @@ public:
     // Takes ownership of the generator
     static SkImageCacherator* NewFromGenerator(SkImageGenerator*, const SkIRect* subset = nullptr);
 
+    // Waits for any prefetches still running.
+    ~SkImageCacherator();
+
     const SkImageInfo& info() const { return fInfo; }
     uint32_t uniqueID() const { return fUniqueID; }
 
@@ -62,6 +69,36 @@ public:
 
     // Only return true if the generate has already been cached.
     bool lockAsBitmapOnlyIfAlreadyCached(SkBitmap*);
+
+    /**
+     *  Generates the pixels, or a copy of them scaled to size, on an SkTaskGroup thread into
+     *  discardable memory, and adds them to the SkResourceCache. See SkImage::prefetch().
+     *
+     *  client is notified (->notifyAddedToCache()) when the pixels are added to the cache.
+     */
+    void prefetch(const SkISize& size, const SkImage* client);
+
+    /**
+     *  Finds the copy of the pixels scaled to size made by prefetch(), waiting for it if it is
+     *  still being generated. Returns false if it was never prefetched, or has been purged.
+     */
+    bool lockPrefetched(const SkISize& size, SkBitmap*);
+
+    /**
+     *  Returns a ref() on the YUV planes of the generator, stored contiguously in the
+     *  SkYUVPlanesCache, and sets info and planes to describe them. The caller must call unref()
+     *  when it is done. Returns nullptr if the generator can't produce YUV, or if this is a
+     *  subset of it.
+     *
+     *  A level above 0 returns the planes box filtered down by 2^level, made from the full
+     *  planes the first time and cached, so that downscaled draws can sample them directly.
+     *
+     *  If not NULL, the client will be notified (->notifyAddedToCache()) when the planes are
+     *  added to the cache on its behalf.
+     */
+    SkCachedData* lockAsYUVPlanes(SkYUVPlanesCache::Info* info, const void* planes[3],
+                                  const SkImage* client, int level = 0);
+
     // Call the underlying generator directly
     bool directGeneratePixels(const SkImageInfo& dstInfo, void* dstPixels, size_t dstRB,
                               int srcX, int srcY);
@@ -69,7 +106,11 @@ public:
 private:
     SkImageCacherator(SkImageGenerator*, const SkImageInfo&, const SkIPoint&, uint32_t uniqueID);
 
-    bool generateBitmap(SkBitmap*);
+    bool generateBitmap(SkBitmap*, SkBitmap::Allocator*);
+    bool generateScaledBitmap(SkBitmap*, const SkISize& size, SkBitmap::Allocator*);
+    SkBitmapCacheDesc scaledCacheDesc(const SkISize& size) const;
+    // Blocks until the prefetch of size is done. Returns false if size was never prefetched.
+    bool waitForPrefetch(const SkISize& size);
     bool tryLockAsBitmap(SkBitmap*, const SkImage*, SkImage::CachingHint);
 #if SK_SUPPORT_GPU
     // Returns the texture. If the cacherator is generating the texture and wants to cache it,
@@ -94,6 +135,14 @@ private:
     SkMutex                         fMutexForGenerator;
     SkAutoTDelete<SkImageGenerator> fNotThreadSafeGenerator;
 
+    struct Prefetch {
+        SkISize     fSize;
+        bool        fRunning;   // guarded by fPrefetchMutex
+        SkTaskGroup fTasks;
+    };
+    SkMutex                         fPrefetchMutex;
+    SkTDArray<Prefetch*>            fPrefetches;
+
     const SkImageInfo   fInfo;
     const SkIPoint      fOrigin;
     const uint32_t      fUniqueID;
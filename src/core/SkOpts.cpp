@@ -15,8 +15,10 @@
 #include "SkBlitMask_opts.h"
 #include "SkBlitRow_opts.h"
 #include "SkBlurImageFilter_opts.h"
+#include "SkBoxResize_opts.h"
 #include "SkColorCubeFilter_opts.h"
 #include "SkMorphologyImageFilter_opts.h"
+#include "SkPngFilter_opts.h"
 #include "SkSwizzler_opts.h"
 #include "SkTextureCompressor_opts.h"
 #include "SkXfermode_opts.h"
@@ -71,11 +73,24 @@ namespace SkOpts {
     decltype(inverted_CMYK_to_RGB1) inverted_CMYK_to_RGB1 = sk_default::inverted_CMYK_to_RGB1;
     decltype(inverted_CMYK_to_BGR1) inverted_CMYK_to_BGR1 = sk_default::inverted_CMYK_to_BGR1;
 
+    decltype(RGBA_to_565) RGBA_to_565 = sk_default::RGBA_to_565;
+    decltype(BGRA_to_565) BGRA_to_565 = sk_default::BGRA_to_565;
+
+    decltype(masks_to_RGBA) masks_to_RGBA = sk_default::masks_to_RGBA;
+    decltype(masks_to_rgbA) masks_to_rgbA = sk_default::masks_to_rgbA;
+    decltype(masks_to_BGRA) masks_to_BGRA = sk_default::masks_to_BGRA;
+    decltype(masks_to_bgrA) masks_to_bgrA = sk_default::masks_to_bgrA;
+
     decltype(half_to_float) half_to_float = sk_default::half_to_float;
     decltype(float_to_half) float_to_half = sk_default::float_to_half;
 
     decltype(srcover_srgb_srgb) srcover_srgb_srgb = sk_default::srcover_srgb_srgb;
 
+    decltype(png_filter_row) png_filter_row = sk_default::png_filter_row;
+
+    decltype(box_accumulate_row) box_accumulate_row = sk_default::box_accumulate_row;
+    decltype(box_resolve_row)    box_resolve_row    = sk_default::box_resolve_row;
+
     // Each Init_foo() is defined in src/opts/SkOpts_foo.cpp.
     void Init_ssse3();
     void Init_sse41();
@@ -62,12 +62,48 @@ namespace SkOpts {
                         inverted_CMYK_to_RGB1, // i.e. convert color space
                         inverted_CMYK_to_BGR1; // i.e. convert color space
 
+    // Pack 8888 pixels, with bytes in RGBA or BGRA order, into 565.
+    typedef void (*Swizzle_565)(uint16_t*, const uint32_t*, int);
+    extern Swizzle_565 RGBA_to_565,
+                       BGRA_to_565;
+
+    // Bit masks for 16, 24 or 32 bit pixels, like those of bmps.  Each channel is
+    // (pixel & mask) >> shift, scaled from size bits up to 8.  An alpha mask of 0 means opaque.
+    struct BitMasks {
+        uint32_t mask[4];   // R, G, B, A
+        uint32_t shift[4];
+        uint32_t size[4];   // at most 8
+    };
+
+    // Swizzle count pixels of bytesPerPixel each, srcStep bytes apart, with bit masks into some
+    // sort of 8888 pixel, {premul,unpremul} x {rgba,bgra}.
+    typedef void (*Swizzle_masks)(uint32_t*, const uint8_t*, int count, int bytesPerPixel,
+                                  int srcStep, const BitMasks&);
+    extern Swizzle_masks masks_to_RGBA,
+                         masks_to_rgbA,
+                         masks_to_BGRA,
+                         masks_to_bgrA;
+
     extern void (*half_to_float)(float[], const uint16_t[], int);
     extern void (*float_to_half)(uint16_t[], const float[], int);
 
     // Blend ndst src pixels over dst, where both src and dst point to sRGB pixels (RGBA or BGRA).
     // If nsrc < ndst, we loop over src to create a pattern.
     extern void (*srcover_srgb_srgb)(uint32_t* dst, const uint32_t* src, int ndst, int nsrc);
+
+    // Filters the bytes of one PNG row into dst with whichever of the five PNG filters makes
+    // them smallest, as libpng's heuristic measures it, and returns that filter's type.
+    // prev is the previous unfiltered row, or zeros for the first row.
+    extern int (*png_filter_row)(uint8_t dst[], const uint8_t row[], const uint8_t prev[],
+                                 int bytes, int bpp);
+
+    // Box filter downsampling, a row at a time: sum the rows covered by an output row with
+    // box_accumulate_row(), which adds count bytes of row to sums, then box_resolve_row() writes
+    // width output pixels of bpp (1 or 4) 8-bit channels. Output pixel i is the average of
+    // the summed pixels [bounds[i], bounds[i+1]) over those rows.
+    extern void (*box_accumulate_row)(float sums[], const uint8_t row[], int count);
+    extern void (*box_resolve_row)(uint8_t dst[], const float sums[], const uint32_t bounds[],
+                                   int width, int rows, int bpp);
 }
 
 #endif//SkOpts_DEFINED
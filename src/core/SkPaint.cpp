@@ -2256,7 +2256,7 @@ bool SkTextToPathIter::next(const SkPath** path, SkScalar* xpos) {
 
         if (glyph.fWidth) {
             if (path) {
-                *path = fCache->findPath(glyph);
+                *path = fCache->findPath(glyph, &fPath) ? &fPath : nullptr;
             }
         } else {
             if (path) {
@@ -2275,7 +2275,7 @@ bool SkTextInterceptsIter::next(SkScalar* array, int* count) {
     const SkGlyph& glyph = fGlyphCacheProc(fCache, &fText);
     fXPos += SkScalarMul(fPrevAdvance + fAutoKern.adjust(glyph), fScale);
     fPrevAdvance = advance(glyph, fXYIndex);   // + fPaint.getTextTracking();
-    if (fCache->findPath(glyph)) {
+    if (fCache->findPath(glyph, nullptr)) {
         fCache->findIntercepts(fBounds, fScale, fXPos, SkToBool(fXYIndex),
                 const_cast<SkGlyph*>(&glyph), array, count);
     }
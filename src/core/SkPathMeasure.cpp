@@ -555,13 +555,16 @@ const SkPathMeasure::Segment* SkPathMeasure::distanceToSegment(
     SkDEBUGCODE(SkScalar length = ) this->getLength();
     SkASSERT(distance >= 0 && distance <= length);
 
-    const Segment*  seg = fSegments.begin();
-    int             count = fSegments.count();
-
-    int index = SkTKSearch<Segment, SkScalar>(seg, count, distance);
+    int index = SkTKSearch<Segment, SkScalar>(fSegments.begin(), fSegments.count(), distance);
     // don't care if we hit an exact match or not, so we xor index if it is negative
     index ^= (index >> 31);
-    seg = &seg[index];
+    return this->indexToSegment(index, distance, t);
+}
+
+const SkPathMeasure::Segment* SkPathMeasure::indexToSegment(int index, SkScalar distance,
+                                                            SkScalar* t) const {
+    SkASSERT(index >= 0 && index < fSegments.count());
+    const Segment* seg = &fSegments[index];
 
     // now interpolate t-values with the prev segment (if possible)
     SkScalar    startT = 0, startD = 0;
@@ -611,6 +614,48 @@ bool SkPathMeasure::getPosTan(SkScalar distance, SkPoint* pos,
     return true;
 }
 
+bool SkPathMeasure::getPosTan(int count, const SkScalar distances[], SkPoint positions[],
+                              SkVector tangents[]) {
+    if (nullptr == fPath) {
+        return false;
+    }
+
+    SkScalar    length = this->getLength(); // call this to force computing it
+    int         segCount = fSegments.count();
+
+    if (segCount == 0 || length == 0) {
+        return false;
+    }
+
+    const Segment*  segs = fSegments.begin();
+    int             index = 0;
+    SkScalar        prevDistance = 0;
+
+    for (int i = 0; i < count; ++i) {
+        // pin the distance to a legal range
+        SkScalar distance = SkTPin(distances[i], 0.0f, length);
+
+        // Every segment before index ends before prevDistance, so when the distances are
+        // increasing we only need to search from index on, and usually not even that.
+        if (distance < prevDistance) {
+            index = 0;
+        }
+        if (segs[index].fDistance < distance) {
+            int found = SkTKSearch<Segment, SkScalar>(segs + index + 1, segCount - index - 1,
+                                                      distance);
+            index += 1 + (found ^ (found >> 31));
+        }
+        prevDistance = distance;
+
+        SkScalar        t;
+        const Segment*  seg = this->indexToSegment(index, distance, &t);
+
+        compute_pos_tan(&fPts[seg->fPtIndex], seg->fType, t,
+                        positions ? &positions[i] : nullptr, tangents ? &tangents[i] : nullptr);
+    }
+    return true;
+}
+
 bool SkPathMeasure::getMatrix(SkScalar distance, SkMatrix* matrix,
                               MatrixFlags flags) {
     if (nullptr == fPath) {
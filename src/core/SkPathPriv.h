@@ -8,6 +8,7 @@
 #ifndef SkPathPriv_DEFINED
 #define SkPathPriv_DEFINED
 
+#include "SkChecksum.h"
 #include "SkPath.h"
 
 class SkPathPriv {
@@ -80,6 +81,20 @@ public:
         return false;
     }
 
+    /**
+     *  Returns a hash of the path's fill type, verbs, points and conic weights. Unlike the
+     *  genID, paths which are copies of each other but were built separately (e.g. by
+     *  transforming the same path by the same matrix) return the same hash.
+     */
+    static uint32_t ComputeContentHash(const SkPath& path) {
+        const SkPathRef* ref = path.fPathRef.get();
+        uint32_t hash = SkChecksum::Murmur3(ref->points(), ref->countPoints() * sizeof(SkPoint),
+                                            path.getFillType());
+        hash = SkChecksum::Murmur3(ref->verbsMemBegin(), ref->countVerbs(), hash);
+        return SkChecksum::Murmur3(ref->conicWeights(), ref->countWeights() * sizeof(SkScalar),
+                                   hash);
+    }
+
     static void AddGenIDChangeListener(const SkPath& path, SkPathRef::GenIDChangeListener* listener) {
         path.fPathRef->addGenIDChangeListener(listener);
     }
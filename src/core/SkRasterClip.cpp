@@ -97,6 +97,16 @@ bool SkRasterClip::setRect(const SkIRect& rect) {
     return fIsRect;
 }
 
+bool SkRasterClip::setAAClip(const SkAAClip& aaclip) {
+    AUTO_RASTERCLIP_VALIDATE(*this);
+
+    SkASSERT(!fForceConservativeRects);
+    fBW.setEmpty();
+    fAA = aaclip;
+    fIsBW = false;
+    return this->updateCacheAndReturnNonEmpty();
+}
+
 /////////////////////////////////////////////////////////////////////////////////////
 
 bool SkRasterClip::setConservativeRect(const SkRect& r, const SkIRect& clipR, bool isInverse) {
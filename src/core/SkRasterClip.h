@@ -60,6 +60,9 @@ public:
     bool setEmpty();
     bool setRect(const SkIRect&);
 
+    // Sets this to an antialiased clip that shares aaclip's runs.
+    bool setAAClip(const SkAAClip& aaclip);
+
     bool op(const SkIRect&, SkRegion::Op);
     bool op(const SkRegion&, SkRegion::Op);
     bool op(const SkRect&, const SkIRect&, SkRegion::Op, bool doAA);
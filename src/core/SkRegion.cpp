@@ -8,7 +8,9 @@
 
 #include "SkAtomics.h"
 #include "SkRegionPriv.h"
+#include "SkTDArray.h"
 #include "SkTemplates.h"
+#include "SkTSort.h"
 #include "SkUtils.h"
 
 /* Region Layout
@@ -229,7 +231,12 @@ static bool isRunCountEmpty(int count) {
 }
 
 bool SkRegion::setRuns(RunType runs[], int count) {
-    SkDEBUGCODE(this->validate();)
+#ifdef SK_DEBUG
+    // If runs[] was built in our own storage (see Oper) our old runs are gone.
+    if (!this->isComplex() || runs != fRunHead->readonly_runs()) {
+        this->validate();
+    }
+#endif
     SkASSERT(count > 0);
 
     if (isRunCountEmpty(count)) {
@@ -280,15 +287,22 @@ bool SkRegion::setRuns(RunType runs[], int count) {
 
     //  if we get here, we need to become a complex region
 
-    if (!this->isComplex() || fRunHead->fRunCount != count) {
+    if (this->isComplex() && fRunHead->canReuse(count)) {
+        // We own our storage outright, so overwrite it rather than
+        // reallocating. Note: runs[] may already live in our storage (see
+        // Oper), hence memmove.
+        RunType* dst = fRunHead->writable_runs();
+        if (dst != runs) {
+            memmove(dst, runs, count * sizeof(RunType));
+        }
+        fRunHead->fRunCount = count;
+    } else {
+        // runs[] may live in our current storage, so copy before freeing it.
+        RunHead* head = RunHead::Alloc(count);
+        memcpy(head->writable_runs(), runs, count * sizeof(RunType));
         this->freeRuns();
-        this->allocateRuns(count);
+        fRunHead = head;
     }
-
-    // must call this before we can write directly into runs()
-    // in case we are sharing the buffer with another region (copy on write)
-    fRunHead = fRunHead->ensureWritable();
-    memcpy(fRunHead->writable_runs(), runs, count * sizeof(RunType));
     fRunHead->computeRunBounds(&fBounds);
 
     SkDEBUGCODE(this->validate();)
@@ -584,16 +598,107 @@ void SkRegion::translate(int dx, int dy, SkRegion* dst) const {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static bool rect_top_lt(const SkIRect* a, const SkIRect* b) {
+    return a->fTop < b->fTop;
+}
+
+/*  Build the union of the rects in a single top-to-bottom sweep, rather than
+    as a series of region-ops (each of which rewrites the entire result).
+
+    Each distinct top/bottom edge starts a new band. For each band we keep the
+    rects that span it sorted by their left edge, so the band's intervals can
+    be merged in one linear pass. Bands whose intervals match the previous
+    band just extend that band's bottom, which keeps the runs canonical.
+ */
 bool SkRegion::setRects(const SkIRect rects[], int count) {
-    if (0 == count) {
-        this->setEmpty();
-    } else {
-        this->setRect(rects[0]);
-        for (int i = 1; i < count; i++) {
-            this->op(rects[i], kUnion_Op);
+    SkTDArray<const SkIRect*> sorted;
+    SkTDArray<RunType> ys;
+    for (int i = 0; i < count; ++i) {
+        if (!rects[i].isEmpty()) {
+            *sorted.append() = &rects[i];
+            *ys.append() = rects[i].fTop;
+            *ys.append() = rects[i].fBottom;
+        }
+    }
+    if (sorted.count() <= 1) {
+        return sorted.isEmpty() ? this->setEmpty() : this->setRect(*sorted[0]);
+    }
+
+    SkTQSort(sorted.begin(), sorted.end() - 1, rect_top_lt);
+    SkTQSort(ys.begin(), ys.end() - 1);
+    int yCount = 1;
+    for (int i = 1; i < ys.count(); ++i) {
+        if (ys[i] != ys[yCount - 1]) {
+            ys[yCount++] = ys[i];
+        }
+    }
+
+    SkTDArray<const SkIRect*> active;   // sorted by fLeft
+    SkTDArray<RunType> runs;
+    int nextRect = 0;
+    int prevStart = -1;     // index of the previous band's first interval
+    int prevLen = 0;        // number of interval values in the previous band
+
+    *runs.append() = ys[0];
+    for (int i = 0; i < yCount - 1; ++i) {
+        const int top = ys[i];
+
+        int n = 0;
+        for (int j = 0; j < active.count(); ++j) {
+            if (active[j]->fBottom > top) {
+                active[n++] = active[j];
+            }
         }
+        active.setCount(n);
+
+        while (nextRect < sorted.count() && sorted[nextRect]->fTop == top) {
+            const SkIRect* r = sorted[nextRect++];
+            int index = active.count();
+            while (index > 0 && active[index - 1]->fLeft > r->fLeft) {
+                index -= 1;
+            }
+            *active.insert(index) = r;
+        }
+
+        runs.append(2);     // bottom, interval-count
+        const int start = runs.count();
+        for (int j = 0; j < active.count(); ++j) {
+            const SkIRect* r = active[j];
+            if (runs.count() > start && r->fLeft <= runs.top()) {
+                runs.top() = SkMax32(runs.top(), r->fRight);
+            } else {
+                *runs.append() = r->fLeft;
+                *runs.append() = r->fRight;
+            }
+        }
+
+        const int len = runs.count() - start;
+        if (len == prevLen && prevStart >= 0 &&
+                !memcmp(&runs[prevStart], &runs[start], len * sizeof(RunType))) {
+            runs[prevStart - 2] = ys[i + 1];    // extend the previous band
+            runs.setCount(start - 2);
+        } else {
+            runs[start - 2] = ys[i + 1];
+            runs[start - 1] = len >> 1;
+            *runs.append() = kRunTypeSentinel;
+            prevStart = start;
+            prevLen = len;
+        }
+    }
+    *runs.append() = kRunTypeSentinel;
+
+    return this->setRuns(runs.begin(), runs.count());
+}
+
+bool SkRegion::unionRects(const SkIRect rects[], int count) {
+    if (this->isEmpty()) {
+        return this->setRects(rects, count);
+    }
+    SkRegion tmp;
+    if (!tmp.setRects(rects, count)) {
+        return true;    // we are non-empty
     }
-    return !this->isEmpty();
+    return this->op(tmp, kUnion_Op);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -707,6 +812,30 @@ static SkRegion::RunType* operate_on_span(const SkRegion::RunType a_runs[],
                                           const SkRegion::RunType b_runs[],
                                           SkRegion::RunType dst[],
                                           int min, int max) {
+    // If either span is empty, the result is either empty or a verbatim copy
+    // of the other span (which is already sorted and coalesced), so we can
+    // skip the interval-by-interval merge. This is the common case when
+    // combining regions whose scanlines only partially overlap in Y.
+    const bool a_empty = SkRegion::kRunTypeSentinel == a_runs[0];
+    const bool b_empty = SkRegion::kRunTypeSentinel == b_runs[0];
+    if (a_empty || b_empty) {
+        const SkRegion::RunType* src = nullptr;
+        if (!a_empty && min <= 1 && 1 <= max) {
+            src = a_runs;
+        } else if (!b_empty && min <= 2 && 2 <= max) {
+            src = b_runs;
+        }
+        if (src) {
+            // the interval-count precedes the intervals (see skip_intervals)
+            const int n = src[-1] * 2;
+            SkASSERT(SkRegion::kRunTypeSentinel == src[n]);
+            memcpy(dst, src, n * sizeof(SkRegion::RunType));
+            dst += n;
+        }
+        *dst++ = SkRegion::kRunTypeSentinel;
+        return dst;
+    }
+
     spanRec rec;
     bool    firstInterval = true;
 
@@ -1066,19 +1195,33 @@ bool SkRegion::Oper(const SkRegion& rgnaOrig, const SkRegion& rgnbOrig, Op op,
     const RunType* b_runs = rgnb->getRuns(tmpB, &b_intervals);
 
     int dstCount = compute_worst_case_count(a_intervals, b_intervals);
-    SkAutoSTMalloc<256, RunType> array(dstCount);
+    SkAutoSTMalloc<256, RunType> array;
+    RunType* dstRuns;
+
+    // If the result owns storage large enough for the worst case, and that
+    // storage is not also one of our sources, operate directly into it. setRuns
+    // will then (usually) keep the result there, avoiding both the scratch
+    // allocation and a free/malloc of the result's runs.
+    if (result && result->isComplex() &&
+            result->fRunHead != rgna->fRunHead && result->fRunHead != rgnb->fRunHead &&
+            1 == result->fRunHead->fRefCnt &&
+            dstCount <= result->fRunHead->getRunCapacity()) {
+        dstRuns = result->fRunHead->writable_runs();
+    } else {
+        dstRuns = array.reset(dstCount);
+    }
 
 #ifdef SK_DEBUG
 //  Sometimes helpful to seed everything with a known value when debugging
-//  sk_memset32((uint32_t*)array.get(), 0x7FFFFFFF, dstCount);
+//  sk_memset32((uint32_t*)dstRuns, 0x7FFFFFFF, dstCount);
 #endif
 
-    int count = operate(a_runs, b_runs, array.get(), op, nullptr == result);
+    int count = operate(a_runs, b_runs, dstRuns, op, nullptr == result);
     SkASSERT(count <= dstCount);
 
     if (result) {
         SkASSERT(count >= 0);
-        return result->setRuns(array.get(), count);
+        return result->setRuns(dstRuns, count);
     } else {
         return (QUICK_EXIT_TRUE_COUNT == count) || !isRunCountEmpty(count);
     }
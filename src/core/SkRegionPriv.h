@@ -70,6 +70,7 @@ public:
         RunHead* head = (RunHead*)sk_malloc_throw(size);
         head->fRefCnt = 1;
         head->fRunCount = count;
+        head->fRunCapacity = count;
         // these must be filled in later, otherwise we will be invalid
         head->fYSpanCount = 0;
         head->fIntervalCount = 0;
@@ -86,6 +87,25 @@ public:
         return head;
     }
 
+    /**
+     *  Number of RunTypes that fit in our storage. This is always >= fRunCount,
+     *  and is larger only when the storage has been reused for a smaller
+     *  result (see canReuse()).
+     */
+    int getRunCapacity() const {
+        return fRunCapacity;
+    }
+
+    /**
+     *  Return true if we are the sole owner of this storage, and it can hold
+     *  count RunTypes without wasting more than half of it. In that case the
+     *  caller may write count runs directly into writable_runs() and then set
+     *  fRunCount, rather than freeing and reallocating.
+     */
+    bool canReuse(int count) const {
+        return 1 == fRefCnt && count <= fRunCapacity && count >= (fRunCapacity >> 1);
+    }
+
     SkRegion::RunType* writable_runs() {
         SkASSERT(fRefCnt == 1);
         return (SkRegion::RunType*)(this + 1);
@@ -230,6 +250,7 @@ public:
 private:
     int32_t fYSpanCount;
     int32_t fIntervalCount;
+    int32_t fRunCapacity;
 };
 
 #endif
@@ -9,6 +9,7 @@
 #include "SkMessageBus.h"
 #include "SkMipMap.h"
 #include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkPixelRef.h"
 #include "SkResourceCache.h"
 #include "SkTraceMemoryDump.h"
@@ -584,6 +585,17 @@ SkBitmap::Allocator* SkResourceCache::GetAllocator() {
     return get_cache()->allocator();
 }
 
+SkBitmap::Allocator* SkResourceCache::GetDiscardableAllocator() {
+    SkBitmap::Allocator* allocator = GetAllocator();
+    if (allocator) {
+        return allocator;
+    }
+    static SkOnce once;
+    static SkBitmap::Allocator* gAllocator;
+    once([] { gAllocator = new SkResourceCacheDiscardableAllocator(SkDiscardableMemory::Create); });
+    return gAllocator;
+}
+
 SkCachedData* SkResourceCache::NewCachedData(size_t bytes) {
     SkAutoMutexAcquire am(gMutex);
     return get_cache()->newCachedData(bytes);
@@ -173,6 +173,13 @@ public:
      */
     static SkBitmap::Allocator* GetAllocator();
 
+    /**
+     *  Returns an allocator that puts pixels in memory from SkDiscardableMemory::Create() (a
+     *  budgeted SkDiscardableMemoryPool in the default port), even if the ResourceCache itself
+     *  was not initialized with a DiscardableFactory.
+     */
+    static SkBitmap::Allocator* GetDiscardableAllocator();
+
     static SkCachedData* NewCachedData(size_t bytes);
 
     static void PostPurgeSharedID(uint64_t sharedID);
@@ -563,6 +563,23 @@ void SkScalerContext::getImage(const SkGlyph& origGlyph) {
     }
 }
 
+void SkScalerContext::getImages(const SkGlyph* const glyphs[], int count) {
+    // Mask filters and images drawn from paths are made one glyph at a time by getImage.
+    if (fMaskFilter || fGenerateImageFromPath) {
+        for (int i = 0; i < count; ++i) {
+            this->getImage(*glyphs[i]);
+        }
+        return;
+    }
+    this->generateImages(glyphs, count);
+}
+
+void SkScalerContext::generateImages(const SkGlyph* const glyphs[], int count) {
+    for (int i = 0; i < count; ++i) {
+        this->generateImage(*glyphs[i]);
+    }
+}
+
 void SkScalerContext::getPath(const SkGlyph& glyph, SkPath* path) {
     this->internalGetPath(glyph, nullptr, path, nullptr);
 }
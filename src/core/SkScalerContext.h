@@ -244,9 +244,13 @@ public:
     }
 
     unsigned    getGlyphCount() { return this->generateGlyphCount(); }
+    /** Identifies the version of the font engine generating the glyphs, or 0 if it is unknown. */
+    uint32_t    getEngineVersion() { return this->generateEngineVersion(); }
     void        getAdvance(SkGlyph*);
     void        getMetrics(SkGlyph*);
     void        getImage(const SkGlyph&);
+    /** Like calling getImage on each glyph, but lets the context share its setup between them. */
+    void        getImages(const SkGlyph* const glyphs[], int count);
     void        getPath(const SkGlyph&, SkPath*);
     void        getFontMetrics(SkPaint::FontMetrics*);
 
@@ -305,6 +309,13 @@ protected:
      */
     virtual void generateImage(const SkGlyph& glyph) = 0;
 
+    /** Generates the contents of each glyph's fImage, as generateImage would.
+     *  Contexts which must do work before each glyph (e.g. selecting their size and transform)
+     *  may override this to do it once for all of the glyphs.
+     *  The default implementation calls generateImage for each glyph.
+     */
+    virtual void generateImages(const SkGlyph* const glyphs[], int count);
+
     /** Sets the passed path to the glyph outline.
      *  If this cannot be done the path is set to empty;
      *  this is indistinguishable from a glyph with an empty path.
@@ -331,6 +342,11 @@ protected:
      */
     virtual SkUnichar generateGlyphToChar(uint16_t glyphId);
 
+    /** Returns the version of the font engine, which glyphs generated elsewhere must match to be
+     *  reused. Returns 0 if it is not known.
+     */
+    virtual uint32_t generateEngineVersion() { return 0; }
+
     void forceGenerateImageFromPath() { fGenerateImageFromPath = true; }
     void forceOffGenerateImageFromPath() { fGenerateImageFromPath = false; }
 
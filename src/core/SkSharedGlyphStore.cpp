@@ -0,0 +1,566 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkSharedGlyphStore.h"
+
+#include "SkAtomics.h"
+#include "SkChecksum.h"
+#include "SkCompactPath.h"
+#include "SkDescriptor.h"
+#include "SkFontDescriptor.h"
+#include "SkGlyph.h"
+#include "SkMilestone.h"
+#include "SkPath.h"
+#include "SkScalerContext.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkTypeface.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+    #define SK_HAS_SHARED_GLYPH_STORE
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/file.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+
+const uint32_t kMagic = SkSetFourByteTag('s', 'k', 'g', 's');
+// Bump when the layout of the store, or of the scaler context records in its keys, changes.
+const uint32_t kVersion = 4;
+// Stores written by another milestone are not used, in case it generates glyphs differently.
+const uint32_t kBuild = SK_MILESTONE;
+
+const int kStrikeBucketCount = 1 << 8;
+const int kGlyphBucketCount = 1 << 14;
+
+}  // namespace
+
+// All offsets are from the start of the store, and entries are 8-byte aligned, so that glyph
+// images may be read as 16 or 32-bit pixels. Each bucket holds the offset of the most recently
+// added entry of its chain, or 0. Entries are allocated in order, so each links to one at a lower
+// offset, and a chain always ends.
+struct SkSharedGlyphStore::Header {
+    uint32_t    fMagic;
+    uint32_t    fVersion;
+    uint32_t    fBuild;
+    uint32_t    fSize;
+    uint32_t    fUsed;
+    uint32_t    fStrikes[kStrikeBucketCount];
+    uint32_t    fGlyphs[kGlyphBucketCount];
+};
+
+// Followed by the key.
+struct SkSharedGlyphStore::StrikeEntry {
+    uint32_t    fNext;
+    uint32_t    fHash;
+    uint32_t    fKeyLength;
+};
+
+// Followed by the image, if fImageSize is not 0. fPath is the offset of the glyph's PathEntry, or
+// 0 until the path is added.
+struct SkSharedGlyphStore::GlyphEntry {
+    uint32_t    fNext;
+    uint32_t    fStrike;
+    uint32_t    fPackedID;
+    uint32_t    fImageSize;
+    float       fAdvanceX, fAdvanceY;
+    uint16_t    fWidth, fHeight;
+    int16_t     fTop, fLeft;
+    uint8_t     fMaskFormat;
+    int8_t      fRsbDelta, fLsbDelta;
+    int8_t      fForceBW;
+    uint32_t    fPath;
+};
+
+// Followed by the path, as written by SkCompactPath::writeToMemory() if fCompact is not 0, or
+// otherwise by SkPath::writeToMemory().
+struct SkSharedGlyphStore::PathEntry {
+    uint32_t    fLength;
+    uint32_t    fCompact;
+};
+
+static uint32_t glyph_bucket(SkSharedGlyphStore::StrikeID strike, uint32_t packedID) {
+    return SkChecksum::Mix(strike ^ SkChecksum::CheapMix(packedID)) & (kGlyphBucketCount - 1);
+}
+
+sk_sp<SkData> SkSharedGlyphStore::MakeStrikeKey(SkScalerContext* context,
+                                                const SkDescriptor& desc) {
+    // Glyphs from another version of the font engine may differ, so keep them apart, and do not
+    // share glyphs of engines which can not tell their version.
+    uint32_t engineVersion = context->getEngineVersion();
+    if (0 == engineVersion) {
+        return nullptr;
+    }
+    SkTypeface* typeface = context->getTypeface();
+
+    // The 'head' table has the font's checksum and dates, which tell fonts apart.
+    static const SkFontTableTag kHeadTag = SkSetFourByteTag('h', 'e', 'a', 'd');
+    size_t headSize = typeface->getTableSize(kHeadTag);
+    if (0 == headSize || headSize > 1024) {
+        return nullptr;
+    }
+    SkAutoSTMalloc<64, uint8_t> head(headSize);
+    if (typeface->getTableData(kHeadTag, 0, headSize, head.get()) != headSize) {
+        return nullptr;
+    }
+    // Variations are not in the 'head' table.
+    SkAutoTDelete<SkFontData> fontData(typeface->createFontData());
+    if (fontData && fontData->getAxisCount() > 0) {
+        return nullptr;
+    }
+    SkString familyName;
+    typeface->getFamilyName(&familyName);
+    SkFontStyle style = typeface->fontStyle();
+
+    // Font IDs are given out by each process, so leave out the ID, and the checksum covering it.
+    SkAutoDescriptor ad(desc);
+    SkDescriptor* localDesc = ad.getDesc();
+    SkScalerContextRec* rec = static_cast<SkScalerContextRec*>(const_cast<void*>(
+            localDesc->findEntry(kRec_SkDescriptorTag, nullptr)));
+    if (!rec) {
+        return nullptr;
+    }
+    rec->fFontID = 0;
+
+    SkDynamicMemoryWStream key;
+    key.write32(engineVersion);
+    key.write32(SkToU32(headSize));
+    key.write(head.get(), headSize);
+    key.write32(SkToU32(familyName.size()));
+    key.write(familyName.c_str(), familyName.size());
+    key.write32(style.weight());
+    key.write32(style.width());
+    key.write32(style.slant());
+    key.write32(typeface->countGlyphs());
+    key.write(reinterpret_cast<const char*>(localDesc) + sizeof(uint32_t),
+              localDesc->getLength() - sizeof(uint32_t));
+    return sk_sp<SkData>(key.copyToData());
+}
+
+#ifdef SK_HAS_SHARED_GLYPH_STORE
+
+namespace {
+
+class AutoFileLock : SkNoncopyable {
+public:
+    explicit AutoFileLock(int fd) : fFD(fd) {
+        while (0 != flock(fFD, LOCK_EX) && EINTR == errno) {}
+    }
+    ~AutoFileLock() { flock(fFD, LOCK_UN); }
+
+private:
+    const int fFD;
+};
+
+}  // namespace
+
+sk_sp<SkSharedGlyphStore> SkSharedGlyphStore::Make(const char name[], size_t size) {
+    int fd = shm_open(name, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    return MakeFromFD(fd, size);
+}
+
+sk_sp<SkSharedGlyphStore> SkSharedGlyphStore::MakeFromFile(const char path[], size_t size) {
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    if (sk_sp<SkSharedGlyphStore> store = MakeFromFD(fd, size)) {
+        return store;
+    }
+
+    // The file is not a store of this version, so write a new one beside it, and move that over
+    // it. Processes which have the old file open keep using it.
+    SkString tempPath;
+    tempPath.printf("%s.%d", path, (int)getpid());
+    fd = open(tempPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        return nullptr;
+    }
+    sk_sp<SkSharedGlyphStore> store = MakeFromFD(fd, size);
+    if (!store || 0 != rename(tempPath.c_str(), path)) {
+        unlink(tempPath.c_str());
+        return nullptr;
+    }
+    return store;
+}
+
+sk_sp<SkSharedGlyphStore> SkSharedGlyphStore::MakeFromFD(int fd, size_t size) {
+    if (size < sizeof(Header) || size > UINT32_MAX) {
+        close(fd);
+        return nullptr;
+    }
+
+    struct stat st;
+    bool ok;
+    {
+        AutoFileLock lock(fd);
+        ok = 0 == fstat(fd, &st);
+        if (ok && 0 == st.st_size) {
+            // We are the first to open the store, so size it and write its header. The rest of
+            // the header, and the entries, start out as zeros.
+            const uint32_t header[] = { kMagic, kVersion, kBuild, SkToU32(size),
+                                        sizeof(Header) };
+            ok = 0 == ftruncate(fd, size) &&
+                 sizeof(header) == pwrite(fd, header, sizeof(header), 0);
+            st.st_size = size;
+        }
+    }
+    void* base = MAP_FAILED;
+    if (ok && st.st_size >= (off_t)sizeof(Header)) {
+        base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    if (MAP_FAILED == base) {
+        close(fd);
+        return nullptr;
+    }
+
+    const Header* header = static_cast<const Header*>(base);
+    if (header->fMagic != kMagic || header->fVersion != kVersion || header->fBuild != kBuild ||
+        header->fSize != (size_t)st.st_size) {
+        munmap(base, st.st_size);
+        close(fd);
+        return nullptr;
+    }
+    return sk_sp<SkSharedGlyphStore>(new SkSharedGlyphStore(fd, base, st.st_size));
+}
+
+void SkSharedGlyphStore::Unlink(const char name[]) {
+    shm_unlink(name);
+}
+
+SkSharedGlyphStore::SkSharedGlyphStore(int fd, void* base, size_t size)
+    : fFD(fd)
+    , fBase(base)
+    , fSize(size)
+    , fCorrupt(false) {}
+
+SkSharedGlyphStore::~SkSharedGlyphStore() {
+    munmap(fBase, fSize);
+    close(fFD);
+}
+
+void SkSharedGlyphStore::setWritable(uint32_t offset, size_t length, bool writable) {
+    static const size_t kPageSize = sysconf(_SC_PAGESIZE);
+    size_t start = offset & ~(kPageSize - 1);
+    size_t end = SkTMin(fSize, (offset + length + kPageSize - 1) & ~(kPageSize - 1));
+    mprotect(static_cast<char*>(fBase) + start, end - start,
+             writable ? PROT_READ | PROT_WRITE : PROT_READ);
+}
+
+#else
+
+sk_sp<SkSharedGlyphStore> SkSharedGlyphStore::Make(const char[], size_t) { return nullptr; }
+sk_sp<SkSharedGlyphStore> SkSharedGlyphStore::MakeFromFile(const char[], size_t) {
+    return nullptr;
+}
+sk_sp<SkSharedGlyphStore> SkSharedGlyphStore::MakeFromFD(int, size_t) { return nullptr; }
+void SkSharedGlyphStore::Unlink(const char[]) {}
+
+SkSharedGlyphStore::SkSharedGlyphStore(int fd, void* base, size_t size)
+    : fFD(fd)
+    , fBase(base)
+    , fSize(size)
+    , fCorrupt(false) {}
+
+SkSharedGlyphStore::~SkSharedGlyphStore() {}
+
+void SkSharedGlyphStore::setWritable(uint32_t, size_t, bool) {}
+
+class AutoFileLock : SkNoncopyable {
+public:
+    explicit AutoFileLock(int) {}
+};
+
+#endif
+
+template <typename T>
+const T* SkSharedGlyphStore::at(uint32_t offset, size_t length) const {
+    if (offset < sizeof(Header) || offset > fSize || length > fSize - offset) {
+        return nullptr;
+    }
+    return reinterpret_cast<const T*>(static_cast<const char*>(fBase) + offset);
+}
+
+uint32_t SkSharedGlyphStore::allocate(size_t length) {
+    Header* header = const_cast<Header*>(this->header());
+    size_t offset = SkAlign8(header->fUsed);
+    if (offset > fSize || length > fSize - offset) {
+        return 0;
+    }
+    sk_atomic_store(&header->fUsed, SkToU32(offset + length), sk_memory_order_relaxed);
+    return SkToU32(offset);
+}
+
+size_t SkSharedGlyphStore::bytesUsed() const {
+    return sk_atomic_load(&this->header()->fUsed, sk_memory_order_relaxed);
+}
+
+bool SkSharedGlyphStore::isCorrupt() const {
+    return sk_atomic_load(&fCorrupt, sk_memory_order_relaxed);
+}
+
+void SkSharedGlyphStore::markCorrupt() const {
+    SkDEBUGF(("SkSharedGlyphStore: found a bad link, no longer using the store.\n"));
+    sk_atomic_store(&fCorrupt, true, sk_memory_order_relaxed);
+}
+
+SkSharedGlyphStore::StrikeID SkSharedGlyphStore::findOrAddStrike(const SkData& key) {
+    const uint32_t hash = SkChecksum::Murmur3(key.data(), key.size());
+    const uint32_t bucket = hash & (kStrikeBucketCount - 1);
+    // Returns the strike, or 0 if it is not in the store. Sets corrupt if the chain is broken.
+    auto find = [&](bool* corrupt) -> StrikeID {
+        uint32_t offset = sk_atomic_load(&this->header()->fStrikes[bucket],
+                                         sk_memory_order_acquire);
+        while (offset) {
+            const StrikeEntry* entry = this->at<StrikeEntry>(offset, sizeof(StrikeEntry));
+            if (!entry) {
+                break;
+            }
+            if (entry->fHash == hash && entry->fKeyLength == key.size() &&
+                this->at<StrikeEntry>(offset, sizeof(StrikeEntry) + key.size()) &&
+                0 == memcmp(entry + 1, key.data(), key.size())) {
+                return offset;
+            }
+            if (entry->fNext >= offset) {
+                break;
+            }
+            offset = entry->fNext;
+        }
+        *corrupt = 0 != offset;
+        return 0;
+    };
+
+    if (this->isCorrupt()) {
+        return 0;
+    }
+    bool corrupt;
+    if (StrikeID strike = find(&corrupt)) {
+        return strike;
+    }
+    if (corrupt) {
+        this->markCorrupt();
+        return 0;
+    }
+
+    SkAutoMutexAcquire ac(fMutex);
+    AutoFileLock lock(fFD);
+    // Another writer may have added the strike since we looked.
+    if (StrikeID strike = find(&corrupt)) {
+        return strike;
+    }
+    if (corrupt) {
+        this->markCorrupt();
+        return 0;
+    }
+
+    Header* header = const_cast<Header*>(this->header());
+    const size_t length = sizeof(StrikeEntry) + key.size();
+    this->setWritable(0, sizeof(Header), true);
+    uint32_t offset = this->allocate(length);
+    if (offset) {
+        this->setWritable(offset, length, true);
+        StrikeEntry* entry = reinterpret_cast<StrikeEntry*>(static_cast<char*>(fBase) + offset);
+        entry->fNext = header->fStrikes[bucket];
+        entry->fHash = hash;
+        entry->fKeyLength = SkToU32(key.size());
+        memcpy(entry + 1, key.data(), key.size());
+        sk_atomic_store(&header->fStrikes[bucket], offset, sk_memory_order_release);
+        this->setWritable(offset, length, false);
+    }
+    this->setWritable(0, sizeof(Header), false);
+    return offset;
+}
+
+const SkSharedGlyphStore::GlyphEntry* SkSharedGlyphStore::findGlyphEntry(
+        StrikeID strike, uint32_t packedID) const {
+    if (this->isCorrupt()) {
+        return nullptr;
+    }
+    uint32_t offset = sk_atomic_load(&this->header()->fGlyphs[glyph_bucket(strike, packedID)],
+                                     sk_memory_order_acquire);
+    while (offset) {
+        const GlyphEntry* entry = this->at<GlyphEntry>(offset, sizeof(GlyphEntry));
+        if (!entry) {
+            break;
+        }
+        if (entry->fStrike == strike && entry->fPackedID == packedID) {
+            if (const GlyphEntry* withImage = this->at<GlyphEntry>(
+                        offset, sizeof(GlyphEntry) + entry->fImageSize)) {
+                return withImage;
+            }
+            break;
+        }
+        if (entry->fNext >= offset) {
+            break;
+        }
+        offset = entry->fNext;
+    }
+    if (offset) {
+        this->markCorrupt();
+    }
+    return nullptr;
+}
+
+bool SkSharedGlyphStore::findGlyph(StrikeID strike, uint32_t packedID, SkGlyph* glyph) const {
+    const GlyphEntry* entry = this->findGlyphEntry(strike, packedID);
+    if (!entry) {
+        return false;
+    }
+    glyph->fAdvanceX   = entry->fAdvanceX;
+    glyph->fAdvanceY   = entry->fAdvanceY;
+    glyph->fWidth      = entry->fWidth;
+    glyph->fHeight     = entry->fHeight;
+    glyph->fTop        = entry->fTop;
+    glyph->fLeft       = entry->fLeft;
+    glyph->fMaskFormat = entry->fMaskFormat;
+    glyph->fRsbDelta   = entry->fRsbDelta;
+    glyph->fLsbDelta   = entry->fLsbDelta;
+    glyph->fForceBW    = entry->fForceBW;
+    glyph->fImage = nullptr;
+    if (entry->fImageSize > 0 && entry->fImageSize == glyph->computeImageSize()) {
+        glyph->fImage = const_cast<GlyphEntry*>(entry + 1);
+    }
+    return true;
+}
+
+void SkSharedGlyphStore::addGlyphs(StrikeID strike, const uint32_t packedIDs[],
+                                   const SkGlyph* const glyphs[], int count) {
+    static_assert(0 == sizeof(GlyphEntry) % 8, "glyph images must stay aligned");
+    if (!strike || count <= 0 || this->isCorrupt()) {
+        return;
+    }
+    SkAutoMutexAcquire ac(fMutex);
+    AutoFileLock lock(fFD);
+
+    Header* header = const_cast<Header*>(this->header());
+    this->setWritable(0, sizeof(Header), true);
+    // Entries are allocated one after another, so the added ones are protected together after,
+    // in case the first shares a page with the header.
+    uint32_t addedStart = 0, addedEnd = 0;
+    for (int i = 0; i < count; ++i) {
+        const SkGlyph& glyph = *glyphs[i];
+        const uint32_t imageSize = glyph.fImage ? SkToU32(glyph.computeImageSize()) : 0;
+        const GlyphEntry* existing = this->findGlyphEntry(strike, packedIDs[i]);
+        if (this->isCorrupt()) {
+            break;
+        }
+        if (existing && (existing->fImageSize > 0 || 0 == imageSize)) {
+            continue;
+        }
+
+        const size_t length = sizeof(GlyphEntry) + imageSize;
+        uint32_t offset = this->allocate(length);
+        if (!offset) {
+            break;
+        }
+        const uint32_t bucket = glyph_bucket(strike, packedIDs[i]);
+        this->setWritable(offset, length, true);
+        GlyphEntry* entry = reinterpret_cast<GlyphEntry*>(static_cast<char*>(fBase) + offset);
+        entry->fNext       = header->fGlyphs[bucket];
+        entry->fStrike     = strike;
+        entry->fPackedID   = packedIDs[i];
+        entry->fImageSize  = imageSize;
+        entry->fAdvanceX   = glyph.fAdvanceX;
+        entry->fAdvanceY   = glyph.fAdvanceY;
+        entry->fWidth      = glyph.fWidth;
+        entry->fHeight     = glyph.fHeight;
+        entry->fTop        = glyph.fTop;
+        entry->fLeft       = glyph.fLeft;
+        entry->fMaskFormat = glyph.fMaskFormat;
+        entry->fRsbDelta   = glyph.fRsbDelta;
+        entry->fLsbDelta   = glyph.fLsbDelta;
+        entry->fForceBW    = glyph.fForceBW;
+        // The new entry hides the existing one, so it takes over its path.
+        entry->fPath       = existing ? sk_atomic_load(&existing->fPath, sk_memory_order_relaxed)
+                                      : 0;
+        if (imageSize) {
+            memcpy(entry + 1, glyph.fImage, imageSize);
+        }
+        sk_atomic_store(&header->fGlyphs[bucket], offset, sk_memory_order_release);
+        if (!addedStart) {
+            addedStart = offset;
+        }
+        addedEnd = SkToU32(offset + length);
+    }
+    if (addedStart) {
+        this->setWritable(addedStart, addedEnd - addedStart, false);
+    }
+    this->setWritable(0, sizeof(Header), false);
+}
+
+bool SkSharedGlyphStore::findPath(StrikeID strike, uint32_t packedID, SkPath* path) const {
+    const GlyphEntry* glyph = this->findGlyphEntry(strike, packedID);
+    if (!glyph) {
+        return false;
+    }
+    uint32_t offset = sk_atomic_load(&glyph->fPath, sk_memory_order_acquire);
+    const PathEntry* entry = this->at<PathEntry>(offset, sizeof(PathEntry));
+    if (!entry || !this->at<PathEntry>(offset, sizeof(PathEntry) + entry->fLength)) {
+        return false;
+    }
+    if (entry->fCompact) {
+        SkAutoTDelete<SkCompactPath> compact(SkCompactPath::CreateFromMemory(entry + 1,
+                                                                            entry->fLength));
+        if (!compact) {
+            return false;
+        }
+        compact->toPath(path);
+        return true;
+    }
+    return entry->fLength == path->readFromMemory(entry + 1, entry->fLength);
+}
+
+void SkSharedGlyphStore::addPath(StrikeID strike, uint32_t packedID, const SkPath& path) {
+    if (!strike) {
+        return;
+    }
+    SkAutoMutexAcquire ac(fMutex);
+    AutoFileLock lock(fFD);
+
+    const GlyphEntry* glyph = this->findGlyphEntry(strike, packedID);
+    if (!glyph || glyph->fPath) {
+        return;
+    }
+    // Outlines from font engines are on a fixed point grid, so most of them can be stored as
+    // SkCompactPaths, in about half the space.
+    SkAutoTDelete<SkCompactPath> compact(SkCompactPath::Create(path));
+    if (compact && compact->writeToMemory(nullptr) >= path.writeToMemory(nullptr)) {
+        compact.reset(nullptr);
+    }
+    const size_t pathLength = compact ? compact->writeToMemory(nullptr)
+                                      : path.writeToMemory(nullptr);
+    const size_t length = sizeof(PathEntry) + pathLength;
+    this->setWritable(0, sizeof(Header), true);
+    uint32_t offset = this->allocate(length);
+    this->setWritable(0, sizeof(Header), false);
+    if (!offset) {
+        return;
+    }
+    this->setWritable(offset, length, true);
+    PathEntry* entry = reinterpret_cast<PathEntry*>(static_cast<char*>(fBase) + offset);
+    entry->fLength = SkToU32(pathLength);
+    entry->fCompact = compact ? 1 : 0;
+    if (compact) {
+        compact->writeToMemory(entry + 1);
+    } else {
+        path.writeToMemory(entry + 1);
+    }
+    this->setWritable(offset, length, false);
+
+    const uint32_t glyphOffset = SkToU32(reinterpret_cast<const char*>(glyph) -
+                                         static_cast<const char*>(fBase));
+    this->setWritable(glyphOffset, sizeof(GlyphEntry), true);
+    sk_atomic_store(&const_cast<GlyphEntry*>(glyph)->fPath, offset, sk_memory_order_release);
+    this->setWritable(glyphOffset, sizeof(GlyphEntry), false);
+}
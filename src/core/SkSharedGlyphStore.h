@@ -0,0 +1,132 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkSharedGlyphStore_DEFINED
+#define SkSharedGlyphStore_DEFINED
+
+#include "SkData.h"
+#include "SkMutex.h"
+#include "SkRefCnt.h"
+
+class SkDescriptor;
+class SkGlyph;
+class SkPath;
+class SkScalerContext;
+
+/**
+ *  A store of glyph metrics, images and paths in POSIX shared memory, or in a file, so that
+ *  processes which draw the same text can each generate a glyph once for all of them, and, with
+ *  a file, so that a process can reuse the glyphs of its previous runs. Glyphs are added to the
+ *  store and never removed; once it is full, nothing more is added.
+ *
+ *  Each process maps the store read-only, and only makes the pages it writes writable while it
+ *  adds to the store. Writers take a file lock on the store, and publish each entry with a
+ *  release store after writing it, so readers never lock.
+ *
+ *  Strikes are keyed by the bytes from MakeStrikeKey, which, unlike an SkDescriptor, do not
+ *  depend on the IDs a process has given its typefaces.
+ */
+class SkSharedGlyphStore : public SkRefCnt {
+public:
+    /**
+     *  Opens the shared memory object name (e.g. "/myapp-glyphs"), creating it with room for
+     *  size bytes if no process has yet. Returns nullptr if shared memory can not be used, or if
+     *  name is not a glyph store.
+     */
+    static sk_sp<SkSharedGlyphStore> Make(const char name[], size_t size);
+
+    /**
+     *  Opens the store in the file at path, creating it with room for size bytes if it does not
+     *  exist. A file written by another version of the store or milestone of Skia, or which is not
+     *  a store, is replaced by a new one. Returns nullptr if the file can not be created or mapped.
+     */
+    static sk_sp<SkSharedGlyphStore> MakeFromFile(const char path[], size_t size);
+
+    /**
+     *  Removes the shared memory object name, so that the next Make creates a new store.
+     *  Processes which have it open may keep using it.
+     */
+    static void Unlink(const char name[]);
+
+    /**
+     *  Returns the key for the strike described by desc, whose glyphs context generates, or
+     *  nullptr if its glyphs can not be shared, e.g. because the font has no 'head' table or has
+     *  variations, or because context does not know the version of its font engine.
+     */
+    static sk_sp<SkData> MakeStrikeKey(SkScalerContext*, const SkDescriptor&);
+
+    ~SkSharedGlyphStore() override;
+
+    // Identifies a strike in the store. 0 is never a strike.
+    typedef uint32_t StrikeID;
+
+    /** Returns the strike with key, adding it if it is new, or 0 if the store is full. */
+    StrikeID findOrAddStrike(const SkData& key);
+
+    /**
+     *  If the store has the glyph packedID of strike, sets glyph's metrics from it and returns
+     *  true. If the store also has its image, glyph.fImage points to it, otherwise it is null.
+     */
+    bool findGlyph(StrikeID strike, uint32_t packedID, SkGlyph* glyph) const;
+
+    /**
+     *  Adds the metrics of each glyph, and their images if they are not null, to strike.
+     *  Glyphs already in the strike with an image are skipped. Stops if the store fills up.
+     */
+    void addGlyphs(StrikeID strike, const uint32_t packedIDs[], const SkGlyph* const glyphs[],
+                   int count);
+
+    /**
+     *  If the store has the path of the glyph packedID of strike, sets path to it and returns
+     *  true.
+     */
+    bool findPath(StrikeID strike, uint32_t packedID, SkPath* path) const;
+
+    /** Adds path to the glyph packedID of strike, which must already have been added. */
+    void addPath(StrikeID strike, uint32_t packedID, const SkPath& path);
+
+    /** Returns the bytes used in the store, by all processes. */
+    size_t bytesUsed() const;
+
+    /**
+     *  Returns true if a lookup found the store's entries linked in a way no writer links them,
+     *  e.g. into a cycle, as a damaged file would be. From then on, this store finds nothing and
+     *  adds nothing.
+     */
+    bool isCorrupt() const;
+
+private:
+    struct Header;
+    struct StrikeEntry;
+    struct GlyphEntry;
+    struct PathEntry;
+
+    SkSharedGlyphStore(int fd, void* base, size_t size);
+
+    // Maps the store in fd, which is empty or holds a store. Closes fd if it fails.
+    static sk_sp<SkSharedGlyphStore> MakeFromFD(int fd, size_t size);
+
+    const Header* header() const { return static_cast<const Header*>(fBase); }
+    template <typename T> const T* at(uint32_t offset, size_t length) const;
+    const GlyphEntry* findGlyphEntry(StrikeID strike, uint32_t packedID) const;
+    void markCorrupt() const;
+
+    // Must be called with fMutex held, and the file locked.
+    uint32_t allocate(size_t length);
+    void setWritable(uint32_t offset, size_t length, bool writable);
+
+    const int       fFD;
+    void* const     fBase;
+    const size_t    fSize;
+    mutable bool    fCorrupt;
+    // Serializes the writers of this process; the file lock serializes those of other processes.
+    SkMutex         fMutex;
+
+    typedef SkRefCnt INHERITED;
+};
+
+#endif
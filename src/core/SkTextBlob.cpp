@@ -8,6 +8,7 @@
 #include "SkTextBlobRunIterator.h"
 
 #include "SkReadBuffer.h"
+#include "SkTextBlobRasterCache.h"
 #include "SkTypeface.h"
 #include "SkWriteBuffer.h"
 
@@ -205,10 +206,15 @@ static int32_t next_id() {
 SkTextBlob::SkTextBlob(int runCount, const SkRect& bounds)
     : fRunCount(runCount)
     , fBounds(bounds)
-    , fUniqueID(next_id()) {
+    , fUniqueID(next_id())
+    , fAddedToCache(false) {
 }
 
 SkTextBlob::~SkTextBlob() {
+    if (fAddedToCache.load()) {
+        SkTextBlobRasterCache::PostPurgeBlob(fUniqueID);
+    }
+
     const RunRecord* run = RunRecord::First(this);
     for (int i = 0; i < fRunCount; ++i) {
         const RunRecord* nextRun = RunRecord::Next(run);
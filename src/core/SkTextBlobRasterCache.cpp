@@ -0,0 +1,134 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDescriptor.h"
+#include "SkMatrix.h"
+#include "SkResourceCache.h"
+#include "SkTextBlob.h"
+#include "SkTextBlobRasterCache.h"
+
+#define CHECK_LOCAL(localCache, localName, globalName, ...) \
+    ((localCache) ? localCache->localName(__VA_ARGS__) : SkResourceCache::globalName(__VA_ARGS__))
+
+static uint64_t make_shared_id(uint32_t blobID) {
+    uint64_t sharedID = SkSetFourByteTag('t', 'b', 'l', 'b');
+    return (sharedID << 32) | blobID;
+}
+
+namespace {
+static unsigned gTextBlobRunKeyNamespaceLabel;
+
+struct TextBlobRunKey : public SkResourceCache::Key {
+    TextBlobRunKey(uint32_t blobID, int runIndex, SkVector fraction, const SkMatrix& matrix,
+                   const SkDescriptor& desc)
+        : fBlobID(blobID)
+        , fRunIndex(runIndex)
+        , fDescChecksum(desc.getChecksum())
+        , fFractionX(fraction.fX)
+        , fFractionY(fraction.fY)
+        , fScaleX(matrix.getScaleX())
+        , fSkewX(matrix.getSkewX())
+        , fSkewY(matrix.getSkewY())
+        , fScaleY(matrix.getScaleY())
+    {
+        // The translate is covered by the fraction; perspective text is not cached.
+        this->init(&gTextBlobRunKeyNamespaceLabel, make_shared_id(blobID),
+                   sizeof(fBlobID) + sizeof(fRunIndex) + sizeof(fDescChecksum) +
+                   sizeof(fFractionX) + sizeof(fFractionY) +
+                   sizeof(fScaleX) + sizeof(fSkewX) + sizeof(fSkewY) + sizeof(fScaleY));
+    }
+
+    uint32_t fBlobID;
+    int32_t  fRunIndex;
+    uint32_t fDescChecksum;
+    SkScalar fFractionX;
+    SkScalar fFractionY;
+    SkScalar fScaleX;
+    SkScalar fSkewX;
+    SkScalar fSkewY;
+    SkScalar fScaleY;
+};
+
+struct TextBlobRunRec : public SkResourceCache::Rec {
+    TextBlobRunRec(const TextBlobRunKey& key, const SkDescriptor& desc, sk_sp<SkData> glyphs)
+        : fKey(key)
+        , fDesc(desc.copy())
+        , fGlyphs(std::move(glyphs))
+    {}
+    ~TextBlobRunRec() override {
+        SkDescriptor::Free(fDesc);
+    }
+
+    TextBlobRunKey      fKey;
+    SkDescriptor* const fDesc;
+    sk_sp<SkData>       fGlyphs;
+
+    const Key& getKey() const override { return fKey; }
+    size_t bytesUsed() const override {
+        return sizeof(*this) + fDesc->getLength() + fGlyphs->size();
+    }
+    const char* getCategory() const override { return "text-blob-run"; }
+
+    struct Context {
+        const SkDescriptor* fDesc;
+        sk_sp<SkData>       fGlyphs;
+    };
+
+    static bool Visitor(const SkResourceCache::Rec& baseRec, void* contextData) {
+        const TextBlobRunRec& rec = static_cast<const TextBlobRunRec&>(baseRec);
+        Context* context = static_cast<Context*>(contextData);
+
+        // Only the checksum of the descriptor is in the key; a run whose descriptor differs is
+        // purged, to make room for the one it collided with.
+        if (*rec.fDesc != *context->fDesc) {
+            return false;
+        }
+        context->fGlyphs = rec.fGlyphs;
+        return true;
+    }
+};
+} // namespace
+
+bool SkTextBlobRasterCache::MapOrigin(SkPoint origin, const SkMatrix& matrix, SkIPoint* whole,
+                                      SkVector* fraction) {
+    SkPoint device;
+    matrix.mapXY(origin.fX, origin.fY, &device);
+
+    // Glyphs past this are not drawn anyway, and it keeps the whole pixel in range of an int.
+    const SkScalar kMaxOrigin = SkIntToScalar(1 << 30);
+    if (!(SkScalarAbs(device.fX) < kMaxOrigin && SkScalarAbs(device.fY) < kMaxOrigin)) {
+        return false;
+    }
+    whole->set(SkScalarFloorToInt(device.fX), SkScalarFloorToInt(device.fY));
+    fraction->set(device.fX - SkIntToScalar(whole->fX), device.fY - SkIntToScalar(whole->fY));
+    return true;
+}
+
+sk_sp<SkData> SkTextBlobRasterCache::FindRun(const SkTextBlob& blob, int runIndex,
+                                             SkVector fraction, const SkMatrix& matrix,
+                                             const SkDescriptor& desc,
+                                             SkResourceCache* localCache) {
+    TextBlobRunKey key(blob.uniqueID(), runIndex, fraction, matrix, desc);
+    TextBlobRunRec::Context context = { &desc, nullptr };
+    if (!CHECK_LOCAL(localCache, find, Find, key, TextBlobRunRec::Visitor, &context)) {
+        return nullptr;
+    }
+    return context.fGlyphs;
+}
+
+void SkTextBlobRasterCache::AddRun(const SkTextBlob& blob, int runIndex, SkVector fraction,
+                                   const SkMatrix& matrix, const SkDescriptor& desc,
+                                   sk_sp<SkData> glyphs, SkResourceCache* localCache) {
+    SkASSERT(!matrix.hasPerspective());
+    TextBlobRunKey key(blob.uniqueID(), runIndex, fraction, matrix, desc);
+    CHECK_LOCAL(localCache, add, Add, new TextBlobRunRec(key, desc, std::move(glyphs)));
+    blob.notifyAddedToCache();
+}
+
+void SkTextBlobRasterCache::PostPurgeBlob(uint32_t uniqueID) {
+    SkResourceCache::PostPurgeSharedID(make_shared_id(uniqueID));
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkTextBlobRasterCache_DEFINED
+#define SkTextBlobRasterCache_DEFINED
+
+#include "SkData.h"
+#include "SkFixed.h"
+#include "SkPoint.h"
+#include "SkRect.h"
+
+class SkDescriptor;
+class SkMatrix;
+class SkResourceCache;
+class SkTextBlob;
+
+/**
+ *  Keeps where the raster backend put the glyphs of each run of a text blob, so that drawing the
+ *  blob again with the same matrix and fonts only has to find their images and blit them.
+ *
+ *  Runs are kept in SkResourceCache, keyed by the blob's unique ID, the index of the run, the
+ *  scale and skew of the matrix, the fraction of a pixel where the blob's origin lands, and the
+ *  descriptor of the run's strike. The glyphs are placed relative to the whole pixel where the
+ *  origin lands, so a blob drawn again at a whole pixel offset, as when scrolling, is a hit.
+ *  Runs are purged when the blob is destroyed.
+ */
+class SkTextBlobRasterCache {
+public:
+    /**
+     *  A glyph of a run, as SkGlyphCache::getGlyphIDMetrics takes it, and its bounds before
+     *  clipping, relative to the whole pixel where the blob's origin lands.
+     */
+    struct Glyph {
+        uint16_t fGlyphID;
+        SkFixed  fSubX;
+        SkFixed  fSubY;
+        SkIRect  fBounds;
+    };
+
+    /**
+     *  Splits the device space position of origin under matrix into the whole pixel that Glyphs
+     *  are relative to, and the fraction that is left over. Returns false if the position is
+     *  too far from device space to be cached.
+     */
+    static bool MapOrigin(SkPoint origin, const SkMatrix& matrix, SkIPoint* whole,
+                          SkVector* fraction);
+
+    /**
+     *  Returns the Glyphs of run runIndex of blob, drawn with matrix into the strike described by
+     *  desc, at an origin that MapOrigin() splits to fraction, or nullptr if they are not in the
+     *  cache.
+     */
+    static sk_sp<SkData> FindRun(const SkTextBlob& blob, int runIndex, SkVector fraction,
+                                 const SkMatrix& matrix, const SkDescriptor& desc,
+                                 SkResourceCache* localCache = nullptr);
+
+    /**
+     *  Adds the Glyphs of run runIndex of blob, drawn with matrix into the strike described by
+     *  desc, at an origin that MapOrigin() splits to fraction, to the cache.
+     */
+    static void AddRun(const SkTextBlob& blob, int runIndex, SkVector fraction,
+                       const SkMatrix& matrix, const SkDescriptor& desc, sk_sp<SkData> glyphs,
+                       SkResourceCache* localCache = nullptr);
+
+    /** Purges the runs of the blob with uniqueID from the cache. */
+    static void PostPurgeBlob(uint32_t uniqueID);
+};
+
+#endif
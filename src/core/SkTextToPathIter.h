@@ -10,6 +10,7 @@
 
 #include "SkAutoKern.h"
 #include "SkPaint.h"
+#include "SkPath.h"
 
 class SkGlyphCache;
 
@@ -43,9 +44,13 @@ public:
     SkScalar        getPathScale() const { return fScale; }
 
     /**
-     *  Returns false when all of the text has been consumed
+     *  Returns false when all of the text has been consumed. The path is valid until the next
+     *  call.
      */
     bool next(const SkPath** path, SkScalar* xpos);
+
+private:
+    SkPath  fPath;
 };
 
 class SkTextInterceptsIter : SkTextBaseIter {
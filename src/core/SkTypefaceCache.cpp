@@ -9,6 +9,7 @@
 
 #include "SkTypefaceCache.h"
 #include "SkAtomics.h"
+#include "SkChecksum.h"
 #include "SkMutex.h"
 
 #define TYPEFACE_CACHE_LIMIT    1024
@@ -20,32 +21,71 @@ void SkTypefaceCache::add(SkTypeface* face) {
         this->purge(TYPEFACE_CACHE_LIMIT >> 2);
     }
 
-    fTypefaces.emplace_back(SkRef(face));
+    fTypefaces.push_back(Entry{ sk_ref_sp(face), false, 0, -1 });
+}
+
+void SkTypefaceCache::add(SkTypeface* face, uint32_t hash) {
+    if (fTypefaces.count() >= TYPEFACE_CACHE_LIMIT) {
+        this->purge(TYPEFACE_CACHE_LIMIT >> 2);
+    }
+
+    fTypefaces.push_back(Entry{ sk_ref_sp(face), true, hash, -1 });
+    this->index(fTypefaces.count() - 1);
+}
+
+void SkTypefaceCache::index(int i) {
+    Entry& entry = fTypefaces[i];
+    SkASSERT(entry.fHashed);
+    int* last = fHashIndex.find(entry.fHash);
+    entry.fNext = last ? *last : -1;
+    fHashIndex.set(entry.fHash, i);
 }
 
 SkTypeface* SkTypefaceCache::findByProcAndRef(FindProc proc, void* ctx) const {
-    for (const sk_sp<SkTypeface>& typeface : fTypefaces) {
-        if (proc(typeface.get(), ctx)) {
-            return SkRef(typeface.get());
+    for (const Entry& entry : fTypefaces) {
+        if (proc(entry.fTypeface.get(), ctx)) {
+            return SkRef(entry.fTypeface.get());
+        }
+    }
+    return nullptr;
+}
+
+SkTypeface* SkTypefaceCache::findByHashAndProcAndRef(uint32_t hash, FindProc proc,
+                                                     void* ctx) const {
+    int* last = fHashIndex.find(hash);
+    for (int i = last ? *last : -1; i >= 0; i = fTypefaces[i].fNext) {
+        SkASSERT(fTypefaces[i].fHashed && fTypefaces[i].fHash == hash);
+        if (proc(fTypefaces[i].fTypeface.get(), ctx)) {
+            return SkRef(fTypefaces[i].fTypeface.get());
         }
     }
     return nullptr;
 }
 
 void SkTypefaceCache::purge(int numToPurge) {
-    int count = fTypefaces.count();
+    const int oldCount = fTypefaces.count();
+    int count = oldCount;
     int i = 0;
-    while (i < count) {
-        if (fTypefaces[i]->unique()) {
+    while (i < count && numToPurge > 0) {
+        if (fTypefaces[i].fTypeface->unique()) {
             fTypefaces.removeShuffle(i);
             --count;
-            if (--numToPurge == 0) {
-                return;
-            }
+            --numToPurge;
         } else {
             ++i;
         }
     }
+    if (count == oldCount) {
+        return;
+    }
+
+    // Removing entries moved others, so index them again.
+    fHashIndex.reset();
+    for (i = 0; i < count; ++i) {
+        if (fTypefaces[i].fHashed) {
+            this->index(i);
+        }
+    }
 }
 
 void SkTypefaceCache::purgeAll() {
@@ -64,6 +104,10 @@ SkFontID SkTypefaceCache::NewFontID() {
     return sk_atomic_inc(&gFontID) + 1;
 }
 
+uint32_t SkTypefaceCache::FileHash(const char path[], int ttcIndex) {
+    return SkChecksum::Murmur3(path, strlen(path), ttcIndex);
+}
+
 SK_DECLARE_STATIC_MUTEX(gMutex);
 
 void SkTypefaceCache::Add(SkTypeface* face) {
@@ -71,11 +115,21 @@ void SkTypefaceCache::Add(SkTypeface* face) {
     Get().add(face);
 }
 
+void SkTypefaceCache::Add(SkTypeface* face, uint32_t hash) {
+    SkAutoMutexAcquire ama(gMutex);
+    Get().add(face, hash);
+}
+
 SkTypeface* SkTypefaceCache::FindByProcAndRef(FindProc proc, void* ctx) {
     SkAutoMutexAcquire ama(gMutex);
     return Get().findByProcAndRef(proc, ctx);
 }
 
+SkTypeface* SkTypefaceCache::FindByHashAndProcAndRef(uint32_t hash, FindProc proc, void* ctx) {
+    SkAutoMutexAcquire ama(gMutex);
+    return Get().findByHashAndProcAndRef(hash, proc, ctx);
+}
+
 void SkTypefaceCache::PurgeAll() {
     SkAutoMutexAcquire ama(gMutex);
     Get().purgeAll();
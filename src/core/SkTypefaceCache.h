@@ -11,8 +11,9 @@
 #define SkTypefaceCache_DEFINED
 
 #include "SkRefCnt.h"
-#include "SkTypeface.h"
 #include "SkTArray.h"
+#include "SkTHash.h"
+#include "SkTypeface.h"
 
 class SkTypefaceCache {
 public:
@@ -33,6 +34,15 @@ public:
      */
     void add(SkTypeface*);
 
+    /**
+     *  Add a typeface to the cache, as add(SkTypeface*) does, indexed by hash
+     *  so that findByHashAndProcAndRef(hash, ...) only has to check the
+     *  typefaces added with the same hash. The hash is computed by the caller
+     *  from whatever identifies its typefaces, e.g. its LOGFONT or file (see
+     *  FileHash); typefaces which proc matches must have the same hash.
+     */
+    void add(SkTypeface*, uint32_t hash);
+
     /**
      *  Iterate through the cache, calling proc(typeface, ctx) with each
      *  typeface. If proc returns true, then we return that typeface (this
@@ -40,6 +50,12 @@ public:
      */
     SkTypeface* findByProcAndRef(FindProc proc, void* ctx) const;
 
+    /**
+     *  As findByProcAndRef, but only calls proc with the typefaces which were
+     *  added with hash.
+     */
+    SkTypeface* findByHashAndProcAndRef(uint32_t hash, FindProc proc, void* ctx) const;
+
     /**
      *  This will unref all of the typefaces in the cache for which the cache
      *  is the only owner. Normally this is handled automatically as needed.
@@ -54,10 +70,18 @@ public:
      */
     static SkFontID NewFontID();
 
+    /**
+     *  Helper: returns the hash of the face at ttcIndex in the file at path,
+     *  for typefaces identified by their file.
+     */
+    static uint32_t FileHash(const char path[], int ttcIndex);
+
     // These are static wrappers around a global instance of a cache.
 
     static void Add(SkTypeface*);
+    static void Add(SkTypeface*, uint32_t hash);
     static SkTypeface* FindByProcAndRef(FindProc proc, void* ctx);
+    static SkTypeface* FindByHashAndProcAndRef(uint32_t hash, FindProc proc, void* ctx);
     static void PurgeAll();
 
     /**
@@ -69,8 +93,18 @@ private:
     static SkTypefaceCache& Get();
 
     void purge(int count);
-
-    SkTArray<sk_sp<SkTypeface>> fTypefaces;
+    void index(int i);
+
+    struct Entry {
+        sk_sp<SkTypeface> fTypeface;
+        bool              fHashed;
+        uint32_t          fHash;
+        int               fNext;  // the index of the next entry with fHash, or -1
+    };
+
+    SkTArray<Entry> fTypefaces;
+    // The index of the last entry added with each hash.
+    SkTHashMap<uint32_t, int> fHashIndex;
 };
 
 #endif
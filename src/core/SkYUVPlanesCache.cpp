@@ -21,14 +21,16 @@ struct YUVValue {
 };
 
 struct YUVPlanesKey : public SkResourceCache::Key {
-    YUVPlanesKey(uint32_t genID)
+    YUVPlanesKey(uint32_t genID, int32_t level)
         : fGenID(genID)
+        , fLevel(level)
     {
         this->init(&gYUVPlanesKeyNamespaceLabel, SkMakeResourceCacheSharedIDForBitmap(genID),
-                   sizeof(genID));
+                   sizeof(genID) + sizeof(level));
     }
 
     uint32_t fGenID;
+    int32_t  fLevel;
 };
 
 struct YUVPlanesRec : public SkResourceCache::Rec {
@@ -72,8 +74,18 @@ struct YUVPlanesRec : public SkResourceCache::Rec {
 
 SkCachedData* SkYUVPlanesCache::FindAndRef(uint32_t genID, Info* info,
                                            SkResourceCache* localCache) {
+    return FindAndRefLevel(genID, 0, info, localCache);
+}
+
+void SkYUVPlanesCache::Add(uint32_t genID, SkCachedData* data, Info* info,
+                           SkResourceCache* localCache) {
+    AddLevel(genID, 0, data, info, localCache);
+}
+
+SkCachedData* SkYUVPlanesCache::FindAndRefLevel(uint32_t genID, int level, Info* info,
+                                                SkResourceCache* localCache) {
     YUVValue result;
-    YUVPlanesKey key(genID);
+    YUVPlanesKey key(genID, level);
     if (!CHECK_LOCAL(localCache, find, Find, key, YUVPlanesRec::Visitor, &result)) {
         return nullptr;
     }
@@ -82,8 +94,8 @@ SkCachedData* SkYUVPlanesCache::FindAndRef(uint32_t genID, Info* info,
     return result.fData;
 }
 
-void SkYUVPlanesCache::Add(uint32_t genID, SkCachedData* data, Info* info,
-                           SkResourceCache* localCache) {
-    YUVPlanesKey key(genID);
+void SkYUVPlanesCache::AddLevel(uint32_t genID, int level, SkCachedData* data, Info* info,
+                                SkResourceCache* localCache) {
+    YUVPlanesKey key(genID, level);
     return CHECK_LOCAL(localCache, add, Add, new YUVPlanesRec(key, data, info));
 }
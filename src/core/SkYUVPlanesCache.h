@@ -40,6 +40,15 @@ public:
      */
     static void Add(uint32_t genID, SkCachedData* data, Info* info,
                     SkResourceCache* localCache = nullptr);
+
+    /**
+     * Like FindAndRef() and Add(), for a copy of the planes downscaled by 2^level. Level 0 is
+     * the planes themselves.
+     */
+    static SkCachedData* FindAndRefLevel(uint32_t genID, int level, Info* info,
+                                         SkResourceCache* localCache = nullptr);
+    static void AddLevel(uint32_t genID, int level, SkCachedData* data, Info* info,
+                         SkResourceCache* localCache = nullptr);
 };
 
 #endif
@@ -0,0 +1,389 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkYUVShaderContext.h"
+
+#include "SkColorPriv.h"
+#include "SkFixed.h"
+#include "SkNx.h"
+#include "SkPaint.h"
+
+#include <new>
+
+// Rows of the YUV -> RGB matrices, in the same normalized units as GrYUVEffect's: R, G and B are
+// dot products of these with (Y, U, V, 1).
+static const float kJPEGConversionMatrix[3][4] = {
+    { 1.0f,  0.0f,      1.402f,   -0.701f },
+    { 1.0f, -0.34414f, -0.71414f,  0.529f },
+    { 1.0f,  1.772f,    0.0f,     -0.886f },
+};
+
+static const float kRec601ConversionMatrix[3][4] = {
+    { 1.164f,  0.0f,    1.596f, -0.87075f },
+    { 1.164f, -0.391f, -0.813f,  0.52925f },
+    { 1.164f,  2.018f,  0.0f,   -1.08175f },
+};
+
+static const float kRec709ConversionMatrix[3][4] = {
+    { 1.164f,  0.0f,    1.793f, -0.96925f },
+    { 1.164f, -0.213f, -0.533f,  0.30025f },
+    { 1.164f,  2.112f,  0.0f,   -1.12875f },
+};
+
+// Pixels are sampled and converted this many at a time.
+static const int kChunk = 64;
+
+// The most columns of a plane one chunk's boxes can cover and still be summed in one pass.
+static const int kMaxBoxColumns = kChunk * SkYUVShaderContext::kMaxBoxTaps;
+
+SkShader::Context* SkYUVShaderContext::Make(const SkShader& shader,
+                                            const SkShader::ContextRec& rec, void* storage,
+                                            int width, int height, SkCachedData* data,
+                                            const SkYUVPlanesCache::Info& info,
+                                            const void* planes[3]) {
+    const SkYUVSizeInfo& sizes = info.fSizeInfo;
+    if (!data || sizes.fSizes[SkYUVSizeInfo::kY].width() > width ||
+            sizes.fSizes[SkYUVSizeInfo::kY].height() > height) {
+        return nullptr;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (sizes.fSizes[i].isEmpty()) {
+            return nullptr;
+        }
+    }
+
+    SkYUVShaderContext* ctx = new (storage) SkYUVShaderContext(shader, rec, data);
+    const SkMatrix& inverse = ctx->getTotalInverse();
+    if (kPerspective_MatrixClass == ctx->getInverseClass() ||
+            kFixedStepInX_MatrixClass == ctx->getInverseClass()) {
+        ctx->~SkYUVShaderContext();
+        return nullptr;
+    }
+
+    // How many texels of the image one device pixel covers in each direction.
+    const float scaleX = SkPoint::Length(inverse.getScaleX(), inverse.getSkewY()),
+                scaleY = SkPoint::Length(inverse.getSkewX(), inverse.getScaleY());
+    const SkFilterQuality quality = rec.fPaint->getFilterQuality();
+    // The Y plane may be a downscaled level. Like mipmaps, a level drawn at up to twice its size
+    // is sampled bilinearly, and, like SkBitmapProcState, one drawn at an integer translate needs
+    // no filtering.
+    const float levelX = (float)sizes.fSizes[SkYUVSizeInfo::kY].width() / width,
+                levelY = (float)sizes.fSizes[SkYUVSizeInfo::kY].height() / height;
+    const float levelScaleX = scaleX * levelX,
+                levelScaleY = scaleY * levelY;
+    SkMatrix levelInverse = inverse;
+    levelInverse.postScale(levelX, levelY);
+    const bool integerTranslate = levelInverse.getType() <= SkMatrix::kTranslate_Mask &&
+                                  SkScalarIsInt(levelInverse.getTranslateX()) &&
+                                  SkScalarIsInt(levelInverse.getTranslateY());
+    if (kNone_SkFilterQuality == quality || integerTranslate) {
+        ctx->fFilter = kNearest_Filter;
+    } else if (quality >= kMedium_SkFilterQuality && SkTMax(levelScaleX, levelScaleY) >= 2) {
+        ctx->fFilter = kBox_Filter;
+    } else {
+        ctx->fFilter = kBilinear_Filter;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        Plane& plane = ctx->fPlanes[i];
+        plane.fPixels = (const uint8_t*)planes[i];
+        plane.fRowBytes = sizes.fWidthBytes[i];
+        plane.fWidth = sizes.fSizes[i].width();
+        plane.fHeight = sizes.fSizes[i].height();
+        plane.fScaleX = (float)plane.fWidth / width;
+        plane.fScaleY = (float)plane.fHeight / height;
+        plane.fBoxWidth = SkTMin(plane.fWidth, SkTMax(1, (int)(scaleX * plane.fScaleX + 0.5f)));
+        plane.fBoxHeight = SkTMin(plane.fHeight, SkTMax(1, (int)(scaleY * plane.fScaleY + 0.5f)));
+        // Very large downscales would read a lot of texels per pixel, so their taps are spread
+        // evenly over the box.
+        plane.fTapsX = SkTMin(plane.fBoxWidth, kMaxBoxTaps);
+        plane.fTapsY = SkTMin(plane.fBoxHeight, kMaxBoxTaps);
+        for (int j = 0; j < plane.fTapsX; j++) {
+            plane.fTapOffsetsX[j] = (2 * j + 1) * plane.fBoxWidth / (2 * plane.fTapsX);
+        }
+        for (int j = 0; j < plane.fTapsY; j++) {
+            plane.fTapOffsetsY[j] = (2 * j + 1) * plane.fBoxHeight / (2 * plane.fTapsY);
+        }
+    }
+
+    const float (*matrix)[4] = kJPEGConversionMatrix;
+    switch (info.fColorSpace) {
+        case kRec601_SkYUVColorSpace: matrix = kRec601ConversionMatrix; break;
+        case kRec709_SkYUVColorSpace: matrix = kRec709ConversionMatrix; break;
+        default:                                                        break;
+    }
+    // Fold the paint's alpha into the matrix, as the pixels are opaque.
+    const float alphaScale = ctx->getPaintAlpha() * (1.0f / 255);
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 3; col++) {
+            ctx->fMatrix[row][col] = matrix[row][col] * alphaScale;
+        }
+        ctx->fMatrix[row][3] = matrix[row][3] * 255 * alphaScale;
+    }
+    return ctx;
+}
+
+int SkYUVShaderContext::ChooseLevel(const SkShader::ContextRec& rec,
+                                    const SkMatrix& totalInverse) {
+    if (rec.fPaint->getFilterQuality() < kMedium_SkFilterQuality ||
+            totalInverse.hasPerspective()) {
+        return 0;
+    }
+    const float scale = SkTMin(SkPoint::Length(totalInverse.getScaleX(),
+                                               totalInverse.getSkewY()),
+                               SkPoint::Length(totalInverse.getSkewX(),
+                                               totalInverse.getScaleY()));
+    // Past this, the levels are a texel or two, and no cheaper to sample.
+    const int kMaxLevel = 12;
+    int level = 0;
+    while (level < kMaxLevel && scale >= (2 << level)) {
+        level++;
+    }
+    return level;
+}
+
+SkYUVShaderContext::SkYUVShaderContext(const SkShader& shader, const SkShader::ContextRec& rec,
+                                       SkCachedData* data)
+    : INHERITED(shader, rec)
+    , fData(SkRef(data))
+{}
+
+SkYUVShaderContext::~SkYUVShaderContext() {
+    fData->unref();
+}
+
+uint32_t SkYUVShaderContext::getFlags() const {
+    return 0xFF == this->getPaintAlpha() ? SkShader::kOpaqueAlpha_Flag : 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////
+
+typedef SkYUVShaderContext::Plane Plane;
+
+static inline int clamp(int v, int limit) {
+    return SkTPin(v, 0, limit - 1);
+}
+
+static inline const uint8_t* row_addr(const Plane& plane, int y) {
+    return plane.fPixels + y * plane.fRowBytes;
+}
+
+static inline int box_corner(float center, int boxSize, int limit) {
+    return SkTPin((int)floorf(center - boxSize * 0.5f + 0.5f), 0, limit - boxSize);
+}
+
+static inline float box_sum(const Plane& plane, const uint8_t* const rows[], int left) {
+    int sum = 0;
+    for (int ty = 0; ty < plane.fTapsY; ty++) {
+        const uint8_t* row = rows[ty] + left;
+        for (int tx = 0; tx < plane.fTapsX; tx++) {
+            sum += row[plane.fTapOffsetsX[tx]];
+        }
+    }
+    return sum * (1.0f / (plane.fTapsX * plane.fTapsY));
+}
+
+// Samples n pixels of plane into dst, starting at (fx, fy) in plane coordinates and stepping by
+// (dx, dy). The samples are left in 8-bit units.
+static void sample_any(const Plane& plane, SkYUVShaderContext::Filter filter,
+                       float fx, float fy, float dx, float dy, int n, float dst[]) {
+    switch (filter) {
+        case SkYUVShaderContext::kNearest_Filter:
+            for (int i = 0; i < n; i++, fx += dx, fy += dy) {
+                const int x = clamp((int)floorf(fx), plane.fWidth),
+                          y = clamp((int)floorf(fy), plane.fHeight);
+                dst[i] = row_addr(plane, y)[x];
+            }
+            break;
+
+        case SkYUVShaderContext::kBilinear_Filter:
+            for (int i = 0; i < n; i++, fx += dx, fy += dy) {
+                // Texel centers are at half-integers.
+                const float sx = fx - 0.5f, sy = fy - 0.5f;
+                const float left = floorf(sx), top = floorf(sy);
+                const float wx = sx - left, wy = sy - top;
+                const int x0 = clamp((int)left, plane.fWidth),
+                          x1 = clamp((int)left + 1, plane.fWidth),
+                          y0 = clamp((int)top, plane.fHeight),
+                          y1 = clamp((int)top + 1, plane.fHeight);
+                const uint8_t* row0 = row_addr(plane, y0);
+                const uint8_t* row1 = row_addr(plane, y1);
+                const float upper = row0[x0] + wx * (row0[x1] - row0[x0]),
+                            lower = row1[x0] + wx * (row1[x1] - row1[x0]);
+                dst[i] = upper + wy * (lower - upper);
+            }
+            break;
+
+        case SkYUVShaderContext::kBox_Filter:
+            for (int i = 0; i < n; i++, fx += dx, fy += dy) {
+                // The box is centered on (fx, fy), and moved inside the plane at its edges.
+                const int top = box_corner(fy, plane.fBoxHeight, plane.fHeight);
+                const uint8_t* rows[SkYUVShaderContext::kMaxBoxTaps];
+                for (int ty = 0; ty < plane.fTapsY; ty++) {
+                    rows[ty] = row_addr(plane, top + plane.fTapOffsetsY[ty]);
+                }
+                dst[i] = box_sum(plane, rows, box_corner(fx, plane.fBoxWidth, plane.fWidth));
+            }
+            break;
+    }
+}
+
+// Like sample_any(), for spans that stay on one row of the plane (i.e. the draw only scales and
+// translates). The rows are found once, and x steps in 16.16 fixed point. Returns false if the
+// span's coordinates are too large for that.
+static bool sample_row(const Plane& plane, SkYUVShaderContext::Filter filter,
+                       float fx, float fy, float dx, int n, float dst[]) {
+    const float kLimit = 16384;
+    if (!(SkTAbs(fx) < kLimit && SkTAbs(fx + n * dx) < kLimit && SkTAbs(fy) < kLimit)) {
+        return false;
+    }
+    const SkFixed step = SkFloatToFixed(dx);
+
+    switch (filter) {
+        case SkYUVShaderContext::kNearest_Filter: {
+            const uint8_t* row = row_addr(plane, clamp((int)floorf(fy), plane.fHeight));
+            SkFixed x = SkFloatToFixed(fx);
+            for (int i = 0; i < n; i++, x += step) {
+                dst[i] = row[clamp(x >> 16, plane.fWidth)];
+            }
+            break;
+        }
+
+        case SkYUVShaderContext::kBilinear_Filter: {
+            const float sy = fy - 0.5f, top = floorf(sy);
+            const int wy = (int)((sy - top) * 256);
+            const uint8_t* row0 = row_addr(plane, clamp((int)top, plane.fHeight));
+            const uint8_t* row1 = row_addr(plane, clamp((int)top + 1, plane.fHeight));
+            SkFixed x = SkFloatToFixed(fx - 0.5f);
+            for (int i = 0; i < n; i++, x += step) {
+                const int x0 = clamp(x >> 16, plane.fWidth),
+                          x1 = clamp((x >> 16) + 1, plane.fWidth),
+                          wx = (x >> 8) & 0xFF;
+                const int upper = (row0[x0] << 8) + wx * (row0[x1] - row0[x0]),
+                          lower = (row1[x0] << 8) + wx * (row1[x1] - row1[x0]);
+                dst[i] = ((upper << 8) + wy * (lower - upper)) * (1.0f / 65536);
+            }
+            break;
+        }
+
+        case SkYUVShaderContext::kBox_Filter: {
+            const int top = box_corner(fy, plane.fBoxHeight, plane.fHeight);
+            const uint8_t* rows[SkYUVShaderContext::kMaxBoxTaps];
+            for (int ty = 0; ty < plane.fTapsY; ty++) {
+                rows[ty] = row_addr(plane, top + plane.fTapOffsetsY[ty]);
+            }
+            // The left edge of each box, rounded: fx - boxWidth/2 + 1/2.
+            SkFixed left = SkFloatToFixed(fx) - (plane.fBoxWidth << 15) + SK_FixedHalf;
+            const int maxLeft = plane.fWidth - plane.fBoxWidth;
+            const int first = SkTPin(SkTMin(left, left + (n - 1) * step) >> 16, 0, maxLeft),
+                      last = SkTPin(SkTMax(left, left + (n - 1) * step) >> 16, 0, maxLeft);
+            const int columns = last - first + plane.fBoxWidth;
+            if (plane.fTapsX < plane.fBoxWidth || plane.fTapsY < plane.fBoxHeight ||
+                    columns > kMaxBoxColumns) {
+                for (int i = 0; i < n; i++, left += step) {
+                    dst[i] = box_sum(plane, rows, SkTPin(left >> 16, 0, maxLeft));
+                }
+                break;
+            }
+            // When every texel of the box is sampled, sum the columns the span covers once, and
+            // then each box is a run of those sums.
+            uint16_t sums[kMaxBoxColumns];
+            for (int c = 0; c < columns; c++) {
+                sums[c] = rows[0][first + c];
+            }
+            for (int ty = 1; ty < plane.fTapsY; ty++) {
+                const uint8_t* row = rows[ty] + first;
+                for (int c = 0; c < columns; c++) {
+                    sums[c] += row[c];
+                }
+            }
+            const float invArea = 1.0f / (plane.fBoxWidth * plane.fBoxHeight);
+            for (int i = 0; i < n; i++, left += step) {
+                const uint16_t* box = sums + SkTPin(left >> 16, 0, maxLeft) - first;
+                int sum = 0;
+                for (int tx = 0; tx < plane.fBoxWidth; tx++) {
+                    sum += box[tx];
+                }
+                dst[i] = sum * invArea;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+// Samples n pixels of plane into dst, starting at (fx, fy) in image coordinates and stepping by
+// (dx, dy).
+static void sample_plane(const Plane& plane, SkYUVShaderContext::Filter filter,
+                         float fx, float fy, float dx, float dy, int n, float dst[]) {
+    fx *= plane.fScaleX;
+    fy *= plane.fScaleY;
+    dx *= plane.fScaleX;
+    dy *= plane.fScaleY;
+    if (0 != dy || !sample_row(plane, filter, fx, fy, dx, n, dst)) {
+        sample_any(plane, filter, fx, fy, dx, dy, n, dst);
+    }
+}
+
+// Converts four pixels at a time, writing whole groups of four; dst must have room for count
+// rounded up to a multiple of four.
+static void yuv_to_pmcolor(SkPMColor dst[], const float y[], const float u[], const float v[],
+                           int count, const float matrix[3][4], U8CPU alpha) {
+    const Sk4f rY(matrix[0][0]), rU(matrix[0][1]), rV(matrix[0][2]), rK(matrix[0][3] + 0.5f),
+               gY(matrix[1][0]), gU(matrix[1][1]), gV(matrix[1][2]), gK(matrix[1][3] + 0.5f),
+               bY(matrix[2][0]), bU(matrix[2][1]), bV(matrix[2][2]), bK(matrix[2][3] + 0.5f);
+    const Sk4f zero(0.0f), max(alpha + 0.5f);
+    const Sk4i alphaBits((int)SkPackARGB32(alpha, 0, 0, 0));
+
+    // Each component is rounded, and kept within [0, alpha] so the result is premultiplied.
+    auto component = [&](const Sk4f& value) {
+        return SkNx_cast<int>(Sk4f::Max(zero, Sk4f::Min(value, max)));
+    };
+    for (int i = 0; i < count; i += 4) {
+        const Sk4f Y = Sk4f::Load(y + i), U = Sk4f::Load(u + i), V = Sk4f::Load(v + i);
+        const Sk4i r = component(rY * Y + rU * U + rV * V + rK),
+                   g = component(gY * Y + gU * U + gV * V + gK),
+                   b = component(bY * Y + bU * U + bV * V + bK);
+        (alphaBits + (r << SK_R32_SHIFT) + (g << SK_G32_SHIFT) + (b << SK_B32_SHIFT))
+                .store(dst + i);
+    }
+}
+
+void SkYUVShaderContext::shadeSpan(int x, int y, SkPMColor dst[], int count) {
+    const SkMatrix& inverse = this->getTotalInverse();
+    SkPoint start;
+    inverse.mapXY(x + 0.5f, y + 0.5f, &start);
+    const float dx = inverse.getScaleX(), dy = inverse.getSkewY();
+
+    // Room for whole groups of four, with the tail zeroed so it's never garbage.
+    float ys[kChunk], us[kChunk], vs[kChunk];
+    SkPMColor tail[4];
+    float fx = start.fX, fy = start.fY;
+    while (count > 0) {
+        const int n = SkTMin(count, kChunk);
+        const int padded = SkAlign4(n);
+        for (int i = n; i < padded; i++) {
+            ys[i] = us[i] = vs[i] = 0;
+        }
+        sample_plane(fPlanes[SkYUVSizeInfo::kY], fFilter, fx, fy, dx, dy, n, ys);
+        sample_plane(fPlanes[SkYUVSizeInfo::kU], fFilter, fx, fy, dx, dy, n, us);
+        sample_plane(fPlanes[SkYUVSizeInfo::kV], fFilter, fx, fy, dx, dy, n, vs);
+
+        const int whole = n & ~3;
+        yuv_to_pmcolor(dst, ys, us, vs, whole, fMatrix, this->getPaintAlpha());
+        if (whole < n) {
+            yuv_to_pmcolor(tail, ys + whole, us + whole, vs + whole, 4, fMatrix,
+                           this->getPaintAlpha());
+            memcpy(dst + whole, tail, (n - whole) * sizeof(SkPMColor));
+        }
+
+        dst += n;
+        count -= n;
+        fx += n * dx;
+        fy += n * dy;
+    }
+}
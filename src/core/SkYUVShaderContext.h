@@ -0,0 +1,87 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkYUVShaderContext_DEFINED
+#define SkYUVShaderContext_DEFINED
+
+#include "SkShader.h"
+#include "SkYUVPlanesCache.h"
+
+/**
+ *  Shades with an image's Y, U and V planes, clamped to its edges, converting to RGB as it
+ *  samples them. This is how raster devices draw images that keep YUV planes, so that no RGBA
+ *  copy of the image is ever made.
+ *
+ *  kNone_SkFilterQuality samples the nearest texel of each plane. Otherwise planes are sampled
+ *  bilinearly, or, when medium or high quality draws scale a plane down by 2x or more, with a
+ *  box filter the size of the scale. Those draws are given a cached, downscaled level of the
+ *  planes (see ChooseLevel()), so the box is rarely more than a texel or two.
+ */
+class SkYUVShaderContext : public SkShader::Context {
+public:
+    /**
+     *  Returns a context in storage, which must be at least sizeof(SkYUVShaderContext), or
+     *  nullptr if it can't draw with rec's matrix (e.g. perspective), in which case the caller
+     *  should shade with the RGBA pixels instead. The context refs data, which holds the planes
+     *  of a width x height image, or a level of them from ChooseLevel().
+     */
+    static SkShader::Context* Make(const SkShader&, const SkShader::ContextRec& rec,
+                                   void* storage, int width, int height, SkCachedData* data,
+                                   const SkYUVPlanesCache::Info&, const void* planes[3]);
+
+    /**
+     *  Returns the level of the planes (see SkImageCacherator::lockAsYUVPlanes()) to draw with
+     *  rec and the shader's total inverse matrix. Downscales sample the largest level that is no
+     *  smaller than the draw, like mipmaps, rather than box filtering the full planes every time.
+     */
+    static int ChooseLevel(const SkShader::ContextRec& rec, const SkMatrix& totalInverse);
+
+    ~SkYUVShaderContext() override;
+
+    uint32_t getFlags() const override;
+    void shadeSpan(int x, int y, SkPMColor[], int count) override;
+
+    static const int kMaxBoxTaps = 8;
+
+    enum Filter {
+        kNearest_Filter,
+        kBilinear_Filter,
+        kBox_Filter,
+    };
+
+    struct Plane {
+        const uint8_t*  fPixels;
+        size_t          fRowBytes;
+        int             fWidth;
+        int             fHeight;
+        // Maps image coordinates into this plane, which may be subsampled.
+        float           fScaleX;
+        float           fScaleY;
+        // With kBox_Filter, the size of the box in this plane's texels, and the offsets of the
+        // texels sampled from its corner. Large boxes are sampled with at most kMaxBoxTaps in
+        // each direction.
+        int             fBoxWidth;
+        int             fBoxHeight;
+        int             fTapsX;
+        int             fTapsY;
+        int             fTapOffsetsX[kMaxBoxTaps];
+        int             fTapOffsetsY[kMaxBoxTaps];
+    };
+
+private:
+    SkYUVShaderContext(const SkShader&, const SkShader::ContextRec&, SkCachedData*);
+
+    SkCachedData*   fData;
+    Plane           fPlanes[3];
+    Filter          fFilter;
+    // Rows of the YUV -> RGB matrix, in 8-bit units.
+    float           fMatrix[3][4];
+
+    typedef SkShader::Context INHERITED;
+};
+
+#endif
@@ -11,6 +11,7 @@
 #include "SkWriteBuffer.h"
 #include "SkPathMeasure.h"
 #include "SkStrokeRec.h"
+#include "SkTArray.h"
 
 bool Sk1DPathEffect::filterPath(SkPath* dst, const SkPath& src,
                                 SkStrokeRec*, const SkRect*) const {
@@ -67,34 +68,45 @@ bool SkPath1DPathEffect::filterPath(SkPath* dst, const SkPath& src,
                             SkStrokeRec* rec, const SkRect* cullRect) const {
     if (fAdvance > 0) {
         rec->setFillStyle();
-        return this->INHERITED::filterPath(dst, src, rec, cullRect);
-    }
-    return false;
-}
-
-static bool morphpoints(SkPoint dst[], const SkPoint src[], int count,
-                        SkPathMeasure& meas, SkScalar dist) {
-    for (int i = 0; i < count; i++) {
-        SkPoint pos;
-        SkVector tangent;
-
-        SkScalar sx = src[i].fX;
-        SkScalar sy = src[i].fY;
-
-        if (!meas.getPosTan(dist + sx, &pos, &tangent)) {
-            return false;
+        if (kMorph_Style == fStyle) {
+            return this->INHERITED::filterPath(dst, src, rec, cullRect);
         }
 
-        SkMatrix    matrix;
-        SkPoint     pt;
-
-        pt.set(sx, sy);
-        matrix.setSinCos(tangent.fY, tangent.fX, 0, 0);
-        matrix.preTranslate(-sx, 0);
-        matrix.postTranslate(pos.fX, pos.fY);
-        matrix.mapPoints(&dst[i], &pt, 1);
+        // The stamps along each contour are at increasing distances, so find their positions
+        // (and tangents) a batch at a time, rather than searching the contour for each one.
+        static const int kBatchCount = 64;
+        SkScalar        distances[kBatchCount];
+        SkPoint         positions[kBatchCount];
+        SkVector        tangents[kBatchCount];
+        SkPathMeasure   meas(src, false);
+        do {
+            SkScalar length = meas.getLength();
+            SkScalar distance = this->begin(length);
+            while (distance < length) {
+                int count = 0;
+                for (; count < kBatchCount && distance < length; ++count) {
+                    distances[count] = distance;
+                    distance += fAdvance;
+                }
+                if (!meas.getPosTan(count, distances, positions,
+                                    kRotate_Style == fStyle ? tangents : nullptr)) {
+                    break;
+                }
+                for (int i = 0; i < count; ++i) {
+                    if (kTranslate_Style == fStyle) {
+                        dst->addPath(fPath, positions[i].fX, positions[i].fY);
+                    } else {
+                        SkMatrix matrix;
+                        matrix.setSinCos(tangents[i].fY, tangents[i].fX, 0, 0);
+                        matrix.postTranslate(positions[i].fX, positions[i].fY);
+                        dst->addPath(fPath, matrix);
+                    }
+                }
+            }
+        } while (meas.nextContour());
+        return true;
     }
-    return true;
+    return false;
 }
 
 /*  TODO
@@ -106,15 +118,15 @@ but that seems like a cop-out. Another answer is to get Rob Johnson to figure it
 static void morphpath(SkPath* dst, const SkPath& src, SkPathMeasure& meas,
                       SkScalar dist) {
     SkPath::Iter    iter(src, false);
-    SkPoint         srcP[4], dstP[3];
+    SkPoint         srcP[4];
     SkPath::Verb    verb;
 
+    // Gather every point we will morph first, so that meas can find them all in one batch.
+    SkSTArray<64, SkPoint, true> pts;
     while ((verb = iter.next(srcP)) != SkPath::kDone_Verb) {
         switch (verb) {
             case SkPath::kMove_Verb:
-                if (morphpoints(dstP, srcP, 1, meas, dist)) {
-                    dst->moveTo(dstP[0]);
-                }
+                pts.push_back_n(1, srcP);
                 break;
             case SkPath::kLine_Verb:
                 srcP[2] = srcP[1];
@@ -122,14 +134,55 @@ static void morphpath(SkPath* dst, const SkPath& src, SkPathMeasure& meas,
                             SkScalarAve(srcP[0].fY, srcP[2].fY));
                 // fall through to quad
             case SkPath::kQuad_Verb:
-                if (morphpoints(dstP, &srcP[1], 2, meas, dist)) {
-                    dst->quadTo(dstP[0], dstP[1]);
-                }
+                pts.push_back_n(2, &srcP[1]);
                 break;
             case SkPath::kCubic_Verb:
-                if (morphpoints(dstP, &srcP[1], 3, meas, dist)) {
-                    dst->cubicTo(dstP[0], dstP[1], dstP[2]);
-                }
+                pts.push_back_n(3, &srcP[1]);
+                break;
+            default:
+                break;
+        }
+    }
+
+    const int count = pts.count();
+    SkSTArray<64, SkScalar, true> distances(count);
+    for (int i = 0; i < count; i++) {
+        distances.push_back(dist + pts[i].fX);
+    }
+    SkSTArray<64, SkPoint, true> positions(count);
+    SkSTArray<64, SkVector, true> tangents(count);
+    positions.push_back_n(count);
+    tangents.push_back_n(count);
+    if (!meas.getPosTan(count, distances.begin(), positions.begin(), tangents.begin())) {
+        return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        SkScalar    sx = pts[i].fX;
+        SkMatrix    matrix;
+
+        matrix.setSinCos(tangents[i].fY, tangents[i].fX, 0, 0);
+        matrix.preTranslate(-sx, 0);
+        matrix.postTranslate(positions[i].fX, positions[i].fY);
+        matrix.mapPoints(&pts[i], 1);
+    }
+
+    const SkPoint* dstP = pts.begin();
+    iter.setPath(src, false);
+    while ((verb = iter.next(srcP)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                dst->moveTo(dstP[0]);
+                dstP += 1;
+                break;
+            case SkPath::kLine_Verb:
+            case SkPath::kQuad_Verb:
+                dst->quadTo(dstP[0], dstP[1]);
+                dstP += 2;
+                break;
+            case SkPath::kCubic_Verb:
+                dst->cubicTo(dstP[0], dstP[1], dstP[2]);
+                dstP += 3;
                 break;
             case SkPath::kClose_Verb:
                 dst->close();
@@ -91,8 +91,13 @@ bool SkDiscretePathEffect::filterPath(SkPath* dst, const SkPath& src,
 
     LCGRandom   rand(seed ^ ((seed << 16) | (seed >> 16)));
     SkScalar    scale = fPerterb;
-    SkPoint     p;
-    SkVector    v;
+
+    // The points along each contour are at increasing distances, so we find them a batch at a
+    // time, rather than searching the contour for each one.
+    static const int kBatchCount = 64;
+    SkScalar    distances[kBatchCount];
+    SkPoint     positions[kBatchCount];
+    SkVector    tangents[kBatchCount];
 
     do {
         SkScalar    length = meas.getLength();
@@ -109,15 +114,24 @@ bool SkDiscretePathEffect::filterPath(SkPath* dst, const SkPath& src,
                 distance += delta/2;
             }
 
-            if (meas.getPosTan(distance, &p, &v)) {
-                Perterb(&p, v, SkScalarMul(rand.nextSScalar1(), scale));
-                dst->moveTo(p);
-            }
-            while (--n >= 0) {
-                distance += delta;
-                if (meas.getPosTan(distance, &p, &v)) {
-                    Perterb(&p, v, SkScalarMul(rand.nextSScalar1(), scale));
-                    dst->lineTo(p);
+            // n + 1 points: a moveTo followed by n lineTos
+            for (int start = 0; start <= n; start += kBatchCount) {
+                int count = SkTMin(n + 1 - start, kBatchCount);
+                for (int i = 0; i < count; ++i) {
+                    distances[i] = distance;
+                    distance += delta;
+                }
+                if (!meas.getPosTan(count, distances, positions, tangents)) {
+                    break;
+                }
+                for (int i = 0; i < count; ++i) {
+                    SkPoint p = positions[i];
+                    Perterb(&p, tangents[i], SkScalarMul(rand.nextSScalar1(), scale));
+                    if (0 == start + i) {
+                        dst->moveTo(p);
+                    } else {
+                        dst->lineTo(p);
+                    }
                 }
             }
             if (meas.isClosed()) {
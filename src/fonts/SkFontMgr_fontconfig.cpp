@@ -233,11 +233,12 @@ protected:
         }
 
         // Check if a typeface with this FontIdentity is already in the FontIdentity cache.
-        face = fTFCache.findByProcAndRef(find_by_FontIdentity, &identity);
+        uint32_t hash = SkTypefaceCache::FileHash(identity.fString.c_str(), identity.fTTCIndex);
+        face = fTFCache.findByHashAndProcAndRef(hash, find_by_FontIdentity, &identity);
         if (!face) {
             face = SkTypeface_FCI::Create(fFCI, identity, outFamilyName, outStyle);
             // Add this FontIdentity to the FontIdentity cache.
-            fTFCache.add(face);
+            fTFCache.add(face, hash);
         }
         // Add this request to the request cache.
         fCache.add(face, request.release());
@@ -281,6 +281,34 @@ bool GrClipMaskManager::getAnalyticClipProcessor(const GrReducedClip::ElementLis
     return !failed;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+const GrClipMaskManager::ReducedClip& GrClipMaskManager::reduceClipStack(
+                                                                const SkClipStack& stack,
+                                                                const SkIRect& queryBounds) {
+    int32_t stackGenID = stack.getTopmostGenID();
+    // The reserved genIDs are shared between unrelated stacks so we can't key off of them.
+    if (SkClipStack::kInvalidGenID != stackGenID && SkClipStack::kEmptyGenID != stackGenID &&
+        SkClipStack::kWideOpenGenID != stackGenID &&
+        stackGenID == fReducedClip.fStackGenID && queryBounds == fReducedClip.fQueryBounds) {
+        return fReducedClip;
+    }
+
+    fReducedClip.fStackGenID = stackGenID;
+    fReducedClip.fQueryBounds = queryBounds;
+    fReducedClip.fElementsGenID = 0;
+    fReducedClip.fInitialState = GrReducedClip::kAllIn_InitialState;
+    fReducedClip.fClipSpaceIBounds = queryBounds;
+    fReducedClip.fRequiresAA = false;
+    GrReducedClip::ReduceClipStack(stack,
+                                   queryBounds,
+                                   &fReducedClip.fElements,
+                                   &fReducedClip.fElementsGenID,
+                                   &fReducedClip.fInitialState,
+                                   &fReducedClip.fClipSpaceIBounds,
+                                   &fReducedClip.fRequiresAA);
+    return fReducedClip;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // sort out what kind of clip mask needs to be created: alpha, stencil,
 // scissor, or entirely software
@@ -292,11 +320,6 @@ bool GrClipMaskManager::setupClipping(const GrPipelineBuilder& pipelineBuilder,
         return true;
     }
 
-    GrReducedClip::ElementList elements;
-    int32_t genID = 0;
-    GrReducedClip::InitialState initialState = GrReducedClip::kAllIn_InitialState;
-    SkIRect clipSpaceIBounds;
-    bool requiresAA = false;
     GrRenderTarget* rt = pipelineBuilder.getRenderTarget();
 
     // GrDrawTarget should have filtered this for us
@@ -316,13 +339,13 @@ bool GrClipMaskManager::setupClipping(const GrPipelineBuilder& pipelineBuilder,
     } else {
         clipSpaceReduceQueryBounds = clipSpaceRTIBounds;
     }
-    GrReducedClip::ReduceClipStack(*clip.clipStack(),
-                                    clipSpaceReduceQueryBounds,
-                                    &elements,
-                                    &genID,
-                                    &initialState,
-                                    &clipSpaceIBounds,
-                                    &requiresAA);
+    const ReducedClip& reduced = this->reduceClipStack(*clip.clipStack(),
+                                                       clipSpaceReduceQueryBounds);
+    const GrReducedClip::ElementList& elements = reduced.fElements;
+    const int32_t genID = reduced.fElementsGenID;
+    const GrReducedClip::InitialState initialState = reduced.fInitialState;
+    const SkIRect& clipSpaceIBounds = reduced.fClipSpaceIBounds;
+    const bool requiresAA = reduced.fRequiresAA;
     if (elements.isEmpty()) {
         if (GrReducedClip::kAllIn_InitialState == initialState) {
             if (clipSpaceIBounds == clipSpaceRTIBounds) {
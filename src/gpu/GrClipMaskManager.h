@@ -105,7 +105,25 @@ private:
 
     static const int kMaxAnalyticElements = 4;
 
+    // The result of the most recent clip stack reduction. Consecutive draws usually share both
+    // the clip stack and the query bounds, so the reduction is only redone when the topmost genID
+    // of the stack or the bounds change.
+    struct ReducedClip {
+        ReducedClip() : fStackGenID(SkClipStack::kInvalidGenID) {}
+
+        int32_t                         fStackGenID;
+        SkIRect                         fQueryBounds;
+        GrReducedClip::ElementList      fElements;
+        int32_t                         fElementsGenID;
+        GrReducedClip::InitialState     fInitialState;
+        SkIRect                         fClipSpaceIBounds;
+        bool                            fRequiresAA;
+    };
+
+    const ReducedClip& reduceClipStack(const SkClipStack&, const SkIRect& queryBounds);
+
     GrDrawTarget*   fDrawTarget;    // This is our owning draw target.
+    ReducedClip     fReducedClip;
 
     typedef SkNoncopyable INHERITED;
 };
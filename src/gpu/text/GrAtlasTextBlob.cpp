@@ -158,12 +158,12 @@ void GrAtlasTextBlob::appendGlyph(int runIndex,
 void GrAtlasTextBlob::appendLargeGlyph(GrGlyph* glyph, SkGlyphCache* cache, const SkGlyph& skGlyph,
                                        SkScalar x, SkScalar y, SkScalar scale, bool applyVM) {
     if (nullptr == glyph->fPath) {
-        const SkPath* glyphPath = cache->findPath(skGlyph);
-        if (!glyphPath) {
+        SkPath glyphPath;
+        if (!cache->findPath(skGlyph, &glyphPath)) {
             return;
         }
 
-        glyph->fPath = new SkPath(*glyphPath);
+        glyph->fPath = new SkPath(glyphPath);
     }
     fBigGlyphs.push_back(GrAtlasTextBlob::BigGlyph(*glyph->fPath, x, y, scale, applyVM));
 }
@@ -520,11 +520,11 @@ void GrTextUtils::DrawPosTextAsPath(GrContext* context,
     paint.setStyle(origPaint.getStyle());
     paint.setPathEffect(sk_ref_sp(origPaint.getPathEffect()));
 
+    SkPath path;
     while (text < stop) {
         const SkGlyph& glyph = glyphCacheProc(cache, &text);
         if (glyph.fWidth) {
-            const SkPath* path = cache->findPath(glyph);
-            if (path) {
+            if (cache->findPath(glyph, &path)) {
                 SkPoint tmsLoc;
                 tmsProc(pos, &tmsLoc);
                 SkPoint loc;
@@ -532,7 +532,7 @@ void GrTextUtils::DrawPosTextAsPath(GrContext* context,
 
                 matrix[SkMatrix::kMTransX] = loc.fX;
                 matrix[SkMatrix::kMTransY] = loc.fY;
-                GrBlurUtils::drawPathWithMaskFilter(context, dc, clip, *path, paint,
+                GrBlurUtils::drawPathWithMaskFilter(context, dc, clip, path, paint,
                                                     viewMatrix, &matrix, clipBounds, false);
             }
         }
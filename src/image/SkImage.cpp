@@ -15,6 +15,7 @@
 #include "SkImagePriv.h"
 #include "SkImageShader.h"
 #include "SkImage_Base.h"
+#include "SkImageCacherator.h"
 #include "SkNextID.h"
 #include "SkPicture.h"
 #include "SkPixelRef.h"
@@ -104,6 +105,24 @@ void SkImage::preroll(GrContext* ctx) const {
     }
 }
 
+void SkImage::prefetch(SkScalar scale, SkColorType colorType) const {
+    SkImageCacherator* cacher = as_IB(this)->peekCacherator();
+    if (!cacher || !(scale > 0)) {
+        return;
+    }
+    SkISize size = SkISize::Make(this->width(), this->height());
+    SkColorType drawnType = cacher->info().colorType();
+    if (scale < 1) {
+        size.set(SkTMax(1, SkScalarRoundToInt(this->width() * scale)),
+                 SkTMax(1, SkScalarRoundToInt(this->height() * scale)));
+        drawnType = kN32_SkColorType;
+    }
+    if (kUnknown_SkColorType != colorType && drawnType != colorType) {
+        return;
+    }
+    cacher->prefetch(size, this);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 sk_sp<SkShader> SkImage::makeShader(SkShader::TileMode tileX, SkShader::TileMode tileY,
@@ -11,6 +11,7 @@
 #include "SkImageShader.h"
 #include "SkReadBuffer.h"
 #include "SkWriteBuffer.h"
+#include "SkYUVShaderContext.h"
 
 SkImageShader::SkImageShader(const SkImage* img, TileMode tmx, TileMode tmy, const SkMatrix* matrix)
     : INHERITED(matrix)
@@ -43,10 +44,25 @@ bool SkImageShader::isOpaque() const {
 }
 
 size_t SkImageShader::onContextSize(const ContextRec& rec) const {
-    return SkBitmapProcShader::ContextSize(rec, SkBitmapProvider(fImage).info());
+    const size_t size = SkBitmapProcShader::ContextSize(rec, SkBitmapProvider(fImage).info());
+    return as_IB(fImage)->keepsYUVPlanes() ? SkTMax(size, sizeof(SkYUVShaderContext)) : size;
 }
 
 SkShader::Context* SkImageShader::onCreateContext(const ContextRec& rec, void* storage) const {
+    SkMatrix inverse;
+    if (kClamp_TileMode == fTileModeX && kClamp_TileMode == fTileModeY &&
+            as_IB(fImage)->keepsYUVPlanes() && this->computeTotalInverse(rec, &inverse)) {
+        SkYUVPlanesCache::Info info;
+        const void* planes[3];
+        const int level = SkYUVShaderContext::ChooseLevel(rec, inverse);
+        SkAutoTUnref<SkCachedData> data(as_IB(fImage)->lockYUVPlanes(&info, planes, level));
+        if (data) {
+            if (Context* ctx = SkYUVShaderContext::Make(*this, rec, storage, fImage->width(),
+                                                        fImage->height(), data, info, planes)) {
+                return ctx;
+            }
+        }
+    }
     return SkBitmapProcShader::MakeContext(*this, fTileModeX, fTileModeY,
                                            SkBitmapProvider(fImage), rec, storage);
 }
@@ -11,6 +11,7 @@
 #include "SkAtomics.h"
 #include "SkImage.h"
 #include "SkSurface.h"
+#include "SkYUVPlanesCache.h"
 
 #include <new>
 
@@ -60,6 +61,18 @@ public:
 
     virtual bool onIsLazyGenerated() const { return false; }
 
+    // True for images that keep YUV planes rather than RGBA pixels (see MakeFromEncodedYUV()).
+    // Raster devices draw them with an SkImageShader, which samples lockYUVPlanes().
+    virtual bool keepsYUVPlanes() const { return false; }
+
+    // Returns a ref() on the YUV planes, or nullptr if there are none (or the RGBA pixels are
+    // already cached), in which case draws should use getROPixels(). The caller must call unref()
+    // when it is done. Levels above 0 are cached copies downscaled by 2^level.
+    virtual SkCachedData* lockYUVPlanes(SkYUVPlanesCache::Info*, const void* planes[3],
+                                        int level) const {
+        return nullptr;
+    }
+
     // Return a bitmap suitable for passing to image-filters
     // For now, that means wrapping textures into SkGrPixelRefs...
     virtual bool asBitmapForImageFilters(SkBitmap* bitmap) const {
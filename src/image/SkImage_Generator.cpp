@@ -16,9 +16,10 @@
 
 class SkImage_Generator : public SkImage_Base {
 public:
-    SkImage_Generator(SkImageCacherator* cache)
+    SkImage_Generator(SkImageCacherator* cache, bool keepsYUVPlanes = false)
         : INHERITED(cache->info().width(), cache->info().height(), cache->uniqueID())
         , fCache(cache) // take ownership
+        , fKeepsYUVPlanes(keepsYUVPlanes)
     {}
 
     virtual SkImageInfo onImageInfo() const override {
@@ -33,9 +34,13 @@ public:
     bool getROPixels(SkBitmap*, CachingHint) const override;
     GrTexture* asTextureRef(GrContext*, const GrTextureParams&) const override;
     bool onIsLazyGenerated() const override { return true; }
+    bool keepsYUVPlanes() const override { return fKeepsYUVPlanes; }
+    SkCachedData* lockYUVPlanes(SkYUVPlanesCache::Info*, const void* planes[3],
+                                int level) const override;
 
 private:
     SkAutoTDelete<SkImageCacherator> fCache;
+    const bool                       fKeepsYUVPlanes;
 
     typedef SkImage_Base INHERITED;
 };
@@ -73,6 +78,19 @@ bool SkImage_Generator::getROPixels(SkBitmap* bitmap, CachingHint chint) const {
     return fCache->lockAsBitmap(bitmap, this, chint);
 }
 
+SkCachedData* SkImage_Generator::lockYUVPlanes(SkYUVPlanesCache::Info* info,
+                                               const void* planes[3], int level) const {
+    if (!fKeepsYUVPlanes) {
+        return nullptr;
+    }
+    // If something already needed the RGBA pixels, drawing those is cheaper than a second decode.
+    SkBitmap bm;
+    if (fCache->lockAsBitmapOnlyIfAlreadyCached(&bm)) {
+        return nullptr;
+    }
+    return fCache->lockAsYUVPlanes(info, planes, this, level);
+}
+
 GrTexture* SkImage_Generator::asTextureRef(GrContext* ctx, const GrTextureParams& params) const {
     return fCache->lockAsTexture(ctx, params, this);
 }
@@ -103,3 +121,22 @@ sk_sp<SkImage> SkImage::MakeFromGenerator(SkImageGenerator* generator, const SkI
     }
     return sk_make_sp<SkImage_Generator>(cache);
 }
+
+sk_sp<SkImage> SkImage::MakeFromEncodedYUV(sk_sp<SkData> encoded) {
+    if (nullptr == encoded || 0 == encoded->size()) {
+        return nullptr;
+    }
+    SkImageGenerator* generator = SkImageGenerator::NewFromEncoded(encoded.get());
+    if (!generator) {
+        return nullptr;
+    }
+    SkYUVSizeInfo sizeInfo;
+    SkYUVColorSpace colorSpace;
+    const bool yuv = generator->queryYUV8(&sizeInfo, &colorSpace) &&
+                     sizeInfo.fSizes[SkYUVSizeInfo::kY] == generator->getInfo().dimensions();
+    SkImageCacherator* cache = SkImageCacherator::NewFromGenerator(generator);
+    if (!cache) {
+        return nullptr;
+    }
+    return sk_make_sp<SkImage_Generator>(cache, yuv);
+}
@@ -73,6 +73,41 @@ SkData* SkImageEncoder::EncodeData(const SkPixmap& pixmap,
     return SkImageEncoder::EncodeData(bm, t, quality);
 }
 
+bool SkImageEncoder::begin(SkWStream* stream, const SkImageInfo& info, int quality) {
+    fRowsRemaining = -1;
+    if (!stream || info.isEmpty() || kUnknown_SkColorType == info.colorType() ||
+            kIndex_8_SkColorType == info.colorType()) {
+        return false;
+    }
+    quality = SkMin32(100, SkMax32(0, quality));
+    if (!this->onBeginRows(stream, info, quality)) {
+        return false;
+    }
+    fRowsRemaining = info.height();
+    fMinRowBytes = info.minRowBytes();
+    return true;
+}
+
+bool SkImageEncoder::encodeRows(const void* rows, size_t rowBytes, int count) {
+    if (!rows || count <= 0 || count > fRowsRemaining || rowBytes < fMinRowBytes) {
+        return false;
+    }
+    if (!this->onEncodeRows(rows, rowBytes, count)) {
+        fRowsRemaining = -1;
+        return false;
+    }
+    fRowsRemaining -= count;
+    return true;
+}
+
+bool SkImageEncoder::finish() {
+    if (0 != fRowsRemaining) {
+        return false;
+    }
+    fRowsRemaining = -1;
+    return this->onFinishRows();
+}
+
 namespace {
 class ImageEncoderPixelSerializer final : public SkPixelSerializer {
 protected:
@@ -84,8 +84,8 @@ static void Write_Index_RGB(uint8_t* SK_RESTRICT dst,
     }
 }
 
-static WriteScanline ChooseWriter(const SkBitmap& bm) {
-    switch (bm.colorType()) {
+static WriteScanline ChooseWriter(SkColorType colorType) {
+    switch (colorType) {
         case kN32_SkColorType:
             return Write_32_RGB;
         case kRGB_565_SkColorType:
@@ -100,8 +100,17 @@ static WriteScanline ChooseWriter(const SkBitmap& bm) {
 }
 
 class SkJPEGImageEncoder : public SkImageEncoder {
+public:
+    SkJPEGImageEncoder()
+        : fStarted(false)
+        , fWriter(nullptr)
+        , fColors(nullptr)
+    {}
+
+    ~SkJPEGImageEncoder() override { this->destroyCompress(); }
+
 protected:
-    virtual bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) {
+    bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) override {
 #ifdef TIME_ENCODE
         SkAutoTime atm("JPEG Encode");
 #endif
@@ -111,67 +120,108 @@ protected:
             return false;
         }
 
-        jpeg_compress_struct    cinfo;
-        skjpeg_error_mgr        sk_err;
-        skjpeg_destination_mgr  sk_wstream(stream);
+        const SkPMColor* colors = bm.getColorTable() ? bm.getColorTable()->readColors() : nullptr;
+        return this->startCompress(stream, bm.info(), quality, colors) &&
+               this->onEncodeRows(bm.getPixels(), bm.rowBytes(), bm.height()) &&
+               this->onFinishRows();
+    }
 
-        // allocate these before set call setjmp
-        SkAutoTMalloc<uint8_t>  oneRow;
+    bool onBeginRows(SkWStream* stream, const SkImageInfo& info, int quality) override {
+        return this->startCompress(stream, info, quality, nullptr);
+    }
 
-        cinfo.err = jpeg_std_error(&sk_err);
-        sk_err.error_exit = skjpeg_error_exit;
-        if (setjmp(sk_err.fJmpBuf)) {
+    bool onEncodeRows(const void* rows, size_t rowBytes, int count) override {
+        if (setjmp(fErr.fJmpBuf)) {
+            this->destroyCompress();
             return false;
         }
 
-        // Keep after setjmp or mark volatile.
-        const WriteScanline writer = ChooseWriter(bm);
-        if (nullptr == writer) {
+        const int   width = fCInfo.image_width;
+        uint8_t*    oneRowP = fOneRow.get();
+        const void* srcRow = rows;
+        for (int i = 0; i < count; i++) {
+            JSAMPROW row_pointer[1];    /* pointer to JSAMPLE row[s] */
+
+            fWriter(oneRowP, srcRow, width, fColors);
+            row_pointer[0] = oneRowP;
+            (void) jpeg_write_scanlines(&fCInfo, row_pointer, 1);
+            srcRow = (const void*)((const char*)srcRow + rowBytes);
+        }
+        return true;
+    }
+
+    bool onFinishRows() override {
+        if (setjmp(fErr.fJmpBuf)) {
+            this->destroyCompress();
             return false;
         }
 
-        jpeg_create_compress(&cinfo);
-        cinfo.dest = &sk_wstream;
-        cinfo.image_width = bm.width();
-        cinfo.image_height = bm.height();
-        cinfo.input_components = 3;
-        
+        jpeg_finish_compress(&fCInfo);
+        this->destroyCompress();
+        return true;
+    }
+
+private:
+    // colors is required for kIndex_8, and must remain valid until the encode finishes.
+    bool startCompress(SkWStream* stream, const SkImageInfo& info, int quality,
+                       const SkPMColor* colors) {
+        this->destroyCompress();
+
+        fWriter = ChooseWriter(info.colorType());
+        if (nullptr == fWriter || (kIndex_8_SkColorType == info.colorType() && !colors)) {
+            return false;
+        }
+        fColors = colors;
+        fDest.reset(new skjpeg_destination_mgr(stream));
+
+        fCInfo.err = jpeg_std_error(&fErr);
+        fErr.error_exit = skjpeg_error_exit;
+        if (setjmp(fErr.fJmpBuf)) {
+            this->destroyCompress();
+            return false;
+        }
+
+        jpeg_create_compress(&fCInfo);
+        fStarted = true;
+        fCInfo.dest = fDest.get();
+        fCInfo.image_width = info.width();
+        fCInfo.image_height = info.height();
+        fCInfo.input_components = 3;
+
         // FIXME: Can we take advantage of other in_color_spaces in libjpeg-turbo?
-        cinfo.in_color_space = JCS_RGB;
+        fCInfo.in_color_space = JCS_RGB;
 
         // The gamma value is ignored by libjpeg-turbo.
-        cinfo.input_gamma = 1;
+        fCInfo.input_gamma = 1;
+
+        jpeg_set_defaults(&fCInfo);
 
-        jpeg_set_defaults(&cinfo);
-        
         // Tells libjpeg-turbo to compute optimal Huffman coding tables
         // for the image.  This improves compression at the cost of
         // slower encode performance.
-        cinfo.optimize_coding = TRUE;
-        jpeg_set_quality(&cinfo, quality, TRUE /* limit to baseline-JPEG values */);
-
-        jpeg_start_compress(&cinfo, TRUE);
+        fCInfo.optimize_coding = TRUE;
+        jpeg_set_quality(&fCInfo, quality, TRUE /* limit to baseline-JPEG values */);
 
-        const int       width = bm.width();
-        uint8_t*        oneRowP = oneRow.reset(width * 3);
-
-        const SkPMColor* colors = bm.getColorTable() ? bm.getColorTable()->readColors() : nullptr;
-        const void*      srcRow = bm.getPixels();
+        jpeg_start_compress(&fCInfo, TRUE);
 
-        while (cinfo.next_scanline < cinfo.image_height) {
-            JSAMPROW row_pointer[1];    /* pointer to JSAMPLE row[s] */
+        fOneRow.reset(info.width() * 3);
+        return true;
+    }
 
-            writer(oneRowP, srcRow, width, colors);
-            row_pointer[0] = oneRowP;
-            (void) jpeg_write_scanlines(&cinfo, row_pointer, 1);
-            srcRow = (const void*)((const char*)srcRow + bm.rowBytes());
+    void destroyCompress() {
+        if (fStarted) {
+            jpeg_destroy_compress(&fCInfo);
+            fStarted = false;
         }
-
-        jpeg_finish_compress(&cinfo);
-        jpeg_destroy_compress(&cinfo);
-
-        return true;
     }
+
+    jpeg_compress_struct                    fCInfo;
+    skjpeg_error_mgr                        fErr;
+    SkAutoTDelete<skjpeg_destination_mgr>   fDest;
+    bool                                    fStarted;
+    WriteScanline                           fWriter;
+    const SkPMColor*                        fColors;
+    SkAutoTMalloc<uint8_t>                  fOneRow;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -10,14 +10,22 @@
 #include "SkColorPriv.h"
 #include "SkDither.h"
 #include "SkMath.h"
+#include "SkOpts.h"
 #include "SkRTConf.h"
 #include "SkStream.h"
+#include "SkTaskGroup.h"
 #include "SkTemplates.h"
 #include "SkUtils.h"
 #include "transform_scanline.h"
 
 #include "png.h"
 
+#ifdef ZLIB_INCLUDE
+    #include ZLIB_INCLUDE
+#else
+    #include "zlib.h"
+#endif
+
 /* These were dropped in libpng >= 1.4 */
 #ifndef png_infopp_NULL
 #define png_infopp_NULL nullptr
@@ -162,14 +170,106 @@ static inline int pack_palette(SkColorTable* ctable,
     return num_trans;
 }
 
+static void write_be32(uint8_t dst[4], uint32_t value) {
+    dst[0] = (uint8_t)(value >> 24);
+    dst[1] = (uint8_t)(value >> 16);
+    dst[2] = (uint8_t)(value >> 8);
+    dst[3] = (uint8_t)value;
+}
+
+static bool write_chunk(SkWStream* stream, const char type[4], const void* data, size_t length) {
+    uint8_t header[8];
+    write_be32(header, SkToU32(length));
+    memcpy(header + 4, type, 4);
+    uLong crc = crc32(0, header + 4, 4);
+    if (length > 0) {
+        crc = crc32(crc, (const Bytef*)data, SkToU32(length));
+    }
+    uint8_t trailer[4];
+    write_be32(trailer, (uint32_t)crc);
+    return stream->write(header, sizeof(header)) && stream->write(data, length) &&
+           stream->write(trailer, sizeof(trailer));
+}
+
+// Runs a raw deflate over everything written to it, and remembers the adler32 of the input.
+class DeflateBand {
+public:
+    DeflateBand() : fOk(false), fAdler(adler32(0, nullptr, 0)), fInputBytes(0) {
+        memset(&fZStream, 0, sizeof(fZStream));
+        // libpng compresses IDAT at Z_DEFAULT_COMPRESSION too. A negative window size leaves
+        // out the zlib header and trailer, which only the whole stream has.
+        fOk = Z_OK == deflateInit2(&fZStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                                   Z_DEFAULT_STRATEGY);
+    }
+
+    ~DeflateBand() { deflateEnd(&fZStream); }
+
+    void write(const uint8_t* data, size_t length) {
+        fAdler = adler32(fAdler, data, SkToU32(length));
+        fInputBytes += length;
+        fZStream.next_in = const_cast<Bytef*>(data);
+        fZStream.avail_in = SkToU32(length);
+        this->deflate(Z_NO_FLUSH);
+    }
+
+    // Z_SYNC_FLUSH ends the band on a byte boundary, so it can be followed by the next band's
+    // output; the last band uses Z_FINISH instead.
+    void flush(int mode) { this->deflate(mode); }
+
+    bool ok() const { return fOk; }
+    uLong adler() const { return fAdler; }
+    size_t inputBytes() const { return fInputBytes; }
+    SkDynamicMemoryWStream* output() { return &fOutput; }
+
+private:
+    void deflate(int flush) {
+        uint8_t buffer[4096];
+        do {
+            fZStream.next_out = buffer;
+            fZStream.avail_out = sizeof(buffer);
+            const int result = ::deflate(&fZStream, flush);
+            fOk = fOk && (Z_OK == result || Z_STREAM_END == result || Z_BUF_ERROR == result);
+            fOutput.write(buffer, sizeof(buffer) - fZStream.avail_out);
+        } while (fOk && 0 == fZStream.avail_out);
+    }
+
+    z_stream               fZStream;
+    bool                   fOk;
+    uLong                  fAdler;
+    size_t                 fInputBytes;
+    SkDynamicMemoryWStream fOutput;
+};
+
 class SkPNGImageEncoder : public SkImageEncoder {
+public:
+    SkPNGImageEncoder()
+        : fPng_ptr(nullptr)
+        , fInfo_ptr(nullptr)
+        , fProc(nullptr)
+        , fWidth(0)
+    {}
+
+    ~SkPNGImageEncoder() override { this->destroyWriteStruct(); }
+
 protected:
     bool onEncode(SkWStream* stream, const SkBitmap& bm, int quality) override;
+    bool onBeginRows(SkWStream* stream, const SkImageInfo& info, int quality) override;
+    bool onEncodeRows(const void* rows, size_t rowBytes, int count) override;
+    bool onFinishRows() override;
+
 private:
-    bool doEncode(SkWStream* stream, const SkBitmap& bm,
-                  const bool& hasAlpha, int colorType,
-                  int bitDepth, SkColorType ct,
-                  png_color_8& sig_bit);
+    // Writes everything up to the pixels. ctable is required for kIndex_8.
+    bool writeHeader(SkWStream* stream, const SkImageInfo& info, SkColorTable* ctable);
+    // Filters and deflates bands of rows on other threads, and writes them as the IDAT and
+    // IEND chunks. Must follow writeHeader().
+    bool encodeBands(SkWStream* stream, const SkBitmap& bitmap);
+    void destroyWriteStruct();
+
+    png_structp                 fPng_ptr;
+    png_infop                   fInfo_ptr;
+    transform_scanline_proc     fProc;
+    int                         fWidth;
+    SkAutoSTMalloc<1024, char>  fRowStorage;
 
     typedef SkImageEncoder INHERITED;
 };
@@ -193,16 +293,56 @@ bool SkPNGImageEncoder::onEncode(SkWStream* stream,
                 bitmap = &copy;
             }
     }
-    SkColorType ct = bitmap->colorType();
 
-    const bool hasAlpha = !bitmap->isOpaque();
+    SkAutoLockPixels alp(*bitmap);
+    // readyToDraw checks for pixels (and colortable if that is required)
+    if (!bitmap->readyToDraw()) {
+        return false;
+    }
+
+    // we must do this after we have locked the pixels
+    SkColorTable* ctable = bitmap->getColorTable();
+    if (ctable && ctable->count() == 0) {
+        return false;
+    }
+
+    // Large images are filtered and compressed in bands in parallel. Palette images are left
+    // to libpng, which doesn't filter them.
+    static const int64_t kMinPixelsForThreads = 512 * 512;
+    if (!ctable && sk_64_mul(bitmap->width(), bitmap->height()) >= kMinPixelsForThreads) {
+        const bool success = this->writeHeader(stream, bitmap->info(), nullptr) &&
+                             this->encodeBands(stream, *bitmap);
+        this->destroyWriteStruct();
+        return success;
+    }
+
+    return this->writeHeader(stream, bitmap->info(), ctable) &&
+           this->onEncodeRows(bitmap->getPixels(), bitmap->rowBytes(), bitmap->height()) &&
+           this->onFinishRows();
+}
+
+bool SkPNGImageEncoder::onBeginRows(SkWStream* stream, const SkImageInfo& info, int) {
+    return this->writeHeader(stream, info, nullptr);
+}
+
+bool SkPNGImageEncoder::writeHeader(SkWStream* stream, const SkImageInfo& info,
+                                    SkColorTable* ctable) {
+    this->destroyWriteStruct();
+
+    const SkColorType ct = info.colorType();
+    const bool hasAlpha = !info.isOpaque();
     int colorType = PNG_COLOR_MASK_COLOR;
     int bitDepth = 8;   // default for color
     png_color_8 sig_bit;
 
     switch (ct) {
         case kIndex_8_SkColorType:
+            if (!ctable) {
+                return false;
+            }
             colorType |= PNG_COLOR_MASK_PALETTE;
+            // check if we can store in fewer than 8 bits
+            bitDepth = computeBitDepth(ctable->count());
             // fall through to the ARGB_8888 case
         case kN32_SkColorType:
             sig_bit.red = 8;
@@ -235,54 +375,28 @@ bool SkPNGImageEncoder::onEncode(SkWStream* stream,
         sig_bit.alpha = 0;
     }
 
-    SkAutoLockPixels alp(*bitmap);
-    // readyToDraw checks for pixels (and colortable if that is required)
-    if (!bitmap->readyToDraw()) {
+    fPng_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, sk_error_fn,
+                                       nullptr);
+    if (nullptr == fPng_ptr) {
         return false;
     }
 
-    // we must do this after we have locked the pixels
-    SkColorTable* ctable = bitmap->getColorTable();
-    if (ctable) {
-        if (ctable->count() == 0) {
-            return false;
-        }
-        // check if we can store in fewer than 8 bits
-        bitDepth = computeBitDepth(ctable->count());
-    }
-
-    return doEncode(stream, *bitmap, hasAlpha, colorType, bitDepth, ct, sig_bit);
-}
-
-bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
-                  const bool& hasAlpha, int colorType,
-                  int bitDepth, SkColorType ct,
-                  png_color_8& sig_bit) {
-
-    png_structp png_ptr;
-    png_infop info_ptr;
-
-    png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, sk_error_fn,
-                                      nullptr);
-    if (nullptr == png_ptr) {
-        return false;
-    }
-
-    info_ptr = png_create_info_struct(png_ptr);
-    if (nullptr == info_ptr) {
-        png_destroy_write_struct(&png_ptr,  png_infopp_NULL);
+    fInfo_ptr = png_create_info_struct(fPng_ptr);
+    if (nullptr == fInfo_ptr) {
+        png_destroy_write_struct(&fPng_ptr,  png_infopp_NULL);
+        fPng_ptr = nullptr;
         return false;
     }
 
     /* Set error handling.  REQUIRED if you aren't supplying your own
     * error handling functions in the png_create_write_struct() call.
     */
-    if (setjmp(png_jmpbuf(png_ptr))) {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
+    if (setjmp(png_jmpbuf(fPng_ptr))) {
+        this->destroyWriteStruct();
         return false;
     }
 
-    png_set_write_fn(png_ptr, (void*)stream, sk_write_fn, png_flush_ptr_NULL);
+    png_set_write_fn(fPng_ptr, (void*)stream, sk_write_fn, png_flush_ptr_NULL);
 
     /* Set the image information here.  Width and height are up to 2^31,
     * bit_depth is one of 1, 2, 4, 8, or 16, but valid values also depend on
@@ -293,7 +407,7 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     * currently be PNG_COMPRESSION_TYPE_BASE and PNG_FILTER_TYPE_BASE. REQUIRED
     */
 
-    png_set_IHDR(png_ptr, info_ptr, bitmap.width(), bitmap.height(),
+    png_set_IHDR(fPng_ptr, fInfo_ptr, info.width(), info.height(),
                  bitDepth, colorType,
                  PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE,
                  PNG_FILTER_TYPE_BASE);
@@ -302,37 +416,133 @@ bool SkPNGImageEncoder::doEncode(SkWStream* stream, const SkBitmap& bitmap,
     png_color paletteColors[256];
     png_byte trans[256];
     if (kIndex_8_SkColorType == ct) {
-        SkColorTable* ct = bitmap.getColorTable();
-        int numTrans = pack_palette(ct, paletteColors, trans, hasAlpha);
-        png_set_PLTE(png_ptr, info_ptr, paletteColors, ct->count());
+        int numTrans = pack_palette(ctable, paletteColors, trans, hasAlpha);
+        png_set_PLTE(fPng_ptr, fInfo_ptr, paletteColors, ctable->count());
         if (numTrans > 0) {
-            png_set_tRNS(png_ptr, info_ptr, trans, numTrans, nullptr);
+            png_set_tRNS(fPng_ptr, fInfo_ptr, trans, numTrans, nullptr);
         }
     }
 #ifdef PNG_sBIT_SUPPORTED
-    png_set_sBIT(png_ptr, info_ptr, &sig_bit);
+    png_set_sBIT(fPng_ptr, fInfo_ptr, &sig_bit);
 #endif
-    png_write_info(png_ptr, info_ptr);
+    png_write_info(fPng_ptr, fInfo_ptr);
 
-    const char* srcImage = (const char*)bitmap.getPixels();
-    SkAutoSTMalloc<1024, char> rowStorage(bitmap.width() << 2);
-    char* storage = rowStorage.get();
-    transform_scanline_proc proc = choose_proc(ct, hasAlpha);
+    fProc = choose_proc(ct, hasAlpha);
+    fWidth = info.width();
+    fRowStorage.reset(fWidth << 2);
+    return true;
+}
 
-    for (int y = 0; y < bitmap.height(); y++) {
+bool SkPNGImageEncoder::onEncodeRows(const void* rows, size_t rowBytes, int count) {
+    if (setjmp(png_jmpbuf(fPng_ptr))) {
+        this->destroyWriteStruct();
+        return false;
+    }
+
+    const char* srcImage = (const char*)rows;
+    char* storage = fRowStorage.get();
+    for (int y = 0; y < count; y++) {
         png_bytep row_ptr = (png_bytep)storage;
-        proc(srcImage, bitmap.width(), storage);
-        png_write_rows(png_ptr, &row_ptr, 1);
-        srcImage += bitmap.rowBytes();
+        fProc(srcImage, fWidth, storage);
+        png_write_rows(fPng_ptr, &row_ptr, 1);
+        srcImage += rowBytes;
+    }
+    return true;
+}
+
+bool SkPNGImageEncoder::encodeBands(SkWStream* stream, const SkBitmap& bitmap) {
+    // Each band deflates its filtered rows on its own. Every band but the last ends with a sync
+    // flush, so the compressed bands concatenate into one deflate stream, as pigz does. The
+    // first row of a band is still filtered against the last row of the band above.
+    static const size_t kMinBandBytes = 256 * 1024;
+
+    const int bpp = bitmap.isOpaque() ? 3 : 4;
+    const size_t pngRowBytes = fWidth * bpp;
+    const int height = bitmap.height();
+    const int rowsPerBand = SkTMax(1, SkToInt(kMinBandBytes / (pngRowBytes + 1)));
+    const int bandCount = (height + rowsPerBand - 1) / rowsPerBand;
+
+    // The zlib header for the default compression level.
+    static const uint8_t kZlibHeader[] = { 0x78, 0x9C };
+
+    SkAutoTArray<DeflateBand> bands(bandCount);
+    SkTaskGroup().batch(bandCount, [&](int i) {
+        DeflateBand* band = &bands[i];
+        if (!band->ok()) {
+            return;
+        }
+
+        // The previous row, the current row, and the filtered row after its filter byte.
+        SkAutoTMalloc<uint8_t> storage(3 * pngRowBytes + 1);
+        uint8_t* prev = storage.get();
+        uint8_t* row = prev + pngRowBytes;
+        uint8_t* filtered = row + pngRowBytes;
+
+        if (0 == i) {
+            band->output()->write(kZlibHeader, sizeof(kZlibHeader));
+        }
+        const int top = i * rowsPerBand;
+        const int bottom = SkTMin(height, top + rowsPerBand);
+        if (top > 0) {
+            fProc((const char*)bitmap.getAddr(0, top - 1), fWidth, (char*)prev);
+        } else {
+            memset(prev, 0, pngRowBytes);
+        }
+        for (int y = top; y < bottom; y++) {
+            fProc((const char*)bitmap.getAddr(0, y), fWidth, (char*)row);
+            filtered[0] = (uint8_t)SkOpts::png_filter_row(filtered + 1, row, prev,
+                                                          SkToInt(pngRowBytes), bpp);
+            band->write(filtered, pngRowBytes + 1);
+            SkTSwap(prev, row);
+        }
+        band->flush(bandCount - 1 == i ? Z_FINISH : Z_SYNC_FLUSH);
+    });
+
+    // The zlib trailer is the adler32 of all the bands.
+    uLong adler = adler32(0, nullptr, 0);
+    for (int i = 0; i < bandCount; i++) {
+        if (!bands[i].ok()) {
+            return false;
+        }
+        adler = adler32_combine(adler, bands[i].adler(), bands[i].inputBytes());
+    }
+    uint8_t zlibTrailer[4];
+    write_be32(zlibTrailer, (uint32_t)adler);
+    if (!bands[bandCount - 1].output()->write(zlibTrailer, sizeof(zlibTrailer))) {
+        return false;
     }
 
-    png_write_end(png_ptr, info_ptr);
+    // Each band becomes one IDAT chunk.
+    for (int i = 0; i < bandCount; i++) {
+        SkAutoTUnref<SkData> data(bands[i].output()->copyToData());
+        if (!write_chunk(stream, "IDAT", data->data(), data->size())) {
+            return false;
+        }
+    }
+    return write_chunk(stream, "IEND", nullptr, 0);
+}
+
+bool SkPNGImageEncoder::onFinishRows() {
+    if (setjmp(png_jmpbuf(fPng_ptr))) {
+        this->destroyWriteStruct();
+        return false;
+    }
+
+    png_write_end(fPng_ptr, fInfo_ptr);
 
     /* clean up after the write, and free any memory allocated */
-    png_destroy_write_struct(&png_ptr, &info_ptr);
+    this->destroyWriteStruct();
     return true;
 }
 
+void SkPNGImageEncoder::destroyWriteStruct() {
+    if (fPng_ptr) {
+        png_destroy_write_struct(&fPng_ptr, &fInfo_ptr);
+        fPng_ptr = nullptr;
+        fInfo_ptr = nullptr;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 DEFINE_ENCODER_CREATOR(PNGImageEncoder);
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkBoxResize_opts_DEFINED
+#define SkBoxResize_opts_DEFINED
+
+#include "SkNx.h"
+
+namespace SK_OPTS_NS {
+
+static void box_accumulate_row(float sums[], const uint8_t row[], int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        (Sk4f::Load(sums + i) + SkNx_cast<float>(Sk4b::Load(row + i))).store(sums + i);
+    }
+    for (; i < count; i++) {
+        sums[i] += row[i];
+    }
+}
+
+static void box_resolve_row(uint8_t dst[], const float sums[], const uint32_t bounds[],
+                            int width, int rows, int bpp) {
+    if (4 == bpp) {
+        for (int i = 0; i < width; i++) {
+            Sk4f total(0.0f);
+            for (uint32_t x = bounds[i]; x < bounds[i + 1]; x++) {
+                total = total + Sk4f::Load(sums + 4 * x);
+            }
+            const float scale = 1.0f / (float) ((bounds[i + 1] - bounds[i]) * rows);
+            SkNx_cast<uint8_t>(total * scale + 0.5f).store(dst + 4 * i);
+        }
+        return;
+    }
+
+    SkASSERT(1 == bpp);
+    for (int i = 0; i < width; i++) {
+        float total = 0.0f;
+        for (uint32_t x = bounds[i]; x < bounds[i + 1]; x++) {
+            total += sums[x];
+        }
+        const float scale = 1.0f / (float) ((bounds[i + 1] - bounds[i]) * rows);
+        dst[i] = (uint8_t) (total * scale + 0.5f);
+    }
+}
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkBoxResize_opts_DEFINED
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef SkPngFilter_opts_DEFINED
+#define SkPngFilter_opts_DEFINED
+
+#include "SkTypes.h"
+
+namespace SK_OPTS_NS {
+
+// Each PNG filter predicts a byte x from a (the byte bpp to the left), b (the byte above) and
+// c (above and to the left), and stores x minus the prediction.
+enum {
+    kNone_PngFilter,
+    kSub_PngFilter,
+    kUp_PngFilter,
+    kAvg_PngFilter,
+    kPaeth_PngFilter,
+
+    kPngFilterCount
+};
+
+static inline int paeth_predictor(int a, int b, int c) {
+    const int pa = SkTAbs(b - c),
+              pb = SkTAbs(a - c),
+              pc = SkTAbs(a + b - 2*c);
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+static inline uint8_t filter_byte(int filter, int x, int a, int b, int c) {
+    switch (filter) {
+        case kSub_PngFilter:   return x - a;
+        case kUp_PngFilter:    return x - b;
+        case kAvg_PngFilter:   return x - ((a + b) >> 1);
+        case kPaeth_PngFilter: return x - paeth_predictor(a, b, c);
+        default:               return x;
+    }
+}
+
+// Like libpng, we cost a filtered byte by its magnitude as a signed byte.
+static inline int filter_cost(uint8_t v) {
+    return v < 128 ? v : 256 - v;
+}
+
+// Adds the cost of every filter over bytes [begin, end) of row to costs.
+static void png_filter_costs_portable(uint64_t costs[kPngFilterCount], const uint8_t row[],
+                                      const uint8_t prev[], int begin, int end, int bpp) {
+    for (int i = begin; i < end; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0,
+                  c = i >= bpp ? prev[i - bpp] : 0;
+        for (int f = 0; f < kPngFilterCount; f++) {
+            costs[f] += filter_cost(filter_byte(f, row[i], a, prev[i], c));
+        }
+    }
+}
+
+static void png_apply_filter_portable(int filter, uint8_t dst[], const uint8_t row[],
+                                      const uint8_t prev[], int begin, int end, int bpp) {
+    for (int i = begin; i < end; i++) {
+        const int a = i >= bpp ? row[i - bpp] : 0,
+                  c = i >= bpp ? prev[i - bpp] : 0;
+        dst[i] = filter_byte(filter, row[i], a, prev[i], c);
+    }
+}
+
+// Ties go to the simpler filter, as they do in libpng.
+static int cheapest_filter(const uint64_t costs[kPngFilterCount]) {
+    int best = kNone_PngFilter;
+    for (int f = 1; f < kPngFilterCount; f++) {
+        if (costs[f] < costs[best]) {
+            best = f;
+        }
+    }
+    return best;
+}
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+
+static __m128i if_then_else(__m128i mask, __m128i t, __m128i e) {
+    return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, e));
+}
+
+// Paeth on eight 16-bit lanes.
+static __m128i paeth_predictor(__m128i a, __m128i b, __m128i c) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pa = _mm_sub_epi16(b, c),
+            pb = _mm_sub_epi16(a, c),
+            pc = _mm_add_epi16(pa, pb);
+    pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+    pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+    pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+    // If pa isn't the smallest, the smallest of pb and pc is, so pb == smallest means pb <= pc.
+    const __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+    return if_then_else(_mm_cmpeq_epi16(pa, smallest), a,
+                        if_then_else(_mm_cmpeq_epi16(pb, smallest), b, c));
+}
+
+static __m128i filter_bytes(int filter, __m128i x, __m128i a, __m128i b, __m128i c) {
+    switch (filter) {
+        case kSub_PngFilter: return _mm_sub_epi8(x, a);
+        case kUp_PngFilter:  return _mm_sub_epi8(x, b);
+        case kAvg_PngFilter: {
+            // _mm_avg_epu8 rounds up, the PNG average rounds down.
+            const __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+                                             _mm_and_si128(_mm_xor_si128(a, b),
+                                                           _mm_set1_epi8(1)));
+            return _mm_sub_epi8(x, avg);
+        }
+        case kPaeth_PngFilter: {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i lo = paeth_predictor(_mm_unpacklo_epi8(a, zero),
+                                               _mm_unpacklo_epi8(b, zero),
+                                               _mm_unpacklo_epi8(c, zero)),
+                          hi = paeth_predictor(_mm_unpackhi_epi8(a, zero),
+                                               _mm_unpackhi_epi8(b, zero),
+                                               _mm_unpackhi_epi8(c, zero));
+            return _mm_sub_epi8(x, _mm_packus_epi16(lo, hi));
+        }
+        default: return x;
+    }
+}
+
+static int png_filter_row(uint8_t dst[], const uint8_t row[], const uint8_t prev[],
+                          int bytes, int bpp) {
+    // The first pixel has no left neighbor, so it and the leftover tail are done one byte at
+    // a time, and everything between sixteen bytes at a time.
+    const int begin = SkTMin(bpp, bytes),
+              end = begin + ((bytes - begin) & ~15);
+
+    uint64_t costs[kPngFilterCount] = { 0, 0, 0, 0, 0 };
+    png_filter_costs_portable(costs, row, prev, 0, begin, bpp);
+    png_filter_costs_portable(costs, row, prev, end, bytes, bpp);
+
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sums[kPngFilterCount] = { zero, zero, zero, zero, zero };
+    for (int i = begin; i < end; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(row + i)),
+                      a = _mm_loadu_si128((const __m128i*)(row + i - bpp)),
+                      b = _mm_loadu_si128((const __m128i*)(prev + i)),
+                      c = _mm_loadu_si128((const __m128i*)(prev + i - bpp));
+        for (int f = 0; f < kPngFilterCount; f++) {
+            const __m128i v = filter_bytes(f, x, a, b, c);
+            // min(v, -v) is the magnitude of v as a signed byte.
+            const __m128i cost = _mm_min_epu8(v, _mm_sub_epi8(zero, v));
+            sums[f] = _mm_add_epi64(sums[f], _mm_sad_epu8(cost, zero));
+        }
+    }
+    for (int f = 0; f < kPngFilterCount; f++) {
+        uint64_t halves[2];
+        _mm_storeu_si128((__m128i*)halves, sums[f]);
+        costs[f] += halves[0] + halves[1];
+    }
+
+    const int filter = cheapest_filter(costs);
+    png_apply_filter_portable(filter, dst, row, prev, 0, begin, bpp);
+    png_apply_filter_portable(filter, dst, row, prev, end, bytes, bpp);
+    for (int i = begin; i < end; i += 16) {
+        const __m128i x = _mm_loadu_si128((const __m128i*)(row + i)),
+                      a = _mm_loadu_si128((const __m128i*)(row + i - bpp)),
+                      b = _mm_loadu_si128((const __m128i*)(prev + i)),
+                      c = _mm_loadu_si128((const __m128i*)(prev + i - bpp));
+        _mm_storeu_si128((__m128i*)(dst + i), filter_bytes(filter, x, a, b, c));
+    }
+    return filter;
+}
+
+#else
+
+static int png_filter_row(uint8_t dst[], const uint8_t row[], const uint8_t prev[],
+                          int bytes, int bpp) {
+    uint64_t costs[kPngFilterCount] = { 0, 0, 0, 0, 0 };
+    png_filter_costs_portable(costs, row, prev, 0, bytes, bpp);
+    const int filter = cheapest_filter(costs);
+    png_apply_filter_portable(filter, dst, row, prev, 0, bytes, bpp);
+    return filter;
+}
+
+#endif
+
+}  // namespace SK_OPTS_NS
+
+#endif//SkPngFilter_opts_DEFINED
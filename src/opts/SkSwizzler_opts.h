@@ -9,6 +9,7 @@
 #define SkSwizzler_opts_DEFINED
 
 #include "SkColorPriv.h"
+#include "SkOpts.h"
 
 namespace SK_OPTS_NS {
 
@@ -835,6 +836,197 @@ static void inverted_CMYK_to_BGR1(uint32_t dst[], const void* src, int count) {
 
 #endif
 
+// 565 and bit masks need nothing past SSE2, so every x86 build vectorizes them.
+
+template <bool kSwapRB>
+static void pack_565_portable(uint16_t dst[], const uint32_t src[], int count) {
+    for (int i = 0; i < count; i++) {
+        uint8_t r = src[i] >>  0,
+                g = src[i] >>  8,
+                b = src[i] >> 16;
+        if (kSwapRB) {
+            SkTSwap(r, b);
+        }
+        dst[i] = SkPack888ToRGB16(r, g, b);
+    }
+}
+
+static uint32_t load_masked_pixel(const uint8_t* src, int bytesPerPixel) {
+    switch (bytesPerPixel) {
+        case 2:  return *(const uint16_t*) src;
+        case 3:  return src[0] | (src[1] << 8) | (src[2] << 16);
+        default: return *(const uint32_t*) src;
+    }
+}
+
+// Scales an n bit channel to 8 bits, rounding to nearest.  2^n - 1 is odd, so there are no
+// ties to break.
+static uint8_t masked_channel_portable(uint32_t pixel, const SkOpts::BitMasks& masks, int c) {
+    const uint32_t max = (1 << masks.size[c]) - 1;
+    if (0 == max) {
+        return 0;
+    }
+    const uint32_t v = (pixel & masks.mask[c]) >> masks.shift[c];
+    return (2 * 255 * v + max) / (2 * max);
+}
+
+template <bool kSwapRB, bool kPremul>
+static void masks_to_8888_portable(uint32_t dst[], const uint8_t* src, int count,
+                                   int bytesPerPixel, int srcStep, const SkOpts::BitMasks& masks) {
+    for (int i = 0; i < count; i++) {
+        const uint32_t p = load_masked_pixel(src, bytesPerPixel);
+        uint8_t r = masked_channel_portable(p, masks, 0),
+                g = masked_channel_portable(p, masks, 1),
+                b = masked_channel_portable(p, masks, 2),
+                a = masks.mask[3] ? masked_channel_portable(p, masks, 3) : 0xFF;
+        if (kPremul) {
+            r = SkMulDiv255Round(r, a);
+            g = SkMulDiv255Round(g, a);
+            b = SkMulDiv255Round(b, a);
+        }
+        if (kSwapRB) {
+            SkTSwap(r, b);
+        }
+        dst[i] = (uint32_t)a << 24
+               | (uint32_t)b << 16
+               | (uint32_t)g <<  8
+               | (uint32_t)r <<  0;
+        src += srcStep;
+    }
+}
+
+#if SK_CPU_SSE_LEVEL >= SK_CPU_SSE_LEVEL_SSE2
+
+template <bool kSwapRB>
+static void pack_565(uint16_t dst[], const uint32_t src[], int count) {
+    const __m128i byte = _mm_set1_epi32(0xFF),
+                  bias = _mm_set1_epi32(0x8000);
+    auto pack4 = [&](__m128i px) {
+        __m128i r = _mm_and_si128(px, byte),
+                g = _mm_and_si128(_mm_srli_epi32(px, 8), byte),
+                b = _mm_and_si128(_mm_srli_epi32(px, 16), byte);
+        if (kSwapRB) {
+            SkTSwap(r, b);
+        }
+        // 565 needs all 16 bits, so bias it into signed range to pack with saturation.
+        return _mm_sub_epi32(_mm_or_si128(_mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(r, 3), 11),
+                                                       _mm_slli_epi32(_mm_srli_epi32(g, 2), 5)),
+                                          _mm_srli_epi32(b, 3)),
+                             bias);
+    };
+    while (count >= 8) {
+        const __m128i lo = pack4(_mm_loadu_si128((const __m128i*) (src + 0))),
+                      hi = pack4(_mm_loadu_si128((const __m128i*) (src + 4)));
+        _mm_storeu_si128((__m128i*) dst, _mm_xor_si128(_mm_packs_epi32(lo, hi),
+                                                       _mm_set1_epi16((short) 0x8000)));
+        src += 8;
+        dst += 8;
+        count -= 8;
+    }
+    pack_565_portable<kSwapRB>(dst, src, count);
+}
+
+template <bool kSwapRB, bool kPremul>
+static void masks_to_8888(uint32_t dst[], const uint8_t* src, int count, int bytesPerPixel,
+                          int srcStep, const SkOpts::BitMasks& masks) {
+    __m128i mask[4], shift[4];
+    __m128 scale[4];
+    for (int c = 0; c < 4; c++) {
+        mask[c]  = _mm_set1_epi32(masks.mask[c]);
+        shift[c] = _mm_cvtsi32_si128(masks.shift[c]);
+        scale[c] = _mm_set1_ps(masks.size[c] ? 255.0f / ((1 << masks.size[c]) - 1) : 0.0f);
+    }
+    const bool opaque = 0 == masks.mask[3];
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128i _128 = _mm_set1_epi32(128),
+                  _257 = _mm_set1_epi32(257);
+
+    // Like masked_channel_portable(), since v * 255 / max is never within float error of a tie.
+    auto channel = [&](__m128i px, int c) {
+        const __m128i v = _mm_srl_epi32(_mm_and_si128(px, mask[c]), shift[c]);
+        return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(v), scale[c]), half));
+    };
+    // Each 32-bit lane holds a byte, so 16-bit multiplies can't overflow into the next lane.
+    auto premul = [&](__m128i x, __m128i a) {
+        return _mm_mulhi_epu16(_mm_add_epi32(_mm_mullo_epi16(x, a), _128), _257);
+    };
+
+    const bool contiguous = 4 == bytesPerPixel && 4 == srcStep;
+    while (count >= 4) {
+        __m128i px;
+        if (contiguous) {
+            px = _mm_loadu_si128((const __m128i*) src);
+        } else {
+            px = _mm_setr_epi32(load_masked_pixel(src + 0 * srcStep, bytesPerPixel),
+                                load_masked_pixel(src + 1 * srcStep, bytesPerPixel),
+                                load_masked_pixel(src + 2 * srcStep, bytesPerPixel),
+                                load_masked_pixel(src + 3 * srcStep, bytesPerPixel));
+        }
+        __m128i r = channel(px, 0),
+                g = channel(px, 1),
+                b = channel(px, 2),
+                a = opaque ? _mm_set1_epi32(0xFF) : channel(px, 3);
+        if (kPremul) {
+            r = premul(r, a);
+            g = premul(g, a);
+            b = premul(b, a);
+        }
+        if (kSwapRB) {
+            SkTSwap(r, b);
+        }
+        _mm_storeu_si128((__m128i*) dst,
+                         _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 8)),
+                                      _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24))));
+        src += 4 * srcStep;
+        dst += 4;
+        count -= 4;
+    }
+    masks_to_8888_portable<kSwapRB, kPremul>(dst, src, count, bytesPerPixel, srcStep, masks);
+}
+
+#else
+
+template <bool kSwapRB>
+static void pack_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565_portable<kSwapRB>(dst, src, count);
+}
+
+template <bool kSwapRB, bool kPremul>
+static void masks_to_8888(uint32_t dst[], const uint8_t* src, int count, int bytesPerPixel,
+                          int srcStep, const SkOpts::BitMasks& masks) {
+    masks_to_8888_portable<kSwapRB, kPremul>(dst, src, count, bytesPerPixel, srcStep, masks);
+}
+
+#endif
+
+static void RGBA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565<false>(dst, src, count);
+}
+
+static void BGRA_to_565(uint16_t dst[], const uint32_t src[], int count) {
+    pack_565<true>(dst, src, count);
+}
+
+static void masks_to_RGBA(uint32_t dst[], const uint8_t* src, int count, int bytesPerPixel,
+                          int srcStep, const SkOpts::BitMasks& masks) {
+    masks_to_8888<false, false>(dst, src, count, bytesPerPixel, srcStep, masks);
+}
+
+static void masks_to_rgbA(uint32_t dst[], const uint8_t* src, int count, int bytesPerPixel,
+                          int srcStep, const SkOpts::BitMasks& masks) {
+    masks_to_8888<false, true>(dst, src, count, bytesPerPixel, srcStep, masks);
+}
+
+static void masks_to_BGRA(uint32_t dst[], const uint8_t* src, int count, int bytesPerPixel,
+                          int srcStep, const SkOpts::BitMasks& masks) {
+    masks_to_8888<true, false>(dst, src, count, bytesPerPixel, srcStep, masks);
+}
+
+static void masks_to_bgrA(uint32_t dst[], const uint8_t* src, int count, int bytesPerPixel,
+                          int srcStep, const SkOpts::BitMasks& masks) {
+    masks_to_8888<true, true>(dst, src, count, bytesPerPixel, srcStep, masks);
+}
+
 }
 
 #endif // SkSwizzler_opts_DEFINED
@@ -9,6 +9,7 @@
 
 #include "SkData.h"
 #include "SkGlyphCache.h"
+#include "SkOTUtils.h"
 #include "SkPaint.h"
 #include "SkPDFCanon.h"
 #include "SkPDFDevice.h"
@@ -816,13 +817,8 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFCanon* canon,
         info = SkTypeface::kGlyphNames_PerGlyphInfo;
         info = SkTBitOr<SkTypeface::PerGlyphInfo>(
                   info, SkTypeface::kToUnicode_PerGlyphInfo);
-#if !defined (SK_SFNTLY_SUBSETTER)
-        info = SkTBitOr<SkTypeface::PerGlyphInfo>(
-                  info, SkTypeface::kHAdvance_PerGlyphInfo);
-#endif
         fontMetrics.reset(
             typeface->getAdvancedTypefaceMetrics(info, nullptr, 0));
-#if defined (SK_SFNTLY_SUBSETTER)
         if (fontMetrics.get() &&
             fontMetrics->fType != SkAdvancedTypefaceMetrics::kTrueType_Font) {
             // Font does not support subsetting, get new info with advance.
@@ -831,7 +827,6 @@ SkPDFFont* SkPDFFont::GetFontResource(SkPDFCanon* canon,
             fontMetrics.reset(
                 typeface->getAdvancedTypefaceMetrics(info, nullptr, 0));
         }
-#endif
     }
 
     SkPDFFont* font = SkPDFFont::Create(canon, fontMetrics.get(), typeface,
@@ -1063,6 +1058,22 @@ bool SkPDFCIDFont::addFontDescriptor(int16_t defaultWidth,
                     break;
                 }
             }
+#else
+            if (this->canSubset()) {
+                // The subset reads the tables it leaves unchanged from the font's own stream.
+                int ttcIndex;
+                SkStreamAsset* fontData = this->typeface()->openStream(&ttcIndex);
+                std::unique_ptr<SkStreamAsset> subsetData(SkOTUtils::SubsetFont(
+                        fontData, ttcIndex, subset->begin(), subset->count()));
+                if (subsetData) {
+                    fontSize = subsetData->getLength();
+                    sk_sp<SkPDFSharedStream> fontStream(
+                            new SkPDFSharedStream(subsetData.release()));
+                    fontStream->dict()->insertInt("Length1", fontSize);
+                    descriptor->insertObjRef("FontFile2", std::move(fontStream));
+                    break;
+                }
+            }
 #endif
             sk_sp<SkPDFSharedStream> fontStream;
             std::unique_ptr<SkStreamAsset> fontData(
@@ -1369,10 +1380,10 @@ bool SkPDFType3Font::populate(uint16_t glyphID) {
         SkDynamicMemoryWStream content;
         setGlyphWidthAndBoundingBox(SkFloatToScalar(glyph.fAdvanceX), glyphBBox,
                                     &content);
-        const SkPath* path = cache->findPath(glyph);
-        if (path) {
-            SkPDFUtils::EmitPath(*path, paint.getStyle(), &content);
-            SkPDFUtils::PaintPath(paint.getStyle(), path->getFillType(),
+        SkPath path;
+        if (cache->findPath(glyph, &path)) {
+            SkPDFUtils::EmitPath(path, paint.getStyle(), &content);
+            SkPDFUtils::PaintPath(paint.getStyle(), path.getFillType(),
                                   &content);
         }
         std::unique_ptr<SkMemoryStream> glyphStream(new SkMemoryStream());
@@ -79,12 +79,22 @@ FT_MemoryRec_ gFTMemory = { nullptr, sk_ft_alloc, sk_ft_free, sk_ft_realloc };
 
 class FreeTypeLibrary : SkNoncopyable {
 public:
-    FreeTypeLibrary() : fLibrary(nullptr), fIsLCDSupported(false), fLCDExtra(0) {
+    FreeTypeLibrary()
+        : fLibrary(nullptr), fVersion(0), fIsLCDSupported(false), fLCDExtra(0)
+        , fHasIndependentFaces(false)
+    {
         if (FT_New_Library(&gFTMemory, &fLibrary)) {
             return;
         }
         FT_Add_Default_Modules(fLibrary);
 
+        // Older versions of FreeType share a render pool among all the faces of a library, so
+        // glyphs may only be loaded from one face at a time.
+        FT_Int major, minor, patch;
+        FT_Library_Version(fLibrary, &major, &minor, &patch);
+        fVersion = (major << 16) | (minor << 8) | patch;
+        fHasIndependentFaces = fVersion >= 0x020602;
+
         // Setup LCD filtering. This reduces color fringes for LCD smoothed glyphs.
         // Default { 0x10, 0x40, 0x70, 0x40, 0x10 } adds up to 0x110, simulating ink spread.
         // SetLcdFilter must be called before SetLcdFilterWeights.
@@ -123,13 +133,20 @@ public:
     }
 
     FT_Library library() { return fLibrary; }
+    uint32_t version() { return fVersion; }
     bool isLCDSupported() { return fIsLCDSupported; }
     int lcdExtra() { return fLCDExtra; }
 
+    // If true, separate threads may use separate faces of this library at the same time.
+    // Opening and closing faces must still be serialized.
+    bool hasIndependentFaces() { return fHasIndependentFaces; }
+
 private:
     FT_Library fLibrary;
+    uint32_t fVersion;
     bool fIsLCDSupported;
     int fLCDExtra;
+    bool fHasIndependentFaces;
 
     // FT_Library_SetLcdFilterWeights was introduced in FreeType 2.4.0.
     // The following platforms provide FreeType of at least 2.4.0.
@@ -192,12 +209,17 @@ protected:
     void generateAdvance(SkGlyph* glyph) override;
     void generateMetrics(SkGlyph* glyph) override;
     void generateImage(const SkGlyph& glyph) override;
+    void generateImages(const SkGlyph* const glyphs[], int count) override;
     void generatePath(const SkGlyph& glyph, SkPath* path) override;
     void generateFontMetrics(SkPaint::FontMetrics*) override;
     SkUnichar generateGlyphToChar(uint16_t glyph) override;
+    uint32_t generateEngineVersion() override;
 
 private:
-    FT_Face     fFace;              // reference to shared face in gFaceRecHead
+    FT_Face     fFace;              // fExclusiveFace if there is one, otherwise fSharedFace
+    FT_Face     fSharedFace;        // reference to shared face in gFaceRecHead
+    FT_Face     fExclusiveFace;     // our own face, on the font data of fSharedFace
+    SkBaseMutex* fFaceMutex;        // guards fFace: gFTMutex if it is shared, otherwise nullptr
     FT_Size     fFTSize;            // our own copy
     FT_Int      fStrikeIndex;
     FT_F26Dot6  fScaleX, fScaleY;
@@ -214,9 +236,11 @@ private:
     void getBBoxForCurrentGlyph(SkGlyph* glyph, FT_BBox* bbox,
                                 bool snapToPixelBoundary = false);
     bool getCBoxForLetter(char letter, FT_BBox* bbox);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceMutex and call setupSize before calling this function.
+    void generateImageForCurrentSize(const SkGlyph& glyph);
+    // Caller must lock fFaceMutex before calling this function.
     void updateGlyphIfLCD(SkGlyph* glyph);
-    // Caller must lock gFTMutex before calling this function.
+    // Caller must lock fFaceMutex before calling this function.
     // update FreeType2 glyph slot with glyph emboldened
     void emboldenIfNeeded(FT_Face face, FT_GlyphSlot glyph);
 };
@@ -231,6 +255,8 @@ struct SkFaceRec {
     SkAutoTDelete<SkStreamAsset> fSkStream;
     uint32_t fRefCnt;
     uint32_t fFontID;
+    SkAutoSTMalloc<4, FT_Fixed> fAxes;
+    int fAxisCount;
 
     // assumes ownership of the stream, will delete when its done
     SkFaceRec(SkStreamAsset* strm, uint32_t fontID);
@@ -257,7 +283,7 @@ extern "C" {
 }
 
 SkFaceRec::SkFaceRec(SkStreamAsset* stream, uint32_t fontID)
-        : fNext(nullptr), fSkStream(stream), fRefCnt(1), fFontID(fontID)
+        : fNext(nullptr), fSkStream(stream), fRefCnt(1), fFontID(fontID), fAxisCount(0)
 {
     sk_bzero(&fFTStream, sizeof(fFTStream));
     fFTStream.size = fSkStream->getLength();
@@ -266,7 +292,7 @@ SkFaceRec::SkFaceRec(SkStreamAsset* stream, uint32_t fontID)
     fFTStream.close = sk_ft_stream_close;
 }
 
-static void ft_face_setup_axes(FT_Face face, const SkFontData& data) {
+static void ft_face_setup_axes(FT_Face face, const SkFaceRec& rec) {
     if (!(face->face_flags & FT_FACE_FLAG_MULTIPLE_MASTERS)) {
         return;
     }
@@ -279,24 +305,32 @@ static void ft_face_setup_axes(FT_Face face, const SkFontData& data) {
         }
         SkAutoFree autoFreeVariations(variations);
 
-        if (static_cast<FT_UInt>(data.getAxisCount()) != variations->num_axis) {
+        if (static_cast<FT_UInt>(rec.fAxisCount) != variations->num_axis) {
             SkDEBUGF(("INFO: font %s has %d variations, but %d were specified.\n",
-                    face->family_name, variations->num_axis, data.getAxisCount()));
+                    face->family_name, variations->num_axis, rec.fAxisCount));
             return;
         }
     )
 
-    SkAutoSTMalloc<4, FT_Fixed> coords(data.getAxisCount());
-    for (int i = 0; i < data.getAxisCount(); ++i) {
-        coords[i] = data.getAxis()[i];
-    }
-    if (FT_Set_Var_Design_Coordinates(face, data.getAxisCount(), coords.get())) {
+    if (FT_Set_Var_Design_Coordinates(face, rec.fAxisCount, rec.fAxes.get())) {
         SkDEBUGF(("INFO: font %s has variations, but specified variations could not be set.\n",
                   face->family_name));
         return;
     }
 }
 
+static void ft_face_setup_charmap(FT_Face face) {
+    // FreeType will set the charmap to the "most unicode" cmap if it exists.
+    // If there are no unicode cmaps, the charmap is set to nullptr.
+    // However, "symbol" cmaps should also be considered "fallback unicode" cmaps
+    // because they are effectively private use area only (even if they aren't).
+    // This is the last on the fallback list at
+    // https://developer.apple.com/fonts/TrueType-Reference-Manual/RM06/Chap6cmap.html
+    if (!face->charmap) {
+        FT_Select_Charmap(face, FT_ENCODING_MS_SYMBOL);
+    }
+}
+
 // Will return 0 on failure
 // Caller must lock gFTMutex before calling this function.
 static FT_Face ref_ft_face(const SkTypeface* typeface) {
@@ -341,17 +375,13 @@ static FT_Face ref_ft_face(const SkTypeface* typeface) {
     }
     SkASSERT(rec->fFace);
 
-    ft_face_setup_axes(rec->fFace, *data);
-
-    // FreeType will set the charmap to the "most unicode" cmap if it exists.
-    // If there are no unicode cmaps, the charmap is set to nullptr.
-    // However, "symbol" cmaps should also be considered "fallback unicode" cmaps
-    // because they are effectively private use area only (even if they aren't).
-    // This is the last on the fallback list at
-    // https://developer.apple.com/fonts/TrueType-Reference-Manual/RM06/Chap6cmap.html
-    if (!rec->fFace->charmap) {
-        FT_Select_Charmap(rec->fFace, FT_ENCODING_MS_SYMBOL);
+    rec->fAxisCount = data->getAxisCount();
+    rec->fAxes.reset(rec->fAxisCount);
+    for (int i = 0; i < rec->fAxisCount; ++i) {
+        rec->fAxes[i] = data->getAxis()[i];
     }
+    ft_face_setup_axes(rec->fFace, *rec);
+    ft_face_setup_charmap(rec->fFace);
 
     rec->fNext = gFaceRecHead;
     gFaceRecHead = rec;
@@ -385,6 +415,43 @@ void unref_ft_face(FT_Face face) {
     SkDEBUGFAIL("shouldn't get here, face not in list");
 }
 
+// Opens another face on the font data of a shared face, for a caller that will load glyphs
+// from it on any thread, without holding gFTMutex. The shared face must stay referenced while
+// this face is open. Returns nullptr if the library can not load glyphs from separate faces
+// at once, or if the font data is not in memory, so that faces would have to share a stream.
+// Caller must lock gFTMutex before calling this function, and before calling FT_Done_Face().
+static FT_Face open_exclusive_ft_face(FT_Face sharedFace) {
+    gFTMutex.assertHeld();
+
+    if (!gFTLibrary->hasIndependentFaces()) {
+        return nullptr;
+    }
+
+    SkFaceRec* rec = gFaceRecHead;
+    while (rec && rec->fFace != sharedFace) {
+        rec = rec->fNext;
+    }
+    SkASSERT(rec);
+    const void* memoryBase = rec->fSkStream->getMemoryBase();
+    if (!memoryBase) {
+        return nullptr;
+    }
+
+    FT_Open_Args args;
+    memset(&args, 0, sizeof(args));
+    args.flags = FT_OPEN_MEMORY;
+    args.memory_base = (const FT_Byte*)memoryBase;
+    args.memory_size = rec->fSkStream->getLength();
+
+    FT_Face face;
+    if (FT_Open_Face(gFTLibrary->library(), &args, sharedFace->face_index, &face)) {
+        return nullptr;
+    }
+    ft_face_setup_axes(face, *rec);
+    ft_face_setup_charmap(face);
+    return face;
+}
+
 class AutoFTAccess {
 public:
     AutoFTAccess(const SkTypeface* tf) : fFace(nullptr) {
@@ -796,6 +863,9 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
                                                    const SkDescriptor* desc)
     : SkScalerContext_FreeType_Base(typeface, effects, desc)
     , fFace(nullptr)
+    , fSharedFace(nullptr)
+    , fExclusiveFace(nullptr)
+    , fFaceMutex(&gFTMutex)
     , fFTSize(nullptr)
     , fStrikeIndex(-1)
 {
@@ -813,6 +883,13 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
         return;
     }
 
+    // Load glyphs from a face of our own when we can, so that we need not hold gFTMutex while
+    // loading them, and other threads can load glyphs from this font at the same time.
+    using DoneFTFace = SkFunctionWrapper<FT_Error, skstd::remove_pointer_t<FT_Face>, FT_Done_Face>;
+    std::unique_ptr<skstd::remove_pointer_t<FT_Face>, DoneFTFace> exclusiveFace(
+            open_exclusive_ft_face(ftFace.get()));
+    FT_Face face = exclusiveFace ? exclusiveFace.get() : ftFace.get();
+
     fRec.computeMatrices(SkScalerContextRec::kFull_PreMatrixScale, &fScale, &fMatrix22Scalar);
     fMatrix22Scalar.setSkewX(-fMatrix22Scalar.getSkewX());
     fMatrix22Scalar.setSkewY(-fMatrix22Scalar.getSkewY());
@@ -896,11 +973,11 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
     }
 
     using DoneFTSize = SkFunctionWrapper<FT_Error, skstd::remove_pointer_t<FT_Size>, FT_Done_Size>;
-    std::unique_ptr<skstd::remove_pointer_t<FT_Size>, DoneFTSize> ftSize([&ftFace]() -> FT_Size {
+    std::unique_ptr<skstd::remove_pointer_t<FT_Size>, DoneFTSize> ftSize([face]() -> FT_Size {
         FT_Size size;
-        FT_Error err = FT_New_Size(ftFace.get(), &size);
+        FT_Error err = FT_New_Size(face, &size);
         if (err != 0) {
-            SkDEBUGF(("FT_New_Size returned %x for face %s\n", err, ftFace->family_name));
+            SkDEBUGF(("FT_New_Size returned %x for face %s\n", err, face->family_name));
             return nullptr;
         }
         return size;
@@ -913,23 +990,23 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
     FT_Error err = FT_Activate_Size(ftSize.get());
     if (err != 0) {
         SkDEBUGF(("FT_Activate_Size(%08x, 0x%x, 0x%x) returned 0x%x\n",
-                         ftFace.get(), fScaleX,   fScaleY,       err));
+                         face, fScaleX,   fScaleY,       err));
         return;
     }
 
-    if (FT_IS_SCALABLE(ftFace)) {
-        err = FT_Set_Char_Size(ftFace.get(), fScaleX, fScaleY, 72, 72);
+    if (FT_IS_SCALABLE(face)) {
+        err = FT_Set_Char_Size(face, fScaleX, fScaleY, 72, 72);
         if (err != 0) {
             SkDEBUGF(("FT_Set_CharSize(%08x, 0x%x, 0x%x) returned 0x%x\n",
-                               ftFace.get(), fScaleX, fScaleY,      err));
+                               face, fScaleX, fScaleY,      err));
             return;
         }
-        FT_Set_Transform(ftFace.get(), &fMatrix22, nullptr);
-    } else if (FT_HAS_FIXED_SIZES(ftFace)) {
-        fStrikeIndex = chooseBitmapStrike(ftFace.get(), fScaleY);
+        FT_Set_Transform(face, &fMatrix22, nullptr);
+    } else if (FT_HAS_FIXED_SIZES(face)) {
+        fStrikeIndex = chooseBitmapStrike(face, fScaleY);
         if (fStrikeIndex == -1) {
             SkDEBUGF(("no glyphs for font \"%s\" size %f?\n",
-                            ftFace->family_name,      SkFDot6ToScalar(fScaleY)));
+                            face->family_name,      SkFDot6ToScalar(fScaleY)));
         } else {
             // FreeType does no provide linear metrics for bitmap fonts.
             linearMetrics = false;
@@ -944,11 +1021,14 @@ SkScalerContext_FreeType::SkScalerContext_FreeType(SkTypeface* typeface,
         }
     } else {
         SkDEBUGF(("unknown kind of font \"%s\" size %f?\n",
-                            fFace->family_name,     SkFDot6ToScalar(fScaleY)));
+                            face->family_name,     SkFDot6ToScalar(fScaleY)));
     }
 
     fFTSize = ftSize.release();
-    fFace = ftFace.release();
+    fFace = face;
+    fSharedFace = ftFace.release();
+    fExclusiveFace = exclusiveFace.release();
+    fFaceMutex = fExclusiveFace ? nullptr : &gFTMutex;
     fDoLinearMetrics = linearMetrics;
 }
 
@@ -959,8 +1039,12 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
         FT_Done_Size(fFTSize);
     }
 
-    if (fFace != nullptr) {
-        unref_ft_face(fFace);
+    if (fExclusiveFace != nullptr) {
+        FT_Done_Face(fExclusiveFace);
+    }
+
+    if (fSharedFace != nullptr) {
+        unref_ft_face(fSharedFace);
     }
 
     unref_ft_library();
@@ -970,7 +1054,9 @@ SkScalerContext_FreeType::~SkScalerContext_FreeType() {
     this face with other context (at different sizes).
 */
 FT_Error SkScalerContext_FreeType::setupSize() {
-    gFTMutex.assertHeld();
+    if (fFaceMutex) {
+        fFaceMutex->assertHeld();
+    }
     FT_Error err = FT_Activate_Size(fFTSize);
     if (err != 0) {
         SkDEBUGF(("SkScalerContext_FreeType::FT_Activate_Size(%s %s, 0x%x, 0x%x) returned 0x%x\n",
@@ -990,12 +1076,12 @@ unsigned SkScalerContext_FreeType::generateGlyphCount() {
 }
 
 uint16_t SkScalerContext_FreeType::generateCharToGlyph(SkUnichar uni) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
     return SkToU16(FT_Get_Char_Index( fFace, uni ));
 }
 
 SkUnichar SkScalerContext_FreeType::generateGlyphToChar(uint16_t glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
     // iterate through each cmap entry, looking for matching glyph indices
     FT_UInt glyphIndex;
     SkUnichar charCode = FT_Get_First_Char( fFace, &glyphIndex );
@@ -1010,6 +1096,11 @@ SkUnichar SkScalerContext_FreeType::generateGlyphToChar(uint16_t glyph) {
     return 0;
 }
 
+uint32_t SkScalerContext_FreeType::generateEngineVersion() {
+    // The library outlives the faces of its scaler contexts.
+    return gFTLibrary->version();
+}
+
 static SkScalar SkFT_FixedToScalar(FT_Fixed x) {
   return SkFixedToScalar(x);
 }
@@ -1019,7 +1110,7 @@ void SkScalerContext_FreeType::generateAdvance(SkGlyph* glyph) {
     * which are very cheap to compute with some font formats...
     */
     if (fDoLinearMetrics) {
-        SkAutoMutexAcquire  ac(gFTMutex);
+        SkAutoMutexAcquire  ac(fFaceMutex);
 
         if (this->setupSize()) {
             glyph->zeroMetrics();
@@ -1123,7 +1214,7 @@ inline void scaleGlyphMetrics(SkGlyph& glyph, SkScalar scale) {
 }
 
 void SkScalerContext_FreeType::generateMetrics(SkGlyph* glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     glyph->fRsbDelta = 0;
     glyph->fLsbDelta = 0;
@@ -1231,13 +1322,32 @@ static void clear_glyph_image(const SkGlyph& glyph) {
 }
 
 void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     if (this->setupSize()) {
         clear_glyph_image(glyph);
         return;
     }
 
+    this->generateImageForCurrentSize(glyph);
+}
+
+void SkScalerContext_FreeType::generateImages(const SkGlyph* const glyphs[], int count) {
+    SkAutoMutexAcquire  ac(fFaceMutex);
+
+    if (this->setupSize()) {
+        for (int i = 0; i < count; ++i) {
+            clear_glyph_image(*glyphs[i]);
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        this->generateImageForCurrentSize(*glyphs[i]);
+    }
+}
+
+void SkScalerContext_FreeType::generateImageForCurrentSize(const SkGlyph& glyph) {
     FT_Error err = FT_Load_Glyph(fFace, glyph.getGlyphID(), fLoadGlyphFlags);
     if (err != 0) {
         SkDEBUGF(("SkScalerContext_FreeType::generateImage: FT_Load_Glyph(glyph:%d width:%d height:%d rb:%d flags:%d) returned 0x%x\n",
@@ -1252,7 +1362,7 @@ void SkScalerContext_FreeType::generateImage(const SkGlyph& glyph) {
 
 
 void SkScalerContext_FreeType::generatePath(const SkGlyph& glyph, SkPath* path) {
-    SkAutoMutexAcquire  ac(gFTMutex);
+    SkAutoMutexAcquire  ac(fFaceMutex);
 
     SkASSERT(path);
 
@@ -1293,7 +1403,7 @@ void SkScalerContext_FreeType::generateFontMetrics(SkPaint::FontMetrics* metrics
         return;
     }
 
-    SkAutoMutexAcquire ac(gFTMutex);
+    SkAutoMutexAcquire ac(fFaceMutex);
 
     if (this->setupSize()) {
         sk_bzero(metrics, sizeof(*metrics));
@@ -541,12 +541,15 @@ static SkTypeface* NewFromName(const char familyName[], const SkFontStyle& theSt
         return nullptr;
     }
 
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(find_by_CTFontRef, (void*)ctFont.get());
+    // Equal fonts have equal hashes.
+    uint32_t hash = (uint32_t)CFHash(ctFont.get());
+    SkTypeface* face = SkTypefaceCache::FindByHashAndProcAndRef(hash, find_by_CTFontRef,
+                                                                (void*)ctFont.get());
     if (face) {
         return face;
     }
     face = NewFromFontRef(ctFont.release(), nullptr, false);
-    SkTypefaceCache::Add(face);
+    SkTypefaceCache::Add(face, hash);
     return face;
 }
 
@@ -574,7 +577,9 @@ CTFontRef SkTypeface_GetCTFontRef(const SkTypeface* face) {
  *  not found, returns a new entry (after adding it to the cache).
  */
 SkTypeface* SkCreateTypefaceFromCTFont(CTFontRef fontRef, CFTypeRef resourceRef) {
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(find_by_CTFontRef, (void*)fontRef);
+    uint32_t hash = (uint32_t)CFHash(fontRef);
+    SkTypeface* face = SkTypefaceCache::FindByHashAndProcAndRef(hash, find_by_CTFontRef,
+                                                                (void*)fontRef);
     if (face) {
         return face;
     }
@@ -583,7 +588,7 @@ SkTypeface* SkCreateTypefaceFromCTFont(CTFontRef fontRef, CFTypeRef resourceRef)
         CFRetain(resourceRef);
     }
     face = NewFromFontRef(fontRef, resourceRef, false);
-    SkTypefaceCache::Add(face);
+    SkTypefaceCache::Add(face, hash);
     return face;
 }
 
@@ -627,6 +632,7 @@ protected:
     void generateImage(const SkGlyph& glyph) override;
     void generatePath(const SkGlyph& glyph, SkPath* path) override;
     void generateFontMetrics(SkPaint::FontMetrics*) override;
+    uint32_t generateEngineVersion() override;
 
 private:
     static void CTPathElement(void *info, const CGPathElement *element);
@@ -984,6 +990,10 @@ unsigned SkScalerContext_Mac::generateGlyphCount(void) {
     return fGlyphCount;
 }
 
+uint32_t SkScalerContext_Mac::generateEngineVersion() {
+    return CTGetCoreTextVersion();
+}
+
 uint16_t SkScalerContext_Mac::generateCharToGlyph(SkUnichar uni) {
     AUTO_CG_LOCK();
 
@@ -2161,13 +2171,15 @@ static SkTypeface* createFromDesc(CTFontDescriptorRef desc) {
         return nullptr;
     }
 
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(find_by_CTFontRef, (void*)ctFont.get());
+    uint32_t hash = (uint32_t)CFHash(ctFont.get());
+    SkTypeface* face = SkTypefaceCache::FindByHashAndProcAndRef(hash, find_by_CTFontRef,
+                                                                (void*)ctFont.get());
     if (face) {
         return face;
     }
 
     face = NewFromFontRef(ctFont.release(), nullptr, false);
-    SkTypefaceCache::Add(face);
+    SkTypefaceCache::Add(face, hash);
     return face;
 }
 
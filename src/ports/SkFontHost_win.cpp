@@ -10,6 +10,7 @@
 
 #include "SkAdvancedTypefaceMetrics.h"
 #include "SkBase64.h"
+#include "SkChecksum.h"
 #include "SkColorPriv.h"
 #include "SkData.h"
 #include "SkDescriptor.h"
@@ -320,10 +321,12 @@ static bool FindByLogFont(SkTypeface* face, void* ctx) {
 SkTypeface* SkCreateTypefaceFromLOGFONT(const LOGFONT& origLF) {
     LOGFONT lf = origLF;
     make_canonical(&lf);
-    SkTypeface* face = SkTypefaceCache::FindByProcAndRef(FindByLogFont, &lf);
+    // FindByLogFont compares the bytes of the LOGFONTs, so they hash their bytes.
+    uint32_t hash = SkChecksum::Murmur3(&lf, sizeof(LOGFONT));
+    SkTypeface* face = SkTypefaceCache::FindByHashAndProcAndRef(hash, FindByLogFont, &lf);
     if (nullptr == face) {
         face = LogFontTypeface::Create(lf);
-        SkTypefaceCache::Add(face);
+        SkTypefaceCache::Add(face, hash);
     }
     return face;
 }
@@ -5,24 +5,33 @@
  * found in the LICENSE file.
  */
 
+#include "SkAtomics.h"
+#include "SkBuffer.h"
+#include "SkData.h"
 #include "SkFontDescriptor.h"
 #include "SkFontHost_FreeType_common.h"
 #include "SkFontMgr.h"
 #include "SkFontMgr_custom.h"
 #include "SkFontStyle.h"
+#include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkOSFile.h"
 #include "SkRefCnt.h"
 #include "SkStream.h"
 #include "SkString.h"
 #include "SkTArray.h"
+#include "SkTDArray.h"
+#include "SkTHash.h"
+#include "SkThreadUtils.h"
 #include "SkTemplates.h"
 #include "SkTypeface.h"
 #include "SkTypefaceCache.h"
 #include "SkTypes.h"
 
 #include <limits>
-
-class SkData;
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /** The base SkTypeface implementation for the custom font manager. */
 class SkTypeface_Custom : public SkTypeface_FreeType {
@@ -102,11 +111,19 @@ public:
 protected:
     SkStreamAsset* onOpenStream(int* ttcIndex) const override {
         *ttcIndex = this->getIndex();
+        // The file is mapped once, and its streams share the mapping, so the faces of a large
+        // font directory cost page cache rather than heap or a mapping per stream.
+        fDataOnce([this]() { fData = SkData::MakeFromFileName(fPath.c_str()); });
+        if (fData) {
+            return new SkMemoryStream(fData);
+        }
         return SkStream::NewFromFile(fPath.c_str());
     }
 
 private:
     SkString fPath;
+    mutable SkOnce fDataOnce;
+    mutable sk_sp<SkData> fData;
 
     typedef SkTypeface_Custom INHERITED;
 };
@@ -124,7 +141,24 @@ public:
 
     /** Should only be called during the inital build phase. */
     void appendTypeface(SkTypeface_Custom* typeface) {
-        fStyles.push_back().reset(typeface);
+        Style& style = fStyles.push_back();
+        style.fStyle = typeface->fontStyle();
+        style.fTypeface.reset(typeface);
+        style.fIsFixedPitch = typeface->isFixedPitch();
+        style.fIndex = 0;
+    }
+
+    /**
+     *  Appends the face at index in the file at path, whose SkTypeface_File is only made when it
+     *  is first asked for. Should only be called during the inital build phase.
+     */
+    void appendFile(const SkFontStyle& fontStyle, bool isFixedPitch, const char path[],
+                    int index) {
+        Style& style = fStyles.push_back();
+        style.fStyle = fontStyle;
+        style.fIsFixedPitch = isFixedPitch;
+        style.fPath.set(path);
+        style.fIndex = index;
     }
 
     int count() override {
@@ -134,7 +168,7 @@ public:
     void getStyle(int index, SkFontStyle* style, SkString* name) override {
         SkASSERT(index < fStyles.count());
         if (style) {
-            *style = fStyles[index]->fontStyle();
+            *style = fStyles[index].fStyle;
         }
         if (name) {
             name->reset();
@@ -143,7 +177,15 @@ public:
 
     SkTypeface* createTypeface(int index) override {
         SkASSERT(index < fStyles.count());
-        return SkRef(fStyles[index].get());
+        SkAutoMutexAcquire lock(fMutex);
+        Style& style = fStyles[index];
+        if (!style.fTypeface) {
+            style.fTypeface.reset(new SkTypeface_File(style.fStyle, style.fIsFixedPitch,
+                                                      true,  // system-font (cannot delete)
+                                                      fFamilyName, style.fPath.c_str(),
+                                                      style.fIndex));
+        }
+        return SkRef(style.fTypeface.get());
     }
 
     SkTypeface* matchStyle(const SkFontStyle& pattern) override {
@@ -152,11 +194,31 @@ public:
 
     SkString getFamilyName() { return fFamilyName; }
 
+    /** Returns true if typeface is one this set has made. */
+    bool contains(const SkTypeface* typeface) {
+        SkAutoMutexAcquire lock(fMutex);
+        for (const Style& style : fStyles) {
+            if (style.fTypeface.get() == typeface) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 private:
-    SkTArray<SkAutoTUnref<SkTypeface_Custom>, true> fStyles;
-    SkString fFamilyName;
+    struct Style {
+        SkFontStyle                     fStyle;
+        // Null until the typeface of a file is first asked for.
+        SkAutoTUnref<SkTypeface_Custom> fTypeface;
+        bool                            fIsFixedPitch;
+        SkString                        fPath;
+        int                             fIndex;
+    };
 
-    friend class SkFontMgr_Custom;
+    SkTArray<Style, true> fStyles;
+    SkString fFamilyName;
+    // Guards making the typefaces of files.
+    SkMutex fMutex;
 };
 
 /**
@@ -176,6 +238,9 @@ public:
     };
     explicit SkFontMgr_Custom(const SystemFontLoader& loader) : fDefaultFamily(nullptr) {
         loader.loadSystemFonts(fScanner, &fFamilies);
+        for (int i = 0; i < fFamilies.count(); ++i) {
+            fFamilyIndex.set(fFamilies[i]->getFamilyName(), fFamilies[i].get());
+        }
 
         // Try to pick a default font.
         static const char* defaultNames[] = {
@@ -218,12 +283,8 @@ protected:
     }
 
     SkFontStyleSet_Custom* onMatchFamily(const char familyName[]) const override {
-        for (int i = 0; i < fFamilies.count(); ++i) {
-            if (fFamilies[i]->getFamilyName().equals(familyName)) {
-                return SkRef(fFamilies[i].get());
-            }
-        }
-        return nullptr;
+        SkFontStyleSet_Custom* const* family = fFamilyIndex.find(SkString(familyName));
+        return family ? SkRef(*family) : nullptr;
     }
 
     SkTypeface* onMatchFamilyStyle(const char familyName[],
@@ -244,10 +305,8 @@ protected:
                                  const SkFontStyle& fontStyle) const override
     {
         for (int i = 0; i < fFamilies.count(); ++i) {
-            for (int j = 0; j < fFamilies[i]->fStyles.count(); ++j) {
-                if (fFamilies[i]->fStyles[j] == familyMember) {
-                    return fFamilies[i]->matchStyle(fontStyle);
-                }
+            if (fFamilies[i]->contains(familyMember)) {
+                return fFamilies[i]->matchStyle(fontStyle);
             }
         }
         return nullptr;
@@ -295,23 +354,69 @@ protected:
 
 private:
     Families fFamilies;
+    // The families by name, which the loaders make unique.
+    SkTHashMap<SkString, SkFontStyleSet_Custom*> fFamilyIndex;
     SkFontStyleSet_Custom* fDefaultFamily;
     SkTypeface_FreeType::Scanner fScanner;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Directories with at least this many files to scan are split into tasks of kFilesPerTask, which
+// threads of the scan take in turn. Each thread after the first makes its own scanner, as a
+// scanner only opens one font at a time.
+static constexpr int kMinFilesForTasks = 32;
+static constexpr int kFilesPerTask = 16;
+
+// The version of the index file; files of other versions are replaced.
+static constexpr uint32_t kIndexVersion = 1;
+
+static const char* const kFontSuffixes[] = { ".ttf", ".ttc", ".otf", ".pfb" };
+
 class DirectorySystemFontLoader : public SkFontMgr_Custom::SystemFontLoader {
 public:
-    DirectorySystemFontLoader(const char* dir) : fBaseDirectory(dir) { }
+    DirectorySystemFontLoader(const char* dir, const char* indexPath)
+        : fBaseDirectory(dir), fIndexPath(indexPath) { }
 
     void loadSystemFonts(const SkTypeface_FreeType::Scanner& scanner,
                          SkFontMgr_Custom::Families* families) const override
     {
-        load_directory_fonts(scanner, fBaseDirectory, ".ttf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".ttc", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".otf", families);
-        load_directory_fonts(scanner, fBaseDirectory, ".pfb", families);
+        // The files of each suffix in turn, each in the order the directories are walked.
+        SkTArray<FontFile, true> filesBySuffix[SK_ARRAY_COUNT(kFontSuffixes)];
+        find_directory_fonts(fBaseDirectory, filesBySuffix);
+        SkTArray<FontFile, true> files;
+        for (SkTArray<FontFile, true>& suffixFiles : filesBySuffix) {
+            files.push_back_n(suffixFiles.count(), suffixFiles.begin());
+        }
+
+        // Only the files which are not in the index, or which have changed since it was written,
+        // are opened with FreeType.
+        bool indexIsCurrent = !fIndexPath.isEmpty() && read_index(fIndexPath.c_str(), &files);
+        SkTArray<FontFile*, true> unscanned;
+        for (FontFile& file : files) {
+            if (!file.fScanned) {
+                unscanned.push_back(&file);
+            }
+        }
+        scan_files(scanner, unscanned.begin(), unscanned.count());
+        if (!fIndexPath.isEmpty() && !indexIsCurrent) {
+            write_index(fIndexPath.c_str(), files);
+        }
+
+        // The typefaces themselves are only made when they are first asked for.
+        SkTHashMap<SkString, SkFontStyleSet_Custom*> familyIndex;
+        for (const FontFile& file : files) {
+            for (const FontFace& face : file.fFaces) {
+                SkFontStyleSet_Custom** addTo = familyIndex.find(face.fFamilyName);
+                if (nullptr == addTo) {
+                    SkFontStyleSet_Custom* family = new SkFontStyleSet_Custom(face.fFamilyName);
+                    families->push_back().reset(family);
+                    addTo = familyIndex.set(face.fFamilyName, family);
+                }
+                (*addTo)->appendFile(face.fStyle, face.fIsFixedPitch, file.fPath.c_str(),
+                                     face.fIndex);
+            }
+        }
 
         if (families->empty()) {
             SkFontStyleSet_Custom* family = new SkFontStyleSet_Custom(SkString());
@@ -321,76 +426,260 @@ public:
     }
 
 private:
-    static SkFontStyleSet_Custom* find_family(SkFontMgr_Custom::Families& families,
-                                              const char familyName[])
+    struct FontFace {
+        SkString    fFamilyName;
+        SkFontStyle fStyle;
+        bool        fIsFixedPitch;
+        int         fIndex;
+    };
+
+    struct FontFile {
+        SkString                 fPath;
+        int64_t                  fModified;  // seconds since the epoch, or -1 if unknown
+        int64_t                  fSize;
+        SkTArray<FontFace, true> fFaces;
+        bool                     fScanned;   // fFaces is known, from a scan or the index
+    };
+
+    // Walks the directory tree once for all the suffixes, rather than once for each.
+    static void find_directory_fonts(const SkString& directory,
+                                     SkTArray<FontFile, true> filesBySuffix[])
     {
-       for (int i = 0; i < families.count(); ++i) {
-            if (families[i]->getFamilyName().equals(familyName)) {
-                return families[i].get();
+        SkString name;
+        for (size_t i = 0; i < SK_ARRAY_COUNT(kFontSuffixes); ++i) {
+            SkOSFile::Iter iter(directory.c_str(), kFontSuffixes[i]);
+            while (iter.next(&name, false)) {
+                FontFile& file = filesBySuffix[i].push_back();
+                file.fPath = SkOSPath::Join(directory.c_str(), name.c_str());
+                file.fModified = -1;
+                file.fSize = -1;
+                file.fScanned = false;
+                struct stat status;
+                if (0 == stat(file.fPath.c_str(), &status)) {
+                    file.fModified = status.st_mtime;
+                    file.fSize = status.st_size;
+                }
             }
         }
-        return nullptr;
+
+        SkOSFile::Iter dirIter(directory.c_str());
+        while (dirIter.next(&name, true)) {
+            if (name.startsWith(".")) {
+                continue;
+            }
+            SkString dirname(SkOSPath::Join(directory.c_str(), name.c_str()));
+            find_directory_fonts(dirname, filesBySuffix);
+        }
     }
 
-    static void load_directory_fonts(const SkTypeface_FreeType::Scanner& scanner,
-                                     const SkString& directory, const char* suffix,
-                                     SkFontMgr_Custom::Families* families)
-    {
-        SkOSFile::Iter iter(directory.c_str(), suffix);
-        SkString name;
+    static void scan_file(const SkTypeface_FreeType::Scanner& scanner, FontFile* file) {
+        file->fScanned = true;
+        SkAutoTDelete<SkStream> stream(SkStream::NewFromFile(file->fPath.c_str()));
+        if (!stream.get()) {
+            SkDebugf("---- failed to open <%s>\n", file->fPath.c_str());
+            return;
+        }
 
-        while (iter.next(&name, false)) {
-            SkString filename(SkOSPath::Join(directory.c_str(), name.c_str()));
-            SkAutoTDelete<SkStream> stream(SkStream::NewFromFile(filename.c_str()));
-            if (!stream.get()) {
-                SkDebugf("---- failed to open <%s>\n", filename.c_str());
+        int numFaces;
+        if (!scanner.recognizedFont(stream, &numFaces)) {
+            SkDebugf("---- failed to open <%s> as a font\n", file->fPath.c_str());
+            return;
+        }
+
+        for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
+            FontFace face;
+            face.fStyle = SkFontStyle(); // avoid uninitialized warning
+            face.fIndex = faceIndex;
+            if (!scanner.scanFont(stream, faceIndex, &face.fFamilyName, &face.fStyle,
+                                  &face.fIsFixedPitch, nullptr)) {
+                SkDebugf("---- failed to open <%s> <%d> as a font\n",
+                         file->fPath.c_str(), faceIndex);
                 continue;
             }
+            file->fFaces.push_back(face);
+        }
+    }
 
-            int numFaces;
-            if (!scanner.recognizedFont(stream, &numFaces)) {
-                SkDebugf("---- failed to open <%s> as a font\n", filename.c_str());
-                continue;
+    struct ScanTasks {
+        ScanTasks(FontFile* const files[], int count)
+            : fFiles(files), fCount(count), fNextTask(0) {}
+
+        FontFile* const* fFiles;
+        int fCount;
+        SkAtomic<int> fNextTask;
+    };
+
+    static void scan_tasks(const SkTypeface_FreeType::Scanner& scanner, ScanTasks* tasks) {
+        for (;;) {
+            int first = tasks->fNextTask.fetch_add(1, sk_memory_order_relaxed) * kFilesPerTask;
+            if (first >= tasks->fCount) {
+                return;
+            }
+            int last = SkTMin(first + kFilesPerTask, tasks->fCount);
+            for (int i = first; i < last; ++i) {
+                scan_file(scanner, tasks->fFiles[i]);
             }
+        }
+    }
 
-            for (int faceIndex = 0; faceIndex < numFaces; ++faceIndex) {
-                bool isFixedPitch;
-                SkString realname;
-                SkFontStyle style = SkFontStyle(); // avoid uninitialized warning
-                if (!scanner.scanFont(stream, faceIndex, &realname, &style, &isFixedPitch, nullptr)) {
-                    SkDebugf("---- failed to open <%s> <%d> as a font\n",
-                             filename.c_str(), faceIndex);
-                    continue;
-                }
+    static void scan_tasks_thread(void* tasks) {
+        SkTypeface_FreeType::Scanner scanner;
+        scan_tasks(scanner, static_cast<ScanTasks*>(tasks));
+    }
 
-                SkTypeface_Custom* tf = new SkTypeface_File(style, isFixedPitch,
-                                                            true,  // system-font (cannot delete)
-                                                            realname, filename.c_str(), faceIndex);
+    static void scan_files(const SkTypeface_FreeType::Scanner& scanner, FontFile* const files[],
+                           int count)
+    {
+        if (count < kMinFilesForTasks) {
+            for (int i = 0; i < count; ++i) {
+                scan_file(scanner, files[i]);
+            }
+            return;
+        }
 
-                SkFontStyleSet_Custom* addTo = find_family(*families, realname.c_str());
-                if (nullptr == addTo) {
-                    addTo = new SkFontStyleSet_Custom(realname);
-                    families->push_back().reset(addTo);
-                }
-                addTo->appendTypeface(tf);
+        // The scan runs on threads of its own rather than on SkTaskGroup's. The manager may be
+        // made by SkFontMgr::RefDefault while it holds its once, and waiting on the shared pool
+        // could run a task which needs the default manager.
+        ScanTasks tasks(files, count);
+        int taskCount = (count + kFilesPerTask - 1) / kFilesPerTask;
+        int threadCount = SkTMin(taskCount, SkTMax(1, (int)sysconf(_SC_NPROCESSORS_ONLN)));
+        SkTDArray<SkThread*> threads;
+        for (int i = 1; i < threadCount; ++i) {
+            SkThread* thread = new SkThread(scan_tasks_thread, &tasks);
+            if (thread->start()) {
+                threads.push(thread);
+            } else {
+                delete thread;
             }
         }
+        scan_tasks(scanner, &tasks);
+        for (SkThread* thread : threads) {
+            thread->join();
+        }
+        threads.deleteAll();
+    }
 
-        SkOSFile::Iter dirIter(directory.c_str());
-        while (dirIter.next(&name, true)) {
-            if (name.startsWith(".")) {
-                continue;
+    // The index file holds, for each file found, its path, modification time and size, and the
+    // family, style, pitch and index of each of its faces.
+
+    static void write_string(SkWStream* stream, const SkString& string) {
+        stream->write32(SkToU32(string.size()));
+        stream->write(string.c_str(), string.size());
+    }
+
+    static bool read_string(SkRBufferWithSizeCheck* buffer, SkString* string) {
+        uint32_t length;
+        if (!buffer->readU32(&length) || length > buffer->size() - buffer->pos()) {
+            return false;
+        }
+        string->resize(length);
+        return buffer->read(string->writable_str(), length);
+    }
+
+    static void write_index(const char path[], const SkTArray<FontFile, true>& files) {
+        SkDynamicMemoryWStream index;
+        index.write32(SkSetFourByteTag('s', 'k', 'f', 'i'));
+        index.write32(kIndexVersion);
+        index.write32(files.count());
+        for (const FontFile& file : files) {
+            write_string(&index, file.fPath);
+            index.write(&file.fModified, sizeof(file.fModified));
+            index.write(&file.fSize, sizeof(file.fSize));
+            index.write32(file.fFaces.count());
+            for (const FontFace& face : file.fFaces) {
+                write_string(&index, face.fFamilyName);
+                index.write32(face.fStyle.weight());
+                index.write32(face.fStyle.width());
+                index.write32(face.fStyle.slant());
+                index.write32(face.fIsFixedPitch);
+                index.write32(face.fIndex);
+            }
+        }
+
+        // The index is written next to its path and renamed into place, so a manager never
+        // reads one which is partly written.
+        SkString tmpPath(SkStringPrintf("%s.%d.tmp", path, (int)getpid()));
+        {
+            SkFILEWStream file(tmpPath.c_str());
+            if (!file.isValid()) {
+                return;
+            }
+            index.writeToStream(&file);
+        }
+        if (0 != rename(tmpPath.c_str(), path)) {
+            remove(tmpPath.c_str());
+        }
+    }
+
+    // Sets the faces of the files which have not changed since the index at path was written.
+    // Returns true if the index has every file, and only those.
+    static bool read_index(const char path[], SkTArray<FontFile, true>* files) {
+        sk_sp<SkData> data(SkData::MakeFromFileName(path));
+        if (!data) {
+            return false;
+        }
+        SkRBufferWithSizeCheck buffer(data->data(), data->size());
+        uint32_t tag, version, count;
+        if (!buffer.readU32(&tag) || SkSetFourByteTag('s', 'k', 'f', 'i') != tag ||
+            !buffer.readU32(&version) || kIndexVersion != version ||
+            !buffer.readU32(&count))
+        {
+            return false;
+        }
+
+        SkTHashMap<SkString, FontFile*> filesByPath;
+        for (FontFile& file : *files) {
+            filesByPath.set(file.fPath, &file);
+        }
+
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < count; ++i) {
+            SkString filePath;
+            int64_t modified, size;
+            uint32_t faceCount;
+            if (!read_string(&buffer, &filePath) ||
+                !buffer.read(&modified, sizeof(modified)) ||
+                !buffer.read(&size, sizeof(size)) ||
+                !buffer.readU32(&faceCount))
+            {
+                return false;
+            }
+
+            SkTArray<FontFace, true> faces;
+            for (uint32_t j = 0; j < faceCount; ++j) {
+                FontFace face;
+                uint32_t weight, width, slant, isFixedPitch, index;
+                if (!read_string(&buffer, &face.fFamilyName) ||
+                    !buffer.readU32(&weight) || !buffer.readU32(&width) ||
+                    !buffer.readU32(&slant) || slant > SkFontStyle::kOblique_Slant ||
+                    !buffer.readU32(&isFixedPitch) || !buffer.readU32(&index))
+                {
+                    return false;
+                }
+                face.fStyle = SkFontStyle(weight, width, (SkFontStyle::Slant)slant);
+                face.fIsFixedPitch = SkToBool(isFixedPitch);
+                face.fIndex = index;
+                faces.push_back(face);
+            }
+
+            FontFile** file = filesByPath.find(filePath);
+            if (file && !(*file)->fScanned && -1 != modified &&
+                (*file)->fModified == modified && (*file)->fSize == size)
+            {
+                (*file)->fFaces.swap(&faces);
+                (*file)->fScanned = true;
+                ++found;
             }
-            SkString dirname(SkOSPath::Join(directory.c_str(), name.c_str()));
-            load_directory_fonts(scanner, dirname, suffix, families);
         }
+        return found == count && SkToInt(found) == files->count();
     }
 
     SkString fBaseDirectory;
+    SkString fIndexPath;
 };
 
-SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir) {
-    return new SkFontMgr_Custom(DirectorySystemFontLoader(dir));
+SK_API SkFontMgr* SkFontMgr_New_Custom_Directory(const char* dir, const char* indexPath) {
+    return new SkFontMgr_Custom(DirectorySystemFontLoader(dir, indexPath));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
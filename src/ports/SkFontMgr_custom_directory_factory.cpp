@@ -12,6 +12,11 @@
 #    define SK_FONT_FILE_PREFIX "/usr/share/fonts/"
 #endif
 
+// A file to keep the faces found in SK_FONT_FILE_PREFIX in, e.g. "/var/cache/skia-fonts".
+#ifndef SK_FONT_FILE_INDEX
+#    define SK_FONT_FILE_INDEX nullptr
+#endif
+
 SkFontMgr* SkFontMgr::Factory() {
-    return SkFontMgr_New_Custom_Directory(SK_FONT_FILE_PREFIX);
+    return SkFontMgr_New_Custom_Directory(SK_FONT_FILE_PREFIX, SK_FONT_FILE_INDEX);
 }
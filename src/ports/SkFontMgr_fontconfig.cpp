@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkData.h"
 #include "SkDataTable.h"
 #include "SkFixed.h"
 #include "SkFontDescriptor.h"
@@ -13,6 +14,7 @@
 #include "SkFontStyle.h"
 #include "SkMath.h"
 #include "SkMutex.h"
+#include "SkOnce.h"
 #include "SkOSFile.h"
 #include "SkRefCnt.h"
 #include "SkStream.h"
@@ -26,8 +28,6 @@
 #include <fontconfig/fontconfig.h>
 #include <string.h>
 
-class SkData;
-
 // FC_POSTSCRIPT_NAME was added with b561ff20 which ended up in 2.10.92
 // Ubuntu 12.04 is on 2.8.0, 13.10 is on 2.10.93
 // Debian 7 is on 2.9.0, 8 is on 2.11
@@ -455,6 +455,11 @@ public:
     SkStreamAsset* onOpenStream(int* ttcIndex) const override {
         FCLocker lock;
         *ttcIndex = get_int(fPattern, FC_INDEX, 0);
+        // The file is mapped once, and its streams share the mapping.
+        fDataOnce([this]() { fData = SkData::MakeFromFileName(get_string(fPattern, FC_FILE)); });
+        if (fData) {
+            return new SkMemoryStream(fData);
+        }
         return SkStream::NewFromFile(get_string(fPattern, FC_FILE));
     }
 
@@ -498,6 +503,9 @@ private:
         , fPattern(pattern)
     { };
 
+    mutable SkOnce fDataOnce;
+    mutable sk_sp<SkData> fData;
+
     typedef SkTypeface_FreeType INHERITED;
 };
 
@@ -631,12 +639,14 @@ class SkFontMgr_fontconfig : public SkFontMgr {
     SkTypeface* createTypefaceFromFcPattern(FcPattern* pattern) const {
         FCLocker::AssertHeld();
         SkAutoMutexAcquire ama(fTFCacheMutex);
-        SkTypeface* face = fTFCache.findByProcAndRef(FindByFcPattern, pattern);
+        // Equal patterns have equal hashes.
+        uint32_t hash = FcPatternHash(pattern);
+        SkTypeface* face = fTFCache.findByHashAndProcAndRef(hash, FindByFcPattern, pattern);
         if (nullptr == face) {
             FcPatternReference(pattern);
             face = SkTypeface_fontconfig::Create(pattern);
             if (face) {
-                fTFCache.add(face);
+                fTFCache.add(face, hash);
             }
         }
         return face;
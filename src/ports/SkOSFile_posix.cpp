@@ -150,6 +150,11 @@ bool SkOSFile::Iter::next(SkString* name, bool getDir) {
         dirent* entry;
 
         while ((entry = ::readdir(self.fDIR)) != nullptr) {
+            // Only stat the files which may be returned.
+            if (!getDir && !issuffixfor(self.fSuffix, entry->d_name)) {
+                continue;
+            }
+
             struct stat s;
             SkString str(self.fPath);
 
@@ -164,7 +169,7 @@ bool SkOSFile::Iter::next(SkString* name, bool getDir) {
                         break;
                     }
                 } else {
-                    if (!(s.st_mode & S_IFDIR) && issuffixfor(self.fSuffix, entry->d_name)) {
+                    if (!(s.st_mode & S_IFDIR)) {
                         break;
                     }
                 }
@@ -18,7 +18,7 @@
 
 struct SkOTTableGlyphData;
 
-extern uint8_t const * const SK_OT_GlyphData_NoOutline;
+extern const uint8_t SK_OT_GlyphData_NoOutline[];
 
 struct SkOTTableGlyph {
     static const SK_OT_CHAR TAG0 = 'g';
@@ -9,10 +9,21 @@
 #include "SkEndian.h"
 #include "SkSFNTHeader.h"
 #include "SkStream.h"
+#include "SkOTTable_OS_2.h"
+#include "SkOTTable_gasp.h"
+#include "SkOTTable_glyf.h"
 #include "SkOTTable_head.h"
+#include "SkOTTable_hhea.h"
+#include "SkOTTable_loca.h"
+#include "SkOTTable_maxp.h"
 #include "SkOTTable_name.h"
+#include "SkOTTable_post.h"
 #include "SkOTTableTypes.h"
 #include "SkOTUtils.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+#include "SkTSort.h"
+#include "SkTTCFHeader.h"
 
 extern const uint8_t SK_OT_GlyphData_NoOutline[] = {
     0x0,0x0, //SkOTTableGlyphData::numberOfContours
@@ -160,6 +171,718 @@ SkData* SkOTUtils::RenameFont(SkStreamAsset* fontData, const char* fontName, int
     return rewrittenFontData.release();
 }
 
+namespace {
+
+// Font data is big endian and not necessarily aligned.
+uint16_t read_be16(const uint8_t* p) {
+    return (p[0] << 8) | p[1];
+}
+
+uint32_t read_be32(const uint8_t* p) {
+    return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+void write_be16(uint8_t* p, uint16_t value) {
+    p[0] = value >> 8;
+    p[1] = value & 0xFF;
+}
+
+void write_be32(uint8_t* p, uint32_t value) {
+    write_be16(p, value >> 16);
+    write_be16(p + 2, value & 0xFFFF);
+}
+
+void write_be16(SkWStream* stream, uint16_t value) {
+    uint8_t bytes[2];
+    write_be16(bytes, value);
+    stream->write(bytes, sizeof(bytes));
+}
+
+void write_be32(SkWStream* stream, uint32_t value) {
+    uint8_t bytes[4];
+    write_be32(bytes, value);
+    stream->write(bytes, sizeof(bytes));
+}
+
+// Tags of tables which have no SkOTTable struct.
+const SK_OT_ULONG kCmapTag = SkTEndian_SwapBE32(SkSetFourByteTag('c','m','a','p'));
+const SK_OT_ULONG kCvtTag  = SkTEndian_SwapBE32(SkSetFourByteTag('c','v','t',' '));
+const SK_OT_ULONG kFpgmTag = SkTEndian_SwapBE32(SkSetFourByteTag('f','p','g','m'));
+const SK_OT_ULONG kHmtxTag = SkTEndian_SwapBE32(SkSetFourByteTag('h','m','t','x'));
+const SK_OT_ULONG kPrepTag = SkTEndian_SwapBE32(SkSetFourByteTag('p','r','e','p'));
+const SK_OT_ULONG kVheaTag = SkTEndian_SwapBE32(SkSetFourByteTag('v','h','e','a'));
+const SK_OT_ULONG kVmtxTag = SkTEndian_SwapBE32(SkSetFourByteTag('v','m','t','x'));
+
+struct SFNTTable {
+    SK_OT_ULONG     fTag;       // big endian, like the table directory
+    uint32_t        fChecksum;
+    sk_sp<SkData>   fData;      // either the whole font or a new table
+    size_t          fOffset;    // of the table in fData
+    size_t          fLength;    // without padding
+};
+
+/** A stream which reads a sequence of pieces of other data. */
+class SkSFNTPiecesStream : public SkStreamAsset {
+public:
+    struct Piece {
+        sk_sp<SkData>   fData;
+        size_t          fOffset;
+        size_t          fSize;
+    };
+
+    explicit SkSFNTPiecesStream(const SkTArray<Piece>& pieces)
+        : fPieces(pieces), fLength(0), fPosition(0)
+    {
+        for (int i = 0; i < fPieces.count(); ++i) {
+            fLength += fPieces[i].fSize;
+        }
+    }
+
+    size_t read(void* buffer, size_t size) override {
+        size = SkTMin(size, fLength - fPosition);
+        // Find the piece at fPosition.
+        size_t pieceStart = 0;
+        int i = 0;
+        while (i < fPieces.count() && pieceStart + fPieces[i].fSize <= fPosition) {
+            pieceStart += fPieces[i].fSize;
+            ++i;
+        }
+        for (size_t done = 0; done < size; ++i) {
+            const Piece& piece = fPieces[i];
+            size_t offset = fPosition + done - pieceStart;
+            size_t bytes = SkTMin(piece.fSize - offset, size - done);
+            if (buffer) {
+                memcpy(static_cast<char*>(buffer) + done,
+                       piece.fData->bytes() + piece.fOffset + offset, bytes);
+            }
+            done += bytes;
+            pieceStart += piece.fSize;
+        }
+        fPosition += size;
+        return size;
+    }
+
+    bool isAtEnd() const override { return fPosition == fLength; }
+    bool rewind() override { fPosition = 0; return true; }
+    SkSFNTPiecesStream* duplicate() const override { return new SkSFNTPiecesStream(fPieces); }
+
+    size_t getPosition() const override { return fPosition; }
+    bool seek(size_t position) override {
+        fPosition = SkTMin(position, fLength);
+        return true;
+    }
+    bool move(long offset) override {
+        return this->seek(SkTMax<long>(0, (long)fPosition + offset));
+    }
+    SkSFNTPiecesStream* fork() const override {
+        SkSFNTPiecesStream* that = this->duplicate();
+        that->fPosition = fPosition;
+        return that;
+    }
+
+    size_t getLength() const override { return fLength; }
+
+private:
+    SkTArray<Piece> fPieces;
+    size_t          fLength;
+    size_t          fPosition;
+};
+
+void delete_stream_proc(const void*, void* stream) {
+    delete static_cast<SkStreamAsset*>(stream);
+}
+
+/** Marks glyphID to keep, and queues it to look for components if it was not already kept. */
+void keep_glyph(uint16_t glyphID, int glyphCount, SkTDArray<bool>* keep,
+                SkTDArray<uint16_t>* pending) {
+    if (glyphID < glyphCount && !(*keep)[glyphID]) {
+        (*keep)[glyphID] = true;
+        *pending->append() = glyphID;
+    }
+}
+
+/** Appends the (code point, glyph ID) pairs of a format 4 or 12 'cmap' subtable. */
+bool read_cmap_subtable(const uint8_t* subtable, size_t size, int glyphCount,
+                        SkTDArray<SkUnichar>* codes, SkTDArray<uint16_t>* glyphs) {
+    if (size < 2) {
+        return false;
+    }
+    uint16_t format = read_be16(subtable);
+    if (4 == format) {
+        if (size < 14) {
+            return false;
+        }
+        int segCount = read_be16(subtable + 6) / 2;
+        const uint8_t* endCodes = subtable + 14;
+        const uint8_t* startCodes = endCodes + 2 * segCount + 2;
+        const uint8_t* idDeltas = startCodes + 2 * segCount;
+        const uint8_t* idRangeOffsets = idDeltas + 2 * segCount;
+        if (idRangeOffsets + 2 * segCount > subtable + size) {
+            return false;
+        }
+        for (int i = 0; i < segCount; ++i) {
+            uint16_t start = read_be16(startCodes + 2 * i);
+            uint16_t end = read_be16(endCodes + 2 * i);
+            uint16_t idDelta = read_be16(idDeltas + 2 * i);
+            uint16_t idRangeOffset = read_be16(idRangeOffsets + 2 * i);
+            for (uint32_t code = start; code <= end && code != 0xFFFF; ++code) {
+                uint16_t glyph;
+                if (0 == idRangeOffset) {
+                    glyph = code + idDelta;
+                } else {
+                    const uint8_t* glyphIndex =
+                            idRangeOffsets + 2 * i + idRangeOffset + 2 * (code - start);
+                    if (glyphIndex + 2 > subtable + size) {
+                        return false;
+                    }
+                    glyph = read_be16(glyphIndex);
+                    if (glyph) {
+                        glyph += idDelta;
+                    }
+                }
+                if (glyph && glyph < glyphCount) {
+                    *codes->append() = code;
+                    *glyphs->append() = glyph;
+                }
+            }
+        }
+        return true;
+    }
+    if (12 == format) {
+        if (size < 16) {
+            return false;
+        }
+        uint32_t groupCount = read_be32(subtable + 12);
+        if (groupCount > (size - 16) / 12) {
+            return false;
+        }
+        for (uint32_t i = 0; i < groupCount; ++i) {
+            const uint8_t* group = subtable + 16 + 12 * i;
+            uint32_t start = read_be32(group);
+            uint32_t end = SkTMin<uint32_t>(read_be32(group + 4), 0x10FFFF);
+            uint32_t startGlyph = read_be32(group + 8);
+            for (uint32_t code = start; code <= end; ++code) {
+                uint32_t glyph = startGlyph + (code - start);
+                if (glyph >= SkToU32(glyphCount)) {
+                    break;
+                }
+                if (glyph) {
+                    *codes->append() = code;
+                    *glyphs->append() = SkToU16(glyph);
+                }
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Makes a 'cmap' table mapping to the kept glyphs. It has a format 4 subtable for code points
+ *  in the Basic Multilingual Plane, and a format 12 subtable for all of the code points if
+ *  there are others, or too many to fit in format 4. Returns nullptr if the font has no Unicode
+ *  or symbol subtable that we can read.
+ */
+sk_sp<SkData> subset_cmap(const uint8_t* cmap, size_t size, int glyphCount,
+                          const SkTDArray<bool>& keep) {
+    if (size < 4) {
+        return nullptr;
+    }
+    // Prefer full Unicode subtables, then BMP Unicode subtables, then symbol subtables.
+    const uint8_t* best = nullptr;
+    size_t bestSize = 0;
+    int bestRank = 0;
+    bool symbol = false;
+    int subtableCount = read_be16(cmap + 2);
+    for (int i = 0; i < subtableCount && 4 + 8 * SkToSizeT(i + 1) <= size; ++i) {
+        const uint8_t* record = cmap + 4 + 8 * i;
+        uint16_t platformID = read_be16(record);
+        uint16_t encodingID = read_be16(record + 2);
+        uint32_t offset = read_be32(record + 4);
+        if (offset + 2 > size) {
+            continue;
+        }
+        uint16_t format = read_be16(cmap + offset);
+        int rank = 0;
+        if (12 == format && (0 == platformID || (3 == platformID && 10 == encodingID))) {
+            rank = 3;
+        } else if (4 == format && (0 == platformID || (3 == platformID && 1 == encodingID))) {
+            rank = 2;
+        } else if (4 == format && 3 == platformID && 0 == encodingID) {
+            rank = 1;
+        }
+        if (rank > bestRank) {
+            best = cmap + offset;
+            bestSize = size - offset;
+            bestRank = rank;
+            symbol = (1 == rank);
+        }
+    }
+    SkTDArray<SkUnichar> allCodes;
+    SkTDArray<uint16_t> allGlyphs;
+    if (!best || !read_cmap_subtable(best, bestSize, glyphCount, &allCodes, &allGlyphs)) {
+        return nullptr;
+    }
+
+    struct Mapping {
+        SkUnichar   fCode;
+        uint16_t    fGlyph;
+    };
+    SkTDArray<Mapping> mappings;
+    for (int i = 0; i < allCodes.count(); ++i) {
+        if (keep[allGlyphs[i]]) {
+            *mappings.append() = { allCodes[i], allGlyphs[i] };
+        }
+    }
+    if (mappings.count() > 1) {
+        SkTQSort(mappings.begin(), mappings.end() - 1, [](const Mapping& a, const Mapping& b) {
+            return a.fCode < b.fCode;
+        });
+    }
+
+    // Format 4 segments map runs of consecutive code points with a constant idDelta.
+    SkTDArray<Mapping> segmentStarts;
+    SkTDArray<SkUnichar> segmentEnds;
+    bool needsFormat12 = false;
+    for (int i = 0; i < mappings.count(); ++i) {
+        const Mapping& mapping = mappings[i];
+        if (mapping.fCode >= 0xFFFF) {
+            needsFormat12 |= mapping.fCode > 0xFFFF;
+            continue;
+        }
+        if (segmentEnds.count() && segmentEnds.top() + 1 == mapping.fCode &&
+            mapping.fCode - segmentStarts.top().fCode ==
+                mapping.fGlyph - segmentStarts.top().fGlyph) {
+            segmentEnds.top() = mapping.fCode;
+        } else {
+            *segmentStarts.append() = mapping;
+            *segmentEnds.append() = mapping.fCode;
+        }
+    }
+    // Every format 4 subtable ends with a segment for 0xFFFF.
+    int segCount = segmentStarts.count() + 1;
+    size_t format4Size = 16 + 8 * segCount;
+    bool hasFormat4 = format4Size <= 0xFFFF;
+    needsFormat12 |= !hasFormat4;
+
+    // Format 12 groups map runs of consecutive code points to consecutive glyphs.
+    SkTDArray<Mapping> groupStarts;
+    SkTDArray<SkUnichar> groupEnds;
+    if (needsFormat12) {
+        for (int i = 0; i < mappings.count(); ++i) {
+            const Mapping& mapping = mappings[i];
+            if (groupEnds.count() && groupEnds.top() + 1 == mapping.fCode &&
+                mapping.fCode - groupStarts.top().fCode ==
+                    mapping.fGlyph - groupStarts.top().fGlyph) {
+                groupEnds.top() = mapping.fCode;
+            } else {
+                *groupStarts.append() = mapping;
+                *groupEnds.append() = mapping.fCode;
+            }
+        }
+    }
+
+    int subtables = hasFormat4 + needsFormat12;
+    SkDynamicMemoryWStream table;
+    write_be16(&table, 0);  // version
+    write_be16(&table, subtables);
+    uint32_t offset = 4 + 8 * subtables;
+    if (hasFormat4) {
+        write_be16(&table, 3);  // Windows
+        write_be16(&table, symbol ? 0 : 1);
+        write_be32(&table, offset);
+        offset += SkToU32(format4Size);
+    }
+    if (needsFormat12) {
+        write_be16(&table, 3);  // Windows
+        write_be16(&table, 10);  // Unicode full repertoire
+        write_be32(&table, offset);
+    }
+    if (hasFormat4) {
+        int entrySelector = 0;
+        while ((2 << entrySelector) <= segCount) {
+            ++entrySelector;
+        }
+        int searchRange = 2 << entrySelector;
+        write_be16(&table, 4);
+        write_be16(&table, SkToU16(format4Size));
+        write_be16(&table, 0);  // language
+        write_be16(&table, SkToU16(2 * segCount));
+        write_be16(&table, SkToU16(searchRange));
+        write_be16(&table, SkToU16(entrySelector));
+        write_be16(&table, SkToU16(2 * segCount - searchRange));
+        for (int i = 0; i < segmentEnds.count(); ++i) {
+            write_be16(&table, SkToU16(segmentEnds[i]));
+        }
+        write_be16(&table, 0xFFFF);
+        write_be16(&table, 0);  // reservedPad
+        for (int i = 0; i < segmentStarts.count(); ++i) {
+            write_be16(&table, SkToU16(segmentStarts[i].fCode));
+        }
+        write_be16(&table, 0xFFFF);
+        for (int i = 0; i < segmentStarts.count(); ++i) {
+            write_be16(&table, (segmentStarts[i].fGlyph - segmentStarts[i].fCode) & 0xFFFF);
+        }
+        write_be16(&table, 1);
+        for (int i = 0; i < segCount; ++i) {
+            write_be16(&table, 0);  // idRangeOffset
+        }
+    }
+    if (needsFormat12) {
+        write_be16(&table, 12);
+        write_be16(&table, 0);  // reserved
+        write_be32(&table, SkToU32(16 + 12 * groupStarts.count()));
+        write_be32(&table, 0);  // language
+        write_be32(&table, groupStarts.count());
+        for (int i = 0; i < groupStarts.count(); ++i) {
+            write_be32(&table, groupStarts[i].fCode);
+            write_be32(&table, groupEnds[i]);
+            write_be32(&table, groupStarts[i].fGlyph);
+        }
+    }
+    return sk_sp<SkData>(table.copyToData());
+}
+
+/** Returns new data for a table, with room for padding to a multiple of four bytes. */
+sk_sp<SkData> make_table_data(size_t length) {
+    size_t paddedLength = SkAlign4(length);
+    sk_sp<SkData> data(SkData::MakeUninitialized(paddedLength));
+    sk_bzero(data->writable_data(), paddedLength);
+    return data;
+}
+
+void add_table(SkTArray<SFNTTable>* tables, SK_OT_ULONG tag, sk_sp<SkData> data,
+               size_t length) {
+    SFNTTable& table = tables->push_back();
+    table.fTag = tag;
+    table.fChecksum = SkOTUtils::CalcTableChecksum((SK_OT_ULONG*)data->data(), length);
+    table.fData = std::move(data);
+    table.fOffset = 0;
+    table.fLength = length;
+}
+
+}  // namespace
+
+SkStreamAsset* SkOTUtils::SubsetFont(SkStreamAsset* fontData, int ttcIndex,
+                                     const uint32_t* glyphIDs, int glyphCount) {
+    if (!fontData) {
+        return nullptr;
+    }
+    // Use the font data where it is, if it is in memory.
+    sk_sp<SkData> font;
+    if (const void* memoryBase = fontData->getMemoryBase()) {
+        font = SkData::MakeWithProc(memoryBase, fontData->getLength(),
+                                    delete_stream_proc, fontData);
+    } else {
+        std::unique_ptr<SkStreamAsset> stream(fontData);
+        font = SkData::MakeFromStream(stream.get(), stream->getLength());
+        if (!font) {
+            return nullptr;
+        }
+    }
+    const uint8_t* base = font->bytes();
+    const size_t size = font->size();
+
+    // Find the table directory.
+    size_t headerOffset = 0;
+    const size_t ttcOffsetsStart = offsetof(SkTTCFHeader, numOffsets) + sizeof(SK_OT_ULONG);
+    if (size >= ttcOffsetsStart && SkTTCFHeader::TAG == *(const SK_OT_ULONG*)base) {
+        uint32_t fontCount = read_be32(base + offsetof(SkTTCFHeader, numOffsets));
+        if (ttcIndex < 0 || SkToU32(ttcIndex) >= fontCount ||
+            ttcOffsetsStart + 4 * (ttcIndex + 1) > size) {
+            return nullptr;
+        }
+        headerOffset = read_be32(base + ttcOffsetsStart + 4 * ttcIndex);
+    }
+    if (headerOffset > size || size - headerOffset < sizeof(SkSFNTHeader)) {
+        return nullptr;
+    }
+    const SkSFNTHeader* header = reinterpret_cast<const SkSFNTHeader*>(base + headerOffset);
+    int numTables = SkEndian_SwapBE16(header->numTables);
+    if ((size - headerOffset - sizeof(SkSFNTHeader)) / sizeof(SkSFNTHeader::TableDirectoryEntry)
+            < SkToSizeT(numTables)) {
+        return nullptr;
+    }
+
+    // Sort out the tables we keep, change, and drop.
+    SkTArray<SFNTTable> tables;
+    const uint8_t* glyf = nullptr;  size_t glyfLength = 0;
+    const uint8_t* loca = nullptr;  size_t locaLength = 0;
+    const uint8_t* head = nullptr;  size_t headLength = 0;
+    const uint8_t* maxp = nullptr;  size_t maxpLength = 0;
+    const uint8_t* hhea = nullptr;  size_t hheaLength = 0;
+    const uint8_t* hmtx = nullptr;  size_t hmtxLength = 0;
+    const uint8_t* cmap = nullptr;  size_t cmapLength = 0;
+    const uint8_t* post = nullptr;  size_t postLength = 0;
+    const SkSFNTHeader::TableDirectoryEntry* entries =
+            reinterpret_cast<const SkSFNTHeader::TableDirectoryEntry*>(header + 1);
+    for (int i = 0; i < numTables; ++i) {
+        SK_OT_ULONG tag = entries[i].tag;
+        size_t offset = SkEndian_SwapBE32(entries[i].offset);
+        size_t length = SkEndian_SwapBE32(entries[i].logicalLength);
+        if (offset > size || length > size - offset) {
+            return nullptr;
+        }
+        const uint8_t* data = base + offset;
+        if (SkOTTableGlyph::TAG == tag) {
+            glyf = data; glyfLength = length;
+        } else if (SkOTTableIndexToLocation::TAG == tag) {
+            loca = data; locaLength = length;
+        } else if (SkOTTableHead::TAG == tag) {
+            head = data; headLength = length;
+        } else if (SkOTTableHorizontalHeader::TAG == tag) {
+            hhea = data; hheaLength = length;
+        } else if (kHmtxTag == tag) {
+            hmtx = data; hmtxLength = length;
+        } else if (kCmapTag == tag) {
+            cmap = data; cmapLength = length;
+        } else if (SkOTTablePostScript::TAG == tag) {
+            post = data; postLength = length;
+        } else if (SkOTTableMaximumProfile::TAG == tag || SkOTTableOS2::TAG == tag ||
+                   SkOTTableName::TAG == tag || SkOTTableGridAndScanProcedure::TAG == tag ||
+                   kCvtTag == tag || kFpgmTag == tag || kPrepTag == tag ||
+                   kVheaTag == tag || kVmtxTag == tag) {
+            if (SkOTTableMaximumProfile::TAG == tag) {
+                maxp = data; maxpLength = length;
+            }
+            SFNTTable& table = tables.push_back();
+            table.fTag = tag;
+            table.fChecksum = SkEndian_SwapBE32(entries[i].checksum);
+            table.fData = font;
+            table.fOffset = offset;
+            table.fLength = length;
+        }
+    }
+    if (!glyf || !loca || headLength < sizeof(SkOTTableHead) || maxpLength < 6) {
+        return nullptr;
+    }
+
+    const int numGlyphs = read_be16(maxp + 4);
+    const bool longLoca = SkOTTableHead::IndexToLocFormat::ShortOffsets !=
+            reinterpret_cast<const SkOTTableHead*>(head)->indexToLocFormat.value;
+    if (locaLength < SkToSizeT(numGlyphs + 1) * (longLoca ? 4 : 2)) {
+        return nullptr;
+    }
+    auto glyphData = [&](int glyph, size_t* length) -> const uint8_t* {
+        size_t start = longLoca ? read_be32(loca + 4 * glyph) : 2 * read_be16(loca + 2 * glyph);
+        size_t end = longLoca ? read_be32(loca + 4 * glyph + 4)
+                              : 2 * read_be16(loca + 2 * glyph + 2);
+        if (end < start || end > glyfLength) {
+            *length = 0;
+            return nullptr;
+        }
+        *length = end - start;
+        return glyf + start;
+    };
+
+    // Keep the requested glyphs, glyph 0 (.notdef), and the components of composite glyphs.
+    SkTDArray<bool> keep;
+    keep.setCount(numGlyphs);
+    sk_bzero(keep.begin(), keep.count() * sizeof(bool));
+    SkTDArray<uint16_t> pending;
+    keep_glyph(0, numGlyphs, &keep, &pending);
+    for (int i = 0; i < glyphCount; ++i) {
+        if (glyphIDs[i] <= SK_MaxU16) {
+            keep_glyph(SkToU16(glyphIDs[i]), numGlyphs, &keep, &pending);
+        }
+    }
+    typedef SkOTTableGlyphData::Composite::Component::Flags::Raw ComponentFlags;
+    while (pending.count()) {
+        uint16_t glyph = pending.top();
+        pending.pop();
+        size_t length;
+        const uint8_t* data = glyphData(glyph, &length);
+        // Composite glyphs have a negative number of contours.
+        if (length < sizeof(SkOTTableGlyphData) || (int16_t)SkEndian_SwapBE16(
+                reinterpret_cast<const SkOTTableGlyphData*>(data)->numberOfContours) >= 0) {
+            continue;
+        }
+        const uint8_t* component = data + sizeof(SkOTTableGlyphData);
+        const uint8_t* end = data + length;
+        while (component + 4 <= end) {
+            SK_OT_USHORT flags;
+            memcpy(&flags, component, sizeof(flags));
+            keep_glyph(read_be16(component + 2), numGlyphs, &keep, &pending);
+            component += 4;
+            component += (flags & ComponentFlags::ARG_1_AND_2_ARE_WORDS_Mask) ? 4 : 2;
+            if (flags & ComponentFlags::WE_HAVE_A_SCALE_Mask) {
+                component += 2;
+            } else if (flags & ComponentFlags::WE_HAVE_AN_X_AND_Y_SCALE_Mask) {
+                component += 4;
+            } else if (flags & ComponentFlags::WE_HAVE_A_TWO_BY_TWO_Mask) {
+                component += 8;
+            }
+            if (!(flags & ComponentFlags::MORE_COMPONENTS_Mask)) {
+                break;
+            }
+        }
+    }
+
+    // 'glyf' and 'loca': the kept glyphs, each padded to four bytes, so that short offsets work.
+    size_t newGlyfLength = 0;
+    int lastKeptGlyph = 0;
+    for (int glyph = 0; glyph < numGlyphs; ++glyph) {
+        if (keep[glyph]) {
+            size_t length;
+            glyphData(glyph, &length);
+            newGlyfLength += SkAlign4(length);
+            lastKeptGlyph = glyph;
+        }
+    }
+    const bool newLongLoca = newGlyfLength / 2 > SK_MaxU16;
+    sk_sp<SkData> newGlyf(make_table_data(newGlyfLength));
+    const size_t newLocaLength = (numGlyphs + 1) * (newLongLoca ? 4 : 2);
+    sk_sp<SkData> newLoca(make_table_data(newLocaLength));
+    {
+        uint8_t* glyfDst = static_cast<uint8_t*>(newGlyf->writable_data());
+        uint8_t* locaDst = static_cast<uint8_t*>(newLoca->writable_data());
+        size_t offset = 0;
+        for (int glyph = 0; glyph <= numGlyphs; ++glyph) {
+            if (newLongLoca) {
+                write_be32(locaDst + 4 * glyph, SkToU32(offset));
+            } else {
+                write_be16(locaDst + 2 * glyph, SkToU16(offset / 2));
+            }
+            if (glyph < numGlyphs && keep[glyph]) {
+                size_t length;
+                const uint8_t* data = glyphData(glyph, &length);
+                memcpy(glyfDst + offset, data, length);
+                offset += SkAlign4(length);
+            }
+        }
+    }
+    add_table(&tables, SkOTTableGlyph::TAG, std::move(newGlyf), newGlyfLength);
+    add_table(&tables, SkOTTableIndexToLocation::TAG, std::move(newLoca), newLocaLength);
+
+    // 'hhea' and 'hmtx': metrics only for the kept glyphs, and no more long metrics than needed.
+    const size_t numberOfHMetricsOffset = offsetof(SkOTTableHorizontalHeader, numberOfHMetrics);
+    if (hhea && hheaLength >= sizeof(SkOTTableHorizontalHeader) && hmtx) {
+        int numberOfHMetrics = read_be16(hhea + numberOfHMetricsOffset);
+        if (numberOfHMetrics > 0 && numberOfHMetrics <= numGlyphs &&
+            hmtxLength >= 4 * SkToSizeT(numberOfHMetrics)) {
+            // The last long metric also gives the advance of all of the glyphs after it.
+            int newNumberOfHMetrics = SkTMin(numberOfHMetrics, lastKeptGlyph + 1);
+            size_t newHmtxLength = 4 * newNumberOfHMetrics + 2 * (numGlyphs - newNumberOfHMetrics);
+            sk_sp<SkData> newHmtx(make_table_data(newHmtxLength));
+            uint8_t* dst = static_cast<uint8_t*>(newHmtx->writable_data());
+            for (int glyph = 0; glyph < numGlyphs; ++glyph) {
+                if (!keep[glyph] && glyph != newNumberOfHMetrics - 1) {
+                    continue;
+                }
+                if (glyph < newNumberOfHMetrics) {
+                    memcpy(dst + 4 * glyph, hmtx + 4 * glyph, 4);
+                    continue;
+                }
+                size_t lsbOffset = glyph < numberOfHMetrics
+                                 ? 4 * glyph + 2
+                                 : 4 * numberOfHMetrics + 2 * (glyph - numberOfHMetrics);
+                if (lsbOffset + 2 <= hmtxLength) {
+                    memcpy(dst + 4 * newNumberOfHMetrics + 2 * (glyph - newNumberOfHMetrics),
+                           hmtx + lsbOffset, 2);
+                }
+            }
+            add_table(&tables, kHmtxTag, std::move(newHmtx), newHmtxLength);
+
+            sk_sp<SkData> newHhea(make_table_data(hheaLength));
+            memcpy(newHhea->writable_data(), hhea, hheaLength);
+            write_be16(static_cast<uint8_t*>(newHhea->writable_data()) + numberOfHMetricsOffset,
+                       newNumberOfHMetrics);
+            add_table(&tables, SkOTTableHorizontalHeader::TAG, std::move(newHhea), hheaLength);
+            hhea = hmtx = nullptr;
+        }
+    }
+    if (hhea) {
+        sk_sp<SkData> newHhea(make_table_data(hheaLength));
+        memcpy(newHhea->writable_data(), hhea, hheaLength);
+        add_table(&tables, SkOTTableHorizontalHeader::TAG, std::move(newHhea), hheaLength);
+    }
+    if (hmtx) {
+        sk_sp<SkData> newHmtx(make_table_data(hmtxLength));
+        memcpy(newHmtx->writable_data(), hmtx, hmtxLength);
+        add_table(&tables, kHmtxTag, std::move(newHmtx), hmtxLength);
+    }
+
+    if (cmap) {
+        sk_sp<SkData> newCmap(subset_cmap(cmap, cmapLength, numGlyphs, keep));
+        if (newCmap) {
+            size_t newCmapLength = newCmap->size();
+            sk_sp<SkData> paddedCmap(make_table_data(newCmapLength));
+            memcpy(paddedCmap->writable_data(), newCmap->data(), newCmapLength);
+            add_table(&tables, kCmapTag, std::move(paddedCmap), newCmapLength);
+        }
+    }
+
+    // 'post': version 3 has no glyph names.
+    if (post && postLength >= sizeof(SkOTTablePostScript)) {
+        sk_sp<SkData> newPost(make_table_data(sizeof(SkOTTablePostScript)));
+        SkOTTablePostScript* postTable =
+                static_cast<SkOTTablePostScript*>(newPost->writable_data());
+        memcpy(postTable, post, sizeof(SkOTTablePostScript));
+        postTable->format.value = SkOTTablePostScript::Format::version3;
+        add_table(&tables, SkOTTablePostScript::TAG, std::move(newPost),
+                  sizeof(SkOTTablePostScript));
+    }
+
+    // 'head': the new 'loca' format, and the checksum adjustment, which is set last.
+    sk_sp<SkData> newHead(make_table_data(headLength));
+    SkOTTableHead* headTable = static_cast<SkOTTableHead*>(newHead->writable_data());
+    memcpy(headTable, head, headLength);
+    headTable->checksumAdjustment = 0;
+    headTable->indexToLocFormat.value = newLongLoca
+                                      ? SkOTTableHead::IndexToLocFormat::LongOffsets
+                                      : SkOTTableHead::IndexToLocFormat::ShortOffsets;
+    add_table(&tables, SkOTTableHead::TAG, newHead, headLength);
+
+    // The table directory must be sorted by tag.
+    SkTQSort(tables.begin(), tables.end() - 1, [](const SFNTTable& a, const SFNTTable& b) {
+        return SkEndian_SwapBE32(a.fTag) < SkEndian_SwapBE32(b.fTag);
+    });
+
+    const size_t directoryLength = sizeof(SkSFNTHeader) +
+                                   tables.count() * sizeof(SkSFNTHeader::TableDirectoryEntry);
+    sk_sp<SkData> directory(make_table_data(directoryLength));
+    SkSFNTHeader* newHeader = static_cast<SkSFNTHeader*>(directory->writable_data());
+    int entrySelector = 0;
+    while ((2 << entrySelector) <= tables.count()) {
+        ++entrySelector;
+    }
+    newHeader->fontType = header->fontType;
+    newHeader->numTables = SkEndian_SwapBE16(SkToU16(tables.count()));
+    newHeader->searchRange = SkEndian_SwapBE16(SkToU16(16 << entrySelector));
+    newHeader->entrySelector = SkEndian_SwapBE16(SkToU16(entrySelector));
+    newHeader->rangeShift = SkEndian_SwapBE16(SkToU16(16 * tables.count() - (16 << entrySelector)));
+
+    static const uint8_t kPadding[4] = { 0, 0, 0, 0 };
+    sk_sp<SkData> padding(SkData::MakeWithoutCopy(kPadding, sizeof(kPadding)));
+    SkTArray<SkSFNTPiecesStream::Piece> pieces;
+    pieces.push_back({ directory, 0, directoryLength });
+    SkSFNTHeader::TableDirectoryEntry* newEntries =
+            reinterpret_cast<SkSFNTHeader::TableDirectoryEntry*>(newHeader + 1);
+    uint32_t fontChecksum = 0;
+    size_t offset = directoryLength;
+    for (int i = 0; i < tables.count(); ++i) {
+        const SFNTTable& table = tables[i];
+        newEntries[i].tag = table.fTag;
+        newEntries[i].checksum = SkEndian_SwapBE32(table.fChecksum);
+        newEntries[i].offset = SkEndian_SwapBE32(SkToU32(offset));
+        newEntries[i].logicalLength = SkEndian_SwapBE32(SkToU32(table.fLength));
+        fontChecksum += table.fChecksum;
+
+        size_t paddedLength = SkAlign4(table.fLength);
+        if (table.fData == font) {
+            pieces.push_back({ table.fData, table.fOffset, table.fLength });
+            pieces.push_back({ padding, 0, paddedLength - table.fLength });
+        } else {
+            pieces.push_back({ table.fData, table.fOffset, paddedLength });
+        }
+        offset += paddedLength;
+    }
+    fontChecksum += SkOTUtils::CalcTableChecksum((SK_OT_ULONG*)newHeader, directoryLength);
+    headTable->checksumAdjustment = SkEndian_SwapBE32(SkOTTableHead::fontChecksum - fontChecksum);
+
+    return new SkSFNTPiecesStream(pieces);
+}
+
 
 SkOTUtils::LocalizedStrings_NameTable*
 SkOTUtils::LocalizedStrings_NameTable::CreateForFamilyNames(const SkTypeface& typeface) {
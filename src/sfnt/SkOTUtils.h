@@ -38,6 +38,26 @@ struct SkOTUtils {
       */
     static SkData* RenameFont(SkStreamAsset* fontData, const char* fontName, int fontNameLen);
 
+    /**
+      *  Subsets a TrueType ('glyf') font. On failure (invalid data or not a TrueType font)
+      *  returns nullptr.
+      *
+      *  The new font keeps the outlines of glyphIDs, of glyph 0 and of the components of any
+      *  composite glyphs among them. All other glyphs are left empty, but keep their IDs, so
+      *  text can use the same glyph IDs with either font. The 'cmap' and 'hmtx' tables keep
+      *  only entries for the glyphs kept, 'post' drops its glyph names, and tables which only
+      *  matter for layout or for other glyph formats are removed.
+      *
+      *  Tables which are not changed are not copied. The returned stream reads them from
+      *  fontData, which it keeps until it and all of its duplicates are deleted.
+      *
+      *  ttcIndex selects the font if fontData is a TrueType collection.
+      *
+      *  Takes ownership of fontData.
+      */
+    static SkStreamAsset* SubsetFont(SkStreamAsset* fontData, int ttcIndex,
+                                     const uint32_t* glyphIDs, int glyphCount);
+
     /** An implementation of LocalizedStrings which obtains it's data from a 'name' table. */
     class LocalizedStrings_NameTable : public SkTypeface::LocalizedStrings {
     public:
@@ -122,6 +122,15 @@ protected:
         const SkScalar pos[], int scalarsPerPos,
         const SkPoint& offset, const SkPaint& paint) override;
 
+    // Draws the runs of blobs with drawText and drawPosText, rather than as SkBitmapDevice does.
+    void drawTextBlob(
+        const SkDraw& d,
+        const SkTextBlob* blob,
+        SkScalar x, SkScalar y,
+        const SkPaint& paint, SkDrawFilter* drawFilter) override {
+        this->SkBaseDevice::drawTextBlob(d, blob, x, y, paint, drawFilter);
+    }
+
     virtual void drawVertices(
         const SkDraw&,
         SkCanvas::VertexMode,
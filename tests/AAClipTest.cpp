@@ -6,11 +6,14 @@
  */
 
 #include "SkAAClip.h"
+#include "SkAAClipCache.h"
 #include "SkCanvas.h"
+#include "SkClipStack.h"
 #include "SkMask.h"
 #include "SkPath.h"
 #include "SkRandom.h"
 #include "SkRasterClip.h"
+#include "SkResourceCache.h"
 #include "SkRRect.h"
 #include "Test.h"
 
@@ -420,3 +423,106 @@ DEF_TEST(AAClip, reporter) {
     test_really_a_rect(reporter);
     test_crbug_422693(reporter);
 }
+
+static void make_clip_stack(SkClipStack* stack, const SkPath& path, bool doAA) {
+    stack->clipDevRect(SkRect::MakeXYWH(5, 5, 200, 100), SkRegion::kIntersect_Op, false);
+    stack->save();
+    stack->clipDevPath(path, SkRegion::kIntersect_Op, doAA);
+}
+
+DEF_TEST(AAClipCache, reporter) {
+    SkResourceCache cache(1024 * 1024);
+
+    // Bounds that no other test uses, so that nothing else has touched these keys.
+    const SkIRect bounds = SkIRect::MakeWH(1237, 631);
+    SkRegion clipRgn(bounds);
+
+    SkPath path;
+    path.addCircle(50, 50, 30);
+    SkAAClip expected;
+    expected.setPath(path, &clipRgn, true);
+
+    // Clip stacks with the same elements match, even though their genIDs differ.
+    SkClipStack stack, sameStack;
+    make_clip_stack(&stack, path, true);
+    make_clip_stack(&sameStack, path, true);
+    REPORTER_ASSERT(reporter, stack.getTopmostGenID() != sameStack.getTopmostGenID());
+    const SkAAClipCache::Key key(stack, bounds, bounds, false),
+                             sameKey(sameStack, bounds, bounds, false);
+
+    // A clip is only added once its key has missed before.
+    SkAAClip clip;
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(key, &clip, &cache));
+    SkAAClipCache::Add(key, expected, &cache);
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(sameKey, &clip, &cache));
+    REPORTER_ASSERT(reporter, clip.isEmpty());
+    SkAAClipCache::Add(sameKey, expected, &cache);
+    REPORTER_ASSERT(reporter, SkAAClipCache::Find(key, &clip, &cache));
+    REPORTER_ASSERT(reporter, expected == clip);
+    clip.setEmpty();
+    REPORTER_ASSERT(reporter, SkAAClipCache::Find(sameKey, &clip, &cache));
+    REPORTER_ASSERT(reporter, expected == clip);
+
+    // Anything else in the key should miss.
+    SkAAClip other;
+    SkClipStack otherStack;
+    make_clip_stack(&otherStack, path, false);
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(SkAAClipCache::Key(otherStack, bounds, bounds,
+                                                                      false), &other, &cache));
+    SkPath otherPath;
+    otherPath.addCircle(50, 50, 31);
+    otherStack.reset();
+    make_clip_stack(&otherStack, otherPath, true);
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(SkAAClipCache::Key(otherStack, bounds, bounds,
+                                                                      false), &other, &cache));
+    const SkIRect otherBounds = SkIRect::MakeWH(1237, 632);
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(SkAAClipCache::Key(stack, otherBounds, bounds,
+                                                                      false), &other, &cache));
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(SkAAClipCache::Key(stack, bounds, otherBounds,
+                                                                      false), &other, &cache));
+    REPORTER_ASSERT(reporter, !SkAAClipCache::Find(SkAAClipCache::Key(stack, bounds, bounds, true),
+                                                   &other, &cache));
+    REPORTER_ASSERT(reporter, other.isEmpty());
+}
+
+static void draw_clipped(SkBitmap* bm, const SkPath& path, const SkRegion* region) {
+    bm->allocN32Pixels(120, 100);
+    bm->eraseColor(SK_ColorTRANSPARENT);
+    SkCanvas canvas(*bm);
+    if (region) {
+        canvas.clipRegion(*region);
+    } else {
+        canvas.clipRect(SkRect::Make(SkIRect::MakeLTRB(10, 10, 110, 90)));
+    }
+    canvas.clipPath(path, SkRegion::kIntersect_Op, true);
+    canvas.drawColor(SK_ColorBLACK);
+}
+
+// Canvases share AA clips through the global cache. They must still draw the same pixels as a
+// canvas that builds its own, and a region clip, which the clip stack only records as a rect,
+// must not pick up a clip built for that rect.
+DEF_TEST(AAClipCache_canvas, reporter) {
+    // Not just an oval, which SkCanvas would clip to as an SkRRect.
+    SkPath path;
+    path.addCircle(60, 50, 45);
+    path.addRect(SkRect::MakeLTRB(55, 0, 65, 100));
+
+    SkRegion region;
+    region.op(SkIRect::MakeLTRB(10, 10, 50, 90), SkRegion::kUnion_Op);
+    region.op(SkIRect::MakeLTRB(70, 10, 110, 90), SkRegion::kUnion_Op);
+
+    SkBitmap first, withRegion;
+    draw_clipped(&first, path, nullptr);
+    for (int i = 0; i < 3; ++i) {
+        SkBitmap again;
+        draw_clipped(&again, path, nullptr);
+        REPORTER_ASSERT(reporter, 0 == memcmp(first.getPixels(), again.getPixels(),
+                                              first.getSize()));
+    }
+    for (int i = 0; i < 3; ++i) {
+        draw_clipped(&withRegion, path, &region);
+        REPORTER_ASSERT(reporter, SK_ColorBLACK == *first.getAddr32(60, 50));
+        REPORTER_ASSERT(reporter, SK_ColorTRANSPARENT == *withRegion.getAddr32(60, 50));
+        REPORTER_ASSERT(reporter, SK_ColorBLACK == *withRegion.getAddr32(30, 50));
+    }
+}
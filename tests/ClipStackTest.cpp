@@ -794,6 +794,49 @@ static void test_quickContains(skiatest::Reporter* reporter) {
     }
 }
 
+// quickContains() answers from the stack's bounds when it can. Make sure those answers agree with
+// walking the stack, and follow changes to it.
+static void test_quickContains_bounds(skiatest::Reporter* reporter) {
+    SkRect testRect = SkRect::MakeLTRB(10, 10, 40, 40);
+    SkRect bigRect = SkRect::MakeLTRB(0, 0, 100, 100);
+
+    SkPath bigCircle;
+    bigCircle.addCircle(25, 25, 50);
+    SkPath smallCircle;
+    smallCircle.addCircle(25, 25, 5);
+
+    SkClipStack stack;
+    stack.clipDevRect(bigRect, SkRegion::kIntersect_Op, false);
+    stack.clipDevPath(bigCircle, SkRegion::kIntersect_Op, false);
+    REPORTER_ASSERT(reporter, stack.quickContains(testRect));
+    REPORTER_ASSERT(reporter, stack.quickContains(testRect));
+
+    stack.save();
+    stack.clipDevPath(smallCircle, SkRegion::kIntersect_Op, false);
+    REPORTER_ASSERT(reporter, !stack.quickContains(testRect));
+    REPORTER_ASSERT(reporter, !stack.quickContains(testRect));
+
+    // A copy shares the genIDs and must give the same answers.
+    SkClipStack copy(stack);
+    REPORTER_ASSERT(reporter, !copy.quickContains(testRect));
+
+    stack.restore();
+    REPORTER_ASSERT(reporter, stack.quickContains(testRect));
+
+    // Rects outside the stack's bounds are rejected without walking the stack.
+    REPORTER_ASSERT(reporter, !stack.quickContains(SkRect::MakeLTRB(90, 90, 110, 110)));
+
+    // An intersection of rects is answered by its bounds alone.
+    SkClipStack rects;
+    rects.clipDevRect(bigRect, SkRegion::kIntersect_Op, false);
+    rects.clipDevRect(SkRect::MakeLTRB(5, 5, 50, 50), SkRegion::kIntersect_Op, false);
+    REPORTER_ASSERT(reporter, rects.quickContains(testRect));
+    REPORTER_ASSERT(reporter, !rects.quickContains(SkRect::MakeLTRB(0, 0, 40, 40)));
+
+    stack.clipEmpty();
+    REPORTER_ASSERT(reporter, !stack.quickContains(testRect));
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 #if SK_SUPPORT_GPU
@@ -1213,6 +1256,7 @@ DEF_TEST(ClipStack, reporter) {
     test_rect_inverse_fill(reporter);
     test_path_replace(reporter);
     test_quickContains(reporter);
+    test_quickContains_bounds(reporter);
 #if SK_SUPPORT_GPU
     test_reduced_clip_stack(reporter);
     test_reduced_clip_stack_genid(reporter);
@@ -0,0 +1,278 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkBitmap.h"
+#include "SkCodec.h"
+#include "SkColorPriv.h"
+#include "SkData.h"
+#include "SkStream.h"
+#include "SkTDArray.h"
+#include "Test.h"
+
+static SkCodec* anim_codec(const char path[]) {
+    SkString fullPath(GetResourcePath(path));
+    auto data = SkData::MakeFromFileName(fullPath.c_str());
+    if (!data) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return nullptr;
+    }
+    return SkCodec::NewFromData(data.get());
+}
+
+static bool decode_frame(skiatest::Reporter* r, SkCodec* codec, int index, SkBitmap* bm,
+                         bool hasPriorFrame = false) {
+    if (!hasPriorFrame) {
+        bm->allocPixels(codec->getInfo().makeColorType(kN32_SkColorType)
+                                        .makeAlphaType(kPremul_SkAlphaType));
+    }
+    SkCodec::Options opts;
+    opts.fFrameIndex = index;
+    opts.fHasPriorFrame = hasPriorFrame;
+    const SkCodec::Result result = codec->getPixels(bm->info(), bm->getPixels(), bm->rowBytes(),
+                                                    &opts, nullptr, nullptr);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+    return SkCodec::kSuccess == result;
+}
+
+// animated.gif is an 8x8 canvas with six frames:
+//   0: (0, 0, 8, 8) red,                            kept
+//   1: (2, 2, 4, 4) green,                          restored to background
+//   2: (0, 0, 4, 4) blue checkerboard, transparent, kept
+//   3: (4, 4, 4, 4) green,                          restored to previous
+//   4: (6, 6, 2, 2) red,                            kept
+//   5: (0, 0, 8, 8) blue,                           kept
+// Frame i lasts (i + 1) * 100 milliseconds.
+DEF_TEST(Codec_frames, r) {
+    SkAutoTDelete<SkCodec> codec(anim_codec("animated.gif"));
+    if (!codec) {
+        return;
+    }
+
+    static const struct {
+        int     fRequiredFrame;
+        SkIRect fRect;
+        SkCodec::DisposalMethod fDisposal;
+    } gExpected[] = {
+        { SkCodec::kNone, SkIRect::MakeXYWH(0, 0, 8, 8), SkCodec::kKeep_DisposalMethod },
+        { 0,              SkIRect::MakeXYWH(2, 2, 4, 4), SkCodec::kRestoreBGColor_DisposalMethod },
+        { 1,              SkIRect::MakeXYWH(0, 0, 4, 4), SkCodec::kKeep_DisposalMethod },
+        { 2,              SkIRect::MakeXYWH(4, 4, 4, 4), SkCodec::kRestorePrevious_DisposalMethod },
+        { 2,              SkIRect::MakeXYWH(6, 6, 2, 2), SkCodec::kKeep_DisposalMethod },
+        { SkCodec::kNone, SkIRect::MakeXYWH(0, 0, 8, 8), SkCodec::kKeep_DisposalMethod },
+    };
+
+    const int frameCount = codec->getFrameCount();
+    REPORTER_ASSERT(r, SK_ARRAY_COUNT(gExpected) == frameCount);
+    for (int i = 0; i < frameCount; i++) {
+        SkCodec::FrameInfo info;
+        REPORTER_ASSERT(r, codec->getFrameInfo(i, &info));
+        REPORTER_ASSERT(r, gExpected[i].fRequiredFrame == info.fRequiredFrame);
+        REPORTER_ASSERT(r, gExpected[i].fRect == info.fFrameRect);
+        REPORTER_ASSERT(r, gExpected[i].fDisposal == info.fDisposalMethod);
+        REPORTER_ASSERT(r, (i + 1) * 100 == info.fDuration);
+    }
+    SkCodec::FrameInfo info;
+    REPORTER_ASSERT(r, !codec->getFrameInfo(frameCount, &info));
+
+    // Frame 2 shows through the holes in its checkerboard to what frame 1 left behind.
+    SkBitmap bm;
+    if (decode_frame(r, codec.get(), 2, &bm)) {
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(0, 0));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(1, 0));
+        REPORTER_ASSERT(r, SK_ColorTRANSPARENT == *bm.getAddr32(2, 2));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(3, 2));
+        REPORTER_ASSERT(r, SK_ColorTRANSPARENT == *bm.getAddr32(5, 5));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(7, 7));
+    }
+
+    // Decoding frame 3 on top of frame 2 must match decoding it from scratch.
+    SkBitmap fromScratch;
+    if (decode_frame(r, codec.get(), 3, &fromScratch) &&
+            decode_frame(r, codec.get(), 3, &bm, true)) {
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorGREEN) == *fromScratch.getAddr32(4, 4));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *fromScratch.getAddr32(1, 0));
+        REPORTER_ASSERT(r, 0 == memcmp(bm.getPixels(), fromScratch.getPixels(), bm.getSize()));
+    }
+
+    // Frame 3 is discarded, so frame 4 is drawn directly on frame 2.
+    if (decode_frame(r, codec.get(), 4, &bm)) {
+        REPORTER_ASSERT(r, SK_ColorTRANSPARENT == *bm.getAddr32(4, 4));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(7, 7));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(1, 0));
+    }
+
+    if (decode_frame(r, codec.get(), 5, &bm)) {
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(2, 2));
+    }
+
+    // The first frame still decodes normally afterwards.
+    if (decode_frame(r, codec.get(), 0, &bm)) {
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(4, 4));
+    }
+
+    // Later frames are not supported by scanline decoding.
+    SkCodec::Options opts;
+    opts.fFrameIndex = 1;
+    REPORTER_ASSERT(r, SkCodec::kUnimplemented == codec->startScanlineDecode(bm.info(), &opts,
+                                                                             nullptr, nullptr));
+    opts.fFrameIndex = frameCount;
+    REPORTER_ASSERT(r, SkCodec::kInvalidParameters == codec->getPixels(bm.info(),
+            bm.getPixels(), bm.rowBytes(), &opts, nullptr, nullptr));
+}
+
+DEF_TEST(Codec_frames_still, r) {
+    for (const char* path : { "randPixels.gif", "baby_tux.webp", "mandrill_128.png" }) {
+        SkAutoTDelete<SkCodec> codec(anim_codec(path));
+        if (!codec) {
+            continue;
+        }
+        REPORTER_ASSERT(r, 1 == codec->getFrameCount());
+        SkCodec::FrameInfo info;
+        REPORTER_ASSERT(r, codec->getFrameInfo(0, &info));
+        REPORTER_ASSERT(r, SkCodec::kNone == info.fRequiredFrame);
+
+        // Counting frames must not disturb a normal decode.
+        SkBitmap bm;
+        decode_frame(r, codec.get(), 0, &bm);
+    }
+}
+
+// Writes a gif whose frames each draw one pixel of a width x height canvas, in order, so every
+// frame depends on the one before it. Frame i is color 1 + i % 3 of the palette.
+static sk_sp<SkData> make_pixel_by_pixel_gif(int width, int height) {
+    SkDynamicMemoryWStream stream;
+    stream.write("GIF89a", 6);
+    stream.write16(width);
+    stream.write16(height);
+    // A global palette of four colors: black, red, green and blue.
+    const uint8_t screen[] = { 0x81, 0, 0, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF };
+    stream.write(screen, sizeof(screen));
+    for (int i = 0; i < width * height; i++) {
+        // A graphics control extension keeping the frame, then a 1x1 image whose LZW data is
+        // a clear code, the pixel and an end code, three bits each.
+        const uint8_t control[] = { 0x21, 0xF9, 4, 1 << 2, 1, 0, 0, 0, 0x2C };
+        stream.write(control, sizeof(control));
+        stream.write16(i % width);
+        stream.write16(i / width);
+        stream.write16(1);
+        stream.write16(1);
+        const uint32_t codes = 4 | ((1 + i % 3) << 3) | (5 << 6);
+        const uint8_t image[] = { 0, 2, 2, (uint8_t) codes, (uint8_t) (codes >> 8), 0 };
+        stream.write(image, sizeof(image));
+    }
+    stream.write8(0x3B);
+    return sk_sp<SkData>(stream.copyToData());
+}
+
+// The last frame of a long animation, which depends on every frame before it, is composited
+// from all of them.
+DEF_TEST(Codec_frames_long_chain, r) {
+    const int width = 32, height = 32;
+    sk_sp<SkData> data = make_pixel_by_pixel_gif(width, height);
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(data.get()));
+    if (!codec) {
+        // Gif decoding is not supported in this build.
+        return;
+    }
+    const int frameCount = codec->getFrameCount();
+    REPORTER_ASSERT(r, width * height == frameCount);
+    SkCodec::FrameInfo info;
+    REPORTER_ASSERT(r, codec->getFrameInfo(frameCount - 1, &info));
+    REPORTER_ASSERT(r, frameCount - 2 == info.fRequiredFrame);
+
+    const SkColor colors[] = { SK_ColorRED, SK_ColorGREEN, SK_ColorBLUE };
+    SkBitmap bm;
+    if (decode_frame(r, codec.get(), frameCount - 1, &bm)) {
+        for (int i = 0; i < frameCount; i++) {
+            REPORTER_ASSERT(r, SkPreMultiplyColor(colors[i % 3]) ==
+                               *bm.getAddr32(i % width, i / width));
+        }
+    }
+}
+
+// Writes one frame of a single palette color to a gif, disposed with the given gif disposal
+// method (1 keeps it, 3 restores the previous canvas).
+static void write_gif_frame(SkWStream* stream, const SkIRect& rect, int disposal, int color) {
+    const uint8_t control[] = { 0x21, 0xF9, 4, (uint8_t) (disposal << 2), 1, 0, 0, 0, 0x2C };
+    stream->write(control, sizeof(control));
+    stream->write16(rect.left());
+    stream->write16(rect.top());
+    stream->write16(rect.width());
+    stream->write16(rect.height());
+    stream->write8(0);     // no local palette
+    stream->write8(2);     // LZW minimum code size
+
+    // Three bit codes: a clear code before every pair of pixels keeps the code size fixed,
+    // then an end code.
+    SkTDArray<uint8_t> bytes;
+    uint32_t bits = 0;
+    int bitCount = 0;
+    auto put = [&](uint32_t code) {
+        bits |= code << bitCount;
+        bitCount += 3;
+        while (bitCount >= 8) {
+            *bytes.append() = (uint8_t) bits;
+            bits >>= 8;
+            bitCount -= 8;
+        }
+    };
+    for (int i = 0; i < rect.width() * rect.height(); i++) {
+        if (0 == i % 2) {
+            put(4);
+        }
+        put(color);
+    }
+    put(5);
+    if (bitCount > 0) {
+        *bytes.append() = (uint8_t) bits;
+    }
+    SkASSERT(bytes.count() < 256);
+    stream->write8(bytes.count());
+    stream->write(bytes.begin(), bytes.count());
+    stream->write8(0);
+}
+
+// A frame that restores the previous canvas must not hide the canvas it was drawn on from
+// later frames, even if it covers the whole canvas and so does not depend on anything.
+DEF_TEST(Codec_frames_restore_previous_independent, r) {
+    SkDynamicMemoryWStream stream;
+    stream.write("GIF89a", 6);
+    stream.write16(4);
+    stream.write16(4);
+    // A global palette of four colors: black, red, green and blue.
+    const uint8_t screen[] = { 0x81, 0, 0, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF, 0, 0, 0, 0xFF };
+    stream.write(screen, sizeof(screen));
+    write_gif_frame(&stream, SkIRect::MakeWH(4, 4), 1, 1);
+    write_gif_frame(&stream, SkIRect::MakeWH(4, 4), 3, 2);
+    write_gif_frame(&stream, SkIRect::MakeXYWH(2, 2, 2, 2), 1, 3);
+    stream.write8(0x3B);
+    sk_sp<SkData> data(stream.copyToData());
+
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(data.get()));
+    if (!codec) {
+        // Gif decoding is not supported in this build.
+        return;
+    }
+    REPORTER_ASSERT(r, 3 == codec->getFrameCount());
+    SkCodec::FrameInfo info;
+    REPORTER_ASSERT(r, codec->getFrameInfo(1, &info));
+    REPORTER_ASSERT(r, SkCodec::kNone == info.fRequiredFrame);
+    REPORTER_ASSERT(r, codec->getFrameInfo(2, &info));
+    REPORTER_ASSERT(r, 0 == info.fRequiredFrame);
+
+    SkBitmap bm;
+    if (decode_frame(r, codec.get(), 1, &bm)) {
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorGREEN) == *bm.getAddr32(0, 0));
+    }
+    if (decode_frame(r, codec.get(), 2, &bm)) {
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(0, 0));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorRED) == *bm.getAddr32(1, 3));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(2, 2));
+        REPORTER_ASSERT(r, SkPreMultiplyColor(SK_ColorBLUE) == *bm.getAddr32(3, 3));
+    }
+}
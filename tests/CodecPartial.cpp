@@ -5,6 +5,7 @@
  * found in the LICENSE file.
  */
 
+#include "SkBitmap.h"
 #include "SkCodec.h"
 #include "SkData.h"
 #include "SkImageInfo.h"
@@ -52,6 +53,8 @@ public:
         fLimit = SkTMin(fTotalSize, fLimit + 1000);
     }
 
+    bool hasAllData() const { return fLimit == fTotalSize; }
+
     size_t read(void* buffer, size_t size) override {
         if (fStream.getPosition() + size > fLimit) {
             size = fLimit - fStream.getPosition();
@@ -149,3 +152,69 @@ DEF_TEST(Codec_partial, r) {
     test_partial(r, "randPixels.png");
     test_partial(r, "baby_tux.png");
 }
+
+// Decodes a JPEG incrementally as more of its data arrives.  Each call picks up where the
+// last one suspended, rather than starting over from the beginning of the stream.
+static void test_partial_jpeg(skiatest::Reporter* r, const char* name, bool progressive) {
+    sk_sp<SkData> file = make_from_resource(name);
+    if (!file) {
+        SkDebugf("missing resource %s\n", name);
+        return;
+    }
+
+    SkBitmap truth;
+    if (!create_truth(file, &truth)) {
+        ERRORF(r, "Failed to decode %s\n", name);
+        return;
+    }
+
+    HaltingStream* stream = new HaltingStream(file);
+    SkAutoTDelete<SkCodec> partialCodec(SkCodec::NewFromStream(stream));
+    if (!partialCodec) {
+        ERRORF(r, "Failed to create codec for %s", name);
+        return;
+    }
+
+    const SkImageInfo info = standardize_info(partialCodec);
+    SkBitmap incremental;
+    incremental.allocPixels(info);
+    if (SkCodec::kSuccess != partialCodec->startIncrementalDecode(info,
+            incremental.getPixels(), incremental.rowBytes())) {
+        ERRORF(r, "Failed to start incremental decode of %s\n", name);
+        return;
+    }
+
+    bool sawWholeImage = false;
+    while (true) {
+        int rowsDecoded = 0;
+        const SkCodec::Result result = partialCodec->incrementalDecode(&rowsDecoded);
+        if (SkCodec::kSuccess == result) {
+            break;
+        }
+        REPORTER_ASSERT(r, SkCodec::kIncompleteInput == result);
+        REPORTER_ASSERT(r, rowsDecoded >= 0 && rowsDecoded <= info.height());
+        if (stream->hasAllData()) {
+            ERRORF(r, "Incremental decode of %s did not finish\n", name);
+            return;
+        }
+
+        // A progressive image is drawn in full from its early scans.
+        sawWholeImage |= rowsDecoded == info.height();
+        stream->addNewData();
+    }
+    REPORTER_ASSERT(r, sawWholeImage == progressive);
+
+    for (int y = 0; y < info.height(); y++) {
+        REPORTER_ASSERT(r, !memcmp(truth.getAddr(0, y), incremental.getAddr(0, y),
+                                   info.minRowBytes()));
+    }
+}
+
+DEF_TEST(Codec_partialJpeg, r) {
+    test_partial_jpeg(r, "mandrill_512_q075.jpg", false);
+    test_partial_jpeg(r, "mandrill_h2v1.jpg", false);
+    test_partial_jpeg(r, "color_wheel.jpg", false);
+    test_partial_jpeg(r, "CMYK.jpg", false);
+    test_partial_jpeg(r, "brickwork-texture.jpg", true);
+    test_partial_jpeg(r, "brickwork_normal-map.jpg", true);
+}
@@ -17,6 +17,7 @@
 #include "SkStream.h"
 #include "SkStreamPriv.h"
 #include "SkPngChunkReader.h"
+#include "SkThreadID.h"
 #include "Test.h"
 
 #include "png.h"
@@ -488,6 +489,7 @@ DEF_TEST(Codec, r) {
     check(r, "mandrill_128.png", SkISize::Make(128, 128), false, false, true, true);
     check(r, "mandrill_16.png", SkISize::Make(16, 16), false, false, true, true);
     check(r, "mandrill_256.png", SkISize::Make(256, 256), false, false, true, true);
+    check(r, "mandrill_256_interlaced.png", SkISize::Make(256, 256), false, false, true, true);
     check(r, "mandrill_32.png", SkISize::Make(32, 32), false, false, true, true);
     check(r, "mandrill_512.png", SkISize::Make(512, 512), false, false, true, true);
     check(r, "mandrill_64.png", SkISize::Make(64, 64), false, false, true, true);
@@ -1050,7 +1052,6 @@ DEF_TEST(Codec_fallBack, r) {
     // Formats that currently do not support incremental decoding
     auto files = {
             "box.gif",
-            "CMYK.jpg",
             "color_wheel.ico",
             "mandrill.wbmp",
             "randPixels.bmp",
@@ -1085,3 +1086,403 @@ DEF_TEST(Codec_fallBack, r) {
         }
     }
 }
+
+static SkCodec* codec_from_resource(const char path[]) {
+    SkString fullPath(GetResourcePath(path));
+    auto data = SkData::MakeFromFileName(fullPath.c_str());
+    if (!data) {
+        SkDebugf("Missing resource '%s'\n", path);
+        return nullptr;
+    }
+    return SkCodec::NewFromData(data.get());
+}
+
+static bool rows_match(const SkBitmap& a, int ax, int ay, const SkBitmap& b, int by, int height) {
+    for (int y = 0; y < height; y++) {
+        if (memcmp(a.getAddr(ax, ay + y), b.getAddr(0, by + y), b.width() * b.bytesPerPixel())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Decodes rows [top, top + height) of every subset with the scanline decoder, and compares them
+// to the full decode.
+static void test_jpeg_regions(skiatest::Reporter* r, const char path[], const SkImageInfo& info) {
+    SkAutoTDelete<SkCodec> codec(codec_from_resource(path));
+    if (!codec) {
+        return;
+    }
+    SkBitmap full;
+    full.allocPixels(info);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(info, full.getPixels(),
+                                                             full.rowBytes()));
+
+    // libjpeg-turbo's horizontal crop can change the edge columns, so keep the subset's edges
+    // away from crop boundaries.
+    const int x = info.width() / 5;
+    SkIRect subset = SkIRect::MakeLTRB(x, 0, info.width(), info.height());
+    SkCodec::Options opts;
+    opts.fSubset = &subset;
+    SkBitmap region;
+    region.allocPixels(info.makeWH(subset.width(), 8));
+
+    // Skip forwards twice within one decode, and also start a decode near the bottom.
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->startScanlineDecode(info, &opts,
+                                                                       nullptr, nullptr));
+    int top = 0;
+    for (int skip : { info.height() / 3, info.height() / 4 }) {
+        REPORTER_ASSERT(r, codec->skipScanlines(skip));
+        top += skip;
+        REPORTER_ASSERT(r, 8 == codec->getScanlines(region.getPixels(), 8, region.rowBytes()));
+        REPORTER_ASSERT(r, rows_match(full, x, top, region, 0, 8));
+        top += 8;
+    }
+
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->startScanlineDecode(info, &opts,
+                                                                       nullptr, nullptr));
+    const int bottom = info.height() - 8;
+    REPORTER_ASSERT(r, codec->skipScanlines(bottom));
+    REPORTER_ASSERT(r, 8 == codec->getScanlines(region.getPixels(), 8, region.rowBytes()));
+    REPORTER_ASSERT(r, rows_match(full, x, bottom, region, 0, 8));
+}
+
+DEF_TEST(Codec_jpeg_regions, r) {
+    for (const char* path : { "mandrill_512_q075.jpg", "mandrill_512_q075_restart.jpg" }) {
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(512, 512);
+        // Full size, natively scaled, and resampled.
+        test_jpeg_regions(r, path, info);
+        test_jpeg_regions(r, path, info.makeWH(256, 256));
+        test_jpeg_regions(r, path, info.makeWH(300, 200));
+        test_jpeg_regions(r, path, info.makeWH(300, 200).makeColorType(kGray_8_SkColorType)
+                                                        .makeAlphaType(kOpaque_SkAlphaType));
+        test_jpeg_regions(r, path, info.makeWH(300, 200).makeColorType(kRGB_565_SkColorType)
+                                                        .makeAlphaType(kOpaque_SkAlphaType));
+    }
+
+    // Restart markers are only a different encoding of the same coefficients.
+    SkAutoTDelete<SkCodec> codec(codec_from_resource("mandrill_512_q075.jpg"));
+    SkAutoTDelete<SkCodec> restartCodec(codec_from_resource("mandrill_512_q075_restart.jpg"));
+    if (!codec || !restartCodec) {
+        return;
+    }
+    SkBitmap bm, restartBm;
+    bm.allocN32Pixels(512, 512);
+    restartBm.allocN32Pixels(512, 512);
+    REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getPixels(bm.info(), bm.getPixels(),
+                                                             bm.rowBytes()));
+    REPORTER_ASSERT(r, SkCodec::kSuccess == restartCodec->getPixels(
+            restartBm.info(), restartBm.getPixels(), restartBm.rowBytes()));
+    REPORTER_ASSERT(r, rows_match(bm, 0, 0, restartBm, 0, 512));
+}
+
+// Sample sizes that libjpeg-turbo cannot handle natively are resampled from the next larger
+// native scale, for both full and subset decodes.
+// Checks that each pixel of dst is the average of the box of src pixels that it covers.
+static bool matches_box_filter(const SkBitmap& src, const SkBitmap& dst) {
+    for (int y = 0; y < dst.height(); y++) {
+        const int top = y * src.height() / dst.height(),
+                  bottom = (y + 1) * src.height() / dst.height();
+        for (int x = 0; x < dst.width(); x++) {
+            const int left = x * src.width() / dst.width(),
+                      right = (x + 1) * src.width() / dst.width();
+            int sums[4] = { 0, 0, 0, 0 };
+            for (int sy = top; sy < bottom; sy++) {
+                for (int sx = left; sx < right; sx++) {
+                    const uint8_t* p = (const uint8_t*) src.getAddr32(sx, sy);
+                    for (int c = 0; c < 4; c++) {
+                        sums[c] += p[c];
+                    }
+                }
+            }
+            const int area = (bottom - top) * (right - left);
+            const uint8_t* p = (const uint8_t*) dst.getAddr32(x, y);
+            for (int c = 0; c < 4; c++) {
+                if (SkTAbs(sums[c] - p[c] * area) > area) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+DEF_TEST(Codec_jpeg_sampleSize, r) {
+    SkAutoTDelete<SkStream> stream(resource("mandrill_512_q075_restart.jpg"));
+    if (!stream) {
+        SkDebugf("Missing resource 'mandrill_512_q075_restart.jpg'\n");
+        return;
+    }
+    SkAutoTDelete<SkAndroidCodec> codec(SkAndroidCodec::NewFromStream(stream.release()));
+    REPORTER_ASSERT(r, codec);
+    if (!codec) {
+        return;
+    }
+
+    for (int sampleSize : { 3, 5, 7 }) {
+        const SkISize dims = codec->getSampledDimensions(sampleSize);
+        REPORTER_ASSERT(r, dims == SkISize::Make(512 / sampleSize, 512 / sampleSize));
+        SkBitmap full;
+        full.allocN32Pixels(dims.width(), dims.height());
+        SkAndroidCodec::AndroidOptions options;
+        options.fSampleSize = sampleSize;
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getAndroidPixels(
+                full.info(), full.getPixels(), full.rowBytes(), &options));
+
+        // libjpeg decodes at the nearest scale of M/8 that is at least 1/sampleSize, and that
+        // is box filtered down to the requested size.
+        SkAutoTDelete<SkCodec> nativeCodec(codec_from_resource("mandrill_512_q075_restart.jpg"));
+        const SkISize nativeDims = nativeCodec->getScaledDimensions(
+                ((8 + sampleSize - 1) / sampleSize) / 8.0f);
+        REPORTER_ASSERT(r, nativeDims.width() < 512 && nativeDims.width() >= dims.width());
+        SkBitmap native;
+        native.allocPixels(full.info().makeWH(nativeDims.width(), nativeDims.height()));
+        REPORTER_ASSERT(r, SkCodec::kSuccess == nativeCodec->getPixels(
+                native.info(), native.getPixels(), native.rowBytes()));
+        REPORTER_ASSERT(r, matches_box_filter(native, full));
+
+        SkIRect subset = SkIRect::MakeXYWH(96, 300, 210, 150);
+        const SkISize subsetDims = codec->getSampledSubsetDimensions(sampleSize, subset);
+        SkBitmap region;
+        region.allocN32Pixels(subsetDims.width(), subsetDims.height());
+        options.fSubset = &subset;
+        REPORTER_ASSERT(r, SkCodec::kSuccess == codec->getAndroidPixels(
+                region.info(), region.getPixels(), region.rowBytes(), &options));
+        REPORTER_ASSERT(r, rows_match(full, subset.x() / sampleSize, subset.y() / sampleSize,
+                                      region, 0, region.height()));
+    }
+}
+
+static bool decode_png(skiatest::Reporter* r, const char path[], const SkImageInfo& info,
+                       bool incremental, SkBitmap* bm) {
+    SkAutoTDelete<SkCodec> codec(codec_from_resource(path));
+    if (!codec) {
+        return false;
+    }
+    bm->allocPixels(info.makeWH(codec->getInfo().width(), codec->getInfo().height()));
+    SkCodec::Result result;
+    if (incremental) {
+        result = codec->startIncrementalDecode(bm->info(), bm->getPixels(), bm->rowBytes());
+        if (SkCodec::kSuccess == result) {
+            result = codec->incrementalDecode();
+        }
+    } else {
+        result = codec->getPixels(bm->info(), bm->getPixels(), bm->rowBytes());
+    }
+    REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+    return SkCodec::kSuccess == result;
+}
+
+// Large PNGs are swizzled on other threads, and interlaced PNGs may be decoded straight into the
+// destination, or swizzled in parallel bands. All of these must match a row by row decode.
+DEF_TEST(Codec_png_threaded, r) {
+    const SkImageInfo opaqueInfos[] = {
+        SkImageInfo::Make(0, 0, kRGBA_8888_SkColorType, kOpaque_SkAlphaType),
+        SkImageInfo::Make(0, 0, kBGRA_8888_SkColorType, kPremul_SkAlphaType),
+        SkImageInfo::Make(0, 0, kRGB_565_SkColorType, kOpaque_SkAlphaType),
+    };
+    const SkImageInfo alphaInfos[] = {
+        SkImageInfo::Make(0, 0, kRGBA_8888_SkColorType, kUnpremul_SkAlphaType),
+        SkImageInfo::Make(0, 0, kBGRA_8888_SkColorType, kUnpremul_SkAlphaType),
+        SkImageInfo::Make(0, 0, kN32_SkColorType, kPremul_SkAlphaType),
+    };
+
+    SkBitmap full, incremental;
+    for (const SkImageInfo& info : opaqueInfos) {
+        if (decode_png(r, "mandrill_512.png", info, false, &full) &&
+                decode_png(r, "mandrill_512.png", info, true, &incremental)) {
+            REPORTER_ASSERT(r, rows_match(full, 0, 0, incremental, 0, full.height()));
+        }
+    }
+    for (const SkImageInfo& info : alphaInfos) {
+        if (decode_png(r, "gamut.png", info, false, &full) &&
+                decode_png(r, "gamut.png", info, true, &incremental)) {
+            REPORTER_ASSERT(r, rows_match(full, 0, 0, incremental, 0, full.height()));
+        }
+    }
+
+    static const struct {
+        const char*         fInterlaced;
+        const char*         fNormal;
+        const SkImageInfo*  fInfos;
+    } gPairs[] = {
+        { "mandrill_256_interlaced.png", "mandrill_256.png", opaqueInfos },
+        { "plane_interlaced.png",        "plane.png",        alphaInfos },
+    };
+    SkBitmap interlaced, normal;
+    for (const auto& pair : gPairs) {
+        for (int i = 0; i < 3; i++) {
+            const SkImageInfo& info = pair.fInfos[i];
+            if (!decode_png(r, pair.fNormal, info, false, &normal)) {
+                continue;
+            }
+            for (bool incremental : { false, true }) {
+                if (decode_png(r, pair.fInterlaced, info, incremental, &interlaced)) {
+                    REPORTER_ASSERT(r, rows_match(normal, 0, 0, interlaced, 0, normal.height()));
+                }
+            }
+        }
+    }
+}
+
+static void write_le16(SkWStream* stream, int value) {
+    stream->write16(SkToU16(value));
+}
+
+static void write_le32(SkWStream* stream, int value) {
+    stream->write32((uint32_t) value);
+}
+
+// Makes a bmp with random pixels. Bit masks are used for 16 bit pixels, and a random color
+// table for 8 bit ones. Negative heights are top-down.
+static sk_sp<SkData> make_bmp(int width, int height, int bitsPerPixel) {
+    const bool masks = 16 == bitsPerPixel;
+    const int colors = 8 == bitsPerPixel ? 256 : 0;
+    const int headerBytes = 14 + 40 + (masks ? 12 : 0) + colors * 4;
+    const int rowBytes = SkAlign4(width * bitsPerPixel / 8);
+    const int pixelBytes = rowBytes * SkTAbs(height);
+
+    SkDynamicMemoryWStream stream;
+    stream.write("BM", 2);
+    write_le32(&stream, headerBytes + pixelBytes);
+    write_le32(&stream, 0);
+    write_le32(&stream, headerBytes);
+
+    write_le32(&stream, 40);
+    write_le32(&stream, width);
+    write_le32(&stream, height);
+    write_le16(&stream, 1);
+    write_le16(&stream, bitsPerPixel);
+    write_le32(&stream, masks ? 3 : 0);
+    write_le32(&stream, pixelBytes);
+    write_le32(&stream, 2835);
+    write_le32(&stream, 2835);
+    write_le32(&stream, colors);
+    write_le32(&stream, 0);
+    if (masks) {
+        write_le32(&stream, 0xF800);
+        write_le32(&stream, 0x07E0);
+        write_le32(&stream, 0x001F);
+    }
+
+    SkRandom rand;
+    for (int i = 0; i < colors + pixelBytes / 4; i++) {
+        write_le32(&stream, rand.nextU());
+    }
+    return sk_sp<SkData>(stream.copyToData());
+}
+
+static sk_sp<SkData> make_wbmp(int width, int height) {
+    SkDynamicMemoryWStream stream;
+    const uint8_t header[] = {
+        0, 0,
+        (uint8_t) (0x80 | (width >> 7)), (uint8_t) (width & 0x7F),
+        (uint8_t) (0x80 | (height >> 7)), (uint8_t) (height & 0x7F),
+    };
+    stream.write(header, sizeof(header));
+    SkRandom rand;
+    for (int i = 0; i < (width + 7) / 8 * height; i++) {
+        stream.write8(rand.nextU() & 0xFF);
+    }
+    return sk_sp<SkData>(stream.copyToData());
+}
+
+// A seekable stream with no memory of its own to share, so that every band has to read through
+// a duplicate of it. Like SkFILEStream, duplicate() is not thread safe, so it must only be called
+// on the thread that made the stream. If duplicatesLeft is set, duplicate() fails once that many
+// duplicates have been made.
+class NoMemoryBaseStream : public SkMemoryStream {
+public:
+    NoMemoryBaseStream(sk_sp<SkData> data, int* duplicatesLeft = nullptr,
+                       SkThreadID thread = SkGetThreadID())
+        : SkMemoryStream(data.get())
+        , fData(data)
+        , fDuplicatesLeft(duplicatesLeft)
+        , fThread(thread)
+    {}
+
+    const void* getMemoryBase() override { return nullptr; }
+
+    NoMemoryBaseStream* duplicate() const override {
+        if (SkGetThreadID() != fThread) {
+            gDuplicatedOffThread = true;
+        }
+        if (fDuplicatesLeft && (*fDuplicatesLeft)-- <= 0) {
+            return nullptr;
+        }
+        return new NoMemoryBaseStream(fData, fDuplicatesLeft, fThread);
+    }
+
+    static bool gDuplicatedOffThread;
+
+private:
+    sk_sp<SkData>   fData;
+    int*            fDuplicatesLeft;
+    SkThreadID      fThread;
+};
+
+bool NoMemoryBaseStream::gDuplicatedOffThread = false;
+
+static SkCodec::Result decode_fixed_rows(SkCodec* codec, const SkImageInfo& info, bool scanlines,
+                                         SkBitmap* bm) {
+    bm->allocPixels(info.makeWH(codec->getInfo().width(), codec->getInfo().height()));
+    SkPMColor colors[256];
+    int colorCount = 256;
+    if (!scanlines) {
+        return codec->getPixels(bm->info(), bm->getPixels(), bm->rowBytes(), nullptr, colors,
+                                &colorCount);
+    }
+    SkCodec::Result result = codec->startScanlineDecode(bm->info(), nullptr, colors, &colorCount);
+    if (SkCodec::kSuccess == result &&
+            codec->getScanlines(bm->getPixels(), bm->height(), bm->rowBytes()) != bm->height()) {
+        result = SkCodec::kIncompleteInput;
+    }
+    return result;
+}
+
+// Large bmps and wbmps are decoded in bands on other threads, reading straight from memory or
+// through duplicates of the stream. They must match a row by row scanline decode, including
+// bottom-up bmps and images that are cut short.
+DEF_TEST(Codec_fixed_rows_threaded, r) {
+    const sk_sp<SkData> images[] = {
+        make_bmp(640, 480, 24),
+        make_bmp(601, -457, 32),
+        make_bmp(700, 400, 8),
+        make_bmp(513, 600, 16),
+        make_bmp(530, -520, 16),
+        make_wbmp(1000, 300),
+    };
+    for (const sk_sp<SkData>& data : images) {
+        const SkImageInfo info = SkImageInfo::MakeN32Premul(0, 0);
+        for (size_t length : { data->size(), data->size() * 2 / 3 }) {
+            sk_sp<SkData> truncated(SkData::MakeSubset(data.get(), 0, length));
+            // Running out of duplicates part way through falls back to a serial decode.
+            int duplicatesLeft = 3;
+            SkAutoTDelete<SkCodec> serial(SkCodec::NewFromData(truncated.get())),
+                                   memory(SkCodec::NewFromData(truncated.get())),
+                                   duplicates(SkCodec::NewFromStream(
+                                           new NoMemoryBaseStream(truncated))),
+                                   fewDuplicates(SkCodec::NewFromStream(
+                                           new NoMemoryBaseStream(truncated, &duplicatesLeft)));
+            REPORTER_ASSERT(r, serial && memory && duplicates && fewDuplicates);
+            if (!serial || !memory || !duplicates || !fewDuplicates) {
+                continue;
+            }
+
+            const SkCodec::Result expected = length == data->size() ? SkCodec::kSuccess
+                                                                    : SkCodec::kIncompleteInput;
+            SkBitmap serialBM, memoryBM, duplicatesBM, fewDuplicatesBM;
+            REPORTER_ASSERT(r, expected == decode_fixed_rows(serial, info, true, &serialBM));
+            REPORTER_ASSERT(r, expected == decode_fixed_rows(memory, info, false, &memoryBM));
+            REPORTER_ASSERT(r, expected == decode_fixed_rows(duplicates, info, false,
+                                                             &duplicatesBM));
+            REPORTER_ASSERT(r, expected == decode_fixed_rows(fewDuplicates, info, false,
+                                                             &fewDuplicatesBM));
+            REPORTER_ASSERT(r, rows_match(serialBM, 0, 0, memoryBM, 0, serialBM.height()));
+            REPORTER_ASSERT(r, rows_match(serialBM, 0, 0, duplicatesBM, 0, serialBM.height()));
+            REPORTER_ASSERT(r, rows_match(serialBM, 0, 0, fewDuplicatesBM, 0,
+                                          serialBM.height()));
+        }
+    }
+    REPORTER_ASSERT(r, !NoMemoryBaseStream::gDuplicatedOffThread);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkCompactPath.h"
+#include "SkFloatBits.h"
+#include "SkGlyphCache.h"
+#include "SkPaint.h"
+#include "SkRandom.h"
+#include "Test.h"
+
+// The compact iterator must return exactly what SkPath::RawIter returns, down to the bits.
+static void check_iter_matches(skiatest::Reporter* reporter, const SkPath& path,
+                               const SkCompactPath& compact) {
+    SkPath::RawIter iter(path);
+    SkCompactPath::Iter compactIter(compact);
+    SkPoint pts[4], compactPts[4];
+    SkPath::Verb verb;
+    do {
+        verb = iter.next(pts);
+        REPORTER_ASSERT(reporter, verb == compactIter.next(compactPts));
+        int n = 0;
+        switch (verb) {
+            case SkPath::kMove_Verb:  n = 1; break;
+            case SkPath::kLine_Verb:  n = 2; break;
+            case SkPath::kQuad_Verb:  n = 3; break;
+            case SkPath::kConic_Verb:
+                n = 3;
+                REPORTER_ASSERT(reporter, iter.conicWeight() == compactIter.conicWeight());
+                break;
+            case SkPath::kCubic_Verb: n = 4; break;
+            default: break;
+        }
+        for (int i = 0; i < n; ++i) {
+            REPORTER_ASSERT(reporter, SkFloat2Bits(pts[i].fX) == SkFloat2Bits(compactPts[i].fX));
+            REPORTER_ASSERT(reporter, SkFloat2Bits(pts[i].fY) == SkFloat2Bits(compactPts[i].fY));
+        }
+    } while (verb != SkPath::kDone_Verb);
+}
+
+static void check_round_trip(skiatest::Reporter* reporter, const SkPath& path) {
+    SkAutoTDelete<SkCompactPath> compact(SkCompactPath::Create(path));
+    REPORTER_ASSERT(reporter, compact);
+    if (!compact) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, compact->countPoints() == path.countPoints());
+    REPORTER_ASSERT(reporter, compact->countVerbs() == path.countVerbs());
+    REPORTER_ASSERT(reporter, compact->getBounds() == path.getBounds());
+    check_iter_matches(reporter, path, *compact);
+
+    SkPath rebuilt;
+    compact->toPath(&rebuilt);
+    REPORTER_ASSERT(reporter, rebuilt == path);
+
+    size_t size = compact->writeToMemory(nullptr);
+    REPORTER_ASSERT(reporter, SkIsAlign4(size));
+    SkAutoTMalloc<char> buffer(size);
+    REPORTER_ASSERT(reporter, size == compact->writeToMemory(buffer.get()));
+    SkAutoTDelete<SkCompactPath> read(SkCompactPath::CreateFromMemory(buffer.get(), size));
+    REPORTER_ASSERT(reporter, read);
+    if (read) {
+        check_iter_matches(reporter, path, *read);
+    }
+    REPORTER_ASSERT(reporter, !SkCompactPath::CreateFromMemory(buffer.get(), size - 4));
+}
+
+DEF_TEST(CompactPath, reporter) {
+    check_round_trip(reporter, SkPath());
+
+    // Integer icon-like geometry.
+    SkPath icon;
+    icon.moveTo(-10, 4);
+    icon.lineTo(20, 4);
+    icon.quadTo(30, 10, 20, 20);
+    icon.conicTo(0, 30, -10, 20, 0.5f);
+    icon.cubicTo(-20, 15, -15, 10, -10, 4);
+    icon.close();
+    icon.lineTo(5, 5);  // injects a moveTo after the close
+    icon.setFillType(SkPath::kEvenOdd_FillType);
+    check_round_trip(reporter, icon);
+
+    // 26.6 fixed point, as produced by font scalers.
+    SkRandom rand;
+    SkPath glyph;
+    glyph.moveTo(SkIntToScalar(rand.nextRangeU(0, 4000)) / 64, 700.0f / 64);
+    for (int i = 0; i < 100; ++i) {
+        glyph.quadTo(SkIntToScalar(rand.nextRangeU(0, 4000)) / 64,
+                     SkIntToScalar(rand.nextRangeU(0, 4000)) / 64,
+                     SkIntToScalar(rand.nextRangeU(0, 4000)) / 64,
+                     SkIntToScalar(rand.nextRangeU(0, 4000)) / 64);
+    }
+    glyph.close();
+    check_round_trip(reporter, glyph);
+
+    SkAutoTDelete<SkCompactPath> compactGlyph(SkCompactPath::Create(glyph));
+    size_t glyphBytes = glyph.countPoints() * sizeof(SkPoint) + glyph.countVerbs();
+    REPORTER_ASSERT(reporter, compactGlyph->approximateBytesUsed() < glyphBytes);
+
+    // FreeType's outlines have negated y coordinates, so their zeros are negative.
+    SkPath negativeZeros;
+    negativeZeros.moveTo(0, -0.0f);
+    negativeZeros.lineTo(5, -0.0f);
+    negativeZeros.lineTo(5, -10);
+    negativeZeros.close();
+    check_round_trip(reporter, negativeZeros);
+
+    // Zeros of both signs on one axis can't be told apart.
+    SkPath mixedZeros(negativeZeros);
+    mixedZeros.lineTo(0, 0);
+    REPORTER_ASSERT(reporter, nullptr == SkCompactPath::Create(mixedZeros));
+
+    // Coordinates that are not on a power-of-two grid can't be stored exactly.
+    SkPath arbitrary;
+    arbitrary.moveTo(0.1f, 0.2f);
+    arbitrary.lineTo(1.3f, 7.7f);
+    REPORTER_ASSERT(reporter, nullptr == SkCompactPath::Create(arbitrary));
+
+    // Nor can paths too large for 16 bits.
+    SkPath huge;
+    huge.moveTo(0, 0);
+    huge.lineTo(100000, 1);
+    REPORTER_ASSERT(reporter, nullptr == SkCompactPath::Create(huge));
+
+    SkPath nonFinite;
+    nonFinite.moveTo(0, 0);
+    nonFinite.lineTo(SK_ScalarInfinity, 1);
+    REPORTER_ASSERT(reporter, nullptr == SkCompactPath::Create(nonFinite));
+
+    // Bytes which are not a compact path are rejected rather than trusted.
+    SkAutoTDelete<SkCompactPath> compactIcon(SkCompactPath::Create(icon));
+    size_t iconSize = compactIcon->writeToMemory(nullptr);
+    SkAutoTMalloc<uint8_t> iconBytes(iconSize);
+    compactIcon->writeToMemory(iconBytes.get());
+    for (size_t i = 0; i < iconSize; ++i) {
+        iconBytes[i] ^= 0xFF;
+        SkAutoTDelete<SkCompactPath> corrupt(SkCompactPath::CreateFromMemory(iconBytes.get(),
+                                                                             iconSize));
+        if (corrupt) {
+            SkPath path;
+            corrupt->toPath(&path);
+        }
+        iconBytes[i] ^= 0xFF;
+    }
+}
+
+// The glyph cache keeps outlines as SkCompactPaths where it can, and hands back exactly what the
+// scaler context made.
+DEF_TEST(CompactPath_glyphCache, reporter) {
+    SkPaint paint;
+    paint.setTextSize(300);
+    SkAutoGlyphCache cache(paint, nullptr, nullptr);
+    for (SkUnichar c : { 'A', 'g', '8', '&', '@' }) {
+        const SkGlyph& glyph = cache->getUnicharMetrics(c);
+        SkPath path, expected;
+        if (!cache->findPath(glyph, &path)) {
+            continue;
+        }
+        cache->getScalerContext()->getPath(glyph, &expected);
+        REPORTER_ASSERT(reporter, path == expected);
+        REPORTER_ASSERT(reporter, !glyph.fPathData->fPath != !glyph.fPathData->fCompactPath);
+        if (glyph.fPathData->fCompactPath) {
+            check_iter_matches(reporter, expected, *glyph.fPathData->fCompactPath);
+        }
+    }
+}
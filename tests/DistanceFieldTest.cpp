@@ -0,0 +1,101 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkDistanceFieldGen.h"
+#include "SkRandom.h"
+#include "SkTArray.h"
+#include "SkTDArray.h"
+#include "Test.h"
+
+// A filled rectangle's field is above the threshold inside it and below it outside.
+DEF_TEST(DistanceField_rect, reporter) {
+    const int kSize = 16;
+    unsigned char image[kSize * kSize];
+    for (int y = 0; y < kSize; ++y) {
+        for (int x = 0; x < kSize; ++x) {
+            image[y * kSize + x] = (x >= 4 && x < 12 && y >= 4 && y < 12) ? 0xFF : 0;
+        }
+    }
+    const int dfSize = kSize + 2 * SK_DistanceFieldPad;
+    unsigned char field[dfSize * dfSize];
+    REPORTER_ASSERT(reporter, SkGenerateDistanceFieldFromA8Image(field, image, kSize, kSize,
+                                                                 kSize));
+
+    const int center = (SK_DistanceFieldPad + 8) * dfSize + SK_DistanceFieldPad + 8;
+    REPORTER_ASSERT(reporter, field[center] > 128);
+    REPORTER_ASSERT(reporter, field[0] < 128);
+    REPORTER_ASSERT(reporter, field[(SK_DistanceFieldPad + 8) * dfSize + 2] < 128);
+}
+
+// A batch generates the same fields as generating them one at a time, however it is split.
+DEF_TEST(DistanceField_batch, reporter) {
+    SkRandom random;
+    for (int count : { 5, 100 }) {
+        SkTArray<SkAutoTMalloc<unsigned char>, true> images, expected, fields;
+        SkTDArray<SkDistanceFieldImage> batch;
+        for (int i = 0; i < count; ++i) {
+            SkDistanceFieldImage* image = batch.append();
+            image->fWidth = random.nextRangeU(1, 40);
+            image->fHeight = random.nextRangeU(1, 40);
+            image->fIsBW = random.nextBool();
+            image->fRowBytes = image->fIsBW ? (image->fWidth + 7) / 8 : image->fWidth;
+            size_t imageSize = image->fRowBytes * image->fHeight;
+            size_t fieldSize = SkComputeDistanceFieldSize(image->fWidth, image->fHeight);
+
+            images.push_back().reset(imageSize);
+            for (size_t j = 0; j < imageSize; ++j) {
+                images.back()[j] = random.nextBool() ? 0xFF : random.nextU() & 0xFF;
+            }
+            image->fImage = images.back().get();
+            fields.push_back().reset(fieldSize);
+            image->fDistanceField = fields.back().get();
+
+            expected.push_back().reset(fieldSize);
+            if (image->fIsBW) {
+                SkGenerateDistanceFieldFromBWImage(expected.back().get(), image->fImage,
+                                                   image->fWidth, image->fHeight,
+                                                   image->fRowBytes);
+            } else {
+                SkGenerateDistanceFieldFromA8Image(expected.back().get(), image->fImage,
+                                                   image->fWidth, image->fHeight,
+                                                   image->fRowBytes);
+            }
+        }
+
+        REPORTER_ASSERT(reporter, SkGenerateDistanceFields(batch.begin(), batch.count()));
+        for (int i = 0; i < count; ++i) {
+            REPORTER_ASSERT(reporter, batch[i].fSuccess);
+            size_t fieldSize = SkComputeDistanceFieldSize(batch[i].fWidth, batch[i].fHeight);
+            REPORTER_ASSERT(reporter, 0 == memcmp(fields[i].get(), expected[i].get(), fieldSize));
+        }
+    }
+}
+
+// An empty image fails on its own, leaving its field untouched and the rest of the batch intact.
+DEF_TEST(DistanceField_batchFailure, reporter) {
+    const int kSize = 8;
+    unsigned char image[kSize * kSize];
+    memset(image, 0xFF, sizeof(image));
+    const int dfSize = kSize + 2 * SK_DistanceFieldPad;
+    unsigned char fields[3][dfSize * dfSize];
+    memset(fields, 0x5A, sizeof(fields));
+
+    SkDistanceFieldImage batch[3];
+    for (int i = 0; i < 3; ++i) {
+        batch[i] = { fields[i], image, kSize, kSize, kSize, false, false };
+    }
+    batch[1].fWidth = 0;
+
+    REPORTER_ASSERT(reporter, !SkGenerateDistanceFields(batch, 3));
+    REPORTER_ASSERT(reporter, batch[0].fSuccess);
+    REPORTER_ASSERT(reporter, !batch[1].fSuccess);
+    REPORTER_ASSERT(reporter, batch[2].fSuccess);
+    REPORTER_ASSERT(reporter, 0 == memcmp(fields[0], fields[2], sizeof(fields[0])));
+    for (unsigned char value : fields[1]) {
+        REPORTER_ASSERT(reporter, 0x5A == value);
+    }
+}
@@ -8,9 +8,11 @@
 #include "SkBitmap.h"
 #include "SkCanvas.h"
 #include "SkColor.h"
+#include "SkGraphics.h"
 #include "SkPaint.h"
 #include "SkPoint.h"
 #include "SkRect.h"
+#include "SkTypeface.h"
 #include "SkTypes.h"
 #include "Test.h"
 
@@ -111,3 +113,75 @@ DEF_TEST(DrawText, reporter) {
         }
     }
 }
+
+// A run draws many new glyphs at once, which the glyph cache may generate on several threads.
+// Each glyph should look the same as when it is drawn on its own.
+DEF_TEST(DrawText_manyNewGlyphs, reporter) {
+    SkPaint paint;
+    paint.setAntiAlias(true);
+    paint.setSubpixelText(true);
+    paint.setTextSize(SkIntToScalar(12));
+    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    sk_sp<SkTypeface> typeface(SkTypeface::MakeDefault());
+    const int glyphCount = SkTMin(typeface->countGlyphs() - 1, 400);
+    if (glyphCount < 1) {
+        return;
+    }
+    SkAutoTArray<uint16_t> glyphs(glyphCount);
+    SkAutoTArray<SkPoint> positions(glyphCount);
+    for (int i = 0; i < glyphCount; ++i) {
+        glyphs[i] = SkToU16(i + 1);
+        positions[i].set(SkIntToScalar(16 * (i % 20)) + 4.25f, SkIntToScalar(16 * (i / 20 + 1)));
+    }
+
+    const SkIRect rect = SkIRect::MakeWH(16 * 20 + 16, 16 * (glyphCount / 20 + 2));
+    SkBitmap runBitmap, glyphBitmap;
+    create(&runBitmap, rect);
+    create(&glyphBitmap, rect);
+    SkCanvas runCanvas(runBitmap);
+    SkCanvas glyphCanvas(glyphBitmap);
+
+    SkGraphics::PurgeFontCache();
+    drawBG(&runCanvas);
+    runCanvas.drawPosText(glyphs.get(), glyphCount * sizeof(uint16_t), positions.get(), paint);
+
+    SkGraphics::PurgeFontCache();
+    drawBG(&glyphCanvas);
+    for (int i = 0; i < glyphCount; ++i) {
+        glyphCanvas.drawPosText(&glyphs[i], sizeof(uint16_t), &positions[i], paint);
+    }
+
+    REPORTER_ASSERT(reporter, compare(runBitmap, rect, glyphBitmap, rect));
+}
+
+// Glyph ID text of an odd length draws its whole glyphs, and ignores the byte left over.
+DEF_TEST(DrawText_oddGlyphIDLength, reporter) {
+    SkPaint paint;
+    paint.setTextSize(SkIntToScalar(12));
+    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+
+    const uint16_t glyphs[] = { 1, 2, 3, 0 };
+    const SkPoint positions[] = { { 4, 16 }, { 20, 16 }, { 36, 16 }, { 52, 16 } };
+    const SkScalar xpos[] = { 4, 20, 36, 52 };
+    const size_t wholeLength = 3 * sizeof(uint16_t);
+
+    const SkIRect rect = SkIRect::MakeWH(64, 24);
+    SkBitmap oddBitmap, wholeBitmap;
+    create(&oddBitmap, rect);
+    create(&wholeBitmap, rect);
+    SkCanvas oddCanvas(oddBitmap);
+    SkCanvas wholeCanvas(wholeBitmap);
+
+    drawBG(&oddCanvas);
+    oddCanvas.drawPosText(glyphs, wholeLength + 1, positions, paint);
+    drawBG(&wholeCanvas);
+    wholeCanvas.drawPosText(glyphs, wholeLength, positions, paint);
+    REPORTER_ASSERT(reporter, compare(oddBitmap, rect, wholeBitmap, rect));
+
+    drawBG(&oddCanvas);
+    oddCanvas.drawPosTextH(glyphs, wholeLength + 1, xpos, 16, paint);
+    drawBG(&wholeCanvas);
+    wholeCanvas.drawPosTextH(glyphs, wholeLength, xpos, 16, paint);
+    REPORTER_ASSERT(reporter, compare(oddBitmap, rect, wholeBitmap, rect));
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkTypes.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID)
+
+#include "Resources.h"
+#include "SkData.h"
+#include "SkFontMgr.h"
+#include "SkFontMgr_custom.h"
+#include "SkOSFile.h"
+#include "SkStream.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+// Describes the families and styles of fontMgr, to compare managers with.
+static SkString describe(SkFontMgr* fontMgr) {
+    SkString description;
+    for (int i = 0; i < fontMgr->countFamilies(); ++i) {
+        SkAutoTUnref<SkFontStyleSet> set(fontMgr->createStyleSet(i));
+        SkString familyName;
+        fontMgr->getFamilyName(i, &familyName);
+        description.appendf("%s:", familyName.c_str());
+        for (int j = 0; j < set->count(); ++j) {
+            SkFontStyle style;
+            set->getStyle(j, &style, nullptr);
+            description.appendf(" %d/%d/%d", style.weight(), style.width(), style.slant());
+        }
+        description.append("\n");
+    }
+    return description;
+}
+
+// A directory manager with an index finds the same fonts as one without, whether it writes the
+// index, reads it, or replaces one which is not an index.
+DEF_TEST(FontMgrCustom_index, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString fontDir = SkOSPath::Join(tmpDir.c_str(), "font_mgr_custom_test");
+    sk_mkdir(fontDir.c_str());
+    for (const char* font : { "Em.ttf", "HangingS.ttf", "test.ttc" }) {
+        SkString resource = SkStringPrintf("fonts/%s", font);
+        sk_sp<SkData> data(SkData::MakeFromFileName(GetResourcePath(resource.c_str()).c_str()));
+        if (!data) {
+            return;
+        }
+        SkFILEWStream file(SkOSPath::Join(fontDir.c_str(), font).c_str());
+        file.write(data->data(), data->size());
+    }
+    SkString index = SkOSPath::Join(tmpDir.c_str(), "font_mgr_custom_test.index");
+    remove(index.c_str());
+
+    SkAutoTUnref<SkFontMgr> scanned(SkFontMgr_New_Custom_Directory(fontDir.c_str()));
+    SkString expected = describe(scanned);
+    REPORTER_ASSERT(reporter, scanned->countFamilies() >= 3);
+
+    SkAutoTUnref<SkFontMgr> writer(SkFontMgr_New_Custom_Directory(fontDir.c_str(),
+                                                                  index.c_str()));
+    REPORTER_ASSERT(reporter, expected == describe(writer));
+    REPORTER_ASSERT(reporter, sk_exists(index.c_str()));
+
+    SkAutoTUnref<SkFontMgr> reader(SkFontMgr_New_Custom_Directory(fontDir.c_str(),
+                                                                  index.c_str()));
+    REPORTER_ASSERT(reporter, expected == describe(reader));
+
+    // The typefaces made from the index are made lazily, and work.
+    SkString familyName;
+    reader->getFamilyName(0, &familyName);
+    SkAutoTUnref<SkTypeface> typeface(reader->matchFamilyStyle(familyName.c_str(),
+                                                               SkFontStyle()));
+    REPORTER_ASSERT(reporter, typeface && typeface->countGlyphs() > 0);
+
+    {
+        SkFILEWStream file(index.c_str());
+        file.writeText("not an index");
+    }
+    SkAutoTUnref<SkFontMgr> rewriter(SkFontMgr_New_Custom_Directory(fontDir.c_str(),
+                                                                    index.c_str()));
+    REPORTER_ASSERT(reporter, expected == describe(rewriter));
+    sk_sp<SkData> rewritten(SkData::MakeFromFileName(index.c_str()));
+    REPORTER_ASSERT(reporter, rewritten && rewritten->size() > strlen("not an index"));
+}
+
+// A directory with enough files to be scanned by several threads finds all of their faces.
+DEF_TEST(FontMgrCustom_manyFiles, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    sk_sp<SkData> data(SkData::MakeFromFileName(GetResourcePath("fonts/Em.ttf").c_str()));
+    if (!data) {
+        return;
+    }
+    SkString fontDir = SkOSPath::Join(tmpDir.c_str(), "font_mgr_custom_many_test");
+    sk_mkdir(fontDir.c_str());
+    const int kFileCount = 100;
+    for (int i = 0; i < kFileCount; ++i) {
+        SkString font = SkStringPrintf("Em%d.ttf", i);
+        SkFILEWStream file(SkOSPath::Join(fontDir.c_str(), font.c_str()).c_str());
+        file.write(data->data(), data->size());
+    }
+
+    SkAutoTUnref<SkFontMgr> fontMgr(SkFontMgr_New_Custom_Directory(fontDir.c_str()));
+    REPORTER_ASSERT(reporter, 1 == fontMgr->countFamilies());
+    SkAutoTUnref<SkFontStyleSet> set(fontMgr->createStyleSet(0));
+    REPORTER_ASSERT(reporter, kFileCount == set->count());
+}
+
+#endif
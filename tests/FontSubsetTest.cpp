@@ -0,0 +1,151 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkData.h"
+#include "SkEndian.h"
+#include "SkFontStream.h"
+#include "SkOTTable_head.h"
+#include "SkOTUtils.h"
+#include "SkPaint.h"
+#include "SkStream.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+static const SkFontTableTag kGlyf = SkSetFourByteTag('g', 'l', 'y', 'f');
+static const SkFontTableTag kHead = SkSetFourByteTag('h', 'e', 'a', 'd');
+static const SkFontTableTag kLoca = SkSetFourByteTag('l', 'o', 'c', 'a');
+static const SkFontTableTag kMaxp = SkSetFourByteTag('m', 'a', 'x', 'p');
+static const SkFontTableTag kGSUB = SkSetFourByteTag('G', 'S', 'U', 'B');
+
+static sk_sp<SkData> table_data(SkStream* font, int ttcIndex, SkFontTableTag tag) {
+    size_t size = SkFontStream::GetTableSize(font, ttcIndex, tag);
+    sk_sp<SkData> data(SkData::MakeUninitialized(size));
+    if (SkFontStream::GetTableData(font, ttcIndex, tag, 0, size, data->writable_data()) != size) {
+        return nullptr;
+    }
+    return data;
+}
+
+static uint32_t read_be(const uint8_t* p, size_t size) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+// Gets the 'glyf' data of each glyph of a font.
+static void get_glyphs(SkStream* font, int ttcIndex, SkTArray<sk_sp<SkData>>* glyphs) {
+    sk_sp<SkData> head(table_data(font, ttcIndex, kHead));
+    sk_sp<SkData> maxp(table_data(font, ttcIndex, kMaxp));
+    sk_sp<SkData> loca(table_data(font, ttcIndex, kLoca));
+    sk_sp<SkData> glyf(table_data(font, ttcIndex, kGlyf));
+    if (!head || !maxp || !loca || !glyf) {
+        return;
+    }
+    bool longLoca = SkOTTableHead::IndexToLocFormat::LongOffsets ==
+                    reinterpret_cast<const SkOTTableHead*>(head->data())->indexToLocFormat.value;
+    size_t locaSize = longLoca ? 4 : 2;
+    int glyphCount = read_be(maxp->bytes() + 4, 2);
+    for (int i = 0; i < glyphCount && (i + 2) * locaSize <= loca->size(); ++i) {
+        size_t start = read_be(loca->bytes() + i * locaSize, locaSize) * (longLoca ? 1 : 2);
+        size_t end = read_be(loca->bytes() + (i + 1) * locaSize, locaSize) * (longLoca ? 1 : 2);
+        glyphs->push_back(SkData::MakeSubset(glyf.get(), start, end - start));
+    }
+}
+
+static void test_subset(skiatest::Reporter* reporter, const char* resource, int ttcIndex,
+                        const uint32_t subset[], int subsetCount, const uint32_t kept[],
+                        int keptCount) {
+    SkAutoTDelete<SkStreamAsset> original(GetResourceAsStream(resource));
+    if (!original) {
+        INFOF(reporter, "Skipping FontSubsetTest for %s\n", resource);
+        return;
+    }
+    SkAutoTDelete<SkStreamAsset> font(SkOTUtils::SubsetFont(original->duplicate(), ttcIndex,
+                                                            subset, subsetCount));
+    REPORTER_ASSERT(reporter, font);
+    if (!font) {
+        return;
+    }
+
+    // The subset is a valid font file, with a checksum that adds up.
+    sk_sp<SkData> fontData(SkData::MakeFromStream(font, font->getLength()));
+    REPORTER_ASSERT(reporter, fontData->size() % 4 == 0);
+    REPORTER_ASSERT(reporter, SkOTTableHead::fontChecksum ==
+            SkOTUtils::CalcTableChecksum((SK_OT_ULONG*)fontData->writable_data(),
+                                         fontData->size()));
+    SkMemoryStream subsetStream(fontData);
+    REPORTER_ASSERT(reporter, 0 == SkFontStream::GetTableSize(&subsetStream, 0, kGSUB));
+
+    // Duplicates read the same data.
+    SkAutoTDelete<SkStreamAsset> duplicate(font->duplicate());
+    sk_sp<SkData> duplicateData(SkData::MakeFromStream(duplicate, duplicate->getLength()));
+    REPORTER_ASSERT(reporter, duplicateData->equals(fontData.get()));
+
+    // Glyph IDs do not change, and the kept glyphs have their original outlines.
+    SkTArray<sk_sp<SkData>> originalGlyphs, subsetGlyphs;
+    get_glyphs(original, ttcIndex, &originalGlyphs);
+    get_glyphs(&subsetStream, 0, &subsetGlyphs);
+    REPORTER_ASSERT(reporter, originalGlyphs.count() > 0);
+    REPORTER_ASSERT(reporter, originalGlyphs.count() == subsetGlyphs.count());
+    for (int i = 0; i < subsetGlyphs.count(); ++i) {
+        bool isKept = false;
+        for (int j = 0; j < keptCount; ++j) {
+            isKept |= (kept[j] == SkToU32(i));
+        }
+        if (isKept) {
+            REPORTER_ASSERT(reporter, subsetGlyphs[i]->size() >= originalGlyphs[i]->size());
+            REPORTER_ASSERT(reporter, 0 == memcmp(subsetGlyphs[i]->data(),
+                                                  originalGlyphs[i]->data(),
+                                                  originalGlyphs[i]->size()));
+        } else {
+            REPORTER_ASSERT(reporter, 0 == subsetGlyphs[i]->size());
+        }
+    }
+
+    // The characters of the kept glyphs map to the same glyphs.
+    sk_sp<SkTypeface> originalFace(SkTypeface::MakeFromStream(original.release(), ttcIndex));
+    sk_sp<SkTypeface> subsetFace(SkTypeface::MakeFromStream(new SkMemoryStream(fontData)));
+    if (!originalFace || !subsetFace) {
+        return;
+    }
+    REPORTER_ASSERT(reporter, originalFace->countGlyphs() == subsetFace->countGlyphs());
+    for (SkUnichar c = 0x20; c < 0x7F; ++c) {
+        uint16_t originalGlyph, subsetGlyph;
+        originalFace->charsToGlyphs(&c, SkTypeface::kUTF32_Encoding, &originalGlyph, 1);
+        subsetFace->charsToGlyphs(&c, SkTypeface::kUTF32_Encoding, &subsetGlyph, 1);
+        bool isKept = false;
+        for (int j = 0; j < keptCount; ++j) {
+            isKept |= (kept[j] == originalGlyph);
+        }
+        REPORTER_ASSERT(reporter, subsetGlyph == (isKept ? originalGlyph : 0));
+    }
+}
+
+DEF_TEST(FontSubset, reporter) {
+    // Glyph 17 is a composite of glyph 14.
+    const uint32_t subset[] = { 5, 17, 40000 };
+    const uint32_t kept[] = { 0, 5, 14, 17 };
+    test_subset(reporter, "/fonts/Roboto2-Regular_NoEmbed.ttf", 0,
+                subset, SK_ARRAY_COUNT(subset), kept, SK_ARRAY_COUNT(kept));
+
+    const uint32_t ttcSubset[] = { 3 };
+    const uint32_t ttcKept[] = { 0, 3 };
+    test_subset(reporter, "/fonts/test.ttc", 1,
+                ttcSubset, SK_ARRAY_COUNT(ttcSubset), ttcKept, SK_ARRAY_COUNT(ttcKept));
+
+    // Fonts which are not TrueType can not be subset.
+    SkAutoTDelete<SkStreamAsset> notTrueType(GetResourceAsStream("/fonts/Funkster.ttf"));
+    if (notTrueType) {
+        const uint32_t glyph = 1;
+        SkAutoTDelete<SkStreamAsset> font(
+                SkOTUtils::SubsetFont(notTrueType.release(), 0, &glyph, 1));
+        REPORTER_ASSERT(reporter, !font);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkImageEncoder.h"
+
+#include "SkBitmap.h"
+#include "SkCodec.h"
+#include "SkData.h"
+#include "SkRandom.h"
+#include "SkStream.h"
+#include "Test.h"
+
+static void make_bitmap(SkBitmap* bm, SkColorType colorType, SkAlphaType alphaType,
+                        int width = 100, int height = 73) {
+    bm->allocPixels(SkImageInfo::Make(width, height, colorType, alphaType));
+    SkRandom rand;
+    for (int y = 0; y < bm->height(); y++) {
+        for (int x = 0; x < bm->width(); x++) {
+            const U8CPU a = kOpaque_SkAlphaType == alphaType ? 0xFF : rand.nextULessThan(256);
+            bm->eraseArea(SkIRect::MakeXYWH(x, y, 1, 1),
+                          SkColorSetARGB(a, (x * 2) & 0xFF, (y * 3) & 0xFF,
+                                         rand.nextULessThan(256)));
+        }
+    }
+}
+
+// Streaming the rows in uneven bands must give the same bytes as encoding the whole bitmap.
+static void test_rows(skiatest::Reporter* r, SkImageEncoder::Type type, const SkBitmap& bm) {
+    SkAutoTDelete<SkImageEncoder> enc(SkImageEncoder::Create(type));
+    if (!enc) {
+        return;
+    }
+    SkAutoTUnref<SkData> expected(enc->encodeData(bm, 90));
+    REPORTER_ASSERT(r, expected);
+
+    SkDynamicMemoryWStream stream;
+    REPORTER_ASSERT(r, enc->begin(&stream, bm.info(), 90));
+    int y = 0;
+    for (int count : { 1, 7, 32, 33 }) {
+        REPORTER_ASSERT(r, enc->encodeRows(bm.getAddr(0, y), bm.rowBytes(), count));
+        y += count;
+    }
+    REPORTER_ASSERT(r, y == bm.height());
+    REPORTER_ASSERT(r, enc->finish());
+    SkAutoTUnref<SkData> streamed(stream.copyToData());
+    REPORTER_ASSERT(r, expected && streamed->equals(expected));
+
+    // Too many rows, or too few, fail.
+    SkDynamicMemoryWStream unused;
+    REPORTER_ASSERT(r, enc->begin(&unused, bm.info(), 90));
+    REPORTER_ASSERT(r, !enc->encodeRows(bm.getPixels(), bm.rowBytes(), bm.height() + 1));
+    REPORTER_ASSERT(r, enc->encodeRows(bm.getPixels(), bm.rowBytes(), bm.height() - 1));
+    REPORTER_ASSERT(r, !enc->finish());
+    REPORTER_ASSERT(r, !enc->encodeRows(bm.getPixels(), bm.rowBytes(), 0));
+
+    // An unfinished encode doesn't disturb the next one.
+    SkDynamicMemoryWStream again;
+    REPORTER_ASSERT(r, enc->begin(&again, bm.info(), 90));
+    REPORTER_ASSERT(r, enc->encodeRows(bm.getPixels(), bm.rowBytes(), bm.height()));
+    REPORTER_ASSERT(r, enc->finish());
+    SkAutoTUnref<SkData> streamedAgain(again.copyToData());
+    REPORTER_ASSERT(r, expected && streamedAgain->equals(expected));
+}
+
+DEF_TEST(ImageEncoder_rows, r) {
+    SkBitmap opaque, alpha, rgb565;
+    make_bitmap(&opaque, kN32_SkColorType, kOpaque_SkAlphaType);
+    make_bitmap(&alpha, kN32_SkColorType, kPremul_SkAlphaType);
+    make_bitmap(&rgb565, kRGB_565_SkColorType, kOpaque_SkAlphaType);
+
+    for (SkImageEncoder::Type type : { SkImageEncoder::kPNG_Type, SkImageEncoder::kJPEG_Type }) {
+        test_rows(r, type, opaque);
+        test_rows(r, type, alpha);
+        test_rows(r, type, rgb565);
+
+        SkAutoTDelete<SkImageEncoder> enc(SkImageEncoder::Create(type));
+        if (enc) {
+            SkDynamicMemoryWStream stream;
+            REPORTER_ASSERT(r, !enc->begin(&stream, SkImageInfo::MakeN32Premul(0, 10), 90));
+            REPORTER_ASSERT(r, !enc->begin(&stream, SkImageInfo::Make(10, 10, kIndex_8_SkColorType,
+                                                                      kPremul_SkAlphaType), 90));
+        }
+    }
+
+    // libwebp needs the whole picture, so the WebP encoder does not stream rows.
+    SkAutoTDelete<SkImageEncoder> webp(SkImageEncoder::Create(SkImageEncoder::kWEBP_Type));
+    if (webp) {
+        SkDynamicMemoryWStream stream;
+        REPORTER_ASSERT(r, !webp->begin(&stream, opaque.info(), 90));
+        REPORTER_ASSERT(r, !webp->encodeRows(opaque.getPixels(), opaque.rowBytes(), 1));
+        REPORTER_ASSERT(r, !webp->finish());
+    }
+}
+
+static bool decode(skiatest::Reporter* r, SkData* data, const SkImageInfo& info, SkBitmap* bm) {
+    SkAutoTDelete<SkCodec> codec(SkCodec::NewFromData(data));
+    REPORTER_ASSERT(r, codec);
+    if (!codec) {
+        return false;
+    }
+    bm->allocPixels(info);
+    const SkCodec::Result result = codec->getPixels(info, bm->getPixels(), bm->rowBytes());
+    REPORTER_ASSERT(r, SkCodec::kSuccess == result);
+    return SkCodec::kSuccess == result;
+}
+
+// Large PNGs are filtered and compressed in bands on other threads. They must decode to the
+// same pixels as libpng's own encode, which the row API still uses.
+DEF_TEST(ImageEncoder_png_bands, r) {
+    SkBitmap opaque, alpha, rgb565;
+    make_bitmap(&opaque, kN32_SkColorType, kOpaque_SkAlphaType, 640, 480);
+    make_bitmap(&alpha, kN32_SkColorType, kPremul_SkAlphaType, 601, 457);
+    make_bitmap(&rgb565, kRGB_565_SkColorType, kOpaque_SkAlphaType, 1000, 300);
+
+    for (const SkBitmap* bm : { &opaque, &alpha, &rgb565 }) {
+        SkAutoTDelete<SkImageEncoder> enc(SkImageEncoder::Create(SkImageEncoder::kPNG_Type));
+        SkAutoTUnref<SkData> banded(enc->encodeData(*bm, 100));
+        REPORTER_ASSERT(r, banded);
+
+        SkDynamicMemoryWStream stream;
+        REPORTER_ASSERT(r, enc->begin(&stream, bm->info(), 100));
+        REPORTER_ASSERT(r, enc->encodeRows(bm->getPixels(), bm->rowBytes(), bm->height()));
+        REPORTER_ASSERT(r, enc->finish());
+        SkAutoTUnref<SkData> serial(stream.copyToData());
+
+        // Filtering the same way, the bands should cost very little in size.
+        REPORTER_ASSERT(r, banded && banded->size() < serial->size() * 21 / 20);
+
+        const SkImageInfo info = bm->info().makeColorType(kN32_SkColorType);
+        SkBitmap fromBanded, fromSerial;
+        if (banded && decode(r, banded, info, &fromBanded) &&
+                decode(r, serial, info, &fromSerial)) {
+            REPORTER_ASSERT(r, 0 == memcmp(fromBanded.getPixels(), fromSerial.getPixels(),
+                                           fromBanded.getSize()));
+            if (&opaque == bm) {
+                REPORTER_ASSERT(r, 0 == memcmp(fromBanded.getPixels(), bm->getPixels(),
+                                               bm->getSize()));
+            }
+        }
+    }
+}
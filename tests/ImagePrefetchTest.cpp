@@ -0,0 +1,105 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkBitmapCache.h"
+#include "SkCanvas.h"
+#include "SkImage.h"
+#include "SkImageCacherator.h"
+#include "SkImage_Base.h"
+#include "SkPixelRef.h"
+#include "SkSurface.h"
+#include "Test.h"
+
+static bool is_cached(const SkImage* image) {
+    SkBitmap bm;
+    return as_IB(image)->peekCacherator()->lockAsBitmapOnlyIfAlreadyCached(&bm);
+}
+
+DEF_TEST(ImagePrefetch, r) {
+    sk_sp<SkImage> image(GetResourceAsImage("mandrill_512.png"));
+    sk_sp<SkImage> reference(GetResourceAsImage("mandrill_512.png"));
+    if (!image || !reference) {
+        return;
+    }
+    REPORTER_ASSERT(r, !is_cached(image.get()));
+
+    // Drawing waits for the prefetch, and then uses its pixels, which are discardable.
+    image->prefetch();
+    SkBitmap prefetched, decoded;
+    REPORTER_ASSERT(r, as_IB(image)->getROPixels(&prefetched));
+    REPORTER_ASSERT(r, is_cached(image.get()));
+    REPORTER_ASSERT(r, prefetched.pixelRef()->diagnostic_only_getDiscardable());
+    REPORTER_ASSERT(r, as_IB(reference)->getROPixels(&decoded));
+    {
+        SkAutoLockPixels lockA(prefetched), lockB(decoded);
+        REPORTER_ASSERT(r, prefetched.getSize() == decoded.getSize());
+        REPORTER_ASSERT(r, 0 == memcmp(prefetched.getPixels(), decoded.getPixels(),
+                                       decoded.getSize()));
+    }
+
+    // Prefetching again is harmless.
+    image->prefetch();
+    REPORTER_ASSERT(r, is_cached(image.get()));
+
+    // Color types that draws won't use do nothing.
+    sk_sp<SkImage> alpha(GetResourceAsImage("mandrill_512.png"));
+    alpha->prefetch(1, kAlpha_8_SkColorType);
+    alpha->prefetch(0.5f, kRGB_565_SkColorType);
+    REPORTER_ASSERT(r, !is_cached(alpha.get()));
+    SkBitmap unused;
+    REPORTER_ASSERT(r, !as_IB(alpha)->peekCacherator()->lockPrefetched(SkISize::Make(256, 256),
+                                                                         &unused));
+
+    // So do images that are already raster.
+    sk_sp<SkImage> raster(SkImage::MakeFromBitmap(decoded));
+    REPORTER_ASSERT(r, !as_IB(raster)->peekCacherator());
+    raster->prefetch();
+}
+
+DEF_TEST(ImagePrefetch_scaled, r) {
+    sk_sp<SkImage> image(GetResourceAsImage("mandrill_512.png"));
+    if (!image) {
+        return;
+    }
+    image->prefetch(0.25f);
+
+    // A draw at the prefetched size uses the small copy, and never decodes the whole image.
+    auto surface(SkSurface::MakeRasterN32Premul(128, 128));
+    SkPaint paint;
+    paint.setFilterQuality(kMedium_SkFilterQuality);
+    surface->getCanvas()->drawImageRect(image, SkRect::MakeWH(128, 128), &paint);
+    SkBitmap copy;
+    REPORTER_ASSERT(r, SkBitmapCache::FindWH(SkBitmapCacheDesc::Make(image.get(), 128, 128),
+                                             &copy));
+    REPORTER_ASSERT(r, !is_cached(image.get()));
+
+    // It looks like the usual downscale.
+    sk_sp<SkImage> reference(GetResourceAsImage("mandrill_512.png"));
+    auto expected(SkSurface::MakeRasterN32Premul(128, 128));
+    expected->getCanvas()->drawImageRect(reference, SkRect::MakeWH(128, 128), &paint);
+    SkBitmap actualBM, expectedBM;
+    actualBM.allocN32Pixels(128, 128);
+    expectedBM.allocN32Pixels(128, 128);
+    REPORTER_ASSERT(r, surface->getCanvas()->readPixels(&actualBM, 0, 0));
+    REPORTER_ASSERT(r, expected->getCanvas()->readPixels(&expectedBM, 0, 0));
+    int maxDiff = 0;
+    for (int y = 0; y < 128; y++) {
+        for (int x = 0; x < 128; x++) {
+            const SkPMColor a = *actualBM.getAddr32(x, y), e = *expectedBM.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                maxDiff = SkTMax(maxDiff, SkTAbs(int((a >> shift) & 0xFF) -
+                                                 int((e >> shift) & 0xFF)));
+            }
+        }
+    }
+    REPORTER_ASSERT(r, maxDiff < 48);
+
+    // Draws at other sizes don't use it.
+    surface->getCanvas()->drawImageRect(image, SkRect::MakeWH(100, 100), &paint);
+    REPORTER_ASSERT(r, is_cached(image.get()));
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkCanvas.h"
+#include "SkData.h"
+#include "SkImage.h"
+#include "SkImageCacherator.h"
+#include "SkImage_Base.h"
+#include "SkSurface.h"
+#include "SkYUVPlanesCache.h"
+#include "Test.h"
+
+static sk_sp<SkData> load(const char* resource) {
+    return SkData::MakeFromFileName(GetResourcePath(resource).c_str());
+}
+
+static void draw(SkImage* image, const SkRect& dst, const SkPaint& paint, SkBitmap* result) {
+    auto surface(SkSurface::MakeRasterN32Premul(SkScalarCeilToInt(dst.right()),
+                                                SkScalarCeilToInt(dst.bottom())));
+    surface->getCanvas()->clear(SK_ColorWHITE);
+    surface->getCanvas()->drawImageRect(image, dst, &paint);
+    result->allocN32Pixels(surface->width(), surface->height());
+    surface->getCanvas()->readPixels(result, 0, 0);
+}
+
+// Draws both images the same way, and checks the largest and the average difference of any
+// channel. Nothing in the YUV draw upsamples chroma the way the JPEG decoder does, so they never
+// match exactly.
+static void compare(skiatest::Reporter* r, SkImage* yuv, SkImage* rgba, const SkRect& dst,
+                    const SkPaint& paint, int maxDiff, float maxMeanDiff) {
+    SkBitmap actual, expected;
+    draw(yuv, dst, paint, &actual);
+    draw(rgba, dst, paint, &expected);
+    int worst = 0;
+    int64_t total = 0;
+    for (int y = 0; y < actual.height(); y++) {
+        for (int x = 0; x < actual.width(); x++) {
+            const SkPMColor a = *actual.getAddr32(x, y), e = *expected.getAddr32(x, y);
+            for (int shift = 0; shift < 32; shift += 8) {
+                const int diff = SkTAbs(int((a >> shift) & 0xFF) - int((e >> shift) & 0xFF));
+                worst = SkTMax(worst, diff);
+                total += diff;
+            }
+        }
+    }
+    const float mean = (float)total / (4 * actual.width() * actual.height());
+    REPORTER_ASSERT_MESSAGE(r, worst <= maxDiff, SkStringPrintf("max diff %d", worst).c_str());
+    REPORTER_ASSERT_MESSAGE(r, mean <= maxMeanDiff, SkStringPrintf("mean diff %g", mean).c_str());
+}
+
+static bool has_rgba(const SkImage* image) {
+    SkBitmap bm;
+    return as_IB(image)->peekCacherator()->lockAsBitmapOnlyIfAlreadyCached(&bm);
+}
+
+static bool has_yuv(const SkImage* image, int level = 0) {
+    SkYUVPlanesCache::Info info;
+    SkAutoTUnref<SkCachedData> data(SkYUVPlanesCache::FindAndRefLevel(image->uniqueID(), level,
+                                                                      &info));
+    return data && (512 >> level) == info.fSizeInfo.fSizes[SkYUVSizeInfo::kY].width();
+}
+
+DEF_TEST(ImageYUV_draw, r) {
+    sk_sp<SkData> encoded(load("mandrill_512_q075.jpg"));
+    if (!encoded) {
+        return;
+    }
+    sk_sp<SkImage> yuv(SkImage::MakeFromEncodedYUV(encoded));
+    sk_sp<SkImage> rgba(SkImage::MakeFromEncoded(encoded));
+    REPORTER_ASSERT(r, yuv && rgba && as_IB(yuv)->keepsYUVPlanes());
+    if (!yuv || !rgba) {
+        return;
+    }
+
+    SkPaint paint;
+    compare(r, yuv.get(), rgba.get(), SkRect::MakeWH(512, 512), paint, 64, 2);
+    REPORTER_ASSERT(r, has_yuv(yuv.get()));
+    REPORTER_ASSERT(r, !has_rgba(yuv.get()));
+
+    // Thumbnails sample a copy of the planes box filtered down to no smaller than the thumbnail,
+    // which is cached for the next draw.
+    paint.setFilterQuality(kMedium_SkFilterQuality);
+    REPORTER_ASSERT(r, !has_yuv(yuv.get(), 2));
+    compare(r, yuv.get(), rgba.get(), SkRect::MakeXYWH(3, 5, 128, 128), paint, 24, 1.5f);
+    REPORTER_ASSERT(r, has_yuv(yuv.get(), 2));
+    compare(r, yuv.get(), rgba.get(), SkRect::MakeXYWH(0, 0, 200, 150), paint, 32, 2);
+    REPORTER_ASSERT(r, has_yuv(yuv.get(), 1));
+
+    // Scaling up is bilinear.
+    paint.setFilterQuality(kLow_SkFilterQuality);
+    compare(r, yuv.get(), rgba.get(), SkRect::MakeXYWH(0, 0, 700, 600), paint, 40, 2);
+
+    // Paint alpha is applied.
+    paint.setAlpha(0x80);
+    compare(r, yuv.get(), rgba.get(), SkRect::MakeXYWH(0, 0, 256, 256), paint, 24, 1.5f);
+    REPORTER_ASSERT(r, !has_rgba(yuv.get()));
+
+    // Reading pixels still decodes RGBA, and draws then use those instead.
+    SkBitmap bm;
+    REPORTER_ASSERT(r, as_IB(yuv)->getROPixels(&bm));
+    REPORTER_ASSERT(r, has_rgba(yuv.get()));
+    paint.setAlpha(0xFF);
+    compare(r, yuv.get(), rgba.get(), SkRect::MakeWH(256, 256), paint, 0, 0);
+}
+
+DEF_TEST(ImageYUV_fallback, r) {
+    // Formats that can't decode to YUV make ordinary images.
+    sk_sp<SkData> png(load("mandrill_128.png"));
+    if (png) {
+        sk_sp<SkImage> image(SkImage::MakeFromEncodedYUV(png));
+        REPORTER_ASSERT(r, image && !as_IB(image)->keepsYUVPlanes());
+    }
+    REPORTER_ASSERT(r, !SkImage::MakeFromEncodedYUV(SkData::MakeEmpty()));
+
+    // Subsets of the image, and perspective, draw from RGBA.
+    sk_sp<SkData> jpeg(load("mandrill_512_q075.jpg"));
+    if (!jpeg) {
+        return;
+    }
+    sk_sp<SkImage> yuv(SkImage::MakeFromEncodedYUV(jpeg));
+    sk_sp<SkImage> rgba(SkImage::MakeFromEncoded(jpeg));
+    auto surface(SkSurface::MakeRasterN32Premul(100, 100));
+    surface->getCanvas()->drawImageRect(yuv, SkRect::MakeXYWH(10, 10, 50, 50),
+                                        SkRect::MakeWH(100, 100), nullptr);
+    REPORTER_ASSERT(r, has_rgba(yuv.get()));
+
+    sk_sp<SkImage> yuv2(SkImage::MakeFromEncodedYUV(jpeg));
+    SkMatrix perspective;
+    perspective.setAll(1, 0, 0, 0, 1, 0, 0.001f, 0, 1);
+    SkPaint paint;
+    paint.setFilterQuality(kLow_SkFilterQuality);
+    surface->getCanvas()->concat(perspective);
+    surface->getCanvas()->drawImageRect(yuv2, SkRect::MakeWH(100, 100), &paint);
+    REPORTER_ASSERT(r, has_rgba(yuv2.get()));
+}
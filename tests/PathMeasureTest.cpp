@@ -217,3 +217,46 @@ DEF_TEST(PathMeasureConic, reporter) {
     REPORTER_ASSERT(reporter, 19.5f < stdP.fX && stdP.fX < 20.5f);
     REPORTER_ASSERT(reporter, 19.5f < hiP.fX && hiP.fX < 20.5f);
 }
+
+// The batch getPosTan must match the single version whether or not the distances are sorted.
+DEF_TEST(PathMeasureBatch, reporter) {
+    SkPath path;
+    path.moveTo(0, 0);
+    path.cubicTo(100, 0, 0, 100, 100, 100);
+    path.lineTo(200, 50);
+    path.moveTo(300, 300);
+    path.quadTo(400, 300, 400, 400);
+    path.close();
+
+    SkPathMeasure batch(path, false);
+    SkPathMeasure single(path, false);
+    int contours = 0;
+    do {
+        SkScalar length = batch.getLength();
+        REPORTER_ASSERT(reporter, length == single.getLength());
+
+        const SkScalar distances[] = {
+            -5, 0, length * 0.1f, length * 0.1f, length * 0.5f, length * 0.25f,
+            length * 0.9f, length, length + 5,
+        };
+        const int count = SK_ARRAY_COUNT(distances);
+        SkPoint positions[count];
+        SkVector tangents[count];
+        REPORTER_ASSERT(reporter, batch.getPosTan(count, distances, positions, tangents));
+        for (int i = 0; i < count; ++i) {
+            SkPoint pos;
+            SkVector tan;
+            REPORTER_ASSERT(reporter, single.getPosTan(distances[i], &pos, &tan));
+            REPORTER_ASSERT(reporter, pos == positions[i]);
+            REPORTER_ASSERT(reporter, tan == tangents[i]);
+        }
+        contours += 1;
+
+        bool hasNext = batch.nextContour();
+        REPORTER_ASSERT(reporter, hasNext == single.nextContour());
+        if (!hasNext) {
+            break;
+        }
+    } while (true);
+    REPORTER_ASSERT(reporter, 2 == contours);
+}
@@ -290,3 +290,66 @@ DEF_TEST(Region_writeToMemory, r) {
     REPORTER_ASSERT(r, region.isComplex());
     test_write(region, r);
 }
+
+DEF_TEST(Region_unionRects, r) {
+    SkRandom rand;
+    for (int i = 0; i < 200; i++) {
+        const int N = 32;
+        SkIRect rect[N];
+        for (int j = 0; j < N; j++) {
+            rand_rect(&rect[j], rand);
+        }
+        REPORTER_ASSERT(r, test_rects(rect, N));
+
+        SkRegion expected, actual;
+        expected.setRects(rect, N);
+        actual.setRect(rect[0]);
+        actual.unionRects(rect + 1, N - 1);
+        REPORTER_ASSERT(r, expected == actual);
+    }
+
+    // empty rects contribute nothing
+    const SkIRect empties[] = {
+        { 0, 0, 0, 0 },
+        { 5, 5, 5, 10 },
+    };
+    SkRegion rgn;
+    REPORTER_ASSERT(r, !rgn.setRects(empties, SK_ARRAY_COUNT(empties)));
+    REPORTER_ASSERT(r, rgn.isEmpty());
+}
+
+// Ops whose result already owns large enough storage build the result in that storage.
+// Check that they give the same answer as ops into a fresh region.
+DEF_TEST(Region_opIntoExistingStorage, r) {
+    SkRandom rand;
+    for (int i = 0; i < 200; i++) {
+        const int N = 32;
+        SkIRect rect[N];
+        for (int j = 0; j < N; j++) {
+            rand_rect(&rect[j], rand);
+        }
+        SkRegion a, b;
+        a.setRects(rect, 3);
+        b.setRects(rect + 3, 3);
+
+        for (int op = 0; op < SkRegion::kOpCnt; op++) {
+            SkRegion expected;
+            expected.op(a, b, (SkRegion::Op)op);
+
+            SkRegion actual;
+            actual.setRects(rect, N);
+            actual.op(a, b, (SkRegion::Op)op);
+            REPORTER_ASSERT(r, expected == actual);
+
+            // the result must not scribble on storage it shares with another region
+            SkRegion shared;
+            shared.setRects(rect, N);
+            SkRegion copy(shared);
+            shared.op(a, b, (SkRegion::Op)op);
+            REPORTER_ASSERT(r, expected == shared);
+            SkRegion original;
+            original.setRects(rect, N);
+            REPORTER_ASSERT(r, original == copy);
+        }
+    }
+}
@@ -0,0 +1,358 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "Resources.h"
+#include "SkData.h"
+#include "SkGlyph.h"
+#include "SkGlyphCache.h"
+#include "SkOSFile.h"
+#include "SkPath.h"
+#include "SkSharedGlyphStore.h"
+#include "SkStream.h"
+#include "SkString.h"
+#include "SkThreadUtils.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+#if defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_MAC)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static const size_t kStoreSize = 1 << 20;
+static const int kWriterCount = 4;
+static const int kGlyphsPerWriter = 40;
+
+static SkString store_name(const char* test) {
+    SkString name;
+    name.printf("/skia-%s-%d", test, (int)getpid());
+    return name;
+}
+
+// Makes a made-up glyph, and its image in image, which must hold 64 bytes.
+static void make_glyph(uint16_t glyphID, SkGlyph* glyph, uint8_t image[]) {
+    glyph->initWithGlyphID(glyphID);
+    glyph->fAdvanceX = glyphID + 0.5f;
+    glyph->fAdvanceY = 0;
+    glyph->fWidth = 1 + glyphID % 4;
+    glyph->fHeight = 3;
+    glyph->fTop = -3;
+    glyph->fLeft = glyphID % 7;
+    glyph->fMaskFormat = SkMask::kA8_Format;
+    glyph->fRsbDelta = glyph->fLsbDelta = 0;
+    glyph->fImage = image;
+    for (size_t i = 0; i < glyph->computeImageSize(); ++i) {
+        image[i] = (uint8_t)(glyphID * 7 + i);
+    }
+}
+
+struct Writer {
+    const char*     fName;
+    const SkData*   fKey;
+    int             fIndex;
+    bool            fSucceeded;
+};
+
+// Adds the glyphs of one writer to the store, through its own file descriptor and mapping of it, as
+// one of several processes doing so at once would.
+static void add_glyphs(void* context) {
+    Writer* writer = static_cast<Writer*>(context);
+    writer->fSucceeded = false;
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(writer->fName, kStoreSize));
+    if (!store) {
+        return;
+    }
+    SkSharedGlyphStore::StrikeID strike = store->findOrAddStrike(*writer->fKey);
+    if (!strike) {
+        return;
+    }
+    for (int i = 0; i < kGlyphsPerWriter; ++i) {
+        uint16_t glyphID = SkToU16(writer->fIndex * kGlyphsPerWriter + i);
+        uint32_t packedID = glyphID;  // With no subpixel offset, packed IDs are glyph IDs.
+        uint8_t image[64];
+        SkGlyph glyph;
+        make_glyph(glyphID, &glyph, image);
+        const SkGlyph* glyphPtr = &glyph;
+        store->addGlyphs(strike, &packedID, &glyphPtr, 1);
+    }
+    writer->fSucceeded = true;
+}
+
+// Each writer opens the store itself, so writers are serialized by the lock on the store, as
+// processes are, rather than only by the mutex of one SkSharedGlyphStore. They are threads
+// rather than forked processes, as only async-signal-safe calls may be made after forking a
+// process which has threads.
+DEF_TEST(SharedGlyphStore_processes, reporter) {
+    SkString name = store_name("glyphs");
+    SkSharedGlyphStore::Unlink(name.c_str());
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(name.c_str(), kStoreSize));
+    if (!store) {
+        INFOF(reporter, "Shared memory is not available.\n");
+        return;
+    }
+    sk_sp<SkData> key(SkData::MakeWithCString("a strike"));
+
+    Writer writers[kWriterCount];
+    SkThread* threads[kWriterCount];
+    for (int i = 0; i < kWriterCount; ++i) {
+        writers[i] = { name.c_str(), key.get(), i, false };
+        threads[i] = new SkThread(add_glyphs, &writers[i]);
+        REPORTER_ASSERT(reporter, threads[i]->start());
+    }
+    for (int i = 0; i < kWriterCount; ++i) {
+        threads[i]->join();
+        delete threads[i];
+        REPORTER_ASSERT(reporter, writers[i].fSucceeded);
+    }
+
+    // Every writer found the same strike, and this mapping sees all of their glyphs.
+    size_t bytesUsed = store->bytesUsed();
+    SkSharedGlyphStore::StrikeID strike = store->findOrAddStrike(*key);
+    REPORTER_ASSERT(reporter, strike);
+    REPORTER_ASSERT(reporter, bytesUsed == store->bytesUsed());
+    for (int i = 0; i < kWriterCount * kGlyphsPerWriter; ++i) {
+        uint8_t image[64];
+        SkGlyph expected, glyph;
+        make_glyph(SkToU16(i), &expected, image);
+        glyph.initWithGlyphID(i);
+        REPORTER_ASSERT(reporter, store->findGlyph(strike, i, &glyph));
+        REPORTER_ASSERT(reporter, glyph.fAdvanceX == expected.fAdvanceX);
+        REPORTER_ASSERT(reporter, glyph.fWidth == expected.fWidth);
+        REPORTER_ASSERT(reporter, glyph.fLeft == expected.fLeft);
+        REPORTER_ASSERT(reporter, glyph.fImage &&
+                        0 == memcmp(glyph.fImage, image, expected.computeImageSize()));
+    }
+    SkGlyph missing;
+    missing.initWithGlyphID(kWriterCount * kGlyphsPerWriter);
+    REPORTER_ASSERT(reporter, !store->findGlyph(strike, missing.getGlyphID(), &missing));
+
+    SkSharedGlyphStore::Unlink(name.c_str());
+}
+
+// A strike of a typeface at 20 points which is not in the global cache, and which shares its
+// glyphs through a store of its own rather than the global one, so that text drawn by other tests
+// at the same time does not add to the store.
+class SkGlyphCacheTestingAccess : SkNoncopyable {
+public:
+    SkGlyphCacheTestingAccess(SkTypeface* typeface, sk_sp<SkSharedGlyphStore> store) {
+        SkPaint paint;
+        paint.setAntiAlias(true);
+        paint.setTextSize(20);
+        paint.setTypeface(sk_ref_sp(typeface));
+        // The global cache's strike for the paint describes the strike.
+        SkAutoGlyphCache cache(paint, nullptr, nullptr);
+        const SkDescriptor* desc = &cache->getDescriptor();
+        SkScalerContext* context = typeface->createScalerContext(
+                cache->getScalerContext()->getEffects(), desc);
+        fStrike = new SkGlyphCache(typeface, desc, context, std::move(store));
+    }
+    ~SkGlyphCacheTestingAccess() { delete fStrike; }
+
+    SkGlyphCache* operator->() const { return fStrike; }
+
+private:
+    SkGlyphCache* fStrike;
+};
+
+// A store whose entries link into a cycle, as a damaged store might, is not looped over forever:
+// lookups miss, and the store is no longer used.
+DEF_TEST(SharedGlyphStore_corrupt, reporter) {
+    SkString name = store_name("corrupt");
+    SkSharedGlyphStore::Unlink(name.c_str());
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(name.c_str(), kStoreSize));
+    if (!store) {
+        INFOF(reporter, "Shared memory is not available.\n");
+        return;
+    }
+    sk_sp<SkData> key(SkData::MakeWithCString("a strike"));
+    SkSharedGlyphStore::StrikeID strike = store->findOrAddStrike(*key);
+    REPORTER_ASSERT(reporter, strike);
+    uint8_t image[64];
+    SkGlyph glyph;
+    make_glyph(1, &glyph, image);
+    const uint32_t packedID = 1;
+    const SkGlyph* glyphPtr = &glyph;
+    store->addGlyphs(strike, &packedID, &glyphPtr, 1);
+    SkGlyph found;
+    found.initWithGlyphID(1);
+    REPORTER_ASSERT(reporter, store->findGlyph(strike, packedID, &found));
+
+    // Through a writable mapping of our own, find the glyph's entry, which starts with the links
+    // and IDs of its chain, and link it to itself under another ID.
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    REPORTER_ASSERT(reporter, fd >= 0);
+    void* base = mmap(nullptr, kStoreSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    REPORTER_ASSERT(reporter, MAP_FAILED != base);
+    if (fd < 0 || MAP_FAILED == base) {
+        return;
+    }
+    uint32_t* words = static_cast<uint32_t*>(base);
+    bool linked = false;
+    for (size_t i = SkAlign8(strike) / 4; i + 3 < store->bytesUsed() / 4; i += 2) {
+        if (words[i + 1] == strike && words[i + 2] == packedID) {
+            words[i] = SkToU32(i * 4);
+            words[i + 2] = 7;
+            linked = true;
+            break;
+        }
+    }
+    munmap(base, kStoreSize);
+    close(fd);
+    REPORTER_ASSERT(reporter, linked);
+
+    REPORTER_ASSERT(reporter, !store->isCorrupt());
+    REPORTER_ASSERT(reporter, !store->findGlyph(strike, packedID, &found));
+    REPORTER_ASSERT(reporter, store->isCorrupt());
+
+    // Nothing is found or added from then on.
+    REPORTER_ASSERT(reporter, 0 == store->findOrAddStrike(*key));
+    const size_t bytesUsed = store->bytesUsed();
+    store->addGlyphs(strike, &packedID, &glyphPtr, 1);
+    REPORTER_ASSERT(reporter, bytesUsed == store->bytesUsed());
+    SkSharedGlyphStore::Unlink(name.c_str());
+}
+
+static const char kText[] = "Hamburgefons";
+
+// Returns the images of the glyphs of kText, one after another.
+static sk_sp<SkData> glyph_images(const SkGlyphCacheTestingAccess& strike) {
+    SkDynamicMemoryWStream images;
+    for (const char* c = kText; *c; ++c) {
+        const SkGlyph& glyph = strike->getUnicharMetrics(*c);
+        if (const void* image = strike->findImage(glyph)) {
+            images.write(image, glyph.computeImageSize());
+        }
+    }
+    return sk_sp<SkData>(images.copyToData());
+}
+
+// Two typefaces of the same font have different IDs, as they would in two processes, but share
+// their glyphs.
+DEF_TEST(SharedGlyphStore_glyphCache, reporter) {
+    sk_sp<SkTypeface> first(MakeResourceAsTypeface("/fonts/Roboto2-Regular_NoEmbed.ttf"));
+    sk_sp<SkTypeface> second(MakeResourceAsTypeface("/fonts/Roboto2-Regular_NoEmbed.ttf"));
+    if (!first || !second) {
+        INFOF(reporter, "Could not load the test font.\n");
+        return;
+    }
+    REPORTER_ASSERT(reporter, first->uniqueID() != second->uniqueID());
+
+    SkString name = store_name("cache");
+    SkSharedGlyphStore::Unlink(name.c_str());
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(name.c_str(), kStoreSize));
+    SkSharedGlyphStore::Unlink(name.c_str());
+    if (!store) {
+        INFOF(reporter, "Shared memory is not available.\n");
+        return;
+    }
+    size_t emptyBytesUsed = store->bytesUsed();
+    sk_sp<SkData> firstImages = glyph_images(SkGlyphCacheTestingAccess(first.get(), store));
+    size_t bytesUsed = store->bytesUsed();
+    REPORTER_ASSERT(reporter, bytesUsed > emptyBytesUsed);
+
+    sk_sp<SkData> secondImages = glyph_images(SkGlyphCacheTestingAccess(second.get(), store));
+    REPORTER_ASSERT(reporter, bytesUsed == store->bytesUsed());
+    REPORTER_ASSERT(reporter, firstImages->size() > 0 && firstImages->equals(secondImages.get()));
+}
+
+// Returns the paths of the glyphs of kText, side by side.
+static SkPath glyph_paths(const SkGlyphCacheTestingAccess& strike) {
+    SkPath paths, path;
+    for (int i = 0; kText[i]; ++i) {
+        if (strike->findPath(strike->getUnicharMetrics(kText[i]), &path)) {
+            paths.addPath(path, SkIntToScalar(20 * i), 0);
+        }
+    }
+    return paths;
+}
+
+// Glyph outlines are stored as SkCompactPaths, in less space than SkPath::writeToMemory() takes.
+DEF_TEST(SharedGlyphStore_compactPaths, reporter) {
+    sk_sp<SkTypeface> typeface(MakeResourceAsTypeface("/fonts/Roboto2-Regular_NoEmbed.ttf"));
+    if (!typeface) {
+        INFOF(reporter, "Could not load the test font.\n");
+        return;
+    }
+    SkString name = store_name("paths");
+    SkSharedGlyphStore::Unlink(name.c_str());
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::Make(name.c_str(), kStoreSize));
+    SkSharedGlyphStore::Unlink(name.c_str());
+    if (!store) {
+        INFOF(reporter, "Shared memory is not available.\n");
+        return;
+    }
+    SkGlyphCacheTestingAccess strike(typeface.get(), store);
+    glyph_images(strike);
+    size_t imageBytesUsed = store->bytesUsed();
+    SkPath paths = glyph_paths(strike);
+    size_t pathBytes = store->bytesUsed() - imageBytesUsed;
+    REPORTER_ASSERT(reporter, !paths.isEmpty());
+
+    // The glyphs of kText are all different, so each path was added once.
+    size_t uncompactPathBytes = 0;
+    for (const char* c = kText; *c; ++c) {
+        SkPath path;
+        if (strike->findPath(strike->getUnicharMetrics(*c), &path)) {
+            uncompactPathBytes += SkAlign8(2 * sizeof(uint32_t) + path.writeToMemory(nullptr));
+        }
+    }
+    INFOF(reporter, "%zu bytes of paths, %zu without SkCompactPath\n",
+          pathBytes, uncompactPathBytes);
+    REPORTER_ASSERT(reporter, pathBytes > 0 && pathBytes < uncompactPathBytes);
+}
+
+// A store in a file keeps its glyphs and paths for the next process to open it, and replaces a
+// file which is not a store.
+DEF_TEST(SharedGlyphStore_file, reporter) {
+    SkString tmpDir = skiatest::GetTmpDir();
+    if (tmpDir.isEmpty()) {
+        return;
+    }
+    SkString path = SkOSPath::Join(tmpDir.c_str(), "glyph_store_test");
+    {
+        SkFILEWStream notAStore(path.c_str());
+        notAStore.writeText("not a glyph store");
+    }
+
+    sk_sp<SkData> firstImages;
+    SkPath firstPaths;
+    size_t bytesUsed = 0;
+    {
+        sk_sp<SkTypeface> typeface(MakeResourceAsTypeface("/fonts/Roboto2-Regular_NoEmbed.ttf"));
+        sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::MakeFromFile(path.c_str(),
+                                                                         kStoreSize));
+        REPORTER_ASSERT(reporter, store);
+        if (!typeface || !store) {
+            return;
+        }
+        size_t emptyBytesUsed = store->bytesUsed();
+        SkGlyphCacheTestingAccess strike(typeface.get(), store);
+        firstImages = glyph_images(strike);
+        firstPaths = glyph_paths(strike);
+        bytesUsed = store->bytesUsed();
+        REPORTER_ASSERT(reporter, bytesUsed > emptyBytesUsed);
+    }
+
+    // As on the next run, with a new typeface and store, the glyphs are all in the file.
+    sk_sp<SkTypeface> typeface(MakeResourceAsTypeface("/fonts/Roboto2-Regular_NoEmbed.ttf"));
+    sk_sp<SkSharedGlyphStore> store(SkSharedGlyphStore::MakeFromFile(path.c_str(), kStoreSize));
+    REPORTER_ASSERT(reporter, store && bytesUsed == store->bytesUsed());
+    if (!store) {
+        return;
+    }
+    SkGlyphCacheTestingAccess strike(typeface.get(), store);
+    sk_sp<SkData> secondImages = glyph_images(strike);
+    SkPath secondPaths = glyph_paths(strike);
+    REPORTER_ASSERT(reporter, bytesUsed == store->bytesUsed());
+
+    REPORTER_ASSERT(reporter, firstImages->size() > 0 && firstImages->equals(secondImages.get()));
+    REPORTER_ASSERT(reporter, !firstPaths.isEmpty() && firstPaths == secondPaths);
+    remove(path.c_str());
+}
+
+#endif
@@ -5,6 +5,10 @@
  * found in the LICENSE file.
  */
 
+#include "SkCodecPriv.h"
+#include "SkMaskSwizzler.h"
+#include "SkMasks.h"
+#include "SkRandom.h"
 #include "SkSwizzle.h"
 #include "SkSwizzler.h"
 #include "Test.h"
@@ -167,3 +171,205 @@ DEF_TEST(PublicSwizzleOpts, r) {
     SkSwapRB(&dst, &src, 1);
     REPORTER_ASSERT(r, dst == 0xFA04B0CE);
 }
+
+DEF_TEST(SwizzleOpts_565, r) {
+    static const int K = 1023;  // A non-power-of-two, to reach the SIMD tails.
+    uint32_t src[K];
+    uint16_t rgba[K], bgra[K];
+    SkRandom rand;
+    for (int i = 0; i < K; i++) {
+        src[i] = rand.nextU();
+    }
+    SkOpts::RGBA_to_565(rgba, src, K);
+    SkOpts::BGRA_to_565(bgra, src, K);
+    for (int i = 0; i < K; i++) {
+        const U8CPU b0 = src[i] & 0xFF, b1 = (src[i] >> 8) & 0xFF, b2 = (src[i] >> 16) & 0xFF;
+        REPORTER_ASSERT(r, rgba[i] == SkPack888ToRGB16(b0, b1, b2));
+        REPORTER_ASSERT(r, bgra[i] == SkPack888ToRGB16(b2, b1, b0));
+    }
+}
+
+// The bit mask kernels must match the SkMasks getters, at every value of channels of every size.
+DEF_TEST(SwizzleOpts_masks, r) {
+    const struct {
+        uint32_t bitsPerPixel;
+        SkMasks::InputMasks masks;
+    } gRecs[] = {
+        { 16, { 0x7C00, 0x03E0, 0x001F, 0 } },
+        { 16, { 0xF800, 0x07E0, 0x001F, 0 } },
+        { 16, { 0x0F00, 0x00F0, 0x000F, 0xF000 } },
+        { 16, { 0x0003, 0x001C, 0x00E0, 0x0100 } },
+        { 24, { 0xFF0000, 0x00FF00, 0x0000FF, 0 } },
+        { 24, { 0x3F0000, 0x00FC00, 0x00003F, 0xC00000 } },
+        { 32, { 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000 } },
+        { 32, { 0xFE000000, 0x01FC0000, 0x0003F800, 0x000007C0 } },
+        { 32, { 0x3FF00000, 0x000FFC00, 0x000003FF, 0xC0000000 } },  // truncated to 8 bits
+    };
+
+    static const int kPixels = 1 << 16;
+    SkAutoTMalloc<uint8_t> src(4 * kPixels * 3);
+    SkAutoTMalloc<uint32_t> dst(kPixels);
+    SkRandom rand;
+    for (const auto& rec : gRecs) {
+        const int bpp = rec.bitsPerPixel / 8;
+        for (int i = 0; i < kPixels * 3; i++) {
+            // Every 16-bit pixel, then random ones.
+            const uint32_t p = i < kPixels && 2 == bpp ? i : rand.nextU();
+            memcpy(&src[i * bpp], &p, bpp);
+        }
+
+        SkAutoTDelete<SkMasks> masks(SkMasks::CreateMasks(rec.masks, rec.bitsPerPixel));
+        const SkMasks::MaskInfo infos[4] = {
+            masks->getRedInfo(), masks->getGreenInfo(), masks->getBlueInfo(),
+            masks->getAlphaInfo(),
+        };
+        SkOpts::BitMasks bitMasks;
+        for (int c = 0; c < 4; c++) {
+            bitMasks.mask[c] = infos[c].mask;
+            bitMasks.shift[c] = infos[c].shift;
+            bitMasks.size[c] = infos[c].size;
+        }
+
+        // Each pixel, and every third pixel, as when sampling.
+        for (int step : { bpp, 3 * bpp }) {
+            const int count = kPixels - 1;
+            for (int premul = 0; premul < 2; premul++) {
+                for (int swapRB = 0; swapRB < 2; swapRB++) {
+                    const SkOpts::Swizzle_masks proc =
+                            premul ? (swapRB ? SkOpts::masks_to_bgrA : SkOpts::masks_to_rgbA)
+                                   : (swapRB ? SkOpts::masks_to_BGRA : SkOpts::masks_to_RGBA);
+                    proc(dst, src, count, bpp, step, bitMasks);
+
+                    int mismatches = 0;
+                    for (int i = 0; i < count; i++) {
+                        uint32_t p = 0;
+                        memcpy(&p, &src[i * step], bpp);
+                        const uint8_t red = masks->getRed(p),
+                                      green = masks->getGreen(p),
+                                      blue = masks->getBlue(p),
+                                      alpha = rec.masks.alpha ? masks->getAlpha(p) : 0xFF;
+                        uint32_t expected;
+                        if (premul) {
+                            expected = swapRB ? premultiply_argb_as_bgra(alpha, red, green, blue)
+                                              : premultiply_argb_as_rgba(alpha, red, green, blue);
+                        } else {
+                            expected = swapRB ? SkPackARGB_as_BGRA(alpha, red, green, blue)
+                                              : SkPackARGB_as_RGBA(alpha, red, green, blue);
+                        }
+                        mismatches += expected != dst[i];
+                    }
+                    REPORTER_ASSERT(r, 0 == mismatches);
+                }
+            }
+        }
+    }
+}
+
+// Sampled swizzles gather their pixels for the optimized functions.  They must pick out the
+// same pixels as the unsampled swizzle.
+DEF_TEST(Swizzler_sampled, r) {
+    static const int kWidth = 301;
+    SkPMColor ctable[256];
+    uint8_t src[4 * kWidth];
+    SkRandom rand;
+    for (int i = 0; i < 256; i++) {
+        ctable[i] = SkPreMultiplyColor(rand.nextU());
+    }
+    for (int i = 0; i < 4 * kWidth; i++) {
+        src[i] = rand.nextU();
+    }
+
+    const struct {
+        SkEncodedInfo::Color color;
+        SkEncodedInfo::Alpha alpha;
+    } gSrcs[] = {
+        { SkEncodedInfo::kGray_Color,      SkEncodedInfo::kOpaque_Alpha },
+        { SkEncodedInfo::kGrayAlpha_Color, SkEncodedInfo::kUnpremul_Alpha },
+        { SkEncodedInfo::kPalette_Color,   SkEncodedInfo::kUnpremul_Alpha },
+        { SkEncodedInfo::kRGB_Color,       SkEncodedInfo::kOpaque_Alpha },
+        { SkEncodedInfo::kRGBA_Color,      SkEncodedInfo::kUnpremul_Alpha },
+        { SkEncodedInfo::kBGR_Color,       SkEncodedInfo::kOpaque_Alpha },
+        { SkEncodedInfo::kBGRX_Color,      SkEncodedInfo::kOpaque_Alpha },
+        { SkEncodedInfo::kBGRA_Color,      SkEncodedInfo::kUnpremul_Alpha },
+    };
+    for (const auto& rec : gSrcs) {
+        const SkEncodedInfo encodedInfo = SkEncodedInfo::Make(rec.color, rec.alpha, 8);
+        const SkPMColor* colors = SkEncodedInfo::kPalette_Color == rec.color ? ctable : nullptr;
+        SkTArray<SkImageInfo> dstInfos;
+        dstInfos.push_back(SkImageInfo::MakeN32(kWidth, 1, kPremul_SkAlphaType));
+        dstInfos.push_back(SkImageInfo::MakeN32(kWidth, 1, kUnpremul_SkAlphaType));
+        if (SkEncodedInfo::kOpaque_Alpha == rec.alpha) {
+            dstInfos.push_back(SkImageInfo::Make(kWidth, 1, kRGB_565_SkColorType,
+                                                 kOpaque_SkAlphaType));
+        }
+        for (const SkImageInfo& dstInfo : dstInfos) {
+            SkCodec::Options options;
+            SkAutoTDelete<SkSwizzler> full(SkSwizzler::CreateSwizzler(encodedInfo, colors,
+                                                                      dstInfo, options));
+            REPORTER_ASSERT(r, full);
+            if (!full) {
+                continue;
+            }
+            SkAutoTMalloc<uint8_t> expected(dstInfo.minRowBytes());
+            full->swizzle(expected, src);
+
+            const int dstBPP = dstInfo.bytesPerPixel();
+            for (int sampleX : { 2, 3, 5, 8 }) {
+                SkAutoTDelete<SkSwizzler> sampled(SkSwizzler::CreateSwizzler(encodedInfo, colors,
+                                                                             dstInfo, options));
+                const int width = sampled->setSampleX(sampleX);
+                SkAutoTMalloc<uint8_t> actual(width * dstBPP);
+                sampled->swizzle(actual, src);
+                for (int x = 0; x < width; x++) {
+                    const int srcX = get_start_coord(sampleX) + x * sampleX;
+                    REPORTER_ASSERT(r, 0 == memcmp(&actual[x * dstBPP], &expected[srcX * dstBPP],
+                                                   dstBPP));
+                }
+            }
+        }
+    }
+}
+
+// The mask swizzler matches the SkMasks getters, sampled and to 565 too.
+DEF_TEST(MaskSwizzler, r) {
+    static const int kWidth = 301;
+    uint8_t src[4 * kWidth];
+    SkRandom rand;
+    for (int i = 0; i < 4 * kWidth; i++) {
+        src[i] = rand.nextU();
+    }
+
+    SkMasks::InputMasks inputMasks = { 0xF800, 0x07E0, 0x001F, 0 };
+    SkAutoTDelete<SkMasks> masks(SkMasks::CreateMasks(inputMasks, 16));
+    const SkImageInfo srcInfo = SkImageInfo::MakeN32(kWidth, 1, kOpaque_SkAlphaType);
+    for (int sampleX : { 1, 3 }) {
+        for (SkColorType colorType : { kRGBA_8888_SkColorType, kBGRA_8888_SkColorType,
+                                       kRGB_565_SkColorType }) {
+            const SkImageInfo dstInfo = srcInfo.makeColorType(colorType);
+            SkAutoTDelete<SkMaskSwizzler> swizzler(SkMaskSwizzler::CreateMaskSwizzler(
+                    dstInfo, srcInfo, masks, 16, SkCodec::Options()));
+            const int width = swizzler->setSampleX(sampleX);
+            SkAutoTMalloc<uint32_t> dst(width);
+            swizzler->swizzle(dst, src);
+            for (int x = 0; x < width; x++) {
+                const int srcX = get_start_coord(sampleX) + x * sampleX;
+                const uint16_t p = src[2 * srcX] | (src[2 * srcX + 1] << 8);
+                const uint8_t red = masks->getRed(p),
+                              green = masks->getGreen(p),
+                              blue = masks->getBlue(p);
+                switch (colorType) {
+                    case kRGBA_8888_SkColorType:
+                        REPORTER_ASSERT(r, dst[x] == SkPackARGB_as_RGBA(0xFF, red, green, blue));
+                        break;
+                    case kBGRA_8888_SkColorType:
+                        REPORTER_ASSERT(r, dst[x] == SkPackARGB_as_BGRA(0xFF, red, green, blue));
+                        break;
+                    default:
+                        REPORTER_ASSERT(r, ((uint16_t*) dst.get())[x] ==
+                                           SkPack888ToRGB16(red, green, blue));
+                        break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright 2016 Google Inc.
+ *
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "SkBitmap.h"
+#include "SkCanvas.h"
+#include "SkResourceCache.h"
+#include "SkTextBlob.h"
+#include "SkTextBlobRunIterator.h"
+#include "SkTypeface.h"
+#include "Test.h"
+
+// Makes a blob with a run of each kind of positioning.
+static sk_sp<const SkTextBlob> make_blob(bool subpixel) {
+    SkPaint font;
+    font.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    font.setTextSize(17.3f);
+    font.setAntiAlias(true);
+    font.setSubpixelText(subpixel);
+    font.setTypeface(SkTypeface::MakeFromName("monospace", SkTypeface::kNormal));
+
+    const char text[] = "Hamburgefons";
+    const int count = (int)strlen(text);
+    SkTextBlobBuilder builder;
+
+    const SkTextBlobBuilder::RunBuffer& run = builder.allocRun(font, count, 3.7f, 20);
+    SkPaint utf8(font);
+    utf8.setTextEncoding(SkPaint::kUTF8_TextEncoding);
+    utf8.textToGlyphs(text, count, run.glyphs);
+
+    const SkTextBlobBuilder::RunBuffer& posH = builder.allocRunPosH(font, count, 45.2f);
+    utf8.textToGlyphs(text, count, posH.glyphs);
+    for (int i = 0; i < count; ++i) {
+        posH.pos[i] = 2.3f + i * 9.61f;
+    }
+
+    font.setTextSize(11);
+    const SkTextBlobBuilder::RunBuffer& pos = builder.allocRunPos(font, count);
+    utf8.textToGlyphs(text, count, pos.glyphs);
+    for (int i = 0; i < count; ++i) {
+        pos.pos[2 * i] = 1.1f + i * 7.77f;
+        pos.pos[2 * i + 1] = 60 + (i % 3) * 2.9f;
+    }
+    return sk_sp<const SkTextBlob>(builder.build());
+}
+
+// Draws the runs of blob one by one, as devices which do not cache them would.
+static void draw_runs(SkCanvas* canvas, const SkTextBlob* blob, SkScalar x, SkScalar y,
+                      const SkPaint& paint) {
+    SkPaint runPaint(paint);
+    for (SkTextBlobRunIterator it(blob); !it.done(); it.next()) {
+        it.applyFontToPaint(&runPaint);
+        size_t length = it.glyphCount() * sizeof(uint16_t);
+        switch (it.positioning()) {
+            case SkTextBlob::kDefault_Positioning:
+                canvas->drawText(it.glyphs(), length, x + it.offset().x(), y + it.offset().y(),
+                                 runPaint);
+                break;
+            case SkTextBlob::kHorizontal_Positioning: {
+                SkAutoTArray<SkScalar> xpos(it.glyphCount());
+                for (uint32_t i = 0; i < it.glyphCount(); ++i) {
+                    xpos[i] = it.pos()[i] + x;
+                }
+                canvas->drawPosTextH(it.glyphs(), length, xpos.get(), y + it.offset().y(),
+                                     runPaint);
+                break;
+            }
+            case SkTextBlob::kFull_Positioning: {
+                SkAutoTArray<SkPoint> pos(it.glyphCount());
+                for (uint32_t i = 0; i < it.glyphCount(); ++i) {
+                    pos[i].set(it.pos()[2 * i] + x, it.pos()[2 * i + 1] + y);
+                }
+                canvas->drawPosText(it.glyphs(), length, pos.get(), runPaint);
+                break;
+            }
+        }
+    }
+}
+
+static bool equal_pixels(const SkBitmap& a, const SkBitmap& b) {
+    SkAutoLockPixels lockA(a), lockB(b);
+    return a.getSize() == b.getSize() && 0 == memcmp(a.getPixels(), b.getPixels(), a.getSize());
+}
+
+// Drawing a blob again, which blits the glyphs placed the first time, draws the same pixels as
+// drawing its runs, whatever the clip.
+DEF_TEST(TextBlobRasterCache_pixels, reporter) {
+    for (bool subpixel : { false, true }) {
+        sk_sp<const SkTextBlob> blob(make_blob(subpixel));
+        SkPaint paint;
+        paint.setColor(0xFF336699);
+
+        SkBitmap cached, expected;
+        cached.allocN32Pixels(150, 80);
+        expected.allocN32Pixels(150, 80);
+        SkCanvas cachedCanvas(cached), expectedCanvas(expected);
+        const SkScalar x = 0.4f, y = 1.3f;
+
+        for (int i = 0; i < 3; ++i) {
+            cachedCanvas.clear(SK_ColorWHITE);
+            expectedCanvas.clear(SK_ColorWHITE);
+            if (2 == i) {
+                // The cached glyphs are clipped as they are drawn.
+                SkRect clip = SkRect::MakeLTRB(10.5f, 30, 70, 65);
+                cachedCanvas.clipRect(clip, SkRegion::kIntersect_Op, true);
+                expectedCanvas.clipRect(clip, SkRegion::kIntersect_Op, true);
+            }
+            cachedCanvas.drawTextBlob(blob.get(), x, y, paint);
+            draw_runs(&expectedCanvas, blob.get(), x, y, paint);
+            REPORTER_ASSERT(reporter, equal_pixels(cached, expected));
+        }
+
+        // Another matrix places the glyphs elsewhere.
+        cachedCanvas.translate(3.25f, 0.5f);
+        expectedCanvas.translate(3.25f, 0.5f);
+        cachedCanvas.drawTextBlob(blob.get(), x, y, paint);
+        draw_runs(&expectedCanvas, blob.get(), x, y, paint);
+        REPORTER_ASSERT(reporter, equal_pixels(cached, expected));
+    }
+}
+
+struct RunCount {
+    uint32_t fBlobID;
+    int      fCount;
+};
+
+static void count_runs(const SkResourceCache::Rec& rec, void* context) {
+    RunCount* runs = static_cast<RunCount*>(context);
+    if (0 == strcmp(rec.getCategory(), "text-blob-run") &&
+        (uint32_t)rec.getKey().getSharedID() == runs->fBlobID) {
+        runs->fCount += 1;
+    }
+}
+
+// The runs of a blob are purged from the cache once it is deleted.
+DEF_TEST(TextBlobRasterCache_purge, reporter) {
+    SkBitmap bitmap;
+    bitmap.allocN32Pixels(150, 80);
+    SkCanvas canvas(bitmap);
+    SkPaint paint;
+
+    sk_sp<const SkTextBlob> blob(make_blob(false));
+    RunCount runs = { blob->uniqueID(), 0 };
+    canvas.drawTextBlob(blob.get(), 0, 0, paint);
+    SkResourceCache::VisitAll(count_runs, &runs);
+    REPORTER_ASSERT(reporter, 3 == runs.fCount);
+
+    // Drawing it again finds its runs.
+    canvas.drawTextBlob(blob.get(), 0, 0, paint);
+    runs.fCount = 0;
+    SkResourceCache::VisitAll(count_runs, &runs);
+    REPORTER_ASSERT(reporter, 3 == runs.fCount);
+
+    // The cache purges the runs the next time it is used.
+    blob = nullptr;
+    sk_sp<const SkTextBlob> other(make_blob(false));
+    canvas.drawTextBlob(other.get(), 0, 0, paint);
+    runs.fCount = 0;
+    SkResourceCache::VisitAll(count_runs, &runs);
+    REPORTER_ASSERT(reporter, 0 == runs.fCount);
+}
+
+// The glyphs are placed relative to the whole pixel under the blob's origin, so drawing the blob
+// again at a whole pixel offset, by moving it or the canvas, finds the runs already placed.
+DEF_TEST(TextBlobRasterCache_offset, reporter) {
+    for (bool subpixel : { false, true }) {
+        sk_sp<const SkTextBlob> blob(make_blob(subpixel));
+        SkPaint paint;
+        paint.setColor(0xFF336699);
+
+        SkBitmap cached, expected;
+        cached.allocN32Pixels(200, 120);
+        expected.allocN32Pixels(200, 120);
+        SkCanvas cachedCanvas(cached), expectedCanvas(expected);
+        const SkScalar x = 0.25f, y = 1.5f;
+
+        RunCount runs = { blob->uniqueID(), 0 };
+        cachedCanvas.drawTextBlob(blob.get(), x, y, paint);
+        SkResourceCache::VisitAll(count_runs, &runs);
+        REPORTER_ASSERT(reporter, 3 == runs.fCount);
+
+        const SkIPoint offsets[] = { { 37, 11 }, { 5, 40 } };
+        for (int i = 0; i < 2; ++i) {
+            cachedCanvas.clear(SK_ColorWHITE);
+            expectedCanvas.clear(SK_ColorWHITE);
+            SkScalar dx = SkIntToScalar(offsets[i].fX), dy = SkIntToScalar(offsets[i].fY);
+            if (0 == i) {
+                cachedCanvas.drawTextBlob(blob.get(), x + dx, y + dy, paint);
+            } else {
+                cachedCanvas.save();
+                cachedCanvas.translate(dx, dy);
+                cachedCanvas.drawTextBlob(blob.get(), x, y, paint);
+                cachedCanvas.restore();
+            }
+            draw_runs(&expectedCanvas, blob.get(), x + dx, y + dy, paint);
+            REPORTER_ASSERT(reporter, equal_pixels(cached, expected));
+
+            // Both draws were hits, and added no runs.
+            runs.fCount = 0;
+            SkResourceCache::VisitAll(count_runs, &runs);
+            REPORTER_ASSERT(reporter, 3 == runs.fCount);
+        }
+
+        // Half a pixel over is another placement.
+        cachedCanvas.drawTextBlob(blob.get(), x + 0.5f, y, paint);
+        runs.fCount = 0;
+        SkResourceCache::VisitAll(count_runs, &runs);
+        REPORTER_ASSERT(reporter, 6 == runs.fCount);
+    }
+}
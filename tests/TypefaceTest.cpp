@@ -95,3 +95,41 @@ DEF_TEST(TypefaceCache, reporter) {
     }
     REPORTER_ASSERT(reporter, t1->unique());
 }
+
+static bool find_by_id(SkTypeface* face, void* ctx) {
+    return face->uniqueID() == *static_cast<SkFontID*>(ctx);
+}
+
+static bool is_found(const SkTypefaceCache& cache, uint32_t hash, SkFontID id) {
+    sk_sp<SkTypeface> found(cache.findByHashAndProcAndRef(hash, find_by_id, &id));
+    return found && found->uniqueID() == id;
+}
+
+DEF_TEST(TypefaceCache_hash, reporter) {
+    sk_sp<SkTypeface> t1(SkEmptyTypeface::Create(1));
+    sk_sp<SkTypeface> t2(SkEmptyTypeface::Create(2));
+    sk_sp<SkTypeface> t3(SkEmptyTypeface::Create(3));
+    SkTypefaceCache cache;
+    {
+        sk_sp<SkTypeface> t0(SkEmptyTypeface::Create(0));
+        cache.add(t0.get(), 7);
+        cache.add(t1.get(), 7);
+        cache.add(t2.get(), 9);
+        cache.add(t3.get());
+    }
+
+    // Typefaces are only found with the hash they were added with.
+    REPORTER_ASSERT(reporter, is_found(cache, 7, 0));
+    REPORTER_ASSERT(reporter, is_found(cache, 7, 1));
+    REPORTER_ASSERT(reporter, is_found(cache, 9, 2));
+    REPORTER_ASSERT(reporter, !is_found(cache, 9, 1));
+    REPORTER_ASSERT(reporter, !is_found(cache, 7, 3));
+    REPORTER_ASSERT(reporter, count(reporter, cache) == 4);
+
+    // Purging moves the remaining typefaces, which are still found.
+    cache.purgeAll();
+    REPORTER_ASSERT(reporter, count(reporter, cache) == 3);
+    REPORTER_ASSERT(reporter, !is_found(cache, 7, 0));
+    REPORTER_ASSERT(reporter, is_found(cache, 7, 1));
+    REPORTER_ASSERT(reporter, is_found(cache, 9, 2));
+}
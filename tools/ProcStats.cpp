@@ -67,3 +67,25 @@
 #else
     int sk_tools::getCurrResidentSetSizeMB() { return -1; }
 #endif
+
+#if defined(SK_BUILD_FOR_MAC) || defined(SK_BUILD_FOR_IOS)
+    #include <malloc/malloc.h>
+    long long sk_tools::getCurrHeapAllocatedBytes() {
+        malloc_statistics_t stats;
+        malloc_zone_statistics(nullptr, &stats);  // nullptr sums all zones.
+        return stats.size_in_use;
+    }
+#elif defined(SK_BUILD_FOR_UNIX) || defined(SK_BUILD_FOR_ANDROID)
+    #include <malloc.h>
+    long long sk_tools::getCurrHeapAllocatedBytes() {
+        // uordblks counts the arenas' chunks in use, hblkhd the chunks mmap()ed on their own.
+    #if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();  // mallinfo()'s int fields are deprecated.
+    #else
+        struct mallinfo info = mallinfo();
+    #endif
+        return static_cast<long long>(info.uordblks) + static_cast<long long>(info.hblkhd);
+    }
+#else
+    long long sk_tools::getCurrHeapAllocatedBytes() { return -1; }
+#endif
@@ -26,6 +26,13 @@ int getMaxResidentSetSizeMB();
  */
 int getCurrResidentSetSizeMB();
 
+/**
+ *  If implemented, returns the number of bytes the process has allocated from the heap and
+ *  not yet freed. Unlike the resident set, this drops as soon as memory is freed.
+ *  If not, returns -1.
+ */
+long long getCurrHeapAllocatedBytes();
+
 }  // namespace sk_tools
 
 #endif  // ProcStats_DEFINED